@@ -0,0 +1,82 @@
+#pragma once
+
+/// @file bench.h
+/// Minimal timing harness for vost_bench.
+///
+/// Benchmarks register themselves at static-initialization time with
+/// register_bench().  Each receives a State, does its (untimed) setup and
+/// then calls State::measure() with the operation to time.
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace vost {
+namespace bench {
+
+/// Timing summary for one benchmark.
+struct Result {
+    std::string name;
+    size_t      iterations = 0;
+    double      min_ns     = 0;
+    double      median_ns  = 0;
+    double      mean_ns    = 0;
+    uint64_t    items      = 0; ///< Logical items processed per iteration.
+};
+
+/// Per-benchmark context handed to the benchmark function.
+class State {
+public:
+    State(std::string name, double min_time_s, size_t max_iterations);
+
+    /// Set how many logical items (files, paths, commits) one iteration
+    /// processes; reported as items_per_second.
+    void set_items(uint64_t n) { result_.items = n; }
+
+    /// Time @p fn repeatedly until the time budget is spent (at least one
+    /// iteration).  @p setup, if given, runs untimed before each iteration.
+    void measure(const std::function<void()>& fn,
+                 const std::function<void()>& setup = {});
+
+    const Result& result() const { return result_; }
+
+private:
+    double min_time_s_;
+    size_t max_iterations_;
+    Result result_;
+};
+
+using BenchFn = std::function<void(State&)>;
+
+/// A registered benchmark.  Heavy benchmarks are skipped by ``--quick``.
+struct Benchmark {
+    std::string name;
+    BenchFn     fn;
+    bool        heavy = false;
+};
+
+/// Add a benchmark to the global registry.
+void register_bench(std::string name, BenchFn fn, bool heavy = false);
+
+/// All registered benchmarks, in registration order.
+std::vector<Benchmark>& registry();
+
+/// Fresh, uniquely named directory under the system temp dir; removed
+/// (recursively) on destruction.
+class TempDir {
+public:
+    explicit TempDir(const std::string& tag);
+    ~TempDir();
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+} // namespace bench
+} // namespace vost
@@ -0,0 +1,243 @@
+/**
+ * vost_bench — micro and macro benchmarks for the vost C++ library.
+ *
+ * Usage: vost_bench [--filter SUBSTR] [--quick] [--min-time SECONDS]
+ *                   [--json FILE|-] [--list]
+ *
+ * Results are printed as a table; --json also writes them as JSON so runs
+ * can be compared by scripts (e.g. to gate regressions before an upgrade).
+ */
+
+#include "bench.h"
+
+#include <vost/vost.h>
+#include <git2.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace vost {
+namespace bench {
+
+// ---------------------------------------------------------------------------
+// Registry
+// ---------------------------------------------------------------------------
+
+std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benches;
+    return benches;
+}
+
+void register_bench(std::string name, BenchFn fn, bool heavy) {
+    registry().push_back({std::move(name), std::move(fn), heavy});
+}
+
+// ---------------------------------------------------------------------------
+// State
+// ---------------------------------------------------------------------------
+
+State::State(std::string name, double min_time_s, size_t max_iterations)
+    : min_time_s_(min_time_s), max_iterations_(max_iterations) {
+    result_.name = std::move(name);
+}
+
+void State::measure(const std::function<void()>& fn,
+                    const std::function<void()>& setup) {
+    using clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+    double spent = 0;
+    while (samples.empty() ||
+           (spent < min_time_s_ && samples.size() < max_iterations_)) {
+        if (setup) setup();
+        auto t0 = clock::now();
+        fn();
+        auto ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        samples.push_back(ns);
+        spent += ns / 1e9;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    result_.iterations = samples.size();
+    result_.min_ns     = samples.front();
+    result_.median_ns  = samples[samples.size() / 2];
+    result_.mean_ns    = std::accumulate(samples.begin(), samples.end(), 0.0)
+                         / static_cast<double>(samples.size());
+}
+
+// ---------------------------------------------------------------------------
+// TempDir
+// ---------------------------------------------------------------------------
+
+TempDir::TempDir(const std::string& tag) {
+    static std::atomic<unsigned> counter{0};
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    path_ = std::filesystem::temp_directory_path() /
+            ("vost_bench_" + tag + "_" + std::to_string(stamp) + "_" +
+             std::to_string(counter++));
+    std::filesystem::create_directories(path_);
+}
+
+TempDir::~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+}
+
+} // namespace bench
+} // namespace vost
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+namespace {
+
+using vost::bench::Result;
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+double items_per_second(const Result& r) {
+    return r.items && r.median_ns > 0
+        ? static_cast<double>(r.items) * 1e9 / r.median_ns : 0.0;
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results) {
+    int major = 0, minor = 0, rev = 0;
+    git_libgit2_version(&major, &minor, &rev);
+
+    out << "{\n  \"libgit2\": \"" << major << '.' << minor << '.' << rev << "\",\n"
+        << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << json_escape(r.name) << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"min_ns\": " << static_cast<uint64_t>(r.min_ns)
+            << ", \"median_ns\": " << static_cast<uint64_t>(r.median_ns)
+            << ", \"mean_ns\": " << static_cast<uint64_t>(r.mean_ns)
+            << ", \"items\": " << r.items
+            << ", \"items_per_second\": " << static_cast<uint64_t>(items_per_second(r))
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+std::string human_ns(double ns) {
+    char buf[32];
+    if (ns < 1e3)      std::snprintf(buf, sizeof(buf), "%.0f ns", ns);
+    else if (ns < 1e6) std::snprintf(buf, sizeof(buf), "%.1f us", ns / 1e3);
+    else if (ns < 1e9) std::snprintf(buf, sizeof(buf), "%.1f ms", ns / 1e6);
+    else               std::snprintf(buf, sizeof(buf), "%.2f s",  ns / 1e9);
+    return buf;
+}
+
+void print_row(const Result& r) {
+    std::printf("%-44s %8zu %12s %12s", r.name.c_str(), r.iterations,
+                human_ns(r.min_ns).c_str(), human_ns(r.median_ns).c_str());
+    if (r.items) std::printf(" %14.0f/s", items_per_second(r));
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+void usage() {
+    std::cerr << "usage: vost_bench [--filter SUBSTR] [--quick] [--min-time SECONDS]\n"
+                 "                  [--json FILE|-] [--list]\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> filters;
+    std::string json_path;
+    double min_time = 0.5;
+    bool quick = false;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) { usage(); std::exit(2); }
+            return argv[++i];
+        };
+        if (arg == "--filter")        filters.push_back(next());
+        else if (arg == "--json")     json_path = next();
+        else if (arg == "--min-time") min_time = std::atof(next().c_str());
+        else if (arg == "--quick")    quick = true;
+        else if (arg == "--list")     list = true;
+        else { usage(); return 2; }
+    }
+
+    auto selected = [&](const vost::bench::Benchmark& b) {
+        if (quick && b.heavy) return false;
+        if (filters.empty()) return true;
+        return std::any_of(filters.begin(), filters.end(), [&](const std::string& f) {
+            return b.name.find(f) != std::string::npos;
+        });
+    };
+
+    if (list) {
+        for (auto& b : vost::bench::registry())
+            if (selected(b)) std::cout << b.name << (b.heavy ? " (heavy)" : "") << "\n";
+        return 0;
+    }
+
+    // Keep table output on stdout clean when JSON goes there too.
+    bool table = json_path != "-";
+    if (table)
+        std::printf("%-44s %8s %12s %12s %16s\n",
+                    "benchmark", "iters", "min", "median", "throughput");
+
+    std::vector<Result> results;
+    int failures = 0;
+    for (auto& b : vost::bench::registry()) {
+        if (!selected(b)) continue;
+        vost::bench::State st(b.name, min_time, quick ? 20 : 1000);
+        try {
+            b.fn(st);
+        } catch (const std::exception& e) {
+            std::cerr << b.name << ": " << e.what() << "\n";
+            ++failures;
+            continue;
+        }
+        results.push_back(st.result());
+        if (table) print_row(st.result());
+    }
+
+    if (json_path == "-") {
+        write_json(std::cout, results);
+    } else if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        if (!out) {
+            std::cerr << "cannot write " << json_path << "\n";
+            return 1;
+        }
+        write_json(out, results);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+// Macro benchmarks: disk <-> store copies and mirror operations over
+// synthetic trees.
+
+#include "bench.h"
+#include "synth.h"
+
+#include <vost/vost.h>
+
+#include <fstream>
+#include <optional>
+#include <string>
+
+namespace {
+
+namespace sfs = std::filesystem;
+
+using vost::bench::State;
+using vost::bench::TempDir;
+using vost::bench::register_bench;
+
+vost::GitStore open_store(const sfs::path& path) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    return vost::GitStore::open(path, opts);
+}
+
+/// Shape of a synthetic on-disk tree: `dirs` x `files` files of `size` bytes
+/// spread over two directory levels.
+struct DiskShape {
+    size_t dirs;
+    size_t files;
+    size_t size;
+
+    size_t total() const { return dirs * files; }
+    std::string label() const {
+        return std::to_string(total()) + "x" + std::to_string(size) + "B";
+    }
+};
+
+void write_file(const sfs::path& p, size_t size, size_t seed) {
+    std::string data(size, '\0');
+    uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+    for (auto& c : data) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        c = static_cast<char>('a' + x % 26);
+    }
+    std::ofstream(p, std::ios::binary) << data;
+}
+
+void make_disk_tree(const sfs::path& root, const DiskShape& shape) {
+    for (size_t d = 0; d < shape.dirs; ++d) {
+        auto sub = root / ("g" + std::to_string(d % 10)) / ("d" + std::to_string(d));
+        sfs::create_directories(sub);
+        for (size_t f = 0; f < shape.files; ++f)
+            write_file(sub / ("f" + std::to_string(f) + ".dat"), shape.size,
+                       d * shape.files + f);
+    }
+}
+
+/// Rewrite every tenth file under `root` with new content.
+void touch_tenth(const sfs::path& root, const DiskShape& shape, size_t round) {
+    size_t i = 0;
+    for (auto& e : sfs::recursive_directory_iterator(root))
+        if (e.is_regular_file() && i++ % 10 == 0)
+            write_file(e.path(), shape.size, i + round * 7919);
+}
+
+// ---------------------------------------------------------------------------
+// Disk <-> store
+// ---------------------------------------------------------------------------
+
+void bench_copy_in(State& st, const DiskShape& shape) {
+    TempDir dir("copy_in");
+    make_disk_tree(dir.path() / "src", shape);
+    auto fs = open_store(dir.path() / "repo.git").branches()["main"];
+    size_t round = 0;
+    st.set_items(shape.total());
+    st.measure([&] {
+        fs = fs.copy_in(dir.path() / "src", "run" + std::to_string(round++)).second;
+    });
+}
+
+void bench_sync_in(State& st, const DiskShape& shape) {
+    TempDir dir("sync_in");
+    auto src = dir.path() / "src";
+    make_disk_tree(src, shape);
+    auto fs = open_store(dir.path() / "repo.git").branches()["main"];
+    fs = fs.sync_in(src).second;
+    size_t round = 0;
+    st.set_items(shape.total());
+    st.measure([&] { fs = fs.sync_in(src).second; },
+               [&] { touch_tenth(src, shape, ++round); });
+}
+
+void bench_sync_out(State& st, const DiskShape& shape) {
+    TempDir dir("sync_out");
+    make_disk_tree(dir.path() / "src", shape);
+    auto fs = open_store(dir.path() / "repo.git").branches()["main"];
+    fs = fs.copy_in(dir.path() / "src").second;
+    auto out = dir.path() / "out";
+    st.set_items(shape.total());
+    st.measure([&] { fs.sync_out("", out); },
+               [&] { sfs::remove_all(out); });
+}
+
+// ---------------------------------------------------------------------------
+// Mirror
+// ---------------------------------------------------------------------------
+
+/// Store with `shape` imported on main plus a short history.
+vost::GitStore mirror_source(const TempDir& dir, const DiskShape& shape) {
+    make_disk_tree(dir.path() / "src", shape);
+    auto store = open_store(dir.path() / "repo.git");
+    auto fs = store.branches()["main"].copy_in(dir.path() / "src").second;
+    for (size_t i = 0; i < 10; ++i) {
+        touch_tenth(dir.path() / "src", shape, i);
+        fs = fs.sync_in(dir.path() / "src").second;
+    }
+    return store;
+}
+
+void bench_backup(State& st, const DiskShape& shape) {
+    TempDir dir("backup");
+    auto store = mirror_source(dir, shape);
+    auto dest = (dir.path() / "backup.git").string();
+    st.set_items(shape.total());
+    st.measure([&] { store.backup(dest); },
+               [&] { sfs::remove_all(dest); });
+}
+
+void bench_restore(State& st, const DiskShape& shape) {
+    TempDir dir("restore");
+    auto src = (dir.path() / "backup.git").string();
+    mirror_source(dir, shape).backup(src);
+    std::optional<vost::GitStore> target;
+    st.set_items(shape.total());
+    st.measure([&] { target->restore(src); },
+               [&] {
+                   target.reset();
+                   sfs::remove_all(dir.path() / "target.git");
+                   target.emplace(open_store(dir.path() / "target.git"));
+               });
+}
+
+// ---------------------------------------------------------------------------
+// Generated stores
+// ---------------------------------------------------------------------------
+
+void bench_generate(State& st, const vost::synth::Shape& shape) {
+    TempDir dir("generate");
+    size_t round = 0;
+    st.set_items(shape.base_files());
+    st.measure([&] {
+        vost::synth::generate(dir.path() / (std::to_string(round++) + ".git"), shape);
+    });
+}
+
+void bench_walk(State& st, const vost::synth::Shape& shape) {
+    TempDir dir("walk");
+    vost::synth::generate(dir.path() / "repo.git", shape);
+    auto fs = vost::GitStore::open(dir.path() / "repo.git").branches()[shape.branch];
+    st.set_items(shape.base_files());
+    st.measure([&] { fs.walk(); });
+}
+
+// ---------------------------------------------------------------------------
+// Registration
+// ---------------------------------------------------------------------------
+
+[[maybe_unused]] const bool registered = [] {
+    const DiskShape shapes[] = {
+        {20, 50, 1024},      // 1k small files
+        {100, 100, 4096},    // 10k files, 40 MB
+    };
+    for (const auto& shape : shapes) {
+        bool heavy = shape.total() > 1000;
+        std::string l = shape.label();
+        register_bench("macro/copy_in/" + l,  [shape](State& st) { bench_copy_in(st, shape); }, heavy);
+        register_bench("macro/sync_in/" + l,  [shape](State& st) { bench_sync_in(st, shape); }, heavy);
+        register_bench("macro/sync_out/" + l, [shape](State& st) { bench_sync_out(st, shape); }, heavy);
+        register_bench("macro/backup/" + l,   [shape](State& st) { bench_backup(st, shape); }, heavy);
+        register_bench("macro/restore/" + l,  [shape](State& st) { bench_restore(st, shape); }, heavy);
+    }
+
+    auto shape = vost::synth::Shape::parse({"depth=3", "fanout=6", "files_per_dir=8"});
+    auto label = std::to_string(shape.base_files()) + "files";
+    register_bench("macro/generate/" + label, [shape](State& st) { bench_generate(st, shape); });
+    register_bench("macro/walk/" + label,     [shape](State& st) { bench_walk(st, shape); });
+    return true;
+}();
+
+} // anonymous namespace
@@ -0,0 +1,290 @@
+// Micro benchmarks: single Fs/Batch/GitStore operations on small,
+// purpose-built stores.
+
+#include "bench.h"
+
+#include <vost/vost.h>
+
+#include <optional>
+#include <string>
+
+namespace {
+
+using vost::bench::State;
+using vost::bench::TempDir;
+using vost::bench::register_bench;
+
+vost::GitStore open_store(const std::filesystem::path& path,
+                          vost::HashBackend hash = vost::HashBackend::Safe,
+                          std::optional<vost::CompressionPolicy> policy = std::nullopt) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    opts.hash = hash;
+    opts.compression_policy = std::move(policy);
+    return vost::GitStore::open(path, opts);
+}
+
+/// "d0/d1/.../d{depth-2}/file.txt" — a file `depth` levels below the root.
+std::string deep_path(int depth) {
+    std::string p;
+    for (int i = 0; i + 1 < depth; ++i) p += "d" + std::to_string(i) + "/";
+    return p + "file.txt";
+}
+
+// ---------------------------------------------------------------------------
+// Path lookups
+// ---------------------------------------------------------------------------
+
+/// Store whose only file lives `depth` levels down, next to a few siblings
+/// at every level so each lookup scans a realistic tree.
+vost::Fs deep_store(const TempDir& dir, int depth) {
+    auto b = open_store(dir.path() / "repo.git").branches()["main"].batch();
+    std::string prefix;
+    for (int i = 0; i + 1 < depth; ++i) {
+        for (int s = 0; s < 8; ++s)
+            b.write_text(prefix + "sib" + std::to_string(s) + ".txt", "s");
+        prefix += "d" + std::to_string(i) + "/";
+    }
+    b.write_text(deep_path(depth), "payload");
+    return b.commit();
+}
+
+void bench_read(State& st, int depth) {
+    TempDir dir("read");
+    auto fs = deep_store(dir, depth);
+    auto path = deep_path(depth);
+    st.set_items(1);
+    st.measure([&] { fs.read(path); });
+}
+
+void bench_stat(State& st, int depth) {
+    TempDir dir("stat");
+    auto fs = deep_store(dir, depth);
+    auto path = deep_path(depth);
+    st.set_items(1);
+    st.measure([&] { fs.stat(path); });
+}
+
+void bench_exists(State& st, int depth) {
+    TempDir dir("exists");
+    auto fs = deep_store(dir, depth);
+    auto path = deep_path(depth);
+    st.set_items(2);
+    st.measure([&] {
+        fs.exists(path);
+        fs.exists(path + ".missing");
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Directory listing and glob
+// ---------------------------------------------------------------------------
+
+void bench_listdir(State& st, size_t width) {
+    TempDir dir("listdir");
+    auto b = open_store(dir.path() / "repo.git").branches()["main"].batch();
+    for (size_t i = 0; i < width; ++i)
+        b.write_text("wide/f" + std::to_string(i) + ".txt", std::to_string(i));
+    auto fs = b.commit();
+    st.set_items(width);
+    st.measure([&] { fs.listdir("wide"); });
+}
+
+void bench_iglob(State& st) {
+    TempDir dir("iglob");
+    auto b = open_store(dir.path() / "repo.git").branches()["main"].batch();
+    for (int d = 0; d < 20; ++d)
+        for (int f = 0; f < 50; ++f)
+            b.write_text("dir" + std::to_string(d) + "/sub/f" + std::to_string(f) +
+                         (f % 2 ? ".txt" : ".bin"), "x");
+    auto fs = b.commit();
+    st.set_items(1000);
+    st.measure([&] { fs.iglob("**/*.txt"); });
+}
+
+// ---------------------------------------------------------------------------
+// Commit paths
+// ---------------------------------------------------------------------------
+
+void bench_batch_commit(State& st, size_t n) {
+    TempDir dir("batch");
+    auto fs = open_store(dir.path() / "repo.git").branches()["main"];
+    std::optional<vost::Batch> batch;
+    size_t round = 0;
+    st.set_items(n);
+    st.measure(
+        [&] { fs = batch->commit(); },
+        [&] {
+            batch.emplace(fs.batch());
+            std::string tag = std::to_string(round++);
+            for (size_t i = 0; i < n; ++i)
+                batch->write_text("d" + std::to_string(i % 1000) + "/f" +
+                                  std::to_string(i) + ".txt", tag);
+        });
+}
+
+/// Commit 200 new 64 KiB blobs, hashed by `hash`.
+void bench_ingest(State& st, vost::HashBackend hash) {
+    TempDir dir("ingest");
+    auto fs = open_store(dir.path() / "repo.git", hash).branches()["main"];
+    std::optional<vost::Batch> batch;
+    std::string data(64 * 1024, 'x');
+    size_t round = 0;
+    st.set_items(200);
+    st.measure(
+        [&] { fs = batch->commit(); },
+        [&] {
+            batch.emplace(fs.batch());
+            std::string tag = std::to_string(round++);
+            for (int i = 0; i < 200; ++i) {
+                std::string head = tag + "/" + std::to_string(i);
+                data.replace(0, head.size(), head);
+                batch->write_text("in/" + tag + "/" + std::to_string(i), data);
+            }
+        });
+}
+
+/// Commit 200 new 64 KiB incompressible blobs, with or without a
+/// compression policy.
+void bench_ingest_media(State& st, bool policy) {
+    TempDir dir("media");
+    std::optional<vost::CompressionPolicy> cp;
+    if (policy) cp.emplace();
+    auto fs = open_store(dir.path() / "repo.git", vost::HashBackend::Safe, cp)
+                  .branches()["main"];
+    std::optional<vost::Batch> batch;
+    std::string data(64 * 1024, '\0');
+    uint64_t x = 88172645463325252ull;
+    size_t round = 0;
+    st.set_items(200);
+    st.measure(
+        [&] { fs = batch->commit(); },
+        [&] {
+            batch.emplace(fs.batch());
+            std::string tag = std::to_string(round++);
+            for (int i = 0; i < 200; ++i) {
+                for (auto& c : data) {  // xorshift64: cheap random bytes
+                    x ^= x << 13;
+                    x ^= x >> 7;
+                    x ^= x << 17;
+                    c = static_cast<char>(x);
+                }
+                batch->write_text("media/" + tag + "/" + std::to_string(i) + ".bin", data);
+            }
+        });
+}
+
+/// Existence checks for 10k blob hashes, half of them absent: one
+/// GitStore::missing call, or a has_hash call per hash.
+void bench_missing(State& st, bool batched) {
+    TempDir dir("missing");
+    auto store = open_store(dir.path() / "repo.git");
+    auto b = store.branches()["main"].batch();
+    for (int i = 0; i < 5000; ++i) b.write_text("f/" + std::to_string(i), std::to_string(i));
+    auto fs = b.commit();
+    store.pack();
+    std::vector<std::string> hashes;
+    for (int i = 0; i < 5000; ++i) {
+        hashes.push_back(fs.object_hash("f/" + std::to_string(i)));
+        std::string absent = hashes.back();
+        absent[0] = absent[0] == 'f' ? '0' : 'f';
+        hashes.push_back(absent);
+    }
+    st.set_items(hashes.size());
+    if (batched) {
+        st.measure([&] { store.missing(hashes); });
+    } else {
+        st.measure([&] {
+            for (const auto& h : hashes) store.has_hash(h);
+        });
+    }
+}
+
+/// One read from each of 200 tenant stores, reopening the store per
+/// request or taking it from a StorePool.
+void bench_tenant_read(State& st, bool pooled) {
+    TempDir dir("tenants");
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 200; ++i) {
+        paths.push_back(dir.path() / ("t" + std::to_string(i) + ".git"));
+        open_store(paths.back()).branches()["main"].write_text("a.txt", std::to_string(i));
+    }
+    vost::StorePool pool;
+    st.set_items(paths.size());
+    st.measure([&] {
+        for (const auto& p : paths) {
+            auto store = pooled ? pool.open(p) : vost::GitStore::open(p);
+            store.branches()["main"].read("a.txt");
+        }
+    });
+}
+
+void bench_log_path(State& st) {
+    TempDir dir("log");
+    auto fs = open_store(dir.path() / "repo.git").branches()["main"];
+    for (int i = 0; i < 500; ++i) {
+        if (i % 10 == 0) fs = fs.write_text("hot/x.txt", std::to_string(i));
+        else             fs = fs.write_text("cold/" + std::to_string(i) + ".txt", "c");
+    }
+    vost::LogOptions opts;
+    opts.path = "hot/x.txt";
+    st.set_items(500);
+    st.measure([&] { fs.log(opts); });
+}
+
+void bench_pack(State& st) {
+    TempDir dir("pack");
+    auto store = open_store(dir.path() / "repo.git");
+    auto fs = store.branches()["main"];
+    size_t round = 0;
+    st.set_items(200);
+    st.measure(
+        [&] { store.pack(); },
+        [&] {
+            auto b = fs.batch();
+            std::string tag = std::to_string(round++);
+            for (int i = 0; i < 200; ++i)
+                b.write_text("p/" + tag + "/" + std::to_string(i), tag);
+            fs = b.commit();
+        });
+}
+
+// ---------------------------------------------------------------------------
+// Registration
+// ---------------------------------------------------------------------------
+
+[[maybe_unused]] const bool registered = [] {
+    for (int depth : {1, 4, 16}) {
+        std::string d = std::to_string(depth);
+        register_bench("micro/read/depth=" + d,   [depth](State& st) { bench_read(st, depth); });
+        register_bench("micro/stat/depth=" + d,   [depth](State& st) { bench_stat(st, depth); });
+        register_bench("micro/exists/depth=" + d, [depth](State& st) { bench_exists(st, depth); });
+    }
+    for (size_t width : {100, 10000})
+        register_bench("micro/listdir/width=" + std::to_string(width),
+                       [width](State& st) { bench_listdir(st, width); });
+    register_bench("micro/iglob/1k", bench_iglob);
+    for (size_t n : {10, 1000, 100000})
+        register_bench("micro/batch_commit/n=" + std::to_string(n),
+                       [n](State& st) { bench_batch_commit(st, n); }, n >= 100000);
+    register_bench("micro/ingest/hash=safe",
+                   [](State& st) { bench_ingest(st, vost::HashBackend::Safe); });
+    register_bench("micro/ingest/hash=fast",
+                   [](State& st) { bench_ingest(st, vost::HashBackend::Fast); });
+    register_bench("micro/ingest_media/policy=off",
+                   [](State& st) { bench_ingest_media(st, false); });
+    register_bench("micro/ingest_media/policy=on",
+                   [](State& st) { bench_ingest_media(st, true); });
+    register_bench("micro/missing/10k", [](State& st) { bench_missing(st, true); });
+    register_bench("micro/has_hash/10k", [](State& st) { bench_missing(st, false); });
+    register_bench("micro/tenant_read/pool=off",
+                   [](State& st) { bench_tenant_read(st, false); });
+    register_bench("micro/tenant_read/pool=on",
+                   [](State& st) { bench_tenant_read(st, true); });
+    register_bench("micro/log_path/500", bench_log_path);
+    register_bench("micro/pack/200", bench_pack);
+    return true;
+}();
+
+} // anonymous namespace
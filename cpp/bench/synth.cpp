@@ -0,0 +1,368 @@
+#include "synth.h"
+
+#include <git2.h>
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+namespace vost {
+namespace synth {
+
+namespace {
+
+/// 64-bit FNV-1a, used to key per-path content streams.
+uint64_t fnv1a(const std::string& s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+uint64_t path_key(uint64_t seed, const std::string& path, uint64_t version) {
+    return fnv1a(path) ^ (seed * 0x9E3779B97F4A7C15ull) ^ (version * 0xD1B54A32D192ED03ull);
+}
+
+[[noreturn]] void throw_git(const std::string& ctx) {
+    const git_error* e = git_error_last();
+    std::string msg = ctx;
+    if (e && e->message) { msg += ": "; msg += e->message; }
+    throw GitError(msg);
+}
+
+std::string oid_hex(const git_oid* oid) {
+    char buf[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(buf, sizeof(buf), oid);
+    return std::string(buf, GIT_OID_HEXSZ);
+}
+
+struct RepoGuard {
+    git_repository* r = nullptr;
+    ~RepoGuard() { if (r) git_repository_free(r); }
+};
+
+struct BuilderGuard {
+    git_treebuilder* tb = nullptr;
+    ~BuilderGuard() { if (tb) git_treebuilder_free(tb); }
+};
+
+/// Turns off libgit2's strict object creation (the existence check on
+/// every tree insert) while alive, and restores it on destruction, also
+/// when unwinding.  The option is process-wide: other stores in the same
+/// process skip the check too while a guard lives.  libgit2 has no getter
+/// for it, so guards are counted and the last one restores libgit2's
+/// default (on); a process that turned it off itself should not generate.
+class StrictObjectsOff {
+public:
+    StrictObjectsOff() {
+        std::lock_guard<std::mutex> lk(mutex());
+        if (depth()++ == 0) git_libgit2_opts(GIT_OPT_ENABLE_STRICT_OBJECT_CREATION, 0);
+    }
+    ~StrictObjectsOff() {
+        std::lock_guard<std::mutex> lk(mutex());
+        if (--depth() == 0) git_libgit2_opts(GIT_OPT_ENABLE_STRICT_OBJECT_CREATION, 1);
+    }
+    StrictObjectsOff(const StrictObjectsOff&) = delete;
+    StrictObjectsOff& operator=(const StrictObjectsOff&) = delete;
+
+private:
+    static std::mutex& mutex() { static std::mutex m; return m; }
+    static int& depth() { static int d = 0; return d; }
+};
+
+// ---------------------------------------------------------------------------
+// Base snapshot — direct tree construction
+// ---------------------------------------------------------------------------
+
+/// Write the directory at @p prefix and everything below it; returns its
+/// tree OID, or nullopt for an empty non-root directory.  Paths of all
+/// files written are appended to @p paths.
+std::optional<git_oid> build_dir(git_repository* repo, const Shape& shape,
+                  const std::string& prefix, size_t level,
+                  std::vector<std::string>& paths) {
+    BuilderGuard bg;
+    if (git_treebuilder_new(&bg.tb, repo, nullptr) != 0)
+        throw_git("git_treebuilder_new");
+
+    for (size_t f = 0; f < shape.files_per_dir; ++f) {
+        std::string name = "f" + std::to_string(f) + ".dat";
+        std::string path = prefix + name;
+        uint64_t key = path_key(shape.seed, path, 0);
+        auto data = content(key, Rng(key).log_uniform(shape.min_size, shape.max_size));
+
+        git_oid blob;
+        if (git_blob_create_from_buffer(&blob, repo, data.data(), data.size()) != 0)
+            throw_git("git_blob_create_from_buffer");
+        if (git_treebuilder_insert(nullptr, bg.tb, name.c_str(), &blob,
+                                   GIT_FILEMODE_BLOB) != 0)
+            throw_git("git_treebuilder_insert");
+        paths.push_back(std::move(path));
+    }
+
+    if (level < shape.depth) {
+        for (size_t d = 0; d < shape.fanout; ++d) {
+            std::string name = "d" + std::to_string(d);
+            auto sub = build_dir(repo, shape, prefix + name + "/", level + 1, paths);
+            if (!sub) continue;
+            if (git_treebuilder_insert(nullptr, bg.tb, name.c_str(), &*sub,
+                                       GIT_FILEMODE_TREE) != 0)
+                throw_git("git_treebuilder_insert");
+        }
+    }
+
+    if (level > 0 && git_treebuilder_entrycount(bg.tb) == 0) return std::nullopt;
+    git_oid out;
+    if (git_treebuilder_write(&out, bg.tb) != 0)
+        throw_git("git_treebuilder_write");
+    return out;
+}
+
+/// Build the base tree and commit it on top of @p parent_hex.
+/// Returns (commit hex, tree hex).
+std::pair<std::string, std::string>
+commit_base(const std::filesystem::path& path, const Shape& shape,
+            const Signature& who, const std::string& parent_hex,
+            std::vector<std::string>& paths) {
+    RepoGuard repo;
+    if (git_repository_open(&repo.r, path.string().c_str()) != 0)
+        throw_git("git_repository_open");
+
+    // Every entry inserted below was just written, so skip libgit2's
+    // per-insert existence check (an ODB lookup per file).
+    git_oid tree_oid;
+    {
+        StrictObjectsOff unchecked;
+        tree_oid = *build_dir(repo.r, shape, "", 0, paths);
+    }
+
+    git_tree* tree = nullptr;
+    if (git_tree_lookup(&tree, repo.r, &tree_oid) != 0)
+        throw_git("git_tree_lookup");
+    git_commit* parent = nullptr;
+    git_oid parent_oid;
+    if (git_oid_fromstr(&parent_oid, parent_hex.c_str()) != 0 ||
+        git_commit_lookup(&parent, repo.r, &parent_oid) != 0) {
+        git_tree_free(tree);
+        throw_git("git_commit_lookup");
+    }
+    git_signature* sig = nullptr;
+    if (git_signature_now(&sig, who.name.c_str(), who.email.c_str()) != 0) {
+        git_commit_free(parent);
+        git_tree_free(tree);
+        throw_git("git_signature_now");
+    }
+
+    const git_commit* parents[] = {parent};
+    git_oid commit_oid;
+    std::string msg = "synth: base " + std::to_string(paths.size()) + " files";
+    int rc = git_commit_create(&commit_oid, repo.r, nullptr, sig, sig, nullptr,
+                               msg.c_str(), tree, 1, parents);
+    git_signature_free(sig);
+    git_commit_free(parent);
+    git_tree_free(tree);
+    if (rc != 0) throw_git("git_commit_create");
+
+    return {oid_hex(&commit_oid), oid_hex(&tree_oid)};
+}
+
+/// Parent directory of a slash-separated path, with trailing slash ("" at root).
+std::string dir_of(const std::string& path) {
+    auto slash = path.rfind('/');
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------
+// Rng / content
+// ---------------------------------------------------------------------------
+
+uint64_t Rng::next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+size_t Rng::log_uniform(size_t lo, size_t hi) {
+    if (hi <= lo) return lo;
+    // Pick a power-of-two band uniformly, then a value inside it; integer
+    // only, so results do not depend on the platform's libm.
+    auto bits = [](size_t v) { size_t b = 0; while (v) { ++b; v >>= 1; } return b; };
+    size_t lo_bits = bits(lo), hi_bits = bits(hi);
+    size_t band = lo_bits + below(hi_bits - lo_bits + 1);
+    size_t band_lo = band ? size_t(1) << (band - 1) : 0;
+    size_t band_hi = band ? (size_t(1) << band) - 1 : 0;
+    band_lo = std::max(band_lo, lo);
+    band_hi = std::min(band_hi, hi);
+    return band_lo + below(band_hi - band_lo + 1);
+}
+
+std::vector<uint8_t> content(uint64_t key, size_t size) {
+    // Text-like lines of lowercase words: compressible roughly like source
+    // or config files, and cheap to produce.
+    std::vector<uint8_t> out(size);
+    Rng rng(key);
+    uint64_t bits = 0;
+    int left = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (left == 0) { bits = rng.next(); left = 12; }
+        uint8_t r = bits & 31;
+        bits >>= 5;
+        --left;
+        out[i] = r < 26 ? static_cast<uint8_t>('a' + r) : (r < 30 ? ' ' : '\n');
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Shape
+// ---------------------------------------------------------------------------
+
+size_t Shape::base_files() const {
+    size_t dirs = 0, level = 1;
+    for (size_t d = 0; d <= depth; ++d) {
+        dirs += level;
+        level *= fanout;
+    }
+    return dirs * files_per_dir;
+}
+
+std::string Shape::to_string() const {
+    return "seed=" + std::to_string(seed) +
+           " depth=" + std::to_string(depth) +
+           " fanout=" + std::to_string(fanout) +
+           " files_per_dir=" + std::to_string(files_per_dir) +
+           " min_size=" + std::to_string(min_size) +
+           " max_size=" + std::to_string(max_size) +
+           " commits=" + std::to_string(commits) +
+           " changes_per_commit=" + std::to_string(changes_per_commit) +
+           " branches=" + std::to_string(branches) +
+           " notes=" + std::to_string(notes) +
+           " branch=" + branch;
+}
+
+Shape Shape::parse(const std::vector<std::string>& tokens) {
+    Shape s;
+    for (const auto& tok : tokens) {
+        auto eq = tok.find('=');
+        if (eq == std::string::npos)
+            throw std::invalid_argument("expected key=value: " + tok);
+        std::string key = tok.substr(0, eq);
+        std::string val = tok.substr(eq + 1);
+        if (key == "branch") {
+            if (val.empty()) throw std::invalid_argument("empty branch");
+            s.branch = val;
+            continue;
+        }
+        uint64_t n;
+        try {
+            size_t used = 0;
+            n = std::stoull(val, &used);
+            if (used != val.size()) throw std::invalid_argument(val);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("bad value for " + key + ": " + val);
+        }
+        if      (key == "seed")               s.seed = n;
+        else if (key == "depth")              s.depth = n;
+        else if (key == "fanout")             s.fanout = n;
+        else if (key == "files_per_dir")      s.files_per_dir = n;
+        else if (key == "min_size")           s.min_size = n;
+        else if (key == "max_size")           s.max_size = n;
+        else if (key == "commits")            s.commits = n;
+        else if (key == "changes_per_commit") s.changes_per_commit = n;
+        else if (key == "branches")           s.branches = n;
+        else if (key == "notes")              s.notes = n;
+        else throw std::invalid_argument("unknown key: " + key);
+    }
+    if (s.min_size > s.max_size)
+        throw std::invalid_argument("min_size > max_size");
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// generate
+// ---------------------------------------------------------------------------
+
+Summary generate(const std::filesystem::path& path, const Shape& shape) {
+    if (std::filesystem::exists(path))
+        throw std::invalid_argument("already exists: " + path.string());
+
+    OpenOptions opts;
+    opts.create = true;
+    opts.branch = shape.branch;
+    auto store = GitStore::open(path, opts);
+
+    Summary sum;
+    std::vector<std::string> paths;
+    auto init = *store.branches()[shape.branch].commit_hash();
+    auto [base_commit, base_tree] =
+        commit_base(path, shape, store.signature(), init, paths);
+    store.branches().set(shape.branch, store.fs(base_commit));
+    sum.base_tree = base_tree;
+
+    // History: each commit modifies, adds or removes changes_per_commit files.
+    Rng rng(shape.seed ^ 0x5EED5EED5EED5EEDull);
+    std::vector<std::string> history{base_commit};
+    auto fs = store.branches()[shape.branch];
+    for (size_t c = 0; c < shape.commits; ++c) {
+        BatchOptions bo;
+        bo.message = "synth: commit " + std::to_string(c + 1);
+        auto batch = fs.batch(bo);
+        for (size_t k = 0; k < shape.changes_per_commit; ++k) {
+            uint64_t r = rng.below(10);
+            if (paths.empty()) r = 9;
+            if (r == 0) {
+                size_t i = rng.below(paths.size());
+                batch.remove(paths[i]);
+                paths[i] = std::move(paths.back());
+                paths.pop_back();
+            } else if (r == 1 || r == 9) {
+                std::string dir = paths.empty() ? "" : dir_of(paths[rng.below(paths.size())]);
+                std::string p = dir + "n" + std::to_string(c) + "_" + std::to_string(k) + ".dat";
+                uint64_t key = path_key(shape.seed, p, c + 1);
+                batch.write(p, content(key, rng.log_uniform(shape.min_size, shape.max_size)));
+                paths.push_back(std::move(p));
+            } else {
+                const auto& p = paths[rng.below(paths.size())];
+                uint64_t key = path_key(shape.seed, p, c + 1);
+                batch.write(p, content(key, rng.log_uniform(shape.min_size, shape.max_size)));
+            }
+        }
+        fs = batch.commit();
+        history.push_back(*fs.commit_hash());
+    }
+
+    // Branches forked from random points in history, one commit each.
+    for (size_t b = 0; b < shape.branches; ++b) {
+        std::string name = "synth/b" + std::to_string(b);
+        store.branches().set(name, store.fs(history[rng.below(history.size())]));
+        auto batch = store.branches()[name].batch();
+        for (size_t k = 0; k < shape.changes_per_commit; ++k) {
+            std::string p = name + "/n" + std::to_string(k) + ".dat";
+            batch.write(p, content(path_key(shape.seed, p, 0),
+                                   rng.log_uniform(shape.min_size, shape.max_size)));
+        }
+        batch.commit();
+    }
+
+    // Notes on evenly spaced main-line commits.
+    if (shape.notes && !history.empty()) {
+        size_t n = std::min(shape.notes, history.size());
+        auto nb = store.notes().commits().batch();
+        for (size_t i = 0; i < n; ++i)
+            nb.set(history[i * history.size() / n], "synth note " + std::to_string(i));
+        nb.commit();
+    }
+
+    sum.files   = paths.size();
+    sum.commits = history.size() + 1; // + the store's initial commit
+    sum.tip     = history.back();
+    return sum;
+}
+
+} // namespace synth
+} // namespace vost
@@ -0,0 +1,91 @@
+#pragma once
+
+/// @file synth.h
+/// Deterministic synthetic stores for benchmarks and perf reproductions.
+///
+/// A Shape plus its seed fully determines every path, blob and tree: two
+/// runs of generate() with the same Shape produce identical tree hashes.
+/// Commit hashes additionally include the committer timestamp and differ
+/// between runs.
+
+#include <vost/vost.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace vost {
+namespace synth {
+
+/// Controls the shape of a generated store.
+struct Shape {
+    uint64_t seed = 1;
+
+    // -- Base snapshot ----------------------------------------------------
+    size_t depth         = 3;    ///< Directory levels below the root.
+    size_t fanout        = 4;    ///< Subdirectories per directory.
+    size_t files_per_dir = 16;   ///< Files in every directory (root included).
+    size_t min_size      = 64;   ///< Smallest file, bytes.
+    size_t max_size      = 4096; ///< Largest file, bytes (log-uniform in between).
+
+    // -- History ----------------------------------------------------------
+    size_t commits            = 0;  ///< Commits on top of the base snapshot.
+    size_t changes_per_commit = 8;  ///< Files added/modified/removed per commit.
+    size_t branches           = 0;  ///< Extra branches, each forked from history.
+    size_t notes              = 0;  ///< Notes on distinct main-line commits.
+
+    std::string branch = "main";
+
+    /// Number of files in the base snapshot.
+    size_t base_files() const;
+
+    /// Canonical ``key=value`` form accepted by parse().
+    std::string to_string() const;
+
+    /// Parse ``key=value`` tokens (as printed by to_string()) over the
+    /// defaults.
+    /// @throws std::invalid_argument on unknown keys or bad values.
+    static Shape parse(const std::vector<std::string>& tokens);
+};
+
+/// What generate() produced.
+struct Summary {
+    size_t      files   = 0; ///< Files on the main branch tip.
+    size_t      commits = 0; ///< Commits on the main branch (base included).
+    std::string base_tree;   ///< Tree hash of the base snapshot.
+    std::string tip;         ///< Commit hash of the main branch tip.
+};
+
+/// Small, portable PRNG (splitmix64); stable across platforms and
+/// standard libraries, unlike the <random> distributions.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_(seed) {}
+    uint64_t next();
+    /// Uniform in [0, n).
+    uint64_t below(uint64_t n) { return n ? next() % n : 0; }
+    /// Log-uniform in [lo, hi].
+    size_t log_uniform(size_t lo, size_t hi);
+
+private:
+    uint64_t state_;
+};
+
+/// Deterministic content of @p size bytes for stream @p key.
+std::vector<uint8_t> content(uint64_t key, size_t size);
+
+/// Create a new store at @p path with @p shape.
+///
+/// The base snapshot is built bottom-up directly as git trees, one
+/// tree write per directory, so large shapes cost O(files).  History,
+/// branches and notes are then written through Batch and NotesBatch.
+///
+/// While the base trees are built, libgit2's strict object creation is
+/// off for the whole process (see StrictObjectsOff in synth.cpp), so run
+/// generation apart from stores whose tree writes need that check.
+/// @throws std::invalid_argument if @p path already exists.
+Summary generate(const std::filesystem::path& path, const Shape& shape);
+
+} // namespace synth
+} // namespace vost
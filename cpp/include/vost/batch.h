@@ -74,6 +74,14 @@ public:
     /// @throws BatchClosedError if already committed.
     Batch& write_symlink(const std::string& path, const std::string& target);
 
+    /// Stage the blob `hash`, already in the store, at `path` without
+    /// sending its content (see GitStore::missing).  Its existence is
+    /// checked by commit().
+    /// @throws BatchClosedError if already committed.
+    /// @throws InvalidHashError if `hash` is malformed.
+    Batch& write_oid(const std::string& path, const std::string& hash,
+                     uint32_t mode = MODE_BLOB);
+
     /// Stage `path` for removal.
     /// @throws BatchClosedError if already committed.
     Batch& remove(const std::string& path);
@@ -82,13 +90,14 @@ public:
 
     /// Commit all staged changes and return the resulting Fs.
     /// After this call the Batch is closed — further writes throw BatchClosedError.
+    /// @throws NotFoundError if a write_oid() blob is not in the store.
     Fs commit();
 
     // -- State ---------------------------------------------------------------
 
     bool closed() const { return closed_; }
 
-    size_t pending_writes()  const { return writes_.size(); }
+    size_t pending_writes()  const { return writes_.size() + refs_.size(); }
     size_t pending_removes() const { return removes_.size(); }
 
     /// The result Fs after commit(). Only valid after commit() has been called.
@@ -102,6 +111,8 @@ private:
     /// data is empty for removes that have been superseded.
     std::vector<std::pair<std::string,
                           std::pair<std::vector<uint8_t>, uint32_t>>> writes_;
+    /// write_oid() entries: (normalized_path, {blob hex, mode}).
+    std::vector<std::pair<std::string, std::pair<std::string, uint32_t>>> refs_;
     std::vector<std::string> removes_;
     std::optional<std::string>               message_;
     std::optional<std::string>               operation_;
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace vost {
 
+struct MergeConflict;
+
 // ---------------------------------------------------------------------------
 // Base exception
 // ---------------------------------------------------------------------------
@@ -111,6 +115,16 @@ public:
     BatchClosedError() : VostError("batch already closed") {}
 };
 
+/// A three-way merge found paths changed differently on both sides.
+class MergeConflictError : public VostError {
+public:
+    explicit MergeConflictError(std::vector<MergeConflict> conflicts);
+    /// The conflicting paths, in tree order.
+    const std::vector<MergeConflict>& conflicts() const { return *conflicts_; }
+private:
+    std::shared_ptr<const std::vector<MergeConflict>> conflicts_;
+};
+
 /// A low-level libgit2 operation failed.
 class GitError : public VostError {
 public:
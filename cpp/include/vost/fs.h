@@ -2,12 +2,14 @@
 
 #include "error.h"
 #include "types.h"
+#include "watch.h"
 
 #include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct git_oid;
@@ -84,51 +86,51 @@ public:
     /// Read file contents as bytes.
     /// @throws NotFoundError if path does not exist.
     /// @throws IsADirectoryError if path is a directory.
-    std::vector<uint8_t> read(const std::string& path) const;
+    std::vector<uint8_t> read(std::string_view path) const;
 
     /// Read file contents as a UTF-8 string.
     /// @throws NotFoundError if path does not exist.
-    std::string read_text(const std::string& path) const;
+    std::string read_text(std::string_view path) const;
 
     /// List entry names at `path` (or root if empty).
     /// @throws NotADirectoryError if path is a file.
-    std::vector<std::string> ls(const std::string& path = "") const;
+    std::vector<std::string> ls(std::string_view path = "") const;
 
     /// Recursively walk all directories under `path` (os.walk-style).
     /// Returns one WalkDirEntry per directory, each with dirnames and files.
     std::vector<WalkDirEntry>
-    walk(const std::string& path = "") const;
+    walk(std::string_view path = "") const;
 
     /// Return true if `path` exists (file, directory, or symlink).
-    bool exists(const std::string& path) const;
+    bool exists(std::string_view path) const;
 
     /// Return true if `path` is a directory.
-    bool is_dir(const std::string& path) const;
+    bool is_dir(std::string_view path) const;
 
     /// Return the FileType of `path`.
     /// @throws NotFoundError if path does not exist.
-    FileType file_type(const std::string& path) const;
+    FileType file_type(std::string_view path) const;
 
     /// Return the size in bytes of the object at `path`.
     /// @throws NotFoundError if path does not exist.
     /// @throws IsADirectoryError if path is a directory.
-    uint64_t size(const std::string& path) const;
+    uint64_t size(std::string_view path) const;
 
     /// Return the 40-char hex SHA of the object at `path`.
-    std::string object_hash(const std::string& path) const;
+    std::string object_hash(std::string_view path) const;
 
     /// Read the target of a symlink at `path`.
-    std::string readlink(const std::string& path) const;
+    std::string readlink(std::string_view path) const;
 
     /// stat() — single-call getattr for FUSE.
     /// @throws NotFoundError if path does not exist.
-    StatResult stat(const std::string& path = "") const;
+    StatResult stat(std::string_view path = "") const;
 
     /// List directory entries with name, OID, and mode — for FUSE readdir.
-    std::vector<WalkEntry> listdir(const std::string& path = "") const;
+    std::vector<WalkEntry> listdir(std::string_view path = "") const;
 
     /// Read with optional byte-range (for FUSE partial reads).
-    std::vector<uint8_t> read_range(const std::string& path,
+    std::vector<uint8_t> read_range(std::string_view path,
                                     size_t offset,
                                     std::optional<size_t> size = std::nullopt) const;
 
@@ -253,6 +255,88 @@ public:
              const std::filesystem::path& dest,
              SyncOptions opts = {}) const;
 
+    /// Bring local `dest`, last synced from the tree `from_tree`, up to
+    /// date with this snapshot by applying only their difference.
+    ///
+    /// `from_tree` is the tree_hash() of the snapshot previously written
+    /// to `dest` ("" = nothing yet).  Subtrees whose OIDs match are skipped
+    /// whole, so the cost tracks the size of the change rather than of the
+    /// tree.  Each written file goes to a temporary next to its target and
+    /// is renamed over it.  Local files the diff does not mention are left
+    /// alone.
+    /// @throws InvalidHashError if `from_tree` is not a tree hash.
+    ChangeReport
+    sync_out_diff(const std::string& from_tree,
+                  const std::string& src,
+                  const std::filesystem::path& dest,
+                  SyncOptions opts = {}) const;
+
+    /// Keep the store at `dest` in sync with local `src` continuously.
+    ///
+    /// Runs a full sync_in() before returning, then watches `src` (inotify
+    /// on Linux, recursive) and commits only the paths that changed, one
+    /// commit per debounced batch.  If the kernel event queue overflows the
+    /// next batch is a full rescan.  Where inotify is unavailable, `src` is
+    /// rescanned every `opts.poll_interval_ms`.
+    /// @param callback  Called after each background commit.  May be empty.
+    /// @throws PermissionError if this snapshot is read-only.
+    [[nodiscard]] SyncWatcher
+    watch_sync_in(const std::filesystem::path& src,
+                  const std::string& dest = "",
+                  SyncWatchOptions opts = {},
+                  SyncWatchCallback callback = {}) const;
+
+    // -- Archive ------------------------------------------------------------
+
+    /// Stream a POSIX (pax) tar of the subtree at `path` to `sink`.
+    ///
+    /// Members are named relative to `path` and written in tree order
+    /// straight from the walk: directories as 0755, files as 0644 or 0755
+    /// for executables, symlinks as symlinks, all with the commit time as
+    /// mtime.  A file `path` yields a one-member archive.  Trees are read
+    /// as the walk reaches them, so bytes reach `sink` after one tree read,
+    /// and nothing is buffered beyond the directories on the current path
+    /// and the blob in flight (or a window of members per prefetch thread).
+    /// @throws NotFoundError if `path` does not exist.
+    void export_tar(const std::string& path,
+                    const ArchiveSink& sink,
+                    TarExportOptions opts = {}) const;
+
+    /// Stream a zip archive of the subtree at `path` to `sink`.
+    ///
+    /// Members, modes and timestamps follow export_tar.  Each blob is
+    /// deflated, or stored when it is a symlink, looks already compressed
+    /// (by extension or byte entropy) or would not shrink.  With
+    /// `opts.threads` > 0, workers read and deflate members in parallel
+    /// while the archive is written in tree order.  The tree is walked
+    /// incrementally as for export_tar; only the central directory is kept
+    /// until the end.  Output never seeks; zip64 records are used where
+    /// sizes, offsets or counts require them.
+    /// @throws NotFoundError if `path` does not exist.
+    /// @throws std::invalid_argument if `opts.level` is outside 1..9.
+    void export_zip(const std::string& path,
+                    const ArchiveSink& sink,
+                    ZipExportOptions opts = {}) const;
+
+    /// Import a tar stream into the store at `dest` as a single commit.
+    ///
+    /// Each member is hashed straight into the object database as it is
+    /// read, with no temporary files.  Regular files map to MODE_BLOB, or
+    /// MODE_BLOB_EXEC when the owner-execute bit is set; symlinks to
+    /// MODE_LINK; hard links reuse the blob of their target.  Directories
+    /// are implied by their contents, and other member types (devices,
+    /// fifos) are skipped with a warning in the report.  Members identical
+    /// to what is already at their path are left out of the commit.
+    /// @return The ChangeReport (add / update) and the new Fs.
+    /// @throws IoError if the archive is truncated or malformed.
+    /// @throws InvalidPathError if a member name contains "..".
+    /// @throws PermissionError if this snapshot is read-only.
+    /// @throws StaleSnapshotError if the branch tip has advanced.
+    std::pair<ChangeReport, Fs>
+    import_tar(const ArchiveSource& source,
+               const std::string& dest = "",
+               TarImportOptions opts = {}) const;
+
     // -- Batch --------------------------------------------------------------
 
     /// Return a Batch accumulator for this snapshot.
@@ -295,6 +379,52 @@ public:
     Fs squash(std::optional<Fs> parent = std::nullopt,
               const std::string& message = "squash") const;
 
+    /// Bound branch history: keep recent commits, squash everything older.
+    ///
+    /// Walks the first-parent chain from this snapshot and keeps every
+    /// commit selected by @p policy (the newest ``keep_commits`` commits
+    /// and/or those younger than ``keep_age`` seconds).  The first commit
+    /// outside the policy is squashed (see squash()) into a new root commit
+    /// with the same tree, and the retained commits are re-created on top of
+    /// it with their trees, authors, committers and messages unchanged.
+    /// Extra (merge) parents of retained commits are dropped.  The branch is
+    /// then moved to the rewritten tip and, if ``policy.gc`` is set,
+    /// GitStore::gc() runs.
+    ///
+    /// Returns *this unchanged when nothing falls outside the policy.
+    ///
+    /// @param policy HistoryRetention (keep_commits, keep_age, message, gc).
+    /// @return New writable Fs at the rewritten tip (same tree).
+    /// @throws PermissionError if read-only.
+    /// @throws StaleSnapshotError if the branch has advanced.
+    /// @throws std::invalid_argument if the policy keeps nothing explicit.
+    Fs compact_history(const HistoryRetention& policy) const;
+
+    /// Three-way merge @p other into this branch.
+    ///
+    /// Trees are merged entry by entry against @p base (default: the merge
+    /// base of the two commits; unrelated histories merge against an empty
+    /// tree).  A subtree identical on two sides is taken by OID without
+    /// being read, so merging long-lived branches costs O(changed paths).
+    /// The result is committed with this snapshot and @p other as parents.
+    ///
+    /// Returns *this unchanged if @p other is already merged.  There is no
+    /// fast-forward: if this snapshot is an ancestor of @p other, a merge
+    /// commit is still created.
+    ///
+    /// @param other Snapshot to merge (any branch, tag or detached commit).
+    /// @param base  Override the common ancestor.
+    /// @param opts  MergeOptions (message, favor).
+    /// @return New writable Fs at the merge commit.  Its changes() lists
+    ///         each conflict settled by ``opts.favor`` in ``warnings``.
+    /// @throws MergeConflictError listing conflicting paths unless
+    ///         ``opts.favor`` is set.
+    /// @throws PermissionError if read-only.
+    /// @throws StaleSnapshotError if the branch has advanced.
+    Fs merge(const Fs& other,
+             std::optional<Fs> base = std::nullopt,
+             MergeOptions opts = {}) const;
+
     // -- Internal -----------------------------------------------------------
 
     /// Access the shared store inner (used by Batch, RefDict, tree functions).
@@ -318,6 +448,7 @@ public:
        std::optional<ChangeReport> changes = std::nullopt);
 
     friend class Batch;
+    friend struct SyncWatchState;
 
 private:
     std::shared_ptr<GitStoreInner> inner_;
@@ -335,13 +466,25 @@ private:
     /// Throw NotFoundError("no tree in snapshot") if tree is absent.
     const std::string& require_tree() const;
 
-    /// Commit pending writes/removes and return new Fs.
+    /// Commit pending writes/removes and return new Fs.  `stored` holds
+    /// path -> (blob oid hex, mode) for blobs already written to the odb.
     Fs commit_changes(
         const std::vector<std::pair<std::string, std::pair<std::vector<uint8_t>, uint32_t>>>& writes,
         const std::vector<std::string>& removes,
         const std::string& message,
         std::optional<ChangeReport> report = std::nullopt,
-        const std::vector<std::string>& extra_parent_oids = {}) const;
+        const std::vector<std::string>& extra_parent_oids = {},
+        const std::vector<std::pair<std::string, std::pair<std::string, uint32_t>>>& stored = {}) const;
+
+    /// sync_in() limited to `scope` (paths relative to `src`; null means
+    /// everything), with an optional gitignore-style filter on top of the
+    /// include/exclude globs.
+    std::pair<ChangeReport, Fs> sync_in_scoped(
+        const std::filesystem::path& src,
+        const std::string& dest,
+        const SyncOptions& opts,
+        const ExcludeFilter* filter,
+        const std::vector<std::string>* scope) const;
 };
 
 // ---------------------------------------------------------------------------
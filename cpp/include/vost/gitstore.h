@@ -3,11 +3,15 @@
 #include "error.h"
 #include "notes.h"
 #include "types.h"
+#include "watch.h"
 
+#include <atomic>
 #include <filesystem>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // Forward-declare libgit2 types to avoid pulling the header into every TU.
 struct git_repository;
@@ -15,7 +19,9 @@ struct git_repository;
 namespace vost {
 
 class Fs;
+class Observer;
 class RefDict;
+struct RefCache;
 
 // ---------------------------------------------------------------------------
 // GitStoreInner — shared state (analogous to Rust's Arc<GitStoreInner>)
@@ -28,6 +34,15 @@ struct GitStoreInner {
     std::filesystem::path path;      ///< Path to the bare repository.
     Signature             signature;  ///< Default commit signature.
     std::mutex            mutex;     ///< Thread-level serialization.
+    std::unique_ptr<RefCache> ref_cache; ///< Resolved-ref cache (null when disabled).
+    std::vector<std::weak_ptr<RefWatchState>> watches; ///< Live subscriptions (guarded by mutex).
+    ReflogRetention       reflog_retention; ///< Reflog trimming policy.
+    HashBackend           hash = HashBackend::Safe; ///< Blob hashing on ingest.
+    int                   loose_level = 1; ///< zlib level for loose objects vost writes itself.
+    std::optional<CompressionPolicy> compression_policy; ///< Per-blob levels (writes and pack()).
+    std::unordered_map<std::string, size_t> reflog_pending; ///< Updates since last trim, per ref.
+    std::atomic<bool>     observed{false}; ///< Fast check: observer is set.
+    std::shared_ptr<Observer> observer;   ///< Accessed via std::atomic_load/store.
 
     // Non-copyable / non-movable — always accessed via shared_ptr.
     GitStoreInner(const GitStoreInner&) = delete;
@@ -82,6 +97,56 @@ public:
     /// Return a NoteDict for accessing git notes.
     NoteDict notes();
 
+    // -- Change notification ------------------------------------------------
+
+    /// Subscribe to changes of the given refs.
+    ///
+    /// Short names are branches ("main" = refs/heads/main); full names
+    /// ("refs/tags/v1") are used as-is.  An empty list watches every branch
+    /// and tag.  Changes made by this process wake the watcher directly;
+    /// changes from other processes are picked up through inotify on Linux
+    /// and by rescanning every ``opts.poll_interval_ms`` elsewhere.  Changes
+    /// within ``opts.coalesce_ms`` are merged into one event per ref.
+    ///
+    /// @param refs      Refs to watch (empty = all branches and tags).
+    /// @param callback  Called on a background thread for each change.
+    /// @param opts      WatchOptions (coalescing window, poll fallback).
+    /// @return RefWatch handle; the subscription ends when it is destroyed.
+    /// @throws InvalidRefNameError for malformed short names.
+    [[nodiscard]] RefWatch watch(const std::vector<std::string>& refs,
+                                 RefWatchCallback callback,
+                                 WatchOptions opts = {});
+
+    /// Keep local `dest` checked out from `src` on `branch`, following the
+    /// branch as it advances.
+    ///
+    /// The first checkout is a full sync_out(), unless `opts.state_file`
+    /// names a tree hash already checked out there, in which case only the
+    /// difference is applied.  After that each branch move applies just the
+    /// tree diff (Fs::sync_out_diff): writes, deletes, mode and symlink
+    /// changes, each file renamed into place.  The last checked-out tree
+    /// hash is kept in `opts.state_file` when set.
+    /// @param callback  Called on a background thread after each update.
+    /// @return SyncFollower handle; following ends when it is destroyed.
+    /// @throws NotFoundError if `branch` does not exist.
+    [[nodiscard]] SyncFollower follow(const std::string& branch,
+                                      const std::string& src,
+                                      const std::filesystem::path& dest,
+                                      FollowOptions opts = {},
+                                      FollowCallback callback = {});
+
+    // -- Metrics ------------------------------------------------------------
+
+    /// Register @p observer to receive timings and counters for every public
+    /// operation on this store (and on Fs/Batch snapshots taken from it).
+    /// Pass nullptr to unregister.  Safe to call while other threads use the
+    /// store; operations already running report to the observer they started
+    /// with.
+    void set_observer(std::shared_ptr<Observer> observer);
+
+    /// The registered observer, or nullptr.
+    std::shared_ptr<Observer> observer() const;
+
     // -- Maintenance --------------------------------------------------------
 
     /// Pack loose objects into a packfile.
@@ -163,11 +228,22 @@ public:
                                        size_t size = 0) const;
 
     /// Check if a blob with the given hash exists in the object store.
+    /// Reads only the object header, never the content.
     ///
     /// @param hash 40-char hex SHA of the blob.
     /// @returns true if the blob exists, false otherwise.
     bool has_hash(const std::string& hash) const;
 
+    /// Return the hashes in `hashes` that are not stored as blobs, in input
+    /// order and without duplicates.  Lookups are batched, taking the store
+    /// lock once per few thousand hashes rather than once per hash.  Pair
+    /// with WriteEntry::from_oid / Batch::write_oid so a client uploads only
+    /// the content the store lacks.
+    ///
+    /// @param hashes 40-char hex blob SHAs.
+    /// @throws InvalidHashError if a hash is malformed.
+    std::vector<std::string> missing(const std::vector<std::string>& hashes) const;
+
     // -- Metadata -----------------------------------------------------------
 
     /// Path to the bare repository on disk.
@@ -182,6 +258,8 @@ public:
     std::shared_ptr<GitStoreInner> inner() const { return inner_; }
 
 private:
+    friend class StorePool;
+
     explicit GitStore(std::shared_ptr<GitStoreInner> inner);
 
     std::shared_ptr<GitStoreInner> inner_;
@@ -249,6 +327,15 @@ public:
     /// Return the reflog for the named ref (most-recent first).
     std::vector<ReflogEntry> reflog(const std::string& name);
 
+    /// Return one page of the reflog (most-recent first).
+    ///
+    /// The log is read from its end, so the cost scales with
+    /// ``skip + limit`` rather than with the length of the reflog.
+    /// @param name Branch or tag name.
+    /// @param opts ReflogOptions (limit, skip).
+    std::vector<ReflogEntry> reflog(const std::string& name,
+                                    const ReflogOptions& opts);
+
     // -- Internal -----------------------------------------------------------
     RefDict(std::shared_ptr<GitStoreInner> inner, std::string prefix,
             bool writable);
@@ -0,0 +1,102 @@
+#pragma once
+
+/// @file observe.h
+/// Timing and counter hooks for vost operations.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vost {
+
+// ---------------------------------------------------------------------------
+// Phases and counters
+// ---------------------------------------------------------------------------
+
+/// Internal stages of an operation, timed while an Observer is registered.
+///
+/// Phases may nest (BlobWrite runs inside RebuildTree for ordinary writes),
+/// so per-phase totals are not expected to sum to the operation time.
+enum class Phase : uint8_t {
+    LockWait,    ///< Waiting for the repository lock and the store mutex.
+    CasCheck,    ///< Checking that the branch tip has not moved.
+    RebuildTree, ///< Rebuilding trees for the changed paths.
+    BlobWrite,   ///< Writing new blobs to the object database.
+    WriteCommit, ///< Creating the commit object.
+    RefUpdate,   ///< Moving the ref, plus reflog and watcher bookkeeping.
+    TreeLookup,  ///< Resolving a path to a tree entry.
+    TreeWalk,    ///< Listing or walking a tree.
+    BlobRead,    ///< Loading and inflating a blob.
+    PackWrite,   ///< Building and writing a packfile (pack, bundle export).
+    PackIndex,   ///< Indexing a received packfile (bundle import).
+    Transfer,    ///< Pushing to or fetching from another repository.
+};
+
+/// Number of Phase values.
+constexpr size_t kPhaseCount = 12;
+
+/// Object-database activity counted while an Observer is registered.
+enum class Counter : uint8_t {
+    TreeLookups,   ///< Tree objects loaded.
+    BlobLookups,   ///< Blob objects loaded.
+    BytesInflated, ///< Blob bytes read (decompressed) from the database.
+    BlobsWritten,  ///< Blob objects written.
+    BytesWritten,  ///< Blob bytes written (before compression).
+};
+
+/// Number of Counter values.
+constexpr size_t kCounterCount = 5;
+
+/// Stable snake_case name of a phase ("lock_wait", "rebuild_tree", ...).
+const char* phase_name(Phase phase);
+
+/// Stable snake_case name of a counter ("tree_lookups", ...).
+const char* counter_name(Counter counter);
+
+// ---------------------------------------------------------------------------
+// OperationStats
+// ---------------------------------------------------------------------------
+
+/// Timings and counters for one public operation.
+///
+/// Operations that call other public operations (write_text -> write,
+/// copy_in -> commit) are reported once, under the outermost name, with
+/// the inner work folded into its phases and counters.
+struct OperationStats {
+    std::string_view operation;       ///< e.g. "Fs::write", "GitStore::backup".
+    uint64_t         start_ns    = 0; ///< steady_clock time at entry.
+    uint64_t         duration_ns = 0; ///< Wall time of the whole operation.
+    bool             failed      = false; ///< True if it exited by throwing.
+    std::array<uint64_t, kPhaseCount>   phase_ns{}; ///< Time per Phase.
+    std::array<uint64_t, kCounterCount> counters{}; ///< Value per Counter.
+
+    uint64_t phase(Phase p) const { return phase_ns[static_cast<size_t>(p)]; }
+    uint64_t count(Counter c) const { return counters[static_cast<size_t>(c)]; }
+};
+
+// ---------------------------------------------------------------------------
+// Observer
+// ---------------------------------------------------------------------------
+
+/// Receives metrics from a GitStore; register with GitStore::set_observer().
+///
+/// Callbacks run synchronously on the thread performing the operation,
+/// possibly on several threads at once, and must not call back into the
+/// store.  With no observer registered the hooks cost one relaxed atomic
+/// load per operation.
+class Observer {
+public:
+    virtual ~Observer() = default;
+
+    /// Called once when an outermost public operation returns or throws.
+    virtual void on_operation(const OperationStats& stats) = 0;
+
+    /// Called as each phase ends.  @p start_ns is steady_clock time.
+    virtual void on_phase(std::string_view operation, Phase phase,
+                          uint64_t start_ns, uint64_t duration_ns) {
+        (void)operation; (void)phase; (void)start_ns; (void)duration_ns;
+    }
+};
+
+} // namespace vost
@@ -0,0 +1,114 @@
+#pragma once
+
+/// @file pool.h
+/// Bounded set of open stores for hosts serving many repositories.
+
+#include "gitstore.h"
+#include "types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace vost {
+
+/// Opens stores on demand and keeps at most `max_open` of them.
+///
+/// open() returns the store already open for a path (compared after
+/// canonicalisation), so every caller for one tenant shares one libgit2
+/// repository and its caches.  When the pool is over its limit, the least
+/// recently opened stores that nothing outside the pool still references
+/// (no GitStore, Fs or Batch copies) are closed; a store in use is never
+/// closed under its holders, so the limit is exceeded until they finish.
+///
+/// There is no background thread: the LRU limit and `idle_ms` timeout are
+/// applied only inside open() and trim(), so a pool that sees no opens
+/// keeps its idle stores until trim() is called (e.g. from a timer).
+///
+/// Pack-file, mapped-byte and object-cache budgets are libgit2 globals
+/// that bound every repository in the process together, pooled or not;
+/// they are set once with set_process_limits(), not per pool.
+///
+/// @code
+///     vost::ProcessLimits limits;
+///     limits.max_pack_files = 4096;
+///     limits.cache_bytes = size_t(512) << 20;
+///     vost::StorePool::set_process_limits(limits);
+///
+///     vost::PoolOptions opts;
+///     opts.max_open = 1000;
+///     vost::StorePool pool(opts);
+///     auto fs = pool.open("/srv/tenants/acme.git").branches()["main"];
+/// @endcode
+///
+/// Thread-safe.  Concurrent open() calls for one path open it once.
+class StorePool {
+public:
+    explicit StorePool(PoolOptions opts = {});
+    ~StorePool();
+
+    StorePool(const StorePool&) = delete;
+    StorePool& operator=(const StorePool&) = delete;
+
+    /// The store at `path`, opening it with PoolOptions::open if needed.
+    /// @throws NotFoundError / GitError as GitStore::open.
+    GitStore open(const std::filesystem::path& path);
+
+    /// True if the store at `path` is open in the pool.
+    bool contains(const std::filesystem::path& path) const;
+
+    /// Close the store at `path` if it is idle.
+    /// @return false if it is not open or still in use.
+    bool close(const std::filesystem::path& path);
+
+    /// Apply the open-store limit and idle timeout now.  open() does so
+    /// after opening a new store; nothing else does.
+    /// @return Number of stores closed.
+    size_t trim();
+
+    /// Number of stores held by the pool.
+    size_t size() const;
+
+    PoolStats stats() const;
+
+    /// Set libgit2's process-wide pack and cache limits.  They apply to
+    /// every repository in the process, in any pool or none; later calls
+    /// overwrite earlier ones.
+    static void set_process_limits(const ProcessLimits& limits);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string                    key;
+        std::shared_ptr<GitStoreInner> inner;
+        Clock::time_point              last_used;
+    };
+    using Lru = std::list<Entry>; // most recently opened first
+
+    static std::string key_for(const std::filesystem::path& path);
+    static bool idle(const Entry& e) { return e.inner.use_count() == 1; }
+
+    /// Unlink entries to close; caller holds mutex_ and destroys them after
+    /// unlocking.
+    Lru evict_locked(Clock::time_point now);
+
+    PoolOptions                                 opts_;
+    mutable std::mutex                          mutex_;
+    std::condition_variable                     opened_;
+    Lru                                         lru_;
+    std::unordered_map<std::string, Lru::iterator> index_;
+    std::unordered_set<std::string>             opening_;
+    uint64_t                                    hits_ = 0;
+    uint64_t                                    misses_ = 0;
+    uint64_t                                    evictions_ = 0;
+};
+
+} // namespace vost
@@ -0,0 +1,84 @@
+#pragma once
+
+/// @file trace.h
+/// Chrome trace-event recording of vost operations and phases.
+
+#include "observe.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace vost {
+
+/// Observer that records every operation and phase as a timed span.
+///
+/// write_json() emits the Chrome trace-event format, which loads directly
+/// in Perfetto (ui.perfetto.dev) and chrome://tracing.  Each span carries
+/// the id of the thread that ran it, so phases nest under their operation
+/// and concurrent writers queueing on LockWait show up side by side.
+///
+/// @code
+///     auto tracer = std::make_shared<vost::Tracer>();
+///     store.set_observer(tracer);
+///     fs.sync_in("/data");
+///     tracer->write_json("sync_in.trace.json");
+/// @endcode
+class Tracer : public Observer {
+public:
+    /// @param next        Observer to forward every callback to, so a
+    ///                    Tracer can sit in front of an existing metrics
+    ///                    sink.  May be null.
+    /// @param max_events  Spans kept before further ones are dropped.
+    explicit Tracer(std::shared_ptr<Observer> next = nullptr,
+                    size_t max_events = 1u << 20);
+
+    void on_operation(const OperationStats& stats) override;
+    void on_phase(std::string_view operation, Phase phase,
+                  uint64_t start_ns, uint64_t duration_ns) override;
+
+    /// Write the recorded spans as a Chrome trace-event JSON object.
+    void write_json(std::ostream& out) const;
+
+    /// Write the recorded spans to @p path, replacing it.
+    /// @throws IoError if the file cannot be written.
+    void write_json(const std::filesystem::path& path) const;
+
+    /// Number of spans recorded.
+    size_t size() const;
+
+    /// Number of spans dropped after reaching max_events.
+    size_t dropped() const;
+
+    /// Discard all recorded spans.
+    void clear();
+
+private:
+    struct Span {
+        std::string_view name;   // operation name or phase name (literals)
+        std::string_view parent; // operation name, for phases
+        bool             is_phase;
+        bool             failed;
+        uint32_t         tid;
+        uint64_t         start_ns;
+        uint64_t         duration_ns;
+        std::array<uint64_t, kCounterCount> counters;
+    };
+
+    void record(Span span);
+
+    std::shared_ptr<Observer> next_;
+    size_t                    max_events_;
+    uint64_t                  origin_ns_;
+    mutable std::mutex        mutex_;
+    std::vector<Span>         spans_;
+    size_t                    dropped_ = 0;
+};
+
+} // namespace vost
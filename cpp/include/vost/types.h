@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <optional>
 #include <string>
@@ -115,26 +116,39 @@ struct WriteEntry {
     std::optional<std::vector<uint8_t>> data;   ///< Raw content (for blobs).
     std::optional<std::string>          target;  ///< Symlink target.
     uint32_t                            mode;    ///< Git file mode.
+    std::optional<std::string>          oid;     ///< Hash of a blob already in the store.
 
     /// Create a blob entry from raw bytes.
     static WriteEntry from_bytes(std::vector<uint8_t> d) {
-        return WriteEntry{std::move(d), std::nullopt, MODE_BLOB};
+        return WriteEntry{std::move(d), std::nullopt, MODE_BLOB, std::nullopt};
     }
 
     /// Create a blob entry from a UTF-8 string.
     static WriteEntry from_text(std::string text) {
         std::vector<uint8_t> d(text.begin(), text.end());
-        return WriteEntry{std::move(d), std::nullopt, MODE_BLOB};
+        return WriteEntry{std::move(d), std::nullopt, MODE_BLOB, std::nullopt};
     }
 
     /// Create a symlink entry.
     static WriteEntry symlink(std::string t) {
-        return WriteEntry{std::nullopt, std::move(t), MODE_LINK};
+        return WriteEntry{std::nullopt, std::move(t), MODE_LINK, std::nullopt};
     }
 
-    /// Validate that data/target/mode are consistent.
+    /// Reference a blob already in the store by its hash (see
+    /// GitStore::missing).  `mode` may be MODE_BLOB, MODE_BLOB_EXEC or
+    /// MODE_LINK (the blob holds the link target).
+    static WriteEntry from_oid(std::string hash, uint32_t mode = MODE_BLOB) {
+        return WriteEntry{std::nullopt, std::nullopt, mode, std::move(hash)};
+    }
+
+    /// Validate that data/target/oid/mode are consistent.
     void validate() const {
-        if (mode == MODE_LINK) {
+        if (oid) {
+            if (data || target)
+                throw InvalidPathError("oid entry must not have data or a symlink target");
+            if (mode != MODE_BLOB && mode != MODE_BLOB_EXEC && mode != MODE_LINK)
+                throw InvalidPathError("unsupported mode: " + std::to_string(mode));
+        } else if (mode == MODE_LINK) {
             if (!target) throw InvalidPathError("symlink entry requires a target");
             if (data)    throw InvalidPathError("symlink entry must not have data");
         } else if (mode == MODE_BLOB || mode == MODE_BLOB_EXEC) {
@@ -184,6 +198,26 @@ struct ChangeError {
     std::string error;
 };
 
+/// How much detail a copy / sync operation keeps in its ChangeReport.
+enum class ReportMode : uint8_t {
+    Full,   ///< One FileEntry per change in add / update / del (default).
+    Counts, ///< Only per-kind counts, in ChangeReport::omitted.
+    Stream, ///< Each change is passed to the on_change callback, then counted (copy_in / sync_in: after the commit lands).
+};
+
+/// Per-change callback for ReportMode::Stream.  The entry is only valid
+/// for the duration of the call.
+using ChangeCallback = std::function<void(ChangeActionKind, const FileEntry&)>;
+
+/// Number of changes of each kind.
+struct ChangeCounts {
+    size_t add    = 0;
+    size_t update = 0;
+    size_t del    = 0;
+
+    size_t total() const { return add + update + del; }
+};
+
 /// Report summarising the outcome of a sync / copy / import operation.
 struct ChangeReport {
     std::vector<FileEntry>   add;
@@ -191,13 +225,18 @@ struct ChangeReport {
     std::vector<FileEntry>   del;      ///< Named 'del' to avoid C++ keyword.
     std::vector<ChangeError> errors;
     std::vector<ChangeError> warnings;
+    ChangeCounts             omitted;  ///< Changes counted but not listed above.
 
-    bool in_sync() const {
-        return add.empty() && update.empty() && del.empty();
-    }
+    bool in_sync() const { return total() == 0; }
 
     size_t total() const {
-        return add.size() + update.size() + del.size();
+        return add.size() + update.size() + del.size() + omitted.total();
+    }
+
+    /// Changes of each kind, listed or not.
+    ChangeCounts counts() const {
+        return {add.size() + omitted.add, update.size() + omitted.update,
+                del.size() + omitted.del};
     }
 
     std::vector<ChangeAction> actions() const {
@@ -234,6 +273,18 @@ struct ReflogEntry {
     std::string message;    ///< Reflog message.
 };
 
+/// Options for RefDict::reflog pagination.
+struct ReflogOptions {
+    std::optional<size_t> limit; ///< Max entries to return.
+    std::optional<size_t> skip;  ///< Skip this many of the most recent entries.
+};
+
+/// Reflog retention policy applied as refs are updated.
+struct ReflogRetention {
+    std::optional<size_t>   max_entries; ///< Keep at most this many entries per ref.
+    std::optional<uint64_t> max_age;     ///< Drop entries older than this many seconds.
+};
+
 // ---------------------------------------------------------------------------
 // RefChange / MirrorDiff
 // ---------------------------------------------------------------------------
@@ -255,6 +306,40 @@ struct MirrorDiff {
     size_t total()   const { return add.size() + update.size() + del.size(); }
 };
 
+// ---------------------------------------------------------------------------
+// HashBackend
+// ---------------------------------------------------------------------------
+
+/// SHA-1 implementation used to hash blobs as they are ingested.  Both
+/// produce the same object ids and files.
+enum class HashBackend {
+    Safe, ///< libgit2's collision-detecting SHA-1 (default).
+    Fast, ///< Plain SHA-1 using the CPU's SHA extensions where present.
+          ///< No collision detection: for trusted input only.
+};
+
+// ---------------------------------------------------------------------------
+// CompressionPolicy
+// ---------------------------------------------------------------------------
+
+/// One CompressionPolicy rule.
+struct CompressionRule {
+    std::string pattern; ///< Glob matched against the full path or its basename ("*.json", "media/**").
+    int         level;   ///< zlib level (0-9) for matching blobs.
+};
+
+/// Per-blob zlib level for the objects vost writes (OpenOptions::compression_policy).
+/// A blob's level is the first matching rule's; failing that,
+/// `incompressible_level` for a known compressed format (by extension) or
+/// high-entropy leading bytes; failing that, `default_level`.
+struct CompressionPolicy {
+    std::vector<CompressionRule> rules;                 ///< Checked in order; first match wins.
+    bool               known_extensions = true;         ///< Treat jpg, png, zip, zst, mp4, ... as incompressible.
+    size_t             probe_bytes = 1024;              ///< Bytes sampled for entropy (0 = no probe).
+    int                incompressible_level = 0;        ///< Level for incompressible content.
+    std::optional<int> default_level;                   ///< Level for everything else. Nullopt = OpenOptions::compression, else 6.
+};
+
 // ---------------------------------------------------------------------------
 // OpenOptions
 // ---------------------------------------------------------------------------
@@ -267,6 +352,10 @@ struct OpenOptions {
     std::optional<std::string> email;          ///< Default author email.
     std::optional<int>         compression;    ///< Zlib compression level (0-9). Nullopt = git default.
     std::optional<int64_t>     big_file_threshold; ///< Blobs larger than this (bytes) skip delta compression. 0 = all skip deltas.
+    bool                       ref_cache = true; ///< Cache resolved refs in-process, revalidated by stat() on each lookup.
+    ReflogRetention            reflog_retention; ///< Trim reflogs as refs are updated (default: keep all).
+    HashBackend                hash = HashBackend::Safe; ///< Blob hashing on ingest (copy_in, Batch, import_tar).
+    std::optional<CompressionPolicy> compression_policy; ///< Per-path/per-content blob levels, for writes and pack().
 };
 
 // ---------------------------------------------------------------------------
@@ -336,6 +425,46 @@ struct CommitInfo {
     std::optional<std::string> author_email;
 };
 
+// ---------------------------------------------------------------------------
+// HistoryRetention
+// ---------------------------------------------------------------------------
+
+/// Policy for Fs::compact_history.  A commit is kept if either limit keeps it.
+struct HistoryRetention {
+    std::optional<size_t>      keep_commits; ///< Keep the newest N commits verbatim.
+    std::optional<uint64_t>    keep_age;     ///< Keep commits younger than this many seconds.
+    std::optional<std::string> message;      ///< Message for the new root commit.
+    bool                       gc = true;    ///< Run GitStore::gc() afterwards.
+};
+
+// ---------------------------------------------------------------------------
+// Merge
+// ---------------------------------------------------------------------------
+
+/// Which side wins a conflicting path in Fs::merge.
+enum class MergeFavor : uint8_t {
+    Ours,   ///< Keep this snapshot's entry.
+    Theirs, ///< Take the other snapshot's entry.
+};
+
+/// A path changed differently on both sides of a merge.
+///
+/// Each side is the tree entry at ``path`` (nullopt = absent on that side).
+/// Conflicts are reported at the highest differing path, so a directory
+/// deleted on one side and modified on the other yields a single entry.
+struct MergeConflict {
+    std::string              path;
+    std::optional<WalkEntry> base;
+    std::optional<WalkEntry> ours;
+    std::optional<WalkEntry> theirs;
+};
+
+/// Options for Fs::merge.
+struct MergeOptions {
+    std::optional<std::string> message; ///< Commit message (default "merge: <other>").
+    std::optional<MergeFavor>  favor;   ///< Resolve conflicts instead of throwing; they are listed in the result's changes()->warnings.
+};
+
 // ---------------------------------------------------------------------------
 // CopyInOptions
 // ---------------------------------------------------------------------------
@@ -348,6 +477,20 @@ struct CopyInOptions {
     bool                                    dry_run   = false;
     bool                                    checksum  = true; ///< Skip unchanged files.
     std::vector<std::string>                parents;  ///< Advisory extra parent commit hashes.
+    ReportMode                              report    = ReportMode::Full;
+    ChangeCallback                          on_change; ///< Called per change in Stream mode.
+};
+
+// ---------------------------------------------------------------------------
+// CacheLink
+// ---------------------------------------------------------------------------
+
+/// How copy_out / sync_out place a file from the blob cache.  Each falls
+/// back to a plain copy when the link cannot be made (e.g. across devices).
+enum class CacheLink {
+    Auto,     ///< Reflink (FICLONE) where supported, else hard link.
+    Reflink,  ///< Reflink only: each checkout gets its own writable file.
+    Hardlink, ///< Hard link only: files share the cache's read-only inode.
 };
 
 // ---------------------------------------------------------------------------
@@ -358,6 +501,10 @@ struct CopyInOptions {
 struct CopyOutOptions {
     std::optional<std::vector<std::string>> include;
     std::optional<std::vector<std::string>> exclude;
+    ReportMode                              report    = ReportMode::Full;
+    ChangeCallback                          on_change; ///< Called per change in Stream mode.
+    std::filesystem::path                   blob_cache; ///< Blob cache directory ("" = none).
+    CacheLink                               link      = CacheLink::Auto;
 };
 
 // ---------------------------------------------------------------------------
@@ -372,6 +519,10 @@ struct SyncOptions {
     bool                                    dry_run   = false;
     bool                                    checksum  = true;
     std::vector<std::string>                parents;  ///< Advisory extra parent commit hashes.
+    ReportMode                              report    = ReportMode::Full;
+    ChangeCallback                          on_change; ///< Called per change in Stream mode.
+    std::filesystem::path                   blob_cache; ///< sync_out: blob cache directory.
+    CacheLink                               link      = CacheLink::Auto; ///< sync_out only.
 };
 
 // ---------------------------------------------------------------------------
@@ -392,10 +543,45 @@ struct MoveOptions {
 
 /// Options for Fs::copy_from_ref.
 struct CopyFromRefOptions {
-    bool                       delete_extra = false; ///< Delete files in dest not in source.
+    bool                       delete_extra = false; ///< Delete files under each source's dest target not in source.
     bool                       dry_run      = false;
     std::optional<std::string> message;
     std::vector<std::string>   parents;   ///< Advisory extra parent commit hashes.
+    std::optional<std::vector<std::string>> include; ///< Only copy matching files.
+    std::optional<std::vector<std::string>> exclude; ///< Skip matching files.
+};
+
+// ---------------------------------------------------------------------------
+// Archives
+// ---------------------------------------------------------------------------
+
+/// Receives archive bytes in order as they are produced.  Exceptions
+/// thrown by the sink abort the export and propagate to the caller.
+using ArchiveSink = std::function<void(const uint8_t* data, size_t size)>;
+
+/// Supplies archive bytes: fills up to `size` bytes of `buf` and returns
+/// the number written, or 0 at end of input.
+using ArchiveSource = std::function<size_t(uint8_t* buf, size_t size)>;
+
+/// Options for Fs::export_tar.
+struct TarExportOptions {
+    std::string prefix;       ///< Directory prepended to every member (e.g. "proj-1.0").
+    size_t      prefetch = 0; ///< Worker threads reading blobs ahead (0 = read inline).
+};
+
+/// Options for Fs::export_zip.
+struct ZipExportOptions {
+    std::string prefix;                  ///< Directory prepended to every member.
+    size_t      threads = 0;             ///< Worker threads reading and deflating (0 = inline).
+    int         level   = 6;             ///< Deflate level, 1 (fastest) to 9 (smallest).
+    bool        store_compressed = true; ///< Store members that already look compressed.
+};
+
+/// Options for Fs::import_tar.
+struct TarImportOptions {
+    size_t                     strip_components = 0; ///< Leading member path segments to drop.
+    std::optional<std::string> message;              ///< Commit message.
+    std::vector<std::string>   parents;              ///< Advisory extra parent commit hashes.
 };
 
 // ---------------------------------------------------------------------------
@@ -465,4 +651,59 @@ struct RestoreOptions {
     std::map<std::string, std::string> ref_map;
 };
 
+// ---------------------------------------------------------------------------
+// WatchOptions
+// ---------------------------------------------------------------------------
+
+/// Options for GitStore::watch.
+struct WatchOptions {
+    uint32_t coalesce_ms = 5;        ///< Changes within this window are merged into one event per ref.
+    uint32_t poll_interval_ms = 500; ///< Rescan period where inotify is unavailable.
+};
+
+/// Options for Fs::watch_sync_in.
+struct SyncWatchOptions {
+    SyncOptions   sync;                    ///< include / exclude / message / checksum / report; dry_run is ignored.
+    ExcludeFilter filter;                  ///< gitignore-style excludes, applied on top of sync.include / sync.exclude.
+    uint32_t      debounce_ms = 200;       ///< Changes within this window after the first are committed together.
+    uint32_t      poll_interval_ms = 2000; ///< Full rescan period where inotify is unavailable.
+};
+
+/// Options for GitStore::follow.
+struct FollowOptions {
+    SyncOptions           sync;       ///< include / exclude / report; message, checksum and dry_run are ignored.
+    std::filesystem::path state_file; ///< Where the last checked-out tree hash is kept (empty = memory only).
+    WatchOptions          watch;      ///< How branch moves are detected.
+};
+
+// ---------------------------------------------------------------------------
+// PoolOptions
+// ---------------------------------------------------------------------------
+
+/// Options for StorePool.
+struct PoolOptions {
+    size_t      max_open = 256; ///< Stores kept open; the least recently used idle ones beyond this are closed.
+    uint32_t    idle_ms = 0;    ///< Close idle stores not opened for this long (0 = no timeout), checked by open() and trim().
+    OpenOptions open;           ///< Passed to GitStore::open for each new store.
+};
+
+/// libgit2 limits shared by every repository in the process, set with
+/// StorePool::set_process_limits().  nullopt leaves a setting unchanged.
+struct ProcessLimits {
+    std::optional<size_t> max_pack_files;   ///< Pack files mapped at once (GIT_OPT_SET_MWINDOW_FILE_LIMIT; 0 = unlimited).
+    std::optional<size_t> max_mapped_bytes; ///< Bytes of pack data mapped at once (GIT_OPT_SET_MWINDOW_MAPPED_LIMIT).
+    std::optional<size_t> cache_bytes;      ///< Object (commit/tree/blob) cache budget (GIT_OPT_SET_CACHE_MAX_SIZE).
+};
+
+/// Counters from StorePool::stats().
+struct PoolStats {
+    size_t   open = 0;        ///< Stores currently held by the pool.
+    size_t   idle = 0;        ///< Of those, stores with no handle outside the pool.
+    uint64_t hits = 0;        ///< open() calls served by an already-open store.
+    uint64_t misses = 0;      ///< open() calls that opened the repository.
+    uint64_t evictions = 0;   ///< Stores closed by the LRU limit, idle timeout or close().
+    int64_t  cached_bytes = 0; ///< Object cache in use, process-wide.
+    int64_t  cache_limit = 0;  ///< Object cache budget, process-wide.
+};
+
 } // namespace vost
@@ -10,6 +10,10 @@
 #include "batch.h"
 #include "notes.h"
 #include "mirror.h"
+#include "watch.h"
+#include "observe.h"
+#include "trace.h"
+#include "pool.h"
 
 #include <algorithm>
 #include <chrono>
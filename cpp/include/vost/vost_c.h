@@ -0,0 +1,188 @@
+#ifndef VOST_C_H
+#define VOST_C_H
+
+/// @file vost_c.h
+/// C ABI over the core GitStore / Fs / Batch operations, for bindings in
+/// other languages.  Built as the vost_c shared library
+/// (-DVOST_BUILD_C_API=ON).
+///
+/// Conventions:
+///
+///   * Objects are opaque handles created by a function with an `out`
+///     parameter and freed with the matching *_free / *_release.  Handles
+///     are independent: an Fs stays valid after its store handle is freed.
+///   * Every fallible call returns a vost_status.  VOST_OK is 0; on error
+///     the `out` parameters are left untouched and vost_last_error()
+///     describes the failure on the calling thread.  No C++ exception
+///     crosses this boundary.
+///   * Strings are NUL-terminated UTF-8.  Hashes are 40-char lowercase hex;
+///     `char out[VOST_HASH_BUFSZ]` receives them NUL-terminated.
+///   * Reads return a vost_buf: a refcounted view of the blob as libgit2
+///     loaded it, not a copy.  Wrap vost_buf_data()/vost_buf_size() in
+///     the binding's buffer type and call vost_buf_release() when it is
+///     collected.  Buffers may be released from any thread.
+///   * A handle may be used from several threads at once, except a
+///     vost_batch, which belongs to one thread.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(VOST_C_BUILD)
+#    define VOST_C_API __declspec(dllexport)
+#  else
+#    define VOST_C_API __declspec(dllimport)
+#  endif
+#else
+#  define VOST_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Bumped when a function signature or struct layout changes incompatibly.
+#define VOST_C_ABI_VERSION 1
+
+#define VOST_HASH_BUFSZ 41
+
+#define VOST_MODE_BLOB      0100644u
+#define VOST_MODE_BLOB_EXEC 0100755u
+#define VOST_MODE_LINK      0120000u
+#define VOST_MODE_TREE      0040000u
+
+/// Result of every fallible call; one code per vost error class.
+typedef enum vost_status {
+    VOST_OK = 0,
+    VOST_ERR_NOT_FOUND,
+    VOST_ERR_IS_A_DIRECTORY,
+    VOST_ERR_NOT_A_DIRECTORY,
+    VOST_ERR_PERMISSION,
+    VOST_ERR_STALE_SNAPSHOT,
+    VOST_ERR_KEY_NOT_FOUND,
+    VOST_ERR_KEY_EXISTS,
+    VOST_ERR_INVALID_PATH,
+    VOST_ERR_INVALID_HASH,
+    VOST_ERR_INVALID_REF_NAME,
+    VOST_ERR_BATCH_CLOSED,
+    VOST_ERR_MERGE_CONFLICT,
+    VOST_ERR_GIT,
+    VOST_ERR_IO,
+    VOST_ERR_INVALID_ARGUMENT, ///< A required pointer was NULL.
+    VOST_ERR_OTHER,
+} vost_status;
+
+typedef struct vost_store   vost_store;
+typedef struct vost_fs      vost_fs;
+typedef struct vost_batch   vost_batch;
+typedef struct vost_buf     vost_buf;
+typedef struct vost_strlist vost_strlist;
+
+/// Options for vost_store_open.  Initialise with vost_open_options_init;
+/// `struct_size` lets later versions add fields.
+typedef struct vost_open_options {
+    uint32_t    struct_size;
+    int         create;      ///< Create the repository if missing.
+    const char* branch;      ///< Default branch (NULL = none).
+    const char* author;      ///< Commit author name (NULL = default).
+    const char* email;       ///< Commit author email (NULL = default).
+    int         compression; ///< zlib level 0-9, or -1 for the default.
+    int         fast_hash;   ///< Non-zero selects HashBackend::Fast.
+} vost_open_options;
+
+/// Result of vost_fs_stat.
+typedef struct vost_stat {
+    uint32_t mode;                  ///< Git filemode (VOST_MODE_*).
+    uint64_t size;                  ///< Blob size, or entry count for a directory.
+    uint64_t mtime;                 ///< Commit time, POSIX seconds.
+    char     hash[VOST_HASH_BUFSZ]; ///< Object hash.
+} vost_stat;
+
+// -- Errors and version ------------------------------------------------------
+
+VOST_C_API uint32_t    vost_abi_version(void);
+/// Message for the last failed call on this thread ("" if none).
+VOST_C_API const char* vost_last_error(void);
+/// Symbolic name of a status ("VOST_ERR_NOT_FOUND").
+VOST_C_API const char* vost_status_name(vost_status status);
+
+// -- Buffers -----------------------------------------------------------------
+
+VOST_C_API const uint8_t* vost_buf_data(const vost_buf* buf);
+VOST_C_API size_t         vost_buf_size(const vost_buf* buf);
+/// Add a reference; returns `buf`.
+VOST_C_API vost_buf*      vost_buf_retain(vost_buf* buf);
+/// Drop a reference, freeing the buffer with the last one.  NULL is a no-op.
+VOST_C_API void           vost_buf_release(vost_buf* buf);
+
+// -- String lists ------------------------------------------------------------
+
+VOST_C_API size_t      vost_strlist_count(const vost_strlist* list);
+/// Item `i`, valid until the list is freed; NULL if out of range.
+VOST_C_API const char* vost_strlist_get(const vost_strlist* list, size_t i);
+VOST_C_API void        vost_strlist_free(vost_strlist* list);
+
+// -- Store -------------------------------------------------------------------
+
+VOST_C_API void        vost_open_options_init(vost_open_options* opts);
+/// Open (or create) the bare repository at `path`.  `opts` may be NULL.
+VOST_C_API vost_status vost_store_open(const char* path, const vost_open_options* opts,
+                                       vost_store** out);
+VOST_C_API void        vost_store_free(vost_store* store);
+/// Writable snapshot of branch `name`.
+VOST_C_API vost_status vost_store_branch(vost_store* store, const char* name, vost_fs** out);
+/// Snapshot of a branch, tag or commit hash (GitStore::fs).
+VOST_C_API vost_status vost_store_fs(vost_store* store, const char* ref, vost_fs** out);
+/// Branch names.
+VOST_C_API vost_status vost_store_branches(vost_store* store, vost_strlist** out);
+VOST_C_API vost_status vost_store_read_by_hash(vost_store* store, const char* hash,
+                                               vost_buf** out);
+/// Set `missing[i]` to 1 if `hashes[i]` is not stored as a blob, else 0.
+VOST_C_API vost_status vost_store_missing(vost_store* store, const char* const* hashes,
+                                          size_t count, uint8_t* missing);
+VOST_C_API vost_status vost_store_pack(vost_store* store, size_t* out_count);
+
+// -- Fs ----------------------------------------------------------------------
+
+VOST_C_API void        vost_fs_free(vost_fs* fs);
+/// Commit hash, or "" for a branch with no commits.
+VOST_C_API vost_status vost_fs_commit_hash(const vost_fs* fs, char out[VOST_HASH_BUFSZ]);
+/// Root tree hash, or "" for a branch with no commits.
+VOST_C_API vost_status vost_fs_tree_hash(const vost_fs* fs, char out[VOST_HASH_BUFSZ]);
+VOST_C_API vost_status vost_fs_read(const vost_fs* fs, const char* path, vost_buf** out);
+/// Up to `size` bytes from `offset` (size 0 = to the end).  Shares the
+/// blob with any other buffer read from it.
+VOST_C_API vost_status vost_fs_read_range(const vost_fs* fs, const char* path,
+                                          uint64_t offset, uint64_t size, vost_buf** out);
+VOST_C_API vost_status vost_fs_exists(const vost_fs* fs, const char* path, int* out);
+VOST_C_API vost_status vost_fs_stat(const vost_fs* fs, const char* path, vost_stat* out);
+/// Names in the directory `path` ("" = root).
+VOST_C_API vost_status vost_fs_ls(const vost_fs* fs, const char* path, vost_strlist** out);
+/// Write one file and commit.  `mode` 0 means VOST_MODE_BLOB; `message`
+/// may be NULL.
+VOST_C_API vost_status vost_fs_write(const vost_fs* fs, const char* path,
+                                     const void* data, size_t size, uint32_t mode,
+                                     const char* message, vost_fs** out);
+/// Remove one path (a directory only if `recursive`) and commit.
+VOST_C_API vost_status vost_fs_remove(const vost_fs* fs, const char* path, int recursive,
+                                      const char* message, vost_fs** out);
+
+// -- Batch -------------------------------------------------------------------
+
+/// Start a batch on `fs`.  `message` may be NULL.
+VOST_C_API vost_status vost_fs_batch(const vost_fs* fs, const char* message,
+                                     vost_batch** out);
+VOST_C_API vost_status vost_batch_write(vost_batch* batch, const char* path,
+                                        const void* data, size_t size, uint32_t mode);
+/// Stage a blob already in the store by hash (see vost_store_missing).
+VOST_C_API vost_status vost_batch_write_oid(vost_batch* batch, const char* path,
+                                            const char* hash, uint32_t mode);
+VOST_C_API vost_status vost_batch_remove(vost_batch* batch, const char* path);
+VOST_C_API vost_status vost_batch_commit(vost_batch* batch, vost_fs** out);
+VOST_C_API void        vost_batch_free(vost_batch* batch);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // VOST_C_H
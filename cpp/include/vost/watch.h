@@ -0,0 +1,158 @@
+#pragma once
+
+/// @file watch.h
+/// Change subscriptions for vost refs, continuous sync_in, and branch
+/// followers.
+
+#include "types.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace vost {
+
+class Fs;
+struct RefWatchState;
+struct SyncWatchState;
+struct SyncFollowState;
+
+/// Callback invoked for each ref change delivered by a RefWatch.
+///
+/// ``old_target`` is nullopt for a newly created ref and ``new_target`` is
+/// nullopt for a deleted one.  Runs on the watch's background thread.
+using RefWatchCallback = std::function<void(const RefChange&)>;
+
+// ---------------------------------------------------------------------------
+// RefWatch
+// ---------------------------------------------------------------------------
+
+/// Handle for a subscription created by GitStore::watch().
+///
+/// Move-only.  Destroying the handle (or calling stop()) ends the
+/// subscription; no callback runs after stop() returns, except when stop()
+/// is called from inside the callback itself.
+class RefWatch {
+public:
+    RefWatch() = default;
+    ~RefWatch();
+
+    RefWatch(RefWatch&&) noexcept = default;
+    RefWatch& operator=(RefWatch&& other) noexcept;
+    RefWatch(const RefWatch&) = delete;
+    RefWatch& operator=(const RefWatch&) = delete;
+
+    /// Stop delivering events and release the background thread.
+    /// Safe to call more than once.
+    void stop();
+
+    /// True until stop() has been called.
+    bool active() const;
+
+    // -- Internal -----------------------------------------------------------
+    explicit RefWatch(std::shared_ptr<RefWatchState> state);
+
+private:
+    std::shared_ptr<RefWatchState> state_;
+};
+
+// ---------------------------------------------------------------------------
+// SyncWatcher
+// ---------------------------------------------------------------------------
+
+/// Callback invoked after each commit made by a SyncWatcher, with the
+/// commit's report and the resulting snapshot.  Runs on the watcher's
+/// background thread.
+using SyncWatchCallback = std::function<void(const ChangeReport&, const Fs&)>;
+
+/// Handle for a continuous sync created by Fs::watch_sync_in().
+///
+/// Move-only.  Destroying the handle (or calling stop()) ends the watch;
+/// changes still waiting for their debounce window are not committed.
+class SyncWatcher {
+public:
+    SyncWatcher() = default;
+    ~SyncWatcher();
+
+    SyncWatcher(SyncWatcher&&) noexcept = default;
+    SyncWatcher& operator=(SyncWatcher&& other) noexcept;
+    SyncWatcher(const SyncWatcher&) = delete;
+    SyncWatcher& operator=(const SyncWatcher&) = delete;
+
+    /// Stop watching and release the background thread.
+    /// Safe to call more than once.
+    void stop();
+
+    /// True until stop() has been called.
+    bool active() const;
+
+    /// Snapshot after the most recent commit (or the initial sync).
+    Fs fs() const;
+
+    /// Number of commits made since the initial sync.
+    uint64_t commits() const;
+
+    /// Number of full rescans (initial sync excluded), e.g. after an
+    /// inotify queue overflow.
+    uint64_t rescans() const;
+
+    /// Message of the last error raised by a background sync, if any.
+    /// The paths involved are retried with the next batch.
+    std::optional<std::string> last_error() const;
+
+    // -- Internal -----------------------------------------------------------
+    explicit SyncWatcher(std::shared_ptr<SyncWatchState> state);
+
+private:
+    std::shared_ptr<SyncWatchState> state_;
+};
+
+// ---------------------------------------------------------------------------
+// SyncFollower
+// ---------------------------------------------------------------------------
+
+/// Callback invoked after a SyncFollower updates its directory, with the
+/// update's report and the snapshot now checked out.  Runs on the
+/// follower's background thread.
+using FollowCallback = std::function<void(const ChangeReport&, const Fs&)>;
+
+/// Handle for a branch follower created by GitStore::follow().
+///
+/// Move-only.  Destroying the handle (or calling stop()) stops following;
+/// an update already in progress finishes first.
+class SyncFollower {
+public:
+    SyncFollower() = default;
+    ~SyncFollower();
+
+    SyncFollower(SyncFollower&&) noexcept = default;
+    SyncFollower& operator=(SyncFollower&& other) noexcept;
+    SyncFollower(const SyncFollower&) = delete;
+    SyncFollower& operator=(const SyncFollower&) = delete;
+
+    /// Stop following.  Safe to call more than once.
+    void stop();
+
+    /// True until stop() has been called.
+    bool active() const;
+
+    /// Root tree hash of the snapshot last checked out.
+    std::string tree_hash() const;
+
+    /// Number of updates applied after the initial checkout.
+    uint64_t updates() const;
+
+    /// Message of the last error raised by an update, if any.  The next
+    /// branch move retries from the last successful tree.
+    std::optional<std::string> last_error() const;
+
+    // -- Internal -----------------------------------------------------------
+    explicit SyncFollower(std::shared_ptr<SyncFollowState> state);
+
+private:
+    std::shared_ptr<SyncFollowState> state_;
+};
+
+} // namespace vost
@@ -0,0 +1,1129 @@
+#include "vost/fs.h"
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <git2.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace vost {
+
+namespace {
+
+[[noreturn]] void throw_git(const std::string& ctx) {
+    const git_error* e = git_error_last();
+    std::string msg = ctx;
+    if (e && e->message) { msg += ": "; msg += e->message; }
+    throw GitError(msg);
+}
+
+// ---------------------------------------------------------------------------
+// Members
+// ---------------------------------------------------------------------------
+
+/// One archive member, in output order.
+struct Member {
+    std::string name; ///< Archive path; directories end in '/'.
+    std::string oid;  ///< Blob hex for files and symlinks, empty otherwise.
+    uint32_t    mode;
+};
+
+/// Archive members of `norm_path` (a tree or a single entry), optionally
+/// below a `prefix` directory, in pre-order and git tree order.  Trees are
+/// read as the walk reaches them: an explicit stack holds the listing of
+/// each directory on the current path, so memory follows depth times
+/// fan-out and the first member is ready after one tree read.
+class MemberWalker {
+public:
+    /// Reads from `repo`; construct and call next() under the store mutex.
+    /// @throws NotFoundError if `norm_path` does not exist.
+    MemberWalker(git_repository* repo, const std::string& tree_hex,
+                 const std::string& norm_path, std::string prefix)
+        : repo_(repo) {
+        while (!prefix.empty() && prefix.back() == '/') prefix.pop_back();
+        if (!prefix.empty()) queued_.push_back({prefix + "/", {}, MODE_TREE});
+        std::string base = prefix.empty() ? "" : prefix + "/";
+        if (norm_path.empty()) {
+            push(tree_hex, base);
+            return;
+        }
+        auto entry = tree::lookup(repo, tree_hex, norm_path);
+        if (!entry) throw NotFoundError(norm_path);
+        if (entry->second == MODE_TREE) {
+            push(entry->first, base);
+        } else {
+            std::string name = base + norm_path.substr(norm_path.rfind('/') + 1);
+            queued_.push_back({std::move(name), entry->first, entry->second});
+        }
+    }
+
+    /// True when the walk covers a directory rather than one file.
+    bool is_tree() const { return !stack_.empty(); }
+
+    /// Store the next member in `out`; false once the walk is done.
+    bool next(Member& out) {
+        if (!queued_.empty()) {
+            out = std::move(queued_.front());
+            queued_.erase(queued_.begin());
+            return true;
+        }
+        while (!stack_.empty()) {
+            Frame& top = stack_.back();
+            if (top.pos == top.entries.size()) {
+                stack_.pop_back();
+                continue;
+            }
+            WalkEntry e = std::move(top.entries[top.pos++]);
+            std::string name = top.base + e.name;
+            if (e.mode == MODE_TREE) {
+                out = {name + "/", {}, MODE_TREE};
+                push(e.oid, name + "/");
+            } else if (e.mode == MODE_BLOB || e.mode == MODE_BLOB_EXEC ||
+                       e.mode == MODE_LINK) {
+                out = {std::move(name), std::move(e.oid), e.mode};
+            } else {
+                // Submodule commits have no content here; git archive writes
+                // them as empty directories, and so do we.
+                out = {name + "/", {}, MODE_TREE};
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Frame {
+        std::vector<WalkEntry> entries;
+        size_t                 pos = 0;
+        std::string            base;
+    };
+
+    void push(const std::string& tree_hex, std::string base) {
+        stack_.push_back({tree::list_tree_by_oid(repo_, tree_hex), 0, std::move(base)});
+    }
+
+    git_repository*     repo_;
+    std::vector<Member> queued_; ///< Prefix directory and single-file root.
+    std::vector<Frame>  stack_;
+};
+
+/// Owned blob handle.  With `mutex` set (a shared repository), the blob
+/// is freed under it, including while an exception unwinds.
+struct BlobGuard {
+    git_blob*   b = nullptr;
+    std::mutex* mutex = nullptr;
+
+    BlobGuard() = default;
+    explicit BlobGuard(std::mutex& m) : mutex(&m) {}
+    BlobGuard(const BlobGuard&) = delete;
+    BlobGuard& operator=(const BlobGuard&) = delete;
+    ~BlobGuard() { reset(); }
+
+    void reset() {
+        if (!b) return;
+        if (mutex) {
+            std::lock_guard<std::mutex> lk(*mutex);
+            git_blob_free(b);
+        } else {
+            git_blob_free(b);
+        }
+        b = nullptr;
+    }
+};
+
+void lookup_blob(git_repository* repo, const std::string& hex, BlobGuard& g) {
+    git_oid oid;
+    if (git_oid_fromstr(&oid, hex.c_str()) != 0 ||
+        git_blob_lookup(&g.b, repo, &oid) != 0)
+        throw_git("git_blob_lookup");
+}
+
+// ---------------------------------------------------------------------------
+// TarWriter — ustar headers with pax extensions
+// ---------------------------------------------------------------------------
+
+constexpr size_t kBlock = 512;
+constexpr uint64_t kMaxOctalSize = 077777777777ull; // 11 octal digits
+
+class TarWriter {
+public:
+    TarWriter(const ArchiveSink& sink, uint64_t mtime)
+        : sink_(sink), mtime_(mtime) { buf_.reserve(kFlushAt); }
+
+    /// Write the header(s) for one member; `size` bytes of data follow.
+    void header(const std::string& name, uint32_t mode, char type,
+                uint64_t size, const std::string& link = {}) {
+        std::string pax;
+        if (name.size() > 100) pax += record("path", name);
+        if (link.size() > 100) pax += record("linkpath", link);
+        if (size > kMaxOctalSize) pax += record("size", std::to_string(size));
+        if (!pax.empty()) {
+            std::string base = name.substr(0, name.size() - (name.back() == '/'));
+            base = base.substr(base.rfind('/') + 1);
+            std::string pax_name = "PaxHeaders/" + base;
+            raw_header(pax_name.substr(0, 100), 0644, 'x', pax.size(), {});
+            data(reinterpret_cast<const uint8_t*>(pax.data()), pax.size());
+        }
+        raw_header(name.substr(0, 100), mode, type,
+                   size > kMaxOctalSize ? 0 : size, link.substr(0, 100));
+    }
+
+    /// Append member data, padding to a block boundary.
+    void data(const uint8_t* p, size_t n) {
+        if (buf_.size() + n > kFlushAt) {
+            flush();
+            if (n >= kFlushAt) {
+                sink_(p, n);
+                pad(n);
+                return;
+            }
+        }
+        buf_.insert(buf_.end(), p, p + n);
+        pad(n);
+    }
+
+    /// Write the two end-of-archive blocks and flush.
+    void finish() {
+        buf_.insert(buf_.end(), 2 * kBlock, 0);
+        flush();
+    }
+
+    void flush() {
+        if (!buf_.empty()) sink_(buf_.data(), buf_.size());
+        buf_.clear();
+    }
+
+private:
+    static constexpr size_t kFlushAt = 64 * 1024;
+
+    /// pax record "<len> key=value\n", where len counts itself.
+    static std::string record(const std::string& key, const std::string& value) {
+        size_t body = key.size() + value.size() + 3; // ' ', '=', '\n'
+        size_t len = body + 1;
+        while (std::to_string(len).size() + body != len) ++len;
+        return std::to_string(len) + " " + key + "=" + value + "\n";
+    }
+
+    static void octal(char* field, size_t width, uint64_t v) {
+        // width - 1 zero-padded digits plus NUL.
+        field[width - 1] = '\0';
+        for (size_t i = width - 1; i-- > 0; v >>= 3)
+            field[i] = static_cast<char>('0' + (v & 7));
+    }
+
+    void raw_header(const std::string& name, uint32_t mode, char type,
+                    uint64_t size, const std::string& link) {
+        char h[kBlock] = {};
+        std::memcpy(h, name.data(), name.size());
+        octal(h + 100, 8, mode);
+        octal(h + 108, 8, 0);          // uid
+        octal(h + 116, 8, 0);          // gid
+        octal(h + 124, 12, size);
+        octal(h + 136, 12, mtime_);
+        std::memset(h + 148, ' ', 8);  // checksum placeholder
+        h[156] = type;
+        std::memcpy(h + 157, link.data(), link.size());
+        std::memcpy(h + 257, "ustar", 6);
+        std::memcpy(h + 263, "00", 2);
+        unsigned sum = 0;
+        for (unsigned char c : h) sum += c;
+        octal(h + 148, 7, sum);        // six digits, NUL, then the space
+        auto p = reinterpret_cast<const uint8_t*>(h);
+        buf_.insert(buf_.end(), p, p + kBlock);
+    }
+
+    void pad(size_t n) {
+        if (n % kBlock) buf_.insert(buf_.end(), kBlock - n % kBlock, 0);
+    }
+
+    const ArchiveSink&   sink_;
+    uint64_t             mtime_;
+    std::vector<uint8_t> buf_;
+};
+
+// ---------------------------------------------------------------------------
+// Prefetcher — reads blobs ahead on worker threads, handed out in order
+// ---------------------------------------------------------------------------
+
+/// Pulls members from `source` a bounded window ahead of the consumer,
+/// loads their blobs on worker threads, each with its own repository
+/// handle, turns each into a T with `fn` on the same thread, and hands the
+/// members out in order.  At most four members per thread are held at
+/// once, so memory does not grow with the size of the walk.
+template <typename T>
+class Prefetcher {
+public:
+    using Source = std::function<bool(Member&)>;
+    using Fn = std::function<T(const Member&, const uint8_t*, size_t)>;
+
+    Prefetcher(const std::filesystem::path& repo_path, size_t threads,
+               Source source, Fn fn)
+        : source_(std::move(source)), fn_(std::move(fn)), window_(threads * 4) {
+        for (size_t i = 0; i < threads; ++i)
+            workers_.emplace_back([this, repo_path] { run(repo_path); });
+    }
+
+    ~Prefetcher() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            abort_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    /// Next member in order and, for blobs, its result; blocks until a
+    /// worker has it.  Directories come back with a default T.
+    /// @return false once the source is exhausted.
+    bool next(Member& member, T& data) {
+        // Top up the window; the source takes the store lock, not m_.
+        while (!exhausted_ && queued_ < window_) {
+            Member m;
+            if (!source_(m)) {
+                exhausted_ = true;
+                break;
+            }
+            bool ready = m.oid.empty();
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                slots_.push_back({std::move(m), ready, T{}});
+            }
+            ++queued_;
+            if (!ready) cv_.notify_all();
+        }
+        if (queued_ == 0) return false;
+
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [&] { return slots_.front().ready || error_; });
+        if (error_) std::rethrow_exception(error_);
+        member = std::move(slots_.front().member);
+        data = std::move(slots_.front().data);
+        slots_.pop_front();
+        ++taken_;
+        --queued_;
+        return true;
+    }
+
+private:
+    struct Slot {
+        Member member;
+        bool   ready = false;
+        T      data{};
+    };
+
+    void run(const std::filesystem::path& repo_path) {
+        git_repository* repo = nullptr;
+        try {
+            if (git_repository_open_bare(&repo, repo_path.string().c_str()) != 0)
+                throw_git("git_repository_open_bare");
+            for (;;) {
+                size_t i;
+                Member m;
+                {
+                    std::unique_lock<std::mutex> lk(m_);
+                    // Slots before claimed_ are taken by other workers, and
+                    // directories handed out already are gone from slots_.
+                    auto unclaimed = [&] {
+                        claimed_ = std::max(claimed_, taken_);
+                        while (claimed_ < taken_ + slots_.size() &&
+                               slots_[claimed_ - taken_].ready)
+                            ++claimed_;
+                        return claimed_ < taken_ + slots_.size();
+                    };
+                    cv_.wait(lk, [&] { return abort_ || unclaimed(); });
+                    if (abort_) break;
+                    i = claimed_++;
+                    m = slots_[i - taken_].member;
+                }
+                BlobGuard g;
+                lookup_blob(repo, m.oid, g);
+                T data = fn_(m, static_cast<const uint8_t*>(git_blob_rawcontent(g.b)),
+                             static_cast<size_t>(git_blob_rawsize(g.b)));
+                {
+                    // Slot i is not handed out before it is ready, so it is
+                    // still in slots_.
+                    std::lock_guard<std::mutex> lk(m_);
+                    slots_[i - taken_].data = std::move(data);
+                    slots_[i - taken_].ready = true;
+                }
+                cv_.notify_all();
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (!error_) error_ = std::current_exception();
+            }
+            cv_.notify_all();
+        }
+        if (repo) git_repository_free(repo);
+    }
+
+    Source                   source_;
+    Fn                       fn_;
+    size_t                   window_;
+    size_t                   queued_    = 0;     ///< Consumer only.
+    bool                     exhausted_ = false; ///< Consumer only.
+    std::deque<Slot>         slots_;             ///< Members taken_.. in order.
+    size_t                   claimed_ = 0;
+    size_t                   taken_   = 0;
+    bool                     abort_   = false;
+    std::exception_ptr       error_;
+    std::mutex               m_;
+    std::condition_variable  cv_;
+    std::vector<std::thread> workers_;
+};
+
+// ---------------------------------------------------------------------------
+// TarReader — buffered pull over an ArchiveSource
+// ---------------------------------------------------------------------------
+
+class TarReader {
+public:
+    explicit TarReader(const ArchiveSource& source)
+        : source_(source), buf_(64 * 1024) {}
+
+    /// Read one header block.  Returns false at end of input or at the
+    /// zero block that ends the archive.
+    bool header(uint8_t* block) {
+        if (pos_ == len_ && !refill()) return false;
+        read(block, kBlock);
+        return std::any_of(block, block + kBlock, [](uint8_t c) { return c != 0; });
+    }
+
+    /// Up to `max` bytes of the current member, straight from the buffer.
+    std::pair<const uint8_t*, size_t> chunk(uint64_t max) {
+        if (pos_ == len_ && !refill()) throw IoError("truncated tar archive");
+        size_t n = static_cast<size_t>(std::min<uint64_t>(max, len_ - pos_));
+        const uint8_t* p = buf_.data() + pos_;
+        pos_ += n;
+        return {p, n};
+    }
+
+    void read(uint8_t* out, size_t n) {
+        while (n > 0) {
+            auto [p, got] = chunk(n);
+            std::memcpy(out, p, got);
+            out += got;
+            n -= got;
+        }
+    }
+
+    std::string read_string(uint64_t n) {
+        std::string s(static_cast<size_t>(n), '\0');
+        read(reinterpret_cast<uint8_t*>(s.data()), s.size());
+        return s;
+    }
+
+    void skip(uint64_t n) {
+        while (n > 0) n -= chunk(n).second;
+    }
+
+    /// Skip the padding after `size` bytes of member data.
+    void skip_padding(uint64_t size) {
+        if (size % kBlock) skip(kBlock - size % kBlock);
+    }
+
+private:
+    bool refill() {
+        pos_ = 0;
+        len_ = source_(buf_.data(), buf_.size());
+        return len_ > 0;
+    }
+
+    const ArchiveSource& source_;
+    std::vector<uint8_t> buf_;
+    size_t               pos_ = 0;
+    size_t               len_ = 0;
+};
+
+/// NUL-terminated header field.
+std::string tar_field(const uint8_t* p, size_t n) {
+    auto c = reinterpret_cast<const char*>(p);
+    return std::string(c, strnlen(c, n));
+}
+
+/// Numeric header field: octal, or GNU base-256 when the high bit is set.
+uint64_t tar_number(const uint8_t* p, size_t n) {
+    uint64_t v = 0;
+    if (p[0] & 0x80) {
+        v = p[0] & 0x3f;
+        for (size_t i = 1; i < n; ++i) v = (v << 8) | p[i];
+        return v;
+    }
+    size_t i = 0;
+    while (i < n && p[i] == ' ') ++i;
+    for (; i < n && p[i] >= '0' && p[i] <= '7'; ++i) v = v * 8 + (p[i] - '0');
+    return v;
+}
+
+bool tar_checksum_ok(const uint8_t* h) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kBlock; ++i)
+        sum += (i >= 148 && i < 156) ? ' ' : h[i];
+    return sum == tar_number(h + 148, 8);
+}
+
+/// Apply pax records ("<len> key=value\n") for path, linkpath and size.
+void apply_pax(const std::string& data, std::optional<std::string>& path,
+               std::optional<std::string>& link, std::optional<uint64_t>& size) {
+    size_t i = 0;
+    while (i < data.size()) {
+        size_t sp = data.find(' ', i);
+        if (sp == std::string::npos) break;
+        size_t len = std::strtoull(data.c_str() + i, nullptr, 10);
+        if (len <= sp - i + 1 || i + len > data.size())
+            throw IoError("malformed pax header");
+        std::string rec = data.substr(sp + 1, i + len - sp - 2);
+        size_t eq = rec.find('=');
+        if (eq != std::string::npos) {
+            std::string key = rec.substr(0, eq);
+            if (key == "path") path = rec.substr(eq + 1);
+            else if (key == "linkpath") link = rec.substr(eq + 1);
+            else if (key == "size") size = std::strtoull(rec.c_str() + eq + 1, nullptr, 10);
+        }
+        i += len;
+    }
+}
+
+/// Member name relative to the archive root with `strip` leading
+/// segments removed; nullopt if nothing is left.
+std::optional<std::string> member_path(const std::string& raw, size_t strip) {
+    std::vector<std::string> segs;
+    size_t start = 0;
+    while (start <= raw.size()) {
+        size_t end = raw.find('/', start);
+        if (end == std::string::npos) end = raw.size();
+        std::string seg = raw.substr(start, end - start);
+        if (!seg.empty() && seg != ".") segs.push_back(std::move(seg));
+        start = end + 1;
+    }
+    if (segs.size() <= strip) return std::nullopt;
+    std::string out;
+    for (size_t i = strip; i < segs.size(); ++i) {
+        if (i > strip) out += '/';
+        out += segs[i];
+    }
+    return paths::normalize(out); // rejects ".."
+}
+
+// ---------------------------------------------------------------------------
+// Zip — payload compression and a streaming zip64 writer
+// ---------------------------------------------------------------------------
+
+/// One member's data as it will appear in the archive.
+struct ZipPayload {
+    uint32_t             crc    = 0;
+    uint16_t             method = 0; ///< 0 = stored, 8 = deflated.
+    uint64_t             size   = 0; ///< Uncompressed size.
+    std::vector<uint8_t> data;       ///< Stored or deflated bytes.
+};
+
+/// True for content not worth deflating: a known compressed format by
+/// extension, or a sample whose byte entropy is close to 8 bits.
+bool looks_compressed(const std::string& name, const uint8_t* p, size_t n) {
+    if (odb::compressed_extension(name)) return true;
+    if (n < 4096) return false;
+    return odb::byte_entropy(p, std::min<size_t>(n, 64 * 1024)) > 7.5;
+}
+
+uint32_t crc32_of(const uint8_t* p, size_t n) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (size_t off = 0; off < n;) {
+        uInt step = static_cast<uInt>(std::min<size_t>(n - off, 1u << 30));
+        crc = crc32(crc, p + off, step);
+        off += step;
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+ZipPayload zip_payload(const Member& m, const uint8_t* p, size_t n,
+                       int level, bool store_compressed) {
+    ZipPayload out;
+    out.size = n;
+    out.crc  = crc32_of(p, n);
+    if (n > 0 && m.mode != MODE_LINK &&
+        !(store_compressed && looks_compressed(m.name, p, n))) {
+        z_stream zs{};
+        if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw IoError("deflateInit2 failed");
+        // Output is only kept if it ends up smaller than the input.
+        out.data.resize(n);
+        size_t in_off = 0, out_off = 0;
+        int rc = Z_OK;
+        while (rc == Z_OK && out_off < n) {
+            if (zs.avail_in == 0 && in_off < n) {
+                uInt step = static_cast<uInt>(std::min<size_t>(n - in_off, 1u << 30));
+                zs.next_in  = const_cast<Bytef*>(p + in_off);
+                zs.avail_in = step;
+                in_off += step;
+            }
+            uInt room = static_cast<uInt>(std::min<size_t>(n - out_off, 1u << 30));
+            zs.next_out  = out.data.data() + out_off;
+            zs.avail_out = room;
+            rc = deflate(&zs, in_off == n ? Z_FINISH : Z_NO_FLUSH);
+            out_off += room - zs.avail_out;
+        }
+        deflateEnd(&zs);
+        if (rc == Z_STREAM_END && out_off < n) {
+            out.method = 8;
+            out.data.resize(out_off);
+            return out;
+        }
+        // Deflate did not pay off; fall through to storing.
+    }
+    out.data.assign(p, p + n);
+    return out;
+}
+
+/// MS-DOS date and time fields for a Unix time (UTC, clamped to 1980).
+std::pair<uint16_t, uint16_t> dos_datetime(uint64_t unix_time) {
+    int64_t days = static_cast<int64_t>(unix_time / 86400);
+    uint32_t secs = static_cast<uint32_t>(unix_time % 86400);
+    // Civil date from days since 1970-01-01 (Hinnant's algorithm).
+    days += 719468;
+    int64_t era = days / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp  = (5 * doy + 2) / 153;
+    int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    int64_t mon = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = yoe + era * 400 + (mon <= 2);
+    if (year < 1980) return {static_cast<uint16_t>((1 << 5) | 1), 0};
+    if (year > 2107) year = 2107;
+    auto date = static_cast<uint16_t>(((year - 1980) << 9) | (mon << 5) | day);
+    auto time = static_cast<uint16_t>(((secs / 3600) << 11) |
+                                      (((secs / 60) % 60) << 5) | ((secs % 60) / 2));
+    return {date, time};
+}
+
+/// Writes zip members in order to a sink without seeking: sizes and CRC
+/// are known before each local header, so no data descriptors are needed.
+/// Zip64 fields are added only where a size, offset or count overflows.
+class ZipWriter {
+public:
+    ZipWriter(const ArchiveSink& sink, uint64_t mtime)
+        : sink_(sink), mtime_(mtime) {
+        std::tie(dos_date_, dos_time_) = dos_datetime(mtime);
+    }
+
+    void add(const std::string& name, uint32_t unix_mode, const ZipPayload& pl) {
+        Entry e{name, unix_mode, pl.crc, pl.method, pl.data.size(), pl.size, offset_};
+        bool big = e.csize >= kMax32 || e.usize >= kMax32;
+        put32(0x04034b50);
+        put16(big ? 45 : 20);
+        put16(kUtf8Flag);
+        put16(e.method);
+        put16(dos_time_);
+        put16(dos_date_);
+        put32(e.crc);
+        put32(big ? kMax32 : static_cast<uint32_t>(e.csize));
+        put32(big ? kMax32 : static_cast<uint32_t>(e.usize));
+        put16(static_cast<uint16_t>(name.size()));
+        put16(static_cast<uint16_t>(9 + (big ? 20 : 0)));
+        put_bytes(reinterpret_cast<const uint8_t*>(name.data()), name.size());
+        put_mtime_extra();
+        if (big) {
+            put16(0x0001);
+            put16(16);
+            put64(e.usize);
+            put64(e.csize);
+        }
+        put_bytes(pl.data.data(), pl.data.size());
+        entries_.push_back(std::move(e));
+    }
+
+    void finish() {
+        uint64_t cd_offset = offset_;
+        for (auto& e : entries_) {
+            std::vector<uint64_t> z64;
+            if (e.usize >= kMax32) z64.push_back(e.usize);
+            if (e.csize >= kMax32) z64.push_back(e.csize);
+            if (e.offset >= kMax32) z64.push_back(e.offset);
+            bool zip64 = !z64.empty();
+            put32(0x02014b50);
+            put16((3 << 8) | (zip64 ? 45 : 20)); // made by: Unix
+            put16(zip64 ? 45 : 20);
+            put16(kUtf8Flag);
+            put16(e.method);
+            put16(dos_time_);
+            put16(dos_date_);
+            put32(e.crc);
+            put32(e.csize >= kMax32 ? kMax32 : static_cast<uint32_t>(e.csize));
+            put32(e.usize >= kMax32 ? kMax32 : static_cast<uint32_t>(e.usize));
+            put16(static_cast<uint16_t>(e.name.size()));
+            put16(static_cast<uint16_t>(9 + (zip64 ? 4 + 8 * z64.size() : 0)));
+            put16(0);                            // comment
+            put16(0);                            // disk
+            put16(0);                            // internal attributes
+            put32((e.mode << 16) | ((e.mode & 0170000) == 0040000 ? 0x10 : 0));
+            put32(e.offset >= kMax32 ? kMax32 : static_cast<uint32_t>(e.offset));
+            put_bytes(reinterpret_cast<const uint8_t*>(e.name.data()), e.name.size());
+            put_mtime_extra();
+            if (zip64) {
+                put16(0x0001);
+                put16(static_cast<uint16_t>(8 * z64.size()));
+                for (uint64_t v : z64) put64(v);
+            }
+        }
+        uint64_t cd_size = offset_ - cd_offset;
+        uint64_t count = entries_.size();
+        if (count >= 0xffff || cd_offset >= kMax32 || cd_size >= kMax32) {
+            uint64_t eocd64 = offset_;
+            put32(0x06064b50);
+            put64(44);
+            put16((3 << 8) | 45);
+            put16(45);
+            put32(0);
+            put32(0);
+            put64(count);
+            put64(count);
+            put64(cd_size);
+            put64(cd_offset);
+            put32(0x07064b50);                   // zip64 end locator
+            put32(0);
+            put64(eocd64);
+            put32(1);
+        }
+        put32(0x06054b50);
+        put16(0);
+        put16(0);
+        put16(count >= 0xffff ? 0xffff : static_cast<uint16_t>(count));
+        put16(count >= 0xffff ? 0xffff : static_cast<uint16_t>(count));
+        put32(cd_size >= kMax32 ? kMax32 : static_cast<uint32_t>(cd_size));
+        put32(cd_offset >= kMax32 ? kMax32 : static_cast<uint32_t>(cd_offset));
+        put16(0);
+        flush();
+    }
+
+private:
+    static constexpr uint32_t kMax32    = 0xffffffffu;
+    static constexpr uint16_t kUtf8Flag = 0x0800;
+    static constexpr size_t   kFlushAt  = 64 * 1024;
+
+    struct Entry {
+        std::string name;
+        uint32_t    mode;
+        uint32_t    crc;
+        uint16_t    method;
+        uint64_t    csize;
+        uint64_t    usize;
+        uint64_t    offset;
+    };
+
+    /// Extended timestamp ("UT") extra field carrying the exact mtime.
+    void put_mtime_extra() {
+        put16(0x5455);
+        put16(5);
+        uint8_t flags = 1;
+        put_bytes(&flags, 1);
+        put32(static_cast<uint32_t>(mtime_));
+    }
+
+    void put16(uint16_t v) {
+        uint8_t b[2] = {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8)};
+        put_bytes(b, 2);
+    }
+    void put32(uint32_t v) {
+        put16(static_cast<uint16_t>(v));
+        put16(static_cast<uint16_t>(v >> 16));
+    }
+    void put64(uint64_t v) {
+        put32(static_cast<uint32_t>(v));
+        put32(static_cast<uint32_t>(v >> 32));
+    }
+
+    void put_bytes(const uint8_t* p, size_t n) {
+        offset_ += n;
+        if (buf_.size() + n > kFlushAt) {
+            flush();
+            if (n >= kFlushAt) {
+                sink_(p, n);
+                return;
+            }
+        }
+        buf_.insert(buf_.end(), p, p + n);
+    }
+
+    void flush() {
+        if (!buf_.empty()) sink_(buf_.data(), buf_.size());
+        buf_.clear();
+    }
+
+    const ArchiveSink&   sink_;
+    uint64_t             mtime_;
+    uint16_t             dos_date_ = 0;
+    uint16_t             dos_time_ = 0;
+    uint64_t             offset_   = 0;
+    std::vector<uint8_t> buf_;
+    std::vector<Entry>   entries_;
+};
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------
+// Fs::export_tar
+// ---------------------------------------------------------------------------
+
+void Fs::export_tar(const std::string& path,
+                    const ArchiveSink& sink,
+                    TarExportOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::export_tar");
+    const auto& tree_hex = require_tree();
+    std::string norm = paths::normalize(path);
+
+    uint64_t mtime = 0;
+    std::optional<MemberWalker> walk;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        if (!commit_oid_hex_.empty())
+            mtime = tree::read_commit(inner_->repo, commit_oid_hex_).time;
+        walk.emplace(inner_->repo, tree_hex, norm, opts.prefix);
+    }
+    auto walk_next = [&](Member& m) {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        return walk->next(m);
+    };
+
+    std::optional<Prefetcher<std::vector<uint8_t>>> prefetch;
+    if (opts.prefetch > 0 && walk->is_tree())
+        prefetch.emplace(inner_->path, opts.prefetch, walk_next,
+                         [](const Member&, const uint8_t* p, size_t n) {
+                             return std::vector<uint8_t>(p, p + n);
+                         });
+
+    // Members are written as the walk produces them, so the sink sees the
+    // first bytes after one tree read, not after the whole subtree.
+    TarWriter tar(sink, mtime);
+    Member m;
+    std::vector<uint8_t> fetched;
+    for (;;) {
+        // Blob content: from the prefetcher, or looked up under the store
+        // lock and streamed from libgit2's buffer with the lock released,
+        // so a slow sink never blocks other users of the store.
+        BlobGuard g(inner_->mutex);
+        const uint8_t* p = nullptr;
+        size_t n = 0;
+        if (prefetch) {
+            if (!prefetch->next(m, fetched)) break;
+            p = fetched.data();
+            n = fetched.size();
+        } else {
+            std::lock_guard<std::mutex> lk(inner_->mutex);
+            if (!walk->next(m)) break;
+            if (m.mode != MODE_TREE) {
+                observe::PhaseTimer phase(Phase::BlobRead);
+                lookup_blob(inner_->repo, m.oid, g);
+                p = static_cast<const uint8_t*>(git_blob_rawcontent(g.b));
+                n = static_cast<size_t>(git_blob_rawsize(g.b));
+            }
+        }
+        if (m.mode == MODE_TREE) {
+            tar.header(m.name, 0755, '5', 0);
+            continue;
+        }
+        observe::count(Counter::BlobLookups);
+        observe::count(Counter::BytesInflated, n);
+
+        if (m.mode == MODE_LINK) {
+            tar.header(m.name, 0777, '2', 0,
+                       std::string(reinterpret_cast<const char*>(p), n));
+        } else {
+            tar.header(m.name, m.mode == MODE_BLOB_EXEC ? 0755 : 0644, '0', n);
+            tar.data(p, n);
+        }
+        g.reset();
+    }
+    tar.finish();
+}
+
+// ---------------------------------------------------------------------------
+// Fs::export_zip
+// ---------------------------------------------------------------------------
+
+void Fs::export_zip(const std::string& path,
+                    const ArchiveSink& sink,
+                    ZipExportOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::export_zip");
+    const auto& tree_hex = require_tree();
+    std::string norm = paths::normalize(path);
+    if (opts.level < 1 || opts.level > 9)
+        throw std::invalid_argument("zip level must be 1..9");
+
+    uint64_t mtime = 0;
+    std::optional<MemberWalker> walk;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        if (!commit_oid_hex_.empty())
+            mtime = tree::read_commit(inner_->repo, commit_oid_hex_).time;
+        walk.emplace(inner_->repo, tree_hex, norm, opts.prefix);
+    }
+    auto walk_next = [&](Member& m) {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        return walk->next(m);
+    };
+
+    // Workers read and deflate; the writer below consumes in member order.
+    auto compress = [&opts](const Member& m, const uint8_t* p, size_t n) {
+        return zip_payload(m, p, n, opts.level, opts.store_compressed);
+    };
+    std::optional<Prefetcher<ZipPayload>> workers;
+    if (opts.threads > 0 && walk->is_tree())
+        workers.emplace(inner_->path, opts.threads, walk_next, compress);
+
+    // Members are written as the walk produces them; only the central
+    // directory entries are kept until the end.
+    ZipWriter zip(sink, mtime);
+    Member m;
+    for (;;) {
+        ZipPayload pl;
+        if (workers) {
+            if (!workers->next(m, pl)) break;
+        } else {
+            BlobGuard g(inner_->mutex);
+            {
+                std::lock_guard<std::mutex> lk(inner_->mutex);
+                if (!walk->next(m)) break;
+                if (m.mode != MODE_TREE) {
+                    observe::PhaseTimer phase(Phase::BlobRead);
+                    lookup_blob(inner_->repo, m.oid, g);
+                }
+            }
+            if (g.b)
+                pl = compress(m, static_cast<const uint8_t*>(git_blob_rawcontent(g.b)),
+                              static_cast<size_t>(git_blob_rawsize(g.b)));
+            g.reset();
+        }
+        if (m.mode == MODE_TREE) {
+            zip.add(m.name, 040755, ZipPayload{});
+            continue;
+        }
+        observe::count(Counter::BlobLookups);
+        observe::count(Counter::BytesInflated, pl.size);
+
+        uint32_t mode = m.mode == MODE_LINK ? 0120777
+                      : m.mode == MODE_BLOB_EXEC ? 0100755 : 0100644;
+        zip.add(m.name, mode, pl);
+    }
+    zip.finish();
+}
+
+// ---------------------------------------------------------------------------
+// Fs::import_tar
+// ---------------------------------------------------------------------------
+
+std::pair<ChangeReport, Fs>
+Fs::import_tar(const ArchiveSource& source,
+               const std::string& dest,
+               TarImportOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::import_tar");
+    require_writable("import_tar");
+    std::string dest_norm = dest.empty() ? "" : paths::normalize(dest);
+    auto store_path = [&](const std::string& rel) {
+        return dest_norm.empty() ? rel : dest_norm + "/" + rel;
+    };
+
+    git_odb* odb = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        if (git_repository_odb(&odb, inner_->repo) != 0)
+            throw_git("git_repository_odb");
+    }
+    struct OdbGuard {
+        git_odb* o;
+        ~OdbGuard() { git_odb_free(o); }
+    } odb_guard{odb};
+
+    // Stream `size` bytes of member data into a new blob.  The store lock
+    // is taken per chunk, never while waiting on the source.
+    TarReader rd(source);
+    odb::BlobWriter blobs(*inner_);
+    auto store_blob = [&](uint64_t size, const std::string& path) {
+        observe::PhaseTimer phase(Phase::BlobWrite);
+        if (blobs.hash == HashBackend::Fast) {
+            // Hashed and compressed here; the lock only guards the final
+            // existence check.  The leading bytes pick the policy level.
+            std::vector<uint8_t> head;
+            if (blobs.policy) {
+                head.resize(static_cast<size_t>(
+                    std::min<uint64_t>(size, blobs.policy->probe_bytes)));
+                rd.read(head.data(), head.size());
+            }
+            odb::LooseWriter loose(blobs, size,
+                                   blobs.level_for(path, head.data(), head.size()));
+            loose.write(head.data(), head.size());
+            for (uint64_t left = size - head.size(); left > 0;) {
+                auto [p, n] = rd.chunk(left);
+                loose.write(p, n);
+                left -= n;
+            }
+            git_oid oid;
+            {
+                std::lock_guard<std::mutex> lk(inner_->mutex);
+                loose.finish(&oid);
+            }
+            observe::count(Counter::BlobsWritten);
+            observe::count(Counter::BytesWritten, size);
+            char buf[GIT_OID_HEXSZ + 1];
+            git_oid_tostr(buf, sizeof(buf), &oid);
+            return std::string(buf, GIT_OID_HEXSZ);
+        }
+        git_odb_stream* stream = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(inner_->mutex);
+            if (git_odb_open_wstream(&stream, odb, size, GIT_OBJECT_BLOB) != 0)
+                throw_git("git_odb_open_wstream");
+        }
+        struct StreamGuard {
+            git_odb_stream* s;
+            ~StreamGuard() { git_odb_stream_free(s); }
+        } stream_guard{stream};
+        for (uint64_t left = size; left > 0;) {
+            auto [p, n] = rd.chunk(left);
+            std::lock_guard<std::mutex> lk(inner_->mutex);
+            if (git_odb_stream_write(stream, reinterpret_cast<const char*>(p), n) != 0)
+                throw_git("git_odb_stream_write");
+            left -= n;
+        }
+        git_oid oid;
+        {
+            std::lock_guard<std::mutex> lk(inner_->mutex);
+            if (git_odb_stream_finalize_write(&oid, stream) != 0)
+                throw_git("git_odb_stream_finalize_write");
+        }
+        observe::count(Counter::BlobsWritten);
+        observe::count(Counter::BytesWritten, size);
+        char buf[GIT_OID_HEXSZ + 1];
+        git_oid_tostr(buf, sizeof(buf), &oid);
+        return std::string(buf, GIT_OID_HEXSZ);
+    };
+
+    // Read the archive; later members with the same path win, as with tar.
+    ChangeReport report;
+    std::map<std::string, std::pair<std::string, uint32_t>> imported;
+    std::optional<std::string> pax_path, pax_link;
+    std::optional<uint64_t>    pax_size;
+    uint8_t h[kBlock];
+    while (rd.header(h)) {
+        if (!tar_checksum_ok(h)) throw IoError("invalid tar header checksum");
+        char type = static_cast<char>(h[156]);
+        uint64_t size = pax_size ? *pax_size : tar_number(h + 124, 12);
+
+        if (type == 'x' || type == 'g') {
+            auto data = rd.read_string(size);
+            rd.skip_padding(size);
+            if (type == 'x') apply_pax(data, pax_path, pax_link, pax_size);
+            continue;
+        }
+        if (type == 'L' || type == 'K') {
+            auto data = rd.read_string(size);
+            rd.skip_padding(size);
+            data.resize(strnlen(data.c_str(), data.size()));
+            (type == 'L' ? pax_path : pax_link) = std::move(data);
+            continue;
+        }
+
+        std::string name = tar_field(h, 100);
+        if (std::memcmp(h + 257, "ustar", 5) == 0 && h[345] != 0)
+            name = tar_field(h + 345, 155) + "/" + name;
+        std::string raw_path = pax_path ? *pax_path : name;
+        std::string link = pax_link ? *pax_link : tar_field(h + 157, 100);
+        uint32_t hdr_mode = static_cast<uint32_t>(tar_number(h + 100, 8));
+        pax_path.reset();
+        pax_link.reset();
+        pax_size.reset();
+
+        auto rel = member_path(raw_path, opts.strip_components);
+        bool is_file = type == '0' || type == '\0' || type == '7';
+        if (!rel || type == '5' || (!is_file && type != '1' && type != '2')) {
+            if (rel && type != '5')
+                report.warnings.push_back(
+                    {store_path(*rel), std::string("unsupported tar entry type '") + type + "'"});
+            rd.skip(size);
+            rd.skip_padding(size);
+            continue;
+        }
+
+        std::string path = store_path(*rel);
+        if (is_file) {
+            uint32_t mode = (hdr_mode & 0100) ? MODE_BLOB_EXEC : MODE_BLOB;
+            imported[path] = {store_blob(size, path), mode};
+            rd.skip_padding(size);
+        } else if (type == '2') {
+            std::string oid_hex;
+            {
+                std::lock_guard<std::mutex> lk(inner_->mutex);
+                git_oid oid;
+                blobs.write(reinterpret_cast<const uint8_t*>(link.data()), link.size(), &oid, path);
+                observe::count(Counter::BlobsWritten);
+                observe::count(Counter::BytesWritten, link.size());
+                char buf[GIT_OID_HEXSZ + 1];
+                git_oid_tostr(buf, sizeof(buf), &oid);
+                oid_hex.assign(buf, GIT_OID_HEXSZ);
+            }
+            imported[path] = {std::move(oid_hex), MODE_LINK};
+            rd.skip(size);
+            rd.skip_padding(size);
+        } else {
+            // Hard link: share the blob of an earlier member.
+            auto target = member_path(link, opts.strip_components);
+            auto it = target ? imported.find(store_path(*target)) : imported.end();
+            if (it == imported.end()) {
+                report.warnings.push_back({path, "hard link target not in archive: " + link});
+            } else {
+                imported[path] = it->second;
+            }
+            rd.skip(size);
+            rd.skip_padding(size);
+        }
+    }
+
+    // Compare against what is already at dest.
+    std::map<std::string, std::pair<std::string, uint32_t>> existing;
+    if (!tree_oid_hex_.empty() && !imported.empty()) {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        bool dest_is_tree = dest_norm.empty();
+        if (!dest_is_tree) {
+            auto entry = tree::lookup(inner_->repo, tree_oid_hex_, dest_norm);
+            dest_is_tree = entry && entry->second == MODE_TREE;
+        }
+        if (dest_is_tree)
+            for (auto& [p, we] : tree::walk_tree(inner_->repo, tree_oid_hex_, dest_norm))
+                existing[p] = {we.oid, we.mode};
+    }
+
+    std::vector<std::pair<std::string, std::pair<std::string, uint32_t>>> stored;
+    for (auto& [path, oid_mode] : imported) {
+        auto it = existing.find(path);
+        if (it != existing.end() && it->second == oid_mode) continue;
+        FileEntry fe{path, *file_type_from_mode(oid_mode.second), std::nullopt};
+        (it == existing.end() ? report.add : report.update).push_back(std::move(fe));
+        stored.push_back({path, oid_mode});
+    }
+
+    if (stored.empty()) return {std::move(report), *this};
+
+    std::string msg = paths::format_message("import_tar", opts.message);
+    auto new_fs = commit_changes({}, {}, msg, std::move(report), opts.parents, stored);
+    return {new_fs.changes().value_or(ChangeReport{}), new_fs};
+}
+
+} // namespace vost
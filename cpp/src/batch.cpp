@@ -1,8 +1,10 @@
 #include "vost/batch.h"
 #include "vost/fs.h"
+#include "vost/gitstore.h"
 #include "internal.h"
 
 #include <fstream>
+#include <mutex>
 
 namespace vost {
 
@@ -44,11 +46,37 @@ Batch& Batch::write_with_mode(const std::string& path,
         std::remove_if(writes_.begin(), writes_.end(),
                        [&norm](const auto& kv) { return kv.first == norm; }),
         writes_.end());
+    refs_.erase(
+        std::remove_if(refs_.begin(), refs_.end(),
+                       [&norm](const auto& kv) { return kv.first == norm; }),
+        refs_.end());
 
     writes_.push_back({norm, {data, mode}});
     return *this;
 }
 
+Batch& Batch::write_oid(const std::string& path, const std::string& hash,
+                        uint32_t mode) {
+    require_open();
+    WriteEntry::from_oid(hash, mode).validate();
+    std::string hex = odb::canonical_hex(hash);
+    std::string norm = paths::normalize(path);
+
+    removes_.erase(std::remove(removes_.begin(), removes_.end(), norm),
+                   removes_.end());
+    writes_.erase(
+        std::remove_if(writes_.begin(), writes_.end(),
+                       [&norm](const auto& kv) { return kv.first == norm; }),
+        writes_.end());
+    refs_.erase(
+        std::remove_if(refs_.begin(), refs_.end(),
+                       [&norm](const auto& kv) { return kv.first == norm; }),
+        refs_.end());
+
+    refs_.push_back({norm, {std::move(hex), mode}});
+    return *this;
+}
+
 Batch& Batch::write_from_file(const std::string& path,
                                const std::filesystem::path& local_path,
                                uint32_t mode) {
@@ -86,6 +114,10 @@ Batch& Batch::remove(const std::string& path) {
         std::remove_if(writes_.begin(), writes_.end(),
                        [&norm](const auto& kv) { return kv.first == norm; }),
         writes_.end());
+    refs_.erase(
+        std::remove_if(refs_.begin(), refs_.end(),
+                       [&norm](const auto& kv) { return kv.first == norm; }),
+        refs_.end());
 
     // Add to removes if not already there
     if (std::find(removes_.begin(), removes_.end(), norm) == removes_.end()) {
@@ -99,6 +131,7 @@ Batch& Batch::remove(const std::string& path) {
 // ---------------------------------------------------------------------------
 
 Fs Batch::commit() {
+    observe::Operation obs_op(*fs_.inner(), "Batch::commit");
     require_open();
     closed_ = true;
 
@@ -108,18 +141,24 @@ Fs Batch::commit() {
     } else {
         // Auto-generate from staged operations
         std::string op = operation_.value_or("batch");
-        if (!writes_.empty() && removes_.empty()) {
-            msg = op + ": write " + std::to_string(writes_.size()) + " file(s)";
-        } else if (writes_.empty() && !removes_.empty()) {
+        size_t n_writes = pending_writes();
+        if (n_writes && removes_.empty()) {
+            msg = op + ": write " + std::to_string(n_writes) + " file(s)";
+        } else if (!n_writes && !removes_.empty()) {
             msg = op + ": remove " + std::to_string(removes_.size()) + " file(s)";
         } else {
-            msg = op + ": " + std::to_string(writes_.size()) + " write(s), " +
+            msg = op + ": " + std::to_string(n_writes) + " write(s), " +
                   std::to_string(removes_.size()) + " remove(s)";
         }
     }
 
+    if (!refs_.empty()) {
+        std::lock_guard<std::mutex> lk(fs_.inner()->mutex);
+        odb::require_blobs(fs_.inner()->repo, refs_);
+    }
+
     // Delegate to Fs::commit_changes (internal)
-    Fs result = fs_.commit_changes(writes_, removes_, msg, std::nullopt, parents_);
+    Fs result = fs_.commit_changes(writes_, removes_, msg, std::nullopt, parents_, refs_);
     result_fs_ = result;
     return result;
 }
@@ -0,0 +1,470 @@
+#include "vost/vost_c.h"
+#include "vost/vost.h"
+#include "internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Handles
+// ---------------------------------------------------------------------------
+//
+// Each handle owns a C++ value; an Fs or Batch keeps its GitStoreInner
+// alive through its own shared_ptr, so handles can be freed in any order.
+// A vost_buf holds the libgit2 blob itself (plus the store it came from)
+// and exposes a slice of it, so reads cost no copy beyond libgit2's.
+
+struct vost_store {
+    vost::GitStore store;
+};
+
+struct vost_fs {
+    vost::Fs fs;
+};
+
+struct vost_batch {
+    vost::Batch batch;
+};
+
+struct vost_buf {
+    std::atomic<uint32_t>                refs{1};
+    std::shared_ptr<vost::GitStoreInner> inner;
+    vost::tree::BlobRef                  blob;
+    const uint8_t*                       data = nullptr;
+    size_t                               size = 0;
+
+    vost_buf(std::shared_ptr<vost::GitStoreInner> i, vost::tree::BlobRef b)
+        : inner(std::move(i)), blob(std::move(b)) {}
+
+    ~vost_buf() {
+        // libgit2 objects are released under the store lock, like every
+        // other libgit2 call on this repository.
+        std::lock_guard<std::mutex> lk(inner->mutex);
+        vost::tree::BlobRef gone(std::move(blob));
+    }
+};
+
+struct vost_strlist {
+    std::vector<std::string> items;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+/// Record `what` as this thread's last error.  Never throws: it also runs
+/// outside guarded(), and an exception must not escape an extern "C" call.
+vost_status fail(vost_status status, const char* what) noexcept {
+    try {
+        last_error = what;
+    } catch (...) {
+        last_error.clear(); // no memory for the message; the status stands
+    }
+    return status;
+}
+
+/// Run `fn`, mapping each vost exception to its status code.
+template <class Fn>
+vost_status guarded(Fn&& fn) noexcept {
+    try {
+        fn();
+        last_error.clear();
+        return VOST_OK;
+    } catch (const vost::NotFoundError& e) {
+        return fail(VOST_ERR_NOT_FOUND, e.what());
+    } catch (const vost::IsADirectoryError& e) {
+        return fail(VOST_ERR_IS_A_DIRECTORY, e.what());
+    } catch (const vost::NotADirectoryError& e) {
+        return fail(VOST_ERR_NOT_A_DIRECTORY, e.what());
+    } catch (const vost::PermissionError& e) {
+        return fail(VOST_ERR_PERMISSION, e.what());
+    } catch (const vost::StaleSnapshotError& e) {
+        return fail(VOST_ERR_STALE_SNAPSHOT, e.what());
+    } catch (const vost::KeyNotFoundError& e) {
+        return fail(VOST_ERR_KEY_NOT_FOUND, e.what());
+    } catch (const vost::KeyExistsError& e) {
+        return fail(VOST_ERR_KEY_EXISTS, e.what());
+    } catch (const vost::InvalidPathError& e) {
+        return fail(VOST_ERR_INVALID_PATH, e.what());
+    } catch (const vost::InvalidHashError& e) {
+        return fail(VOST_ERR_INVALID_HASH, e.what());
+    } catch (const vost::InvalidRefNameError& e) {
+        return fail(VOST_ERR_INVALID_REF_NAME, e.what());
+    } catch (const vost::BatchClosedError& e) {
+        return fail(VOST_ERR_BATCH_CLOSED, e.what());
+    } catch (const vost::MergeConflictError& e) {
+        return fail(VOST_ERR_MERGE_CONFLICT, e.what());
+    } catch (const vost::GitError& e) {
+        return fail(VOST_ERR_GIT, e.what());
+    } catch (const vost::IoError& e) {
+        return fail(VOST_ERR_IO, e.what());
+    } catch (const std::bad_alloc&) {
+        return fail(VOST_ERR_OTHER, "out of memory");
+    } catch (const std::exception& e) {
+        return fail(VOST_ERR_OTHER, e.what());
+    } catch (...) {
+        return fail(VOST_ERR_OTHER, "unknown error");
+    }
+}
+
+#define VOST_REQUIRE(arg)                                                   \
+    do {                                                                    \
+        if (!(arg)) return fail(VOST_ERR_INVALID_ARGUMENT, #arg " is NULL"); \
+    } while (0)
+
+void copy_hash(const std::optional<std::string>& hex, char out[VOST_HASH_BUFSZ]) {
+    std::string h = hex.value_or("");
+    std::memcpy(out, h.c_str(), h.size() + 1);
+}
+
+/// Slice [offset, offset + size) of `blob` (size 0 = to the end).
+vost_buf* make_buf(std::shared_ptr<vost::GitStoreInner> inner, vost::tree::BlobRef blob,
+                   uint64_t offset = 0, uint64_t size = 0) {
+    auto* buf = new vost_buf(std::move(inner), std::move(blob));
+    size_t total = buf->blob.size();
+    size_t start = static_cast<size_t>(std::min<uint64_t>(offset, total));
+    size_t end = size ? static_cast<size_t>(std::min<uint64_t>(start + size, total)) : total;
+    buf->data = buf->blob.data() + start;
+    buf->size = end - start;
+    return buf;
+}
+
+/// Load the blob at `path` in `fs` under the store lock.
+vost_buf* read_buf(const vost::Fs& fs, const char* path, uint64_t offset, uint64_t size) {
+    auto inner = fs.inner();
+    vost::observe::Operation obs_op(*inner, "Fs::read");
+    auto tree = fs.tree_hash();
+    if (!tree) throw vost::NotFoundError("no tree in snapshot");
+    std::string norm_buf;
+    auto norm = vost::paths::normalize_view(path, norm_buf);
+    vost::tree::BlobRef blob = [&] {
+        std::lock_guard<std::mutex> lk(inner->mutex);
+        return vost::tree::load_blob(inner->repo, *tree, norm);
+    }();
+    return make_buf(std::move(inner), std::move(blob), offset, size);
+}
+
+std::vector<uint8_t> bytes(const void* data, size_t size) {
+    auto* p = static_cast<const uint8_t*>(data);
+    return std::vector<uint8_t>(p, p + size);
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+// ---------------------------------------------------------------------------
+// Errors and version
+// ---------------------------------------------------------------------------
+
+uint32_t vost_abi_version(void) {
+    return VOST_C_ABI_VERSION;
+}
+
+const char* vost_last_error(void) {
+    return last_error.c_str();
+}
+
+const char* vost_status_name(vost_status status) {
+    switch (status) {
+        case VOST_OK:                   return "VOST_OK";
+        case VOST_ERR_NOT_FOUND:        return "VOST_ERR_NOT_FOUND";
+        case VOST_ERR_IS_A_DIRECTORY:   return "VOST_ERR_IS_A_DIRECTORY";
+        case VOST_ERR_NOT_A_DIRECTORY:  return "VOST_ERR_NOT_A_DIRECTORY";
+        case VOST_ERR_PERMISSION:       return "VOST_ERR_PERMISSION";
+        case VOST_ERR_STALE_SNAPSHOT:   return "VOST_ERR_STALE_SNAPSHOT";
+        case VOST_ERR_KEY_NOT_FOUND:    return "VOST_ERR_KEY_NOT_FOUND";
+        case VOST_ERR_KEY_EXISTS:       return "VOST_ERR_KEY_EXISTS";
+        case VOST_ERR_INVALID_PATH:     return "VOST_ERR_INVALID_PATH";
+        case VOST_ERR_INVALID_HASH:     return "VOST_ERR_INVALID_HASH";
+        case VOST_ERR_INVALID_REF_NAME: return "VOST_ERR_INVALID_REF_NAME";
+        case VOST_ERR_BATCH_CLOSED:     return "VOST_ERR_BATCH_CLOSED";
+        case VOST_ERR_MERGE_CONFLICT:   return "VOST_ERR_MERGE_CONFLICT";
+        case VOST_ERR_GIT:              return "VOST_ERR_GIT";
+        case VOST_ERR_IO:               return "VOST_ERR_IO";
+        case VOST_ERR_INVALID_ARGUMENT: return "VOST_ERR_INVALID_ARGUMENT";
+        case VOST_ERR_OTHER:            return "VOST_ERR_OTHER";
+    }
+    return "VOST_ERR_UNKNOWN";
+}
+
+// ---------------------------------------------------------------------------
+// Buffers and string lists
+// ---------------------------------------------------------------------------
+
+const uint8_t* vost_buf_data(const vost_buf* buf) {
+    return buf ? buf->data : nullptr;
+}
+
+size_t vost_buf_size(const vost_buf* buf) {
+    return buf ? buf->size : 0;
+}
+
+vost_buf* vost_buf_retain(vost_buf* buf) {
+    if (buf) buf->refs.fetch_add(1, std::memory_order_relaxed);
+    return buf;
+}
+
+void vost_buf_release(vost_buf* buf) {
+    if (buf && buf->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete buf;
+}
+
+size_t vost_strlist_count(const vost_strlist* list) {
+    return list ? list->items.size() : 0;
+}
+
+const char* vost_strlist_get(const vost_strlist* list, size_t i) {
+    if (!list || i >= list->items.size()) return nullptr;
+    return list->items[i].c_str();
+}
+
+void vost_strlist_free(vost_strlist* list) {
+    delete list;
+}
+
+// ---------------------------------------------------------------------------
+// Store
+// ---------------------------------------------------------------------------
+
+void vost_open_options_init(vost_open_options* opts) {
+    if (!opts) return;
+    std::memset(opts, 0, sizeof(*opts));
+    opts->struct_size = sizeof(*opts);
+    opts->compression = -1;
+}
+
+vost_status vost_store_open(const char* path, const vost_open_options* opts,
+                            vost_store** out) {
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] {
+        vost::OpenOptions o;
+        if (opts) {
+            if (opts->struct_size < sizeof(vost_open_options))
+                throw std::invalid_argument("vost_open_options: struct_size too small");
+            o.create = opts->create != 0;
+            if (opts->branch) o.branch = opts->branch;
+            if (opts->author) o.author = opts->author;
+            if (opts->email) o.email = opts->email;
+            if (opts->compression >= 0) o.compression = opts->compression;
+            if (opts->fast_hash) o.hash = vost::HashBackend::Fast;
+        }
+        *out = new vost_store{vost::GitStore::open(path, o)};
+    });
+}
+
+void vost_store_free(vost_store* store) {
+    delete store;
+}
+
+vost_status vost_store_branch(vost_store* store, const char* name, vost_fs** out) {
+    VOST_REQUIRE(store);
+    VOST_REQUIRE(name);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = new vost_fs{store->store.branches().get(name)}; });
+}
+
+vost_status vost_store_fs(vost_store* store, const char* ref, vost_fs** out) {
+    VOST_REQUIRE(store);
+    VOST_REQUIRE(ref);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = new vost_fs{store->store.fs(ref)}; });
+}
+
+vost_status vost_store_branches(vost_store* store, vost_strlist** out) {
+    VOST_REQUIRE(store);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = new vost_strlist{store->store.branches().keys()}; });
+}
+
+vost_status vost_store_read_by_hash(vost_store* store, const char* hash, vost_buf** out) {
+    VOST_REQUIRE(store);
+    VOST_REQUIRE(hash);
+    VOST_REQUIRE(out);
+    return guarded([&] {
+        auto inner = store->store.inner();
+        vost::observe::Operation obs_op(*inner, "GitStore::read_by_hash");
+        std::string hex = vost::odb::canonical_hex(hash);
+        vost::tree::BlobRef blob = [&] {
+            std::lock_guard<std::mutex> lk(inner->mutex);
+            return vost::tree::load_blob_by_oid(inner->repo, hex);
+        }();
+        *out = make_buf(std::move(inner), std::move(blob));
+    });
+}
+
+vost_status vost_store_missing(vost_store* store, const char* const* hashes,
+                               size_t count, uint8_t* missing) {
+    VOST_REQUIRE(store);
+    if (count == 0) return VOST_OK;
+    VOST_REQUIRE(hashes);
+    VOST_REQUIRE(missing);
+    return guarded([&] {
+        std::vector<std::string> query;
+        query.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!hashes[i]) throw vost::InvalidHashError("(null)");
+            query.push_back(vost::odb::canonical_hex(hashes[i]));
+        }
+        auto absent = store->store.missing(query);
+        std::sort(absent.begin(), absent.end());
+        for (size_t i = 0; i < count; ++i)
+            missing[i] = std::binary_search(absent.begin(), absent.end(), query[i]) ? 1 : 0;
+    });
+}
+
+vost_status vost_store_pack(vost_store* store, size_t* out_count) {
+    VOST_REQUIRE(store);
+    return guarded([&] {
+        size_t n = store->store.pack();
+        if (out_count) *out_count = n;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Fs
+// ---------------------------------------------------------------------------
+
+void vost_fs_free(vost_fs* fs) {
+    delete fs;
+}
+
+vost_status vost_fs_commit_hash(const vost_fs* fs, char out[VOST_HASH_BUFSZ]) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(out);
+    return guarded([&] { copy_hash(fs->fs.commit_hash(), out); });
+}
+
+vost_status vost_fs_tree_hash(const vost_fs* fs, char out[VOST_HASH_BUFSZ]) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(out);
+    return guarded([&] { copy_hash(fs->fs.tree_hash(), out); });
+}
+
+vost_status vost_fs_read(const vost_fs* fs, const char* path, vost_buf** out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = read_buf(fs->fs, path, 0, 0); });
+}
+
+vost_status vost_fs_read_range(const vost_fs* fs, const char* path,
+                               uint64_t offset, uint64_t size, vost_buf** out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = read_buf(fs->fs, path, offset, size); });
+}
+
+vost_status vost_fs_exists(const vost_fs* fs, const char* path, int* out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = fs->fs.exists(path) ? 1 : 0; });
+}
+
+vost_status vost_fs_stat(const vost_fs* fs, const char* path, vost_stat* out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] {
+        auto st = fs->fs.stat(path);
+        out->mode = st.mode;
+        out->size = st.size;
+        out->mtime = st.mtime;
+        copy_hash(st.hash, out->hash);
+    });
+}
+
+vost_status vost_fs_ls(const vost_fs* fs, const char* path, vost_strlist** out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = new vost_strlist{fs->fs.ls(path)}; });
+}
+
+vost_status vost_fs_write(const vost_fs* fs, const char* path,
+                          const void* data, size_t size, uint32_t mode,
+                          const char* message, vost_fs** out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(data || size == 0);
+    VOST_REQUIRE(out);
+    return guarded([&] {
+        vost::WriteOptions opts;
+        if (mode) opts.mode = mode;
+        if (message) opts.message = message;
+        *out = new vost_fs{fs->fs.write(path, bytes(data, size), opts)};
+    });
+}
+
+vost_status vost_fs_remove(const vost_fs* fs, const char* path, int recursive,
+                           const char* message, vost_fs** out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(out);
+    return guarded([&] {
+        vost::RemoveOptions opts;
+        opts.recursive = recursive != 0;
+        if (message) opts.message = message;
+        *out = new vost_fs{fs->fs.remove({path}, opts)};
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Batch
+// ---------------------------------------------------------------------------
+
+vost_status vost_fs_batch(const vost_fs* fs, const char* message, vost_batch** out) {
+    VOST_REQUIRE(fs);
+    VOST_REQUIRE(out);
+    return guarded([&] {
+        vost::BatchOptions opts;
+        if (message) opts.message = message;
+        *out = new vost_batch{fs->fs.batch(opts)};
+    });
+}
+
+vost_status vost_batch_write(vost_batch* batch, const char* path,
+                             const void* data, size_t size, uint32_t mode) {
+    VOST_REQUIRE(batch);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(data || size == 0);
+    return guarded([&] {
+        batch->batch.write_with_mode(path, bytes(data, size), mode ? mode : vost::MODE_BLOB);
+    });
+}
+
+vost_status vost_batch_write_oid(vost_batch* batch, const char* path,
+                                 const char* hash, uint32_t mode) {
+    VOST_REQUIRE(batch);
+    VOST_REQUIRE(path);
+    VOST_REQUIRE(hash);
+    return guarded([&] {
+        batch->batch.write_oid(path, hash, mode ? mode : vost::MODE_BLOB);
+    });
+}
+
+vost_status vost_batch_remove(vost_batch* batch, const char* path) {
+    VOST_REQUIRE(batch);
+    VOST_REQUIRE(path);
+    return guarded([&] { batch->batch.remove(path); });
+}
+
+vost_status vost_batch_commit(vost_batch* batch, vost_fs** out) {
+    VOST_REQUIRE(batch);
+    VOST_REQUIRE(out);
+    return guarded([&] { *out = new vost_fs{batch->batch.commit()}; });
+}
+
+void vost_batch_free(vost_batch* batch) {
+    delete batch;
+}
+
+} // extern "C"
@@ -5,10 +5,22 @@
 #include <git2.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <map>
 #include <set>
 #include <sys/stat.h>
+#include <thread>
+
+#ifdef __unix__
+#  include <unistd.h>
+#endif
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <linux/fs.h>
+#  include <sys/ioctl.h>
+#endif
 
 namespace vost {
 
@@ -20,17 +32,23 @@ namespace copy {
 
 /// Walk a local directory recursively, returning sorted relative paths.
 std::vector<std::string>
-disk_walk(const std::filesystem::path& root) {
+disk_walk(const std::filesystem::path& root, const PathFilter* filter) {
     namespace fs = std::filesystem;
     std::vector<std::string> results;
     if (!fs::exists(root)) return results;
 
-    for (auto& entry : fs::recursive_directory_iterator(
+    for (auto it = fs::recursive_directory_iterator(
              root, fs::directory_options::follow_directory_symlink
-                 | fs::directory_options::skip_permission_denied)) {
-        auto status = fs::symlink_status(entry);
-        if (fs::is_directory(status)) continue;
-        auto rel = fs::relative(entry.path(), root).string();
+                 | fs::directory_options::skip_permission_denied);
+         it != fs::recursive_directory_iterator(); ++it) {
+        auto status = fs::symlink_status(*it);
+        if (fs::is_directory(status)) {
+            if (filter && filter->active() &&
+                !filter->may_contain(fs::relative(it->path(), root).string()))
+                it.disable_recursion_pending();
+            continue;
+        }
+        auto rel = fs::relative(it->path(), root).string();
         results.push_back(rel);
     }
     std::sort(results.begin(), results.end());
@@ -66,6 +84,103 @@ bool matches_filters(const std::string& path,
     return true;
 }
 
+// ---------------------------------------------------------------------------
+// PathFilter
+// ---------------------------------------------------------------------------
+//
+// A file passes when an include pattern (if any) matches its name or its
+// path and no exclude pattern does.  For a directory that means:
+//
+//   * an include pattern that can match a bare name may match anything
+//     below it; one with a `/` must be able to match a path starting with
+//     "dir/" (glob::may_match_under);
+//   * an exclude pattern that matches every path starting with "dir/"
+//     ("build/*", "tmp/**") rules the directory out.
+//
+// Walks start from the literal directory prefixes of the include
+// patterns, looked up directly, instead of from the source root.
+
+PathFilter::PathFilter(const std::optional<std::vector<std::string>>& include,
+                       const std::optional<std::vector<std::string>>& exclude)
+    : include_(include), exclude_(exclude) {
+    if (!include_) {
+        roots_.push_back("");
+        return;
+    }
+    std::vector<std::string> roots;
+    for (auto& pat : *include_) {
+        if (glob::can_match_basename(pat)) include_any_dir_ = true;
+        roots.push_back(glob::literal_dir(pat));
+    }
+    if (include_any_dir_) {
+        roots_.push_back("");
+        return;
+    }
+    // Sorted, a directory comes before everything below it
+    std::sort(roots.begin(), roots.end());
+    for (auto& r : roots) {
+        bool nested = std::any_of(roots_.begin(), roots_.end(),
+            [&](const std::string& kept) {
+                return kept.empty() || r == kept ||
+                       (r.size() > kept.size() && r[kept.size()] == '/' &&
+                        r.compare(0, kept.size(), kept) == 0);
+            });
+        if (!nested) roots_.push_back(r);
+    }
+}
+
+bool PathFilter::matches(const std::string& path) const {
+    return matches_filters(path, include_, exclude_);
+}
+
+bool PathFilter::may_contain(const std::string& dir) const {
+    std::string prefix = dir + "/";
+    if (exclude_) {
+        for (auto& pat : *exclude_) {
+            if (glob::matches_all_under(pat, prefix)) return false;
+        }
+    }
+    if (!include_ || include_any_dir_) return true;
+    for (auto& pat : *include_) {
+        if (glob::may_match_under(pat, prefix)) return true;
+    }
+    return false;
+}
+
+std::vector<std::pair<std::string, WalkEntry>>
+walk_filtered(git_repository* repo,
+              const std::string& tree_oid_hex,
+              const std::string& norm_path,
+              const PathFilter& filter) {
+    if (!filter.active()) return tree::walk_tree(repo, tree_oid_hex, norm_path);
+
+    if (!norm_path.empty()) {
+        auto entry = tree::lookup(repo, tree_oid_hex, norm_path);
+        if (!entry) throw NotFoundError(norm_path);
+        if (entry->second != MODE_TREE) throw NotADirectoryError(norm_path);
+    }
+
+    std::vector<std::pair<std::string, WalkEntry>> results;
+    for (auto& root : filter.roots()) {
+        std::string at = norm_path;
+        if (!root.empty()) {
+            if (!filter.may_contain(root)) continue;
+            at = norm_path.empty() ? root : norm_path + "/" + root;
+            auto entry = tree::lookup(repo, tree_oid_hex, at);
+            if (!entry || entry->second != MODE_TREE) continue;
+        }
+        std::string base = root.empty() ? "" : root + "/";
+        tree::WalkPrune prune{
+            [&](const std::string& dir) { return filter.may_contain(base + dir); },
+            [&](const std::string& path) { return filter.matches(base + path); },
+        };
+        auto part = tree::walk_tree(repo, tree_oid_hex, at, &prune);
+        results.insert(results.end(), std::make_move_iterator(part.begin()),
+                       std::make_move_iterator(part.end()));
+    }
+    return results;
+}
+
 /// Detect git mode from a local file's metadata.
 uint32_t mode_from_disk(const std::filesystem::path& p) {
     namespace fs = std::filesystem;
@@ -85,6 +200,278 @@ uint32_t mode_from_disk(const std::filesystem::path& p) {
     return MODE_BLOB;
 }
 
+void read_sizes(GitStoreInner& inner,
+                std::map<std::string, Stored>& existing,
+                const std::vector<std::string>& disk_files) {
+    std::lock_guard<std::mutex> lk(inner.mutex);
+    for (auto& rel : disk_files) {
+        auto it = existing.find(rel);
+        if (it == existing.end()) continue;
+        auto& st = it->second;
+        if (st.mode != MODE_BLOB && st.mode != MODE_BLOB_EXEC && st.mode != MODE_LINK)
+            continue;
+        git_oid oid;
+        if (git_oid_fromstr(&oid, st.oid.c_str()) != 0) continue;
+        st.size = tree::blob_size(inner.repo, oid);
+    }
+}
+
+bool unchanged(const std::filesystem::path& p, uint32_t mode,
+               const Stored& stored, HashBackend hash) {
+    namespace fs = std::filesystem;
+    if (mode != stored.mode) return false;
+
+    git_oid oid;
+    try {
+        if (mode == MODE_LINK) {
+            auto target = fs::read_symlink(p).string();
+            if (stored.size && *stored.size != target.size()) return false;
+            odb::hash_blob(hash, reinterpret_cast<const uint8_t*>(target.data()),
+                           target.size(), &oid);
+        } else {
+            std::error_code ec;
+            auto sz = fs::file_size(p, ec);
+            if (ec) return false;
+            if (stored.size && *stored.size != sz) return false;
+            odb::hash_file(hash, p, &oid);
+        }
+    } catch (const VostError&) {
+        return false;
+    }
+    char buf[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(buf, sizeof(buf), &oid);
+    return stored.oid == buf;
+}
+
+bool excluded(const ExcludeFilter& filter, const std::string& rel) {
+    if (!filter.active()) return false;
+    for (auto slash = rel.find('/'); slash != std::string::npos;
+         slash = rel.find('/', slash + 1)) {
+        if (filter.is_excluded(rel.substr(0, slash), true)) return true;
+    }
+    return filter.is_excluded(rel, false);
+}
+
+void replace_file(const std::filesystem::path& path,
+                  const std::vector<uint8_t>& data, uint32_t mode) {
+    namespace fs = std::filesystem;
+    fs::create_directories(path.parent_path());
+    if (fs::is_directory(fs::symlink_status(path))) fs::remove_all(path);
+
+    fs::path tmp = path.parent_path() / ("." + path.filename().string() + ".vost-tmp");
+    if (fs::exists(fs::symlink_status(tmp))) fs::remove(tmp);
+    if (mode == MODE_LINK) {
+        fs::create_symlink(std::string(data.begin(), data.end()), tmp);
+    } else {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(data.data()),
+                  static_cast<std::streamsize>(data.size()));
+        ofs.close();
+        if (!ofs) {
+            fs::remove(tmp);
+            throw IoError("cannot write " + path.string());
+        }
+#if defined(__APPLE__) || defined(__unix__)
+        if (mode == MODE_BLOB_EXEC)
+            fs::permissions(tmp, fs::perms::owner_exec | fs::perms::group_exec,
+                            fs::perm_options::add);
+#endif
+    }
+    fs::rename(tmp, path);
+}
+
+// ---------------------------------------------------------------------------
+// Blob cache
+// ---------------------------------------------------------------------------
+//
+// The cache is a directory of blobs keyed by OID (`ab/cdef...`, with an
+// `.x` suffix for executables since permission bits belong to the inode).
+// Entries are written once, through a temp file and rename so concurrent
+// checkouts never see a partial one; temp names carry the pid and a
+// counter, since several processes may share one cache.  Entries are
+// read-only: a hard-linked checkout shares the inode, so an in-place
+// write would change the cache and every other checkout.  Replacing the
+// file (as editors that save via rename do) is fine.
+
+namespace {
+
+/// A temp path next to `target` that no other thread or process will
+/// pick: ".name.vost-tmp-<pid>-<n>".
+std::filesystem::path unique_tmp(const std::filesystem::path& target) {
+    static std::atomic<uint64_t> counter{0};
+    std::string name = "." + target.filename().string() + ".vost-tmp-";
+#ifdef __unix__
+    name += std::to_string(::getpid()) + "-";
+#endif
+    name += std::to_string(counter++);
+    return target.parent_path() / name;
+}
+
+#ifdef __linux__
+/// Create `to` as a reflink of `from`.  False if the filesystem cannot.
+bool reflink(const std::filesystem::path& from, const std::filesystem::path& to,
+             bool exec) {
+    int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+    int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                     exec ? 0777 : 0666);
+    if (out < 0) { ::close(in); return false; }
+    bool ok = ::ioctl(out, FICLONE, in) == 0;
+    ::close(in);
+    ::close(out);
+    if (!ok) ::unlink(to.c_str());
+    return ok;
+}
+#endif
+
+} // anonymous namespace
+
+std::filesystem::path cache_blob(GitStoreInner& inner,
+                                 const std::filesystem::path& cache,
+                                 const std::string& oid_hex, uint32_t mode) {
+    namespace fs = std::filesystem;
+    bool exec = mode == MODE_BLOB_EXEC;
+    fs::path dir = cache / oid_hex.substr(0, 2);
+    fs::path cached = dir / (oid_hex.substr(2) + (exec ? ".x" : ""));
+    if (fs::exists(cached)) return cached;
+
+    fs::create_directories(dir);
+    fs::path tmp = unique_tmp(cached);
+    {
+        std::lock_guard<std::mutex> lk(inner.mutex);
+        auto blob = tree::load_blob_by_oid(inner.repo, oid_hex);
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(blob.data()),
+                  static_cast<std::streamsize>(blob.size()));
+        ofs.close();
+        if (!ofs) {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            throw IoError("cannot write blob cache entry " + cached.string());
+        }
+    }
+    auto perms = fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read;
+    if (exec)
+        perms |= fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec;
+    std::error_code ec;
+    fs::permissions(tmp, perms, ec);
+    if (!ec) fs::rename(tmp, cached, ec);
+    // Another writer may have stored the same blob meanwhile.
+    if (ec && !fs::exists(cached)) throw IoError("cannot store blob cache entry " + cached.string());
+    return cached;
+}
+
+void link_from_cache(const std::filesystem::path& cached,
+                     const std::filesystem::path& path, CacheLink link) {
+    namespace fs = std::filesystem;
+    fs::create_directories(path.parent_path());
+    if (fs::is_directory(fs::symlink_status(path))) fs::remove_all(path);
+
+    fs::path tmp = unique_tmp(path);
+
+    bool placed = false;
+#ifdef __linux__
+    if (link != CacheLink::Hardlink)
+        placed = reflink(cached, tmp, cached.extension() == ".x");
+#endif
+    std::error_code ec;
+    if (!placed && link != CacheLink::Reflink) {
+        fs::create_hard_link(cached, tmp, ec);
+        placed = !ec;
+    }
+    if (!placed) {
+        fs::copy_file(cached, tmp);
+        fs::permissions(tmp, fs::perms::owner_write, fs::perm_options::add);
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp);
+        throw IoError("cannot place " + path.string() + ": " + ec.message());
+    }
+}
+
+void unshare(const std::filesystem::path& path) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    auto status = fs::symlink_status(path, ec);
+    if (ec || !fs::is_regular_file(status)) return;
+    if (fs::hard_link_count(path, ec) > 1 && !ec) fs::remove(path);
+}
+
+void prune_empty_dirs(const std::filesystem::path& root,
+                      std::filesystem::path dir) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    while (dir != root && dir.native().size() > root.native().size() &&
+           fs::is_empty(dir, ec) && !ec) {
+        if (!fs::remove(dir, ec)) break;
+        dir = dir.parent_path();
+    }
+}
+
+/// Collects changes into a ChangeReport according to a ReportMode.
+///
+/// With `deferred`, Stream mode holds the changes until flush(), so callers
+/// that commit (copy_in, sync_in) report only changes that landed.
+class Reporter {
+public:
+    Reporter(ReportMode mode, const ChangeCallback& on_change, bool deferred = false)
+        : mode_(mode), on_change_(on_change), deferred_(deferred) {}
+
+    /// Record one change.  The FileEntry is only built when the mode
+    /// needs it, so Counts mode costs no allocation per file.
+    void record(ChangeActionKind kind, const std::string& path,
+                uint32_t mode, const std::filesystem::path* src = nullptr) {
+        if (mode_ == ReportMode::Counts) {
+            ++slot(kind);
+            return;
+        }
+        FileEntry fe;
+        fe.path = path;
+        fe.file_type = *file_type_from_mode(mode);
+        if (src) fe.src = *src;
+        if (mode_ == ReportMode::Stream) {
+            if (deferred_) {
+                pending_.emplace_back(kind, std::move(fe));
+            } else if (on_change_) {
+                on_change_(kind, fe);
+            }
+            ++slot(kind);
+            return;
+        }
+        switch (kind) {
+            case ChangeActionKind::Add:    report_.add.push_back(std::move(fe)); break;
+            case ChangeActionKind::Update: report_.update.push_back(std::move(fe)); break;
+            case ChangeActionKind::Delete: report_.del.push_back(std::move(fe)); break;
+        }
+    }
+
+    ChangeReport& report() { return report_; }
+
+    /// Pass the held changes to on_change, in the order recorded.
+    void flush() {
+        auto pending = std::move(pending_);
+        pending_.clear();
+        if (!on_change_) return;
+        for (const auto& [kind, fe] : pending) on_change_(kind, fe);
+    }
+
+private:
+    size_t& slot(ChangeActionKind kind) {
+        switch (kind) {
+            case ChangeActionKind::Add:    return report_.omitted.add;
+            case ChangeActionKind::Update: return report_.omitted.update;
+            default:                       return report_.omitted.del;
+        }
+    }
+
+    ReportMode            mode_;
+    const ChangeCallback& on_change_;
+    bool                  deferred_;
+    ChangeReport          report_;
+    std::vector<std::pair<ChangeActionKind, FileEntry>> pending_;
+};
+
 } // namespace copy
 
 // ---------------------------------------------------------------------------
@@ -95,6 +482,7 @@ std::pair<ChangeReport, Fs>
 Fs::copy_in(const std::filesystem::path& src,
             const std::string& dest,
             CopyInOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::copy_in");
     require_writable("copy_in");
     const auto& tree_hex = require_tree();
     namespace fs = std::filesystem;
@@ -105,7 +493,7 @@ Fs::copy_in(const std::filesystem::path& src,
     auto disk_files = copy::disk_walk(src);
 
     // Build existing entries map (for checksum comparison)
-    std::map<std::string, std::pair<std::string, uint32_t>> existing;
+    std::map<std::string, copy::Stored> existing;
     if (opts.checksum) {
         std::lock_guard<std::mutex> lk(inner_->mutex);
         // Find the subtree at dest
@@ -119,7 +507,7 @@ Fs::copy_in(const std::filesystem::path& src,
             }
         }
         if (!sub_tree.empty()) {
-            auto walked = tree::walk_tree(inner_->repo, sub_tree,
+            auto walked = tree::walk_tree(inner_->repo, tree_hex,
                                           dest_norm.empty() ? "" : dest_norm);
             for (auto& [rel_path, we] : walked) {
                 // Strip dest prefix
@@ -127,13 +515,14 @@ Fs::copy_in(const std::filesystem::path& src,
                 if (!dest_norm.empty() && rel_path.size() > dest_norm.size() + 1) {
                     key = rel_path.substr(dest_norm.size() + 1);
                 }
-                existing[key] = {we.oid, we.mode};
+                existing[key] = {we.oid, we.mode, std::nullopt};
             }
         }
     }
+    if (opts.checksum) copy::read_sizes(*inner_, existing, disk_files);
 
     // Build writes and report
-    ChangeReport report;
+    copy::Reporter report(opts.report, opts.on_change, true);
     std::vector<std::pair<std::string, std::pair<std::vector<uint8_t>, uint32_t>>> writes;
 
     for (auto& rel : disk_files) {
@@ -142,6 +531,13 @@ Fs::copy_in(const std::filesystem::path& src,
         fs::path full = src / rel;
         uint32_t mode = copy::mode_from_disk(full);
 
+        // Checksum: size first, then hash only same-size files
+        if (opts.checksum) {
+            auto it = existing.find(rel);
+            if (it != existing.end() && copy::unchanged(full, mode, it->second, inner_->hash))
+                continue;
+        }
+
         // Read data
         std::vector<uint8_t> data;
         if (mode == MODE_LINK) {
@@ -153,44 +549,22 @@ Fs::copy_in(const std::filesystem::path& src,
                         std::istreambuf_iterator<char>());
         }
 
-        // Checksum: compare blob hash and mode
-        if (opts.checksum) {
-            auto it = existing.find(rel);
-            if (it != existing.end()) {
-                // Compute blob hash
-                std::lock_guard<std::mutex> lk(inner_->mutex);
-                git_oid blob_oid;
-                if (git_blob_create_from_buffer(&blob_oid, inner_->repo,
-                                                data.data(), data.size()) == 0) {
-                    char buf[41];
-                    git_oid_tostr(buf, sizeof(buf), &blob_oid);
-                    std::string blob_hex(buf, 40);
-                    if (blob_hex == it->second.first && mode == it->second.second) {
-                        continue; // unchanged
-                    }
-                }
-            }
-        }
-
         // Build store path
         std::string store_path = dest_norm.empty()
             ? rel : dest_norm + "/" + rel;
 
         writes.push_back({store_path, {std::move(data), mode}});
-
-        FileEntry fe;
-        fe.path = store_path;
-        fe.file_type = *file_type_from_mode(mode);
-        fe.src = full;
-        report.add.push_back(std::move(fe));
+        report.record(ChangeActionKind::Add, store_path, mode, &full);
     }
 
     if (opts.dry_run || writes.empty()) {
-        return {std::move(report), *this};
+        report.flush();
+        return {std::move(report.report()), *this};
     }
 
     std::string msg = paths::format_message("copy_in", opts.message);
-    auto new_fs = commit_changes(writes, {}, msg, std::move(report), opts.parents);
+    auto new_fs = commit_changes(writes, {}, msg, std::move(report.report()), opts.parents);
+    report.flush();
     return {new_fs.changes().value_or(ChangeReport{}), new_fs};
 }
 
@@ -202,20 +576,21 @@ ChangeReport
 Fs::copy_out(const std::string& src_path,
              const std::filesystem::path& dest,
              CopyOutOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::copy_out");
     const auto& tree_hex = require_tree();
     namespace fs = std::filesystem;
 
     std::string src_norm = src_path.empty() ? "" : paths::normalize(src_path);
 
-    // Walk repo tree at src
+    // Walk repo tree at src, skipping what the filters rule out
+    copy::PathFilter filter(opts.include, opts.exclude);
     std::vector<std::pair<std::string, WalkEntry>> entries;
     {
         std::lock_guard<std::mutex> lk(inner_->mutex);
-        entries = tree::walk_tree(inner_->repo, tree_hex,
-                                  src_norm.empty() ? "" : src_norm);
+        entries = copy::walk_filtered(inner_->repo, tree_hex, src_norm, filter);
     }
 
-    ChangeReport report;
+    copy::Reporter report(opts.report, opts.on_change);
 
     for (auto& [rel_path, we] : entries) {
         // Strip src prefix to get relative path
@@ -224,9 +599,13 @@ Fs::copy_out(const std::string& src_path,
             rel = rel.substr(src_norm.size() + 1);
         }
 
-        if (!copy::matches_filters(rel, opts.include, opts.exclude)) continue;
-
         fs::path dest_path = dest / rel;
+        if (!opts.blob_cache.empty() && we.mode != MODE_LINK) {
+            auto cached = copy::cache_blob(*inner_, opts.blob_cache, we.oid, we.mode);
+            copy::link_from_cache(cached, dest_path, opts.link);
+            report.record(ChangeActionKind::Add, rel, we.mode);
+            continue;
+        }
         fs::create_directories(dest_path.parent_path());
 
         // Read blob data
@@ -253,6 +632,7 @@ Fs::copy_out(const std::string& src_path,
 #endif
         } else {
             // Regular file
+            copy::unshare(dest_path);
             std::ofstream ofs(dest_path, std::ios::binary);
             ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
         }
@@ -265,13 +645,10 @@ Fs::copy_out(const std::string& src_path,
 #endif
         }
 
-        FileEntry fe;
-        fe.path = rel;
-        fe.file_type = *file_type_from_mode(we.mode);
-        report.add.push_back(std::move(fe));
+        report.record(ChangeActionKind::Add, rel, we.mode);
     }
 
-    return report;
+    return std::move(report.report());
 }
 
 // ---------------------------------------------------------------------------
@@ -282,53 +659,95 @@ std::pair<ChangeReport, Fs>
 Fs::sync_in(const std::filesystem::path& src,
             const std::string& dest,
             SyncOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::sync_in");
+    return sync_in_scoped(src, dest, opts, nullptr, nullptr);
+}
+
+std::pair<ChangeReport, Fs>
+Fs::sync_in_scoped(const std::filesystem::path& src,
+                   const std::string& dest,
+                   const SyncOptions& opts,
+                   const ExcludeFilter* filter,
+                   const std::vector<std::string>* scope) const {
     require_writable("sync_in");
     const auto& tree_hex = require_tree();
     namespace fs = std::filesystem;
 
     std::string dest_norm = dest.empty() ? "" : paths::normalize(dest);
+    auto store_path_of = [&](const std::string& rel) {
+        return dest_norm.empty() ? rel : dest_norm + "/" + rel;
+    };
+    auto keep = [&](const std::string& rel) {
+        if (!copy::matches_filters(rel, opts.include, opts.exclude)) return false;
+        return !(filter && copy::excluded(*filter, rel));
+    };
 
-    // Walk disk
-    auto disk_files = copy::disk_walk(src);
+    // Walk disk: everything under src, or only the scoped paths
+    std::vector<std::string> disk_files;
+    if (!scope) {
+        disk_files = copy::disk_walk(src);
+    } else {
+        for (auto& rel : *scope) {
+            auto status = fs::symlink_status(src / rel);
+            if (fs::is_directory(status)) {
+                for (auto& sub : copy::disk_walk(src / rel))
+                    disk_files.push_back(rel + "/" + sub);
+            } else if (fs::exists(status)) {
+                disk_files.push_back(rel);
+            }
+        }
+        std::sort(disk_files.begin(), disk_files.end());
+    }
 
-    // Walk existing repo entries at dest
-    std::map<std::string, std::pair<std::string, uint32_t>> existing;
+    // Walk existing repo entries at dest (or at each scoped path)
+    std::map<std::string, copy::Stored> existing;
     {
         std::lock_guard<std::mutex> lk(inner_->mutex);
-        std::string sub_tree = tree_hex;
-        if (!dest_norm.empty()) {
-            auto entry = tree::lookup(inner_->repo, tree_hex, dest_norm);
-            if (entry && entry->second == MODE_TREE) {
-                sub_tree = entry->first;
-            } else {
-                sub_tree.clear();
+        auto collect = [&](const std::string& rel) {
+            std::string at = rel.empty() ? dest_norm : store_path_of(rel);
+            if (!at.empty()) {
+                auto entry = tree::lookup(inner_->repo, tree_hex, at);
+                if (!entry) return;
+                if (entry->second != MODE_TREE) {
+                    if (!rel.empty())
+                        existing[rel] = {entry->first, entry->second, std::nullopt};
+                    return;
+                }
             }
-        }
-        if (!sub_tree.empty()) {
-            auto walked = tree::walk_tree(inner_->repo, sub_tree,
-                                          dest_norm.empty() ? "" : dest_norm);
-            for (auto& [rel_path, we] : walked) {
+            for (auto& [rel_path, we] : tree::walk_tree(inner_->repo, tree_hex, at)) {
                 std::string key = rel_path;
                 if (!dest_norm.empty() && rel_path.size() > dest_norm.size() + 1) {
                     key = rel_path.substr(dest_norm.size() + 1);
                 }
-                existing[key] = {we.oid, we.mode};
+                existing[key] = {we.oid, we.mode, std::nullopt};
             }
+        };
+        if (!scope) {
+            collect("");
+        } else {
+            for (auto& rel : *scope) collect(rel);
         }
     }
+    if (opts.checksum) copy::read_sizes(*inner_, existing, disk_files);
 
     // Build writes, removes, and report
-    ChangeReport report;
+    copy::Reporter report(opts.report, opts.on_change, true);
     std::vector<std::pair<std::string, std::pair<std::vector<uint8_t>, uint32_t>>> writes;
     std::set<std::string> disk_set; // track what's on disk
 
     for (auto& rel : disk_files) {
-        if (!copy::matches_filters(rel, opts.include, opts.exclude)) continue;
+        if (!keep(rel)) continue;
         disk_set.insert(rel);
 
         fs::path full = src / rel;
         uint32_t mode = copy::mode_from_disk(full);
 
+        // Checksum: size first, then hash only same-size files
+        auto it = existing.find(rel);
+        bool is_update = it != existing.end();
+        if (is_update && opts.checksum && copy::unchanged(full, mode, it->second, inner_->hash))
+            continue;
+
         std::vector<uint8_t> data;
         if (mode == MODE_LINK) {
             auto target = fs::read_symlink(full).string();
@@ -339,68 +758,34 @@ Fs::sync_in(const std::filesystem::path& src,
                         std::istreambuf_iterator<char>());
         }
 
-        // Checksum comparison
-        bool is_update = false;
-        if (opts.checksum) {
-            auto it = existing.find(rel);
-            if (it != existing.end()) {
-                std::lock_guard<std::mutex> lk(inner_->mutex);
-                git_oid blob_oid;
-                if (git_blob_create_from_buffer(&blob_oid, inner_->repo,
-                                                data.data(), data.size()) == 0) {
-                    char buf[41];
-                    git_oid_tostr(buf, sizeof(buf), &blob_oid);
-                    std::string blob_hex(buf, 40);
-                    if (blob_hex == it->second.first && mode == it->second.second) {
-                        continue; // unchanged
-                    }
-                }
-                is_update = true;
-            }
-        } else {
-            is_update = existing.count(rel) > 0;
-        }
-
-        std::string store_path = dest_norm.empty()
-            ? rel : dest_norm + "/" + rel;
+        std::string store_path = store_path_of(rel);
 
         writes.push_back({store_path, {std::move(data), mode}});
-
-        FileEntry fe;
-        fe.path = store_path;
-        fe.file_type = *file_type_from_mode(mode);
-        fe.src = full;
-        if (is_update) {
-            report.update.push_back(std::move(fe));
-        } else {
-            report.add.push_back(std::move(fe));
-        }
+        report.record(is_update ? ChangeActionKind::Update : ChangeActionKind::Add,
+                      store_path, mode, &full);
     }
 
     // Determine deletes: repo files not on disk
     std::vector<std::string> removes;
-    for (auto& [rel, oid_mode] : existing) {
+    for (auto& [rel, stored] : existing) {
         if (disk_set.count(rel) == 0) {
             // Check if it matches filters (only delete filtered-in files)
-            if (!copy::matches_filters(rel, opts.include, opts.exclude)) continue;
-
-            std::string store_path = dest_norm.empty()
-                ? rel : dest_norm + "/" + rel;
-            removes.push_back(store_path);
+            if (!keep(rel)) continue;
 
-            FileEntry fe;
-            fe.path = store_path;
-            fe.file_type = *file_type_from_mode(oid_mode.second);
-            report.del.push_back(std::move(fe));
+            std::string store_path = store_path_of(rel);
+            report.record(ChangeActionKind::Delete, store_path, stored.mode);
+            removes.push_back(std::move(store_path));
         }
     }
 
     if (opts.dry_run || (writes.empty() && removes.empty())) {
-        return {std::move(report), *this};
+        report.flush();
+        return {std::move(report.report()), *this};
     }
 
     std::string msg = paths::format_message("sync_in", opts.message);
-    auto new_fs = commit_changes(writes, removes, msg, std::move(report), opts.parents);
+    auto new_fs = commit_changes(writes, removes, msg, std::move(report.report()), opts.parents);
+    report.flush();
     return {new_fs.changes().value_or(ChangeReport{}), new_fs};
 }
 
@@ -412,23 +797,24 @@ ChangeReport
 Fs::sync_out(const std::string& src_path,
              const std::filesystem::path& dest,
              SyncOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::sync_out");
     const auto& tree_hex = require_tree();
     namespace fs = std::filesystem;
 
     std::string src_norm = src_path.empty() ? "" : paths::normalize(src_path);
 
-    // Walk repo tree at src
+    // Walk repo tree at src, skipping what the filters rule out
+    copy::PathFilter filter(opts.include, opts.exclude);
     std::vector<std::pair<std::string, WalkEntry>> entries;
     {
         std::lock_guard<std::mutex> lk(inner_->mutex);
-        entries = tree::walk_tree(inner_->repo, tree_hex,
-                                  src_norm.empty() ? "" : src_norm);
+        entries = copy::walk_filtered(inner_->repo, tree_hex, src_norm, filter);
     }
 
     // Walk local disk at dest
     std::set<std::string> repo_rels;
 
-    ChangeReport report;
+    copy::Reporter report(opts.report, opts.on_change);
 
     // Copy repo → disk (add/update)
     for (auto& [rel_path, we] : entries) {
@@ -437,10 +823,15 @@ Fs::sync_out(const std::string& src_path,
             rel = rel.substr(src_norm.size() + 1);
         }
 
-        if (!copy::matches_filters(rel, opts.include, opts.exclude)) continue;
         repo_rels.insert(rel);
 
         fs::path dest_path = dest / rel;
+        if (!opts.blob_cache.empty() && we.mode != MODE_LINK) {
+            auto cached = copy::cache_blob(*inner_, opts.blob_cache, we.oid, we.mode);
+            copy::link_from_cache(cached, dest_path, opts.link);
+            report.record(ChangeActionKind::Add, rel, we.mode);
+            continue;
+        }
         fs::create_directories(dest_path.parent_path());
 
         std::vector<uint8_t> data;
@@ -456,6 +847,7 @@ Fs::sync_out(const std::string& src_path,
             }
             fs::create_symlink(target, dest_path);
         } else {
+            copy::unshare(dest_path);
             std::ofstream ofs(dest_path, std::ios::binary);
             ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
         }
@@ -467,24 +859,17 @@ Fs::sync_out(const std::string& src_path,
 #endif
         }
 
-        FileEntry fe;
-        fe.path = rel;
-        fe.file_type = *file_type_from_mode(we.mode);
-        report.add.push_back(std::move(fe));
+        report.record(ChangeActionKind::Add, rel, we.mode);
     }
 
     // Delete extra local files not in repo
-    auto local_files = copy::disk_walk(dest);
+    auto local_files = copy::disk_walk(dest, &filter);
     for (auto& local_rel : local_files) {
-        if (!copy::matches_filters(local_rel, opts.include, opts.exclude)) continue;
+        if (!filter.matches(local_rel)) continue;
         if (repo_rels.count(local_rel) == 0) {
             fs::path to_remove = dest / local_rel;
             fs::remove(to_remove);
-
-            FileEntry fe;
-            fe.path = local_rel;
-            fe.file_type = FileType::Blob; // best guess
-            report.del.push_back(std::move(fe));
+            report.record(ChangeActionKind::Delete, local_rel, MODE_BLOB); // best guess
         }
     }
 
@@ -505,7 +890,77 @@ Fs::sync_out(const std::string& src_path,
         }
     }
 
-    return report;
+    return std::move(report.report());
+}
+
+// ---------------------------------------------------------------------------
+// Fs::sync_out_diff
+// ---------------------------------------------------------------------------
+
+ChangeReport
+Fs::sync_out_diff(const std::string& from_tree,
+                  const std::string& src_path,
+                  const std::filesystem::path& dest,
+                  SyncOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::sync_out_diff");
+    const auto& tree_hex = require_tree();
+    namespace fs = std::filesystem;
+
+    if (!from_tree.empty()) {
+        git_oid probe;
+        if (from_tree.size() != GIT_OID_HEXSZ ||
+            git_oid_fromstr(&probe, from_tree.c_str()) != 0)
+            throw InvalidHashError(from_tree);
+    }
+    std::string src_norm = src_path.empty() ? "" : paths::normalize(src_path);
+
+    // Leaf changes between the subtrees at src ("" where there is none)
+    std::vector<tree::TreeChange> changes;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        auto subtree = [&](const std::string& root) -> std::string {
+            if (root.empty() || src_norm.empty()) return root;
+            auto entry = tree::lookup(inner_->repo, root, src_norm);
+            return entry && entry->second == MODE_TREE ? entry->first : "";
+        };
+        changes = tree::diff_trees(inner_->repo, subtree(from_tree), subtree(tree_hex));
+    }
+
+    copy::Reporter report(opts.report, opts.on_change);
+    for (auto& change : changes) {
+        if (!copy::matches_filters(change.path, opts.include, opts.exclude)) continue;
+        fs::path target = dest / change.path;
+
+        if (!change.new_entry) {
+            if (change.old_entry->mode == GIT_FILEMODE_COMMIT) continue;
+            if (!opts.dry_run) {
+                std::error_code ec;
+                fs::remove(target, ec);
+                copy::prune_empty_dirs(dest, target.parent_path());
+            }
+            report.record(ChangeActionKind::Delete, change.path, change.old_entry->mode);
+            continue;
+        }
+        uint32_t mode = change.new_entry->mode;
+        if (mode == GIT_FILEMODE_COMMIT) continue; // submodule: nothing to check out
+
+        if (!opts.dry_run && !opts.blob_cache.empty() && mode != MODE_LINK) {
+            auto cached = copy::cache_blob(*inner_, opts.blob_cache,
+                                           change.new_entry->oid, mode);
+            copy::link_from_cache(cached, target, opts.link);
+        } else if (!opts.dry_run) {
+            std::vector<uint8_t> data;
+            {
+                std::lock_guard<std::mutex> lk(inner_->mutex);
+                auto blob = tree::load_blob_by_oid(inner_->repo, change.new_entry->oid);
+                data.assign(blob.data(), blob.data() + blob.size());
+            }
+            copy::replace_file(target, data, mode);
+        }
+        report.record(change.old_entry ? ChangeActionKind::Update : ChangeActionKind::Add,
+                      change.path, mode);
+    }
+    return std::move(report.report());
 }
 
 // ---------------------------------------------------------------------------
@@ -516,6 +971,7 @@ Fs Fs::copy_from_ref(const Fs& source,
                       const std::vector<std::string>& sources,
                       const std::string& dest,
                       CopyFromRefOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::copy_from_ref");
     require_writable("copy_from_ref");
 
     // Source must have a tree
@@ -524,10 +980,14 @@ Fs Fs::copy_from_ref(const Fs& source,
     }
 
     std::string dest_norm = dest.empty() ? "" : paths::normalize(dest);
+    copy::PathFilter filter(opts.include, opts.exclude);
 
     // Collect writes from source
     std::vector<std::pair<std::string, std::pair<std::vector<uint8_t>, uint32_t>>> writes;
     std::set<std::string> source_dest_paths;
+    // Where each directory source lands in dest.  delete_extra only looks
+    // under these, with the filter relative to each, as on the source side.
+    std::set<std::string> dest_roots;
 
     {
         std::lock_guard<std::mutex> lk(inner_->mutex);
@@ -541,13 +1001,15 @@ Fs Fs::copy_from_ref(const Fs& source,
             // Walk source tree at src_norm
             std::vector<std::pair<std::string, WalkEntry>> src_entries;
             if (src_norm.empty()) {
-                src_entries = tree::walk_tree(inner_->repo, source.tree_oid_hex(), "");
+                src_entries = copy::walk_filtered(inner_->repo, source.tree_oid_hex(),
+                                                  "", filter);
             } else {
                 auto entry = tree::lookup(inner_->repo, source.tree_oid_hex(), src_norm);
                 if (!entry) throw NotFoundError(src_norm);
 
                 if (entry->second == MODE_TREE) {
-                    src_entries = tree::walk_tree(inner_->repo, source.tree_oid_hex(), src_norm);
+                    src_entries = copy::walk_filtered(inner_->repo, source.tree_oid_hex(),
+                                                      src_norm, filter);
                 } else {
                     // Single file
                     auto data = tree::read_blob(inner_->repo, source.tree_oid_hex(), src_norm);
@@ -574,6 +1036,15 @@ Fs Fs::copy_from_ref(const Fs& source,
                 }
             }
 
+            std::string target_root = dest_norm;
+            if (!contents_mode && !src_norm.empty()) {
+                auto slash = src_norm.rfind('/');
+                std::string dir_name = (slash != std::string::npos)
+                    ? src_norm.substr(slash + 1) : src_norm;
+                target_root = dest_norm.empty() ? dir_name : dest_norm + "/" + dir_name;
+            }
+            dest_roots.insert(target_root);
+
             // Map source entries to dest paths
             for (auto& [rel_path, we] : src_entries) {
                 std::string rel;
@@ -587,46 +1058,36 @@ Fs Fs::copy_from_ref(const Fs& source,
                     }
                 }
 
-                std::string target;
-                if (contents_mode || src_norm.empty()) {
-                    // Contents mode: copy contents directly into dest
-                    target = dest_norm.empty() ? rel : dest_norm + "/" + rel;
-                } else {
-                    // Directory mode: copy the directory itself into dest
-                    auto slash = src_norm.rfind('/');
-                    std::string dir_name = (slash != std::string::npos)
-                        ? src_norm.substr(slash + 1) : src_norm;
-                    target = dest_norm.empty()
-                        ? dir_name + "/" + rel
-                        : dest_norm + "/" + dir_name + "/" + rel;
-                }
+                // Contents mode pours the directory's contents into dest;
+                // directory mode copies the directory itself into dest.
+                std::string target = target_root.empty() ? rel : target_root + "/" + rel;
 
-                auto data = tree::read_blob(inner_->repo, source.tree_oid_hex(), rel_path);
-                writes.push_back({target, {std::move(data), we.mode}});
+                auto blob = tree::load_blob_by_oid(inner_->repo, we.oid);
+                writes.push_back({target, {std::vector<uint8_t>(blob.data(),
+                                                                blob.data() + blob.size()),
+                                           we.mode}});
                 source_dest_paths.insert(target);
             }
         }
     }
 
-    // If delete_extra, find files at dest that are not in source
+    // If delete_extra, find files under each source's target that are not
+    // in source
     std::vector<std::string> removes;
     if (opts.delete_extra && !tree_oid_hex_.empty()) {
         std::lock_guard<std::mutex> lk(inner_->mutex);
-        std::vector<std::pair<std::string, WalkEntry>> dest_entries;
-        if (dest_norm.empty()) {
-            dest_entries = tree::walk_tree(inner_->repo, tree_oid_hex_, "");
-        } else {
-            auto entry = tree::lookup(inner_->repo, tree_oid_hex_, dest_norm);
-            if (entry && entry->second == MODE_TREE) {
-                dest_entries = tree::walk_tree(inner_->repo, tree_oid_hex_, dest_norm);
+        std::set<std::string> extra;
+        for (auto& root : dest_roots) {
+            if (!root.empty()) {
+                auto entry = tree::lookup(inner_->repo, tree_oid_hex_, root);
+                if (!entry || entry->second != MODE_TREE) continue;
             }
-        }
-
-        for (auto& [rel_path, we] : dest_entries) {
-            if (source_dest_paths.count(rel_path) == 0) {
-                removes.push_back(rel_path);
+            for (auto& [path, we] : copy::walk_filtered(inner_->repo, tree_oid_hex_,
+                                                        root, filter)) {
+                if (source_dest_paths.count(path) == 0) extra.insert(path);
             }
         }
+        removes.assign(extra.begin(), extra.end());
     }
 
     if (opts.dry_run || (writes.empty() && removes.empty())) {
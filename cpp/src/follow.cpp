@@ -0,0 +1,184 @@
+#include "vost/watch.h"
+#include "vost/fs.h"
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <git2.h>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace vost {
+
+// ---------------------------------------------------------------------------
+// SyncFollowState
+// ---------------------------------------------------------------------------
+//
+// A follower is a RefWatch on one branch plus the tree hash last checked
+// out to `dest`.  Each delivered change checks out the new commit with
+// Fs::sync_out_diff from that tree, then records the new one (and writes
+// it to the state file, if any).  Updates are serialised by `mutex`, which
+// follow() also holds across the initial checkout so an early event
+// cannot race it.
+
+struct SyncFollowState {
+    std::shared_ptr<GitStoreInner> inner;
+    std::string                    branch;
+    std::string                    src;
+    std::filesystem::path          dest;
+    FollowOptions                  opts;
+    FollowCallback                 callback;
+    RefWatch                       watch;
+
+    mutable std::mutex         mutex;
+    std::string                tree;        ///< Last checked-out tree hash.
+    uint64_t                   updates = 0;
+    std::optional<std::string> last_error;
+
+    /// Tree hash recorded in the state file, or "".
+    std::string load_state() const {
+        if (opts.state_file.empty()) return "";
+        std::ifstream in(opts.state_file);
+        std::string hex;
+        if (!(in >> hex) || hex.size() != GIT_OID_HEXSZ) return "";
+        return hex;
+    }
+
+    void save_state() const {
+        if (opts.state_file.empty()) return;
+        auto tmp = opts.state_file;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            out << tree << '\n';
+            out.close();
+            if (!out) throw IoError("cannot write state file: " + tmp.string());
+        }
+        std::filesystem::rename(tmp, opts.state_file);
+    }
+
+    /// Check out `snap`, diffing from the recorded tree.  Caller holds mutex.
+    void apply(const Fs& snap, bool initial) {
+        std::string target = snap.tree_hash().value_or("");
+        if (target.empty() || target == tree) return;
+
+        ChangeReport report;
+        if (tree.empty()) {
+            report = snap.sync_out(src, dest, opts.sync);
+        } else {
+            report = snap.sync_out_diff(tree, src, dest, opts.sync);
+        }
+        tree = std::move(target);
+        save_state();
+        last_error.reset();
+        if (initial) return;
+
+        ++updates;
+        if (callback) {
+            try {
+                callback(report, snap);
+            } catch (...) {
+                // A throwing callback must not end the follower.
+            }
+        }
+    }
+
+    void on_change(const RefChange& change) {
+        if (!change.new_target) return; // branch deleted: keep what is there
+        std::lock_guard<std::mutex> lk(mutex);
+        try {
+            apply(Fs::from_commit(inner, *change.new_target, branch, false), false);
+        } catch (const std::exception& e) {
+            last_error = e.what();
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// GitStore::follow
+// ---------------------------------------------------------------------------
+
+SyncFollower GitStore::follow(const std::string& branch,
+                              const std::string& src,
+                              const std::filesystem::path& dest,
+                              FollowOptions opts,
+                              FollowCallback callback) {
+    auto state = std::make_shared<SyncFollowState>();
+    state->inner = inner_;
+    state->branch = branch;
+    state->src = src;
+    state->dest = dest;
+    state->opts = std::move(opts);
+    state->callback = std::move(callback);
+
+    std::lock_guard<std::mutex> lk(state->mutex);
+    std::weak_ptr<SyncFollowState> weak = state;
+    state->watch = watch({branch}, [weak](const RefChange& change) {
+        if (auto self = weak.lock()) self->on_change(change);
+    }, state->opts.watch);
+
+    auto snap = branches().get(branch);
+    state->tree = state->load_state();
+    if (!state->tree.empty()) {
+        try {
+            state->apply(snap, true);
+        } catch (const GitError&) {
+            // The recorded tree is gone (e.g. after gc): start over.
+            state->tree.clear();
+        } catch (const NotFoundError&) {
+            state->tree.clear();
+        }
+    }
+    if (state->tree.empty()) state->apply(snap, true);
+    return SyncFollower(std::move(state));
+}
+
+// ---------------------------------------------------------------------------
+// SyncFollower
+// ---------------------------------------------------------------------------
+
+SyncFollower::SyncFollower(std::shared_ptr<SyncFollowState> state)
+    : state_(std::move(state)) {}
+
+SyncFollower::~SyncFollower() {
+    stop();
+}
+
+SyncFollower& SyncFollower::operator=(SyncFollower&& other) noexcept {
+    if (this != &other) {
+        stop();
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
+
+void SyncFollower::stop() {
+    if (!state_) return;
+    auto state = std::move(state_);
+    state->watch.stop();
+}
+
+bool SyncFollower::active() const {
+    return state_ && state_->watch.active();
+}
+
+std::string SyncFollower::tree_hash() const {
+    if (!state_) return "";
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    return state_->tree;
+}
+
+uint64_t SyncFollower::updates() const {
+    if (!state_) return 0;
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    return state_->updates;
+}
+
+std::optional<std::string> SyncFollower::last_error() const {
+    if (!state_) return std::nullopt;
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    return state_->last_error;
+}
+
+} // namespace vost
@@ -6,9 +6,9 @@
 #include <git2.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -25,6 +25,64 @@ namespace {
     if (e && e->message) { msg += ": "; msg += e->message; }
     throw GitError(msg);
 }
+
+/// Point branch `ref` at an existing commit, provided it still points at
+/// `expected_hex` (undo, redo, compact_history).
+/// @throws StaleSnapshotError if the branch has moved.
+void move_branch(GitStoreInner& inner,
+                 const std::string& ref,
+                 const std::string& expected_hex,
+                 const std::string& target_hex,
+                 const std::string& target_tree_hex,
+                 const std::string& msg) {
+    std::string refname = "refs/heads/" + ref;
+
+    observe::PhaseTimer lock_wait(Phase::LockWait);
+    lock::with_repo_lock(inner.path, [&]() {
+        std::lock_guard<std::mutex> lk(inner.mutex);
+        lock_wait.stop();
+
+        // Stale-snapshot check
+        {
+            observe::PhaseTimer phase(Phase::CasCheck);
+            git_reference* cur_ref = nullptr;
+            if (git_reference_lookup(&cur_ref, inner.repo, refname.c_str()) == 0) {
+                git_object* obj = nullptr;
+                git_reference_peel(&obj, cur_ref, GIT_OBJECT_COMMIT);
+                git_reference_free(cur_ref);
+                if (obj) {
+                    char buf[GIT_OID_HEXSZ + 1];
+                    git_oid_tostr(buf, sizeof(buf), git_object_id(obj));
+                    git_object_free(obj);
+                    std::string cur_hex(buf, GIT_OID_HEXSZ);
+                    if (cur_hex != expected_hex) {
+                        throw StaleSnapshotError(
+                            "branch '" + ref + "' has advanced (concurrent write)");
+                    }
+                }
+            }
+        }
+
+        // Update ref to target
+        observe::PhaseTimer ref_update(Phase::RefUpdate);
+        git_oid target_oid;
+        if (git_oid_fromstr(&target_oid, target_hex.c_str()) != 0)
+            throw GitError("invalid target oid");
+
+        git_reference* existing = nullptr;
+        if (git_reference_lookup(&existing, inner.repo, refname.c_str()) != 0)
+            throw_git("git_reference_lookup");
+
+        git_reference* out_ref = nullptr;
+        int rc = git_reference_set_target(&out_ref, existing, &target_oid, msg.c_str());
+        git_reference_free(existing);
+        if (out_ref) git_reference_free(out_ref);
+        if (rc != 0) throw_git("git_reference_set_target");
+        refcache::store(inner, refname, target_hex, target_tree_hex);
+        reflog::enforce(inner, refname);
+        watch::notify(inner, refname);
+    });
+}
 } // anonymous namespace
 
 // ---------------------------------------------------------------------------
@@ -133,21 +191,31 @@ const std::string& Fs::require_tree() const {
 // Read operations
 // ---------------------------------------------------------------------------
 
-std::vector<uint8_t> Fs::read(const std::string& path) const {
+std::vector<uint8_t> Fs::read(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::read");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    return tree::read_blob(inner_->repo, tree, norm);
+    auto blob = tree::load_blob(inner_->repo, tree, norm);
+    return std::vector<uint8_t>(blob.data(), blob.data() + blob.size());
 }
 
-std::string Fs::read_text(const std::string& path) const {
-    auto data = read(path);
-    return std::string(data.begin(), data.end());
+std::string Fs::read_text(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::read");
+    const auto& tree = require_tree();
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
+    std::lock_guard<std::mutex> lk(inner_->mutex);
+    auto blob = tree::load_blob(inner_->repo, tree, norm);
+    return std::string(reinterpret_cast<const char*>(blob.data()), blob.size());
 }
 
-std::vector<std::string> Fs::ls(const std::string& path) const {
+std::vector<std::string> Fs::ls(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::ls");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
     auto entries = tree::list_tree(inner_->repo, tree, norm);
     std::vector<std::string> names;
@@ -157,88 +225,100 @@ std::vector<std::string> Fs::ls(const std::string& path) const {
 }
 
 std::vector<WalkDirEntry>
-Fs::walk(const std::string& path) const {
+Fs::walk(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::walk");
     const auto& tree_hex = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
     return tree::walk_tree_dirs(inner_->repo, tree_hex, norm);
 }
 
-bool Fs::exists(const std::string& path) const {
+bool Fs::exists(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::exists");
     if (tree_oid_hex_.empty()) return false;
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     if (norm.empty()) return true; // root always exists
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    auto entry = tree::lookup(inner_->repo, tree_oid_hex_, norm);
-    return entry.has_value();
+    return tree::find(inner_->repo, tree_oid_hex_, norm).has_value();
 }
 
-bool Fs::is_dir(const std::string& path) const {
+bool Fs::is_dir(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::is_dir");
     if (tree_oid_hex_.empty()) return false;
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     if (norm.empty()) return true;
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    auto entry = tree::lookup(inner_->repo, tree_oid_hex_, norm);
+    auto entry = tree::find(inner_->repo, tree_oid_hex_, norm);
     if (!entry) return false;
-    return entry->second == MODE_TREE;
+    return entry->mode == MODE_TREE;
 }
 
-FileType Fs::file_type(const std::string& path) const {
+FileType Fs::file_type(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::file_type");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    auto entry = tree::lookup(inner_->repo, tree, norm);
-    if (!entry) throw NotFoundError(path);
-    auto ft = file_type_from_mode(entry->second);
-    if (!ft) throw GitError("unknown mode for: " + path);
+    auto entry = tree::find(inner_->repo, tree, norm);
+    if (!entry) throw NotFoundError(std::string(path));
+    auto ft = file_type_from_mode(entry->mode);
+    if (!ft) throw GitError("unknown mode for: " + std::string(path));
     return *ft;
 }
 
-uint64_t Fs::size(const std::string& path) const {
+uint64_t Fs::size(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::size");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    auto entry = tree::lookup(inner_->repo, tree, norm);
-    if (!entry) throw NotFoundError(path);
-    if (entry->second == MODE_TREE) throw IsADirectoryError(path);
+    auto entry = tree::find(inner_->repo, tree, norm);
+    if (!entry) throw NotFoundError(std::string(path));
+    if (entry->mode == MODE_TREE) throw IsADirectoryError(std::string(path));
 
+    // The size comes from the object header; the blob is not inflated.
     git_oid oid;
-    if (git_oid_fromstr(&oid, entry->first.c_str()) != 0)
-        throw InvalidHashError(entry->first);
-    git_blob* blob = nullptr;
-    if (git_blob_lookup(&blob, inner_->repo, &oid) != 0)
-        throw_git("git_blob_lookup");
-    uint64_t sz = static_cast<uint64_t>(git_blob_rawsize(blob));
-    git_blob_free(blob);
+    std::memcpy(oid.id, entry->oid, sizeof(entry->oid));
+    observe::PhaseTimer phase(Phase::BlobRead);
+    uint64_t sz = tree::blob_size(inner_->repo, oid);
     return sz;
 }
 
-std::string Fs::object_hash(const std::string& path) const {
+std::string Fs::object_hash(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::object_hash");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    auto entry = tree::lookup(inner_->repo, tree, norm);
-    if (!entry) throw NotFoundError(path);
-    return entry->first;
+    auto entry = tree::find(inner_->repo, tree, norm);
+    if (!entry) throw NotFoundError(std::string(path));
+    return entry->oid_hex();
 }
 
-std::string Fs::readlink(const std::string& path) const {
+std::string Fs::readlink(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::readlink");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
-    auto entry = tree::lookup(inner_->repo, tree, norm);
-    if (!entry) throw NotFoundError(path);
-    if (entry->second != MODE_LINK)
-        throw InvalidPathError(path + " is not a symlink");
-    auto data = tree::read_blob(inner_->repo, tree, norm);
-    return std::string(data.begin(), data.end());
+    auto entry = tree::find(inner_->repo, tree, norm);
+    if (!entry) throw NotFoundError(std::string(path));
+    if (entry->mode != MODE_LINK)
+        throw InvalidPathError(std::string(path) + " is not a symlink");
+    auto blob = tree::load_blob(inner_->repo, tree, norm);
+    return std::string(reinterpret_cast<const char*>(blob.data()), blob.size());
 }
 
-StatResult Fs::stat(const std::string& path) const {
+StatResult Fs::stat(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::stat");
     const auto& tree_hex = require_tree();
     uint64_t mtime_val = commit_oid_hex_.empty() ? 0 : time();
 
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
 
     if (norm.empty()) {
@@ -246,59 +326,67 @@ StatResult Fs::stat(const std::string& path) const {
         return StatResult{MODE_TREE, FileType::Tree, 0, tree_hex, nlink, mtime_val};
     }
 
-    auto entry = tree::lookup(inner_->repo, tree_hex, norm);
-    if (!entry) throw NotFoundError(path);
+    auto entry = tree::find(inner_->repo, tree_hex, norm);
+    if (!entry) throw NotFoundError(std::string(path));
 
-    auto ft = file_type_from_mode(entry->second);
-    if (!ft) throw GitError("unknown mode for: " + path);
+    auto ft = file_type_from_mode(entry->mode);
+    if (!ft) throw GitError("unknown mode for: " + std::string(path));
 
-    if (entry->second == MODE_TREE) {
-        uint32_t nlink = 2 + tree::count_subdirs(inner_->repo, entry->first);
-        return StatResult{entry->second, *ft, 0, entry->first, nlink, mtime_val};
+    std::string hex = entry->oid_hex();
+    if (entry->mode == MODE_TREE) {
+        uint32_t nlink = 2 + tree::count_subdirs(inner_->repo, hex);
+        return StatResult{entry->mode, *ft, 0, std::move(hex), nlink, mtime_val};
     }
 
+    // The size comes from the object header; the blob is not inflated.
     git_oid oid;
-    if (git_oid_fromstr(&oid, entry->first.c_str()) != 0)
-        throw InvalidHashError(entry->first);
-    git_blob* blob = nullptr;
-    if (git_blob_lookup(&blob, inner_->repo, &oid) != 0)
-        throw_git("git_blob_lookup");
-    uint64_t sz = static_cast<uint64_t>(git_blob_rawsize(blob));
-    git_blob_free(blob);
+    std::memcpy(oid.id, entry->oid, sizeof(entry->oid));
+    observe::PhaseTimer phase(Phase::BlobRead);
+    uint64_t sz = tree::blob_size(inner_->repo, oid);
 
-    return StatResult{entry->second, *ft, sz, entry->first, 1, mtime_val};
+    return StatResult{entry->mode, *ft, sz, std::move(hex), 1, mtime_val};
 }
 
-std::vector<WalkEntry> Fs::listdir(const std::string& path) const {
+std::vector<WalkEntry> Fs::listdir(std::string_view path) const {
+    observe::Operation obs_op(*inner_, "Fs::listdir");
     const auto& tree = require_tree();
-    std::string norm = paths::normalize(path);
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
     std::lock_guard<std::mutex> lk(inner_->mutex);
     return tree::list_tree(inner_->repo, tree, norm);
 }
 
-std::vector<uint8_t> Fs::read_range(const std::string& path,
+std::vector<uint8_t> Fs::read_range(std::string_view path,
                                      size_t offset,
                                      std::optional<size_t> sz) const {
-    auto data = read(path);
-    size_t start = std::min(offset, data.size());
+    observe::Operation obs_op(*inner_, "Fs::read_range");
+    const auto& tree = require_tree();
+    std::string norm_buf;
+    auto norm = paths::normalize_view(path, norm_buf);
+    std::lock_guard<std::mutex> lk(inner_->mutex);
+    auto blob = tree::load_blob(inner_->repo, tree, norm);
+    size_t start = std::min(offset, blob.size());
     size_t end   = sz ? std::min(start <= SIZE_MAX - *sz ? start + *sz : SIZE_MAX,
-                                 data.size())
-                      : data.size();
-    return std::vector<uint8_t>(data.begin() + static_cast<ptrdiff_t>(start),
-                                data.begin() + static_cast<ptrdiff_t>(end));
+                                 blob.size())
+                      : blob.size();
+    return std::vector<uint8_t>(blob.data() + start, blob.data() + end);
 }
 
 std::vector<uint8_t> Fs::read_by_hash(const std::string& hash,
                                        size_t offset,
                                        std::optional<size_t> sz) const {
+    observe::Operation obs_op(*inner_, "Fs::read_by_hash");
     git_oid oid;
     if (git_oid_fromstr(&oid, hash.c_str()) != 0)
         throw InvalidHashError(hash);
 
     std::lock_guard<std::mutex> lk(inner_->mutex);
+    observe::PhaseTimer phase(Phase::BlobRead);
     git_blob* blob = nullptr;
     if (git_blob_lookup(&blob, inner_->repo, &oid) != 0)
         throw_git("git_blob_lookup");
+    observe::count(Counter::BlobLookups);
+    observe::count(Counter::BytesInflated, static_cast<uint64_t>(git_blob_rawsize(blob)));
 
     const void* raw = git_blob_rawcontent(blob);
     size_t       rawsz = static_cast<size_t>(git_blob_rawsize(blob));
@@ -324,8 +412,11 @@ Fs Fs::commit_changes(
     const std::vector<std::string>& removes,
     const std::string& message,
     std::optional<ChangeReport> report,
-    const std::vector<std::string>& extra_parent_oids) const
+    const std::vector<std::string>& extra_parent_oids,
+    const std::vector<std::pair<std::string,
+                                std::pair<std::string, uint32_t>>>& stored) const
 {
+    observe::Operation obs_op(*inner_, "Fs::commit");
     const std::string& ref = require_writable("write");
     std::string refname = "refs/heads/" + ref;
 
@@ -333,11 +424,14 @@ Fs Fs::commit_changes(
     std::string new_tree_hex;
 
     // Hold the repo lock while rebuilding tree + creating commit + CAS ref update
+    observe::PhaseTimer lock_wait(Phase::LockWait);
     lock::with_repo_lock(inner_->path, [&]() {
         std::lock_guard<std::mutex> lk(inner_->mutex);
+        lock_wait.stop();
 
         // CAS check: branch tip must still match our commit_oid
         {
+            observe::PhaseTimer phase(Phase::CasCheck);
             git_reference* cur_ref = nullptr;
             if (git_reference_lookup(&cur_ref, inner_->repo, refname.c_str()) == 0) {
                 git_object* obj = nullptr;
@@ -361,7 +455,12 @@ Fs Fs::commit_changes(
             ? std::string(GIT_OID_HEXSZ, '0')
             : tree_oid_hex_;
 
-        new_tree_hex = tree::rebuild_tree(inner_->repo, base_tree, writes, removes);
+        {
+            observe::PhaseTimer phase(Phase::RebuildTree);
+            odb::BlobWriter blobs(*inner_);
+            new_tree_hex = tree::rebuild_tree(inner_->repo, base_tree, writes, removes,
+                                              stored, &blobs);
+        }
 
         // Create commit — build full parents list (branch tip + extras)
         std::vector<std::string> all_parents;
@@ -371,12 +470,16 @@ Fs Fs::commit_changes(
         all_parents.insert(all_parents.end(),
                            extra_parent_oids.begin(),
                            extra_parent_oids.end());
-        new_commit_hex = tree::write_commit(inner_->repo, new_tree_hex,
-                                             all_parents,
-                                             inner_->signature,
-                                             message);
+        {
+            observe::PhaseTimer phase(Phase::WriteCommit);
+            new_commit_hex = tree::write_commit(inner_->repo, new_tree_hex,
+                                                 all_parents,
+                                                 inner_->signature,
+                                                 message);
+        }
 
         // Update ref (CAS)
+        observe::PhaseTimer ref_update(Phase::RefUpdate);
         git_oid new_oid;
         if (git_oid_fromstr(&new_oid, new_commit_hex.c_str()) != 0)
             throw GitError("invalid new commit oid");
@@ -406,6 +509,9 @@ Fs Fs::commit_changes(
         }
         if (out_ref) git_reference_free(out_ref);
         if (rc != 0) throw_git("git_reference update");
+        refcache::store(*inner_, refname, new_commit_hex, new_tree_hex);
+        reflog::enforce(*inner_, refname);
+        watch::notify(*inner_, refname);
     });
 
     return Fs(inner_, new_commit_hex, new_tree_hex, ref_name_, true, std::move(report));
@@ -465,17 +571,11 @@ void iglob_recursive(git_repository* repo,
 } // anonymous namespace
 
 std::vector<std::string> Fs::iglob(const std::string& pattern) const {
+    observe::Operation obs_op(*inner_, "Fs::iglob");
     const auto& tree_hex = require_tree();
 
     // Split pattern by '/'
-    std::vector<std::string> segments;
-    {
-        std::istringstream iss(pattern);
-        std::string seg;
-        while (std::getline(iss, seg, '/')) {
-            if (!seg.empty()) segments.push_back(seg);
-        }
-    }
+    auto segments = paths::split(pattern);
     if (segments.empty()) return {};
 
     std::vector<std::string> results;
@@ -499,6 +599,7 @@ std::vector<std::string> Fs::glob(const std::string& pattern) const {
 Fs Fs::write(const std::string& path,
               const std::vector<uint8_t>& data,
               WriteOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::write");
     std::string norm = paths::normalize(path);
     uint32_t mode = opts.mode.value_or(MODE_BLOB);
     std::string msg = paths::format_message("write: " + norm, opts.message);
@@ -518,6 +619,7 @@ Fs Fs::write_text(const std::string& path,
 Fs Fs::write_from_file(const std::string& path,
                         const std::filesystem::path& local_path,
                         WriteOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::write_from_file");
     namespace fss = std::filesystem;
     if (!fss::exists(local_path)) {
         throw IoError("file not found: " + local_path.string());
@@ -538,6 +640,7 @@ Fs Fs::write_from_file(const std::string& path,
 Fs Fs::write_symlink(const std::string& path,
                       const std::string& target,
                       WriteOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::write_symlink");
     std::string norm = paths::normalize(path);
     std::string msg = paths::format_message("symlink: " + norm, opts.message);
     std::vector<uint8_t> data(target.begin(), target.end());
@@ -550,14 +653,20 @@ Fs Fs::write_symlink(const std::string& path,
 Fs Fs::apply(const std::vector<std::pair<std::string, WriteEntry>>& writes,
               const std::vector<std::string>& removes,
               ApplyOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::apply");
     std::string msg = paths::format_message(opts.operation.value_or("apply"), opts.message);
 
     std::vector<std::pair<std::string,
                           std::pair<std::vector<uint8_t>, uint32_t>>> internal;
+    std::vector<std::pair<std::string, std::pair<std::string, uint32_t>>> refs;
     internal.reserve(writes.size());
     for (auto& [p, we] : writes) {
         we.validate();
         std::string norm = paths::normalize(p);
+        if (we.oid) {
+            refs.push_back({norm, {odb::canonical_hex(*we.oid), we.mode}});
+            continue;
+        }
         std::vector<uint8_t> data;
         if (we.data) data = *we.data;
         else if (we.target) data = std::vector<uint8_t>(
@@ -569,10 +678,15 @@ Fs Fs::apply(const std::vector<std::pair<std::string, WriteEntry>>& writes,
     norm_removes.reserve(removes.size());
     for (auto& r : removes) norm_removes.push_back(paths::normalize(r));
 
-    return commit_changes(internal, norm_removes, msg, std::nullopt, opts.parents);
+    if (!refs.empty()) {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        odb::require_blobs(inner_->repo, refs);
+    }
+    return commit_changes(internal, norm_removes, msg, std::nullopt, opts.parents, refs);
 }
 
 Fs Fs::remove(const std::vector<std::string>& paths_in, RemoveOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::remove");
     require_writable("remove");
     const auto& tree_hex = require_tree();
     std::string msg = paths::format_message("remove", opts.message);
@@ -611,6 +725,7 @@ Fs Fs::remove(const std::vector<std::string>& paths_in, RemoveOptions opts) cons
 Fs Fs::move(const std::vector<std::string>& sources,
                    const std::string& dest,
                    MoveOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::move");
     require_writable("move");
     const auto& tree_hex = require_tree();
     std::string norm_dest = paths::normalize(dest);
@@ -704,6 +819,7 @@ Batch Fs::batch(BatchOptions opts) const {
 // ---------------------------------------------------------------------------
 
 std::optional<Fs> Fs::parent() const {
+    observe::Operation obs_op(*inner_, "Fs::parent");
     if (commit_oid_hex_.empty()) return std::nullopt;
     std::lock_guard<std::mutex> lk(inner_->mutex);
     auto meta = tree::read_commit(inner_->repo, commit_oid_hex_);
@@ -724,6 +840,7 @@ std::optional<Fs> Fs::parent() const {
 }
 
 Fs Fs::back(size_t n) const {
+    observe::Operation obs_op(*inner_, "Fs::back");
     Fs cur = *this;
     for (size_t i = 0; i < n; ++i) {
         auto p = cur.parent();
@@ -740,6 +857,7 @@ Fs Fs::back(size_t n) const {
 
 Fs Fs::rename(const std::string& src, const std::string& dest,
               WriteOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::rename");
     require_writable("rename");
     const auto& tree_hex = require_tree();
     std::string norm_src = paths::normalize(src);
@@ -787,6 +905,7 @@ Fs Fs::rename(const std::string& src, const std::string& dest,
 // ---------------------------------------------------------------------------
 
 Fs Fs::undo(size_t n) const {
+    observe::Operation obs_op(*inner_, "Fs::undo");
     const std::string& ref = require_writable("undo");
     if (commit_oid_hex_.empty())
         throw NotFoundError("no commit to undo");
@@ -809,52 +928,14 @@ Fs Fs::undo(size_t n) const {
         target_tree_hex = tree::tree_oid_for_commit(inner_->repo, target_hex);
     }
 
-    std::string refname = "refs/heads/" + ref;
-
-    lock::with_repo_lock(inner_->path, [&]() {
-        std::lock_guard<std::mutex> lk(inner_->mutex);
-
-        // Stale-snapshot check
-        {
-            git_reference* cur_ref = nullptr;
-            if (git_reference_lookup(&cur_ref, inner_->repo, refname.c_str()) == 0) {
-                git_object* obj = nullptr;
-                git_reference_peel(&obj, cur_ref, GIT_OBJECT_COMMIT);
-                git_reference_free(cur_ref);
-                if (obj) {
-                    char buf[GIT_OID_HEXSZ + 1];
-                    git_oid_tostr(buf, sizeof(buf), git_object_id(obj));
-                    git_object_free(obj);
-                    std::string cur_hex(buf, GIT_OID_HEXSZ);
-                    if (cur_hex != commit_oid_hex_) {
-                        throw StaleSnapshotError(
-                            "branch '" + ref + "' has advanced (concurrent write)");
-                    }
-                }
-            }
-        }
-
-        // Update ref to target
-        git_oid target_oid;
-        if (git_oid_fromstr(&target_oid, target_hex.c_str()) != 0)
-            throw GitError("invalid target oid");
-
-        git_reference* existing = nullptr;
-        if (git_reference_lookup(&existing, inner_->repo, refname.c_str()) != 0)
-            throw_git("git_reference_lookup");
-
-        git_reference* out_ref = nullptr;
-        std::string msg = "undo: " + std::to_string(n) + " commit(s)";
-        int rc = git_reference_set_target(&out_ref, existing, &target_oid, msg.c_str());
-        git_reference_free(existing);
-        if (out_ref) git_reference_free(out_ref);
-        if (rc != 0) throw_git("git_reference_set_target (undo)");
-    });
+    move_branch(*inner_, ref, commit_oid_hex_, target_hex, target_tree_hex,
+                "undo: " + std::to_string(n) + " commit(s)");
 
     return Fs(inner_, target_hex, target_tree_hex, ref_name_, true);
 }
 
 Fs Fs::redo(size_t n) const {
+    observe::Operation obs_op(*inner_, "Fs::redo");
     const std::string& ref = require_writable("redo");
     if (n == 0) return *this;
 
@@ -867,49 +948,23 @@ Fs Fs::redo(size_t n) const {
     // The old_sha of that entry is the commit we want to redo to.
     {
         std::lock_guard<std::mutex> lk(inner_->mutex);
-        git_reflog* rlog = nullptr;
-        if (git_reflog_read(&rlog, inner_->repo, refname.c_str()) != 0)
-            throw NotFoundError("no reflog for redo");
-
-        // RAII guard for reflog
-        struct ReflogGuard {
-            git_reflog* r;
-            ~ReflogGuard() { if (r) git_reflog_free(r); }
-        } rg{rlog};
-
-        size_t entry_count = git_reflog_entrycount(rlog);
         std::string cur_hex = commit_oid_hex_.empty()
             ? std::string(GIT_OID_HEXSZ, '0') : commit_oid_hex_;
+        const std::string zero(GIT_OID_HEXSZ, '0');
 
+        // Newest first; stops as soon as n redo targets are found.
         size_t redo_found = 0;
-        for (size_t i = 0; i < entry_count && redo_found < n; ++i) {
-            const git_reflog_entry* e = git_reflog_entry_byindex(rlog, i);
-
+        reflog::for_each_recent(inner_->path, refname, [&](ReflogEntry&& e) {
             // Only consider entries from undo/redo operations
-            const char* msg_raw = git_reflog_entry_message(e);
-            std::string entry_msg = msg_raw ? msg_raw : "";
-            if (entry_msg.substr(0, 5) != "undo:" &&
-                entry_msg.substr(0, 5) != "redo:") {
-                continue;
+            if (e.message.compare(0, 5, "undo:") != 0 &&
+                e.message.compare(0, 5, "redo:") != 0)
+                return true;
+            if (e.new_sha == cur_hex && e.old_sha != zero) {
+                cur_hex = e.old_sha;
+                ++redo_found;
             }
-
-            char new_buf[GIT_OID_HEXSZ + 1];
-            git_oid_tostr(new_buf, sizeof(new_buf),
-                          git_reflog_entry_id_new(e));
-            std::string entry_new(new_buf, GIT_OID_HEXSZ);
-
-            if (entry_new == cur_hex) {
-                char old_buf[GIT_OID_HEXSZ + 1];
-                git_oid_tostr(old_buf, sizeof(old_buf),
-                              git_reflog_entry_id_old(e));
-                std::string entry_old(old_buf, GIT_OID_HEXSZ);
-
-                if (entry_old != std::string(GIT_OID_HEXSZ, '0')) {
-                    cur_hex = entry_old;
-                    ++redo_found;
-                }
-            }
-        }
+            return redo_found < n;
+        });
 
         if (redo_found < n)
             throw NotFoundError("not enough redo history");
@@ -918,45 +973,8 @@ Fs Fs::redo(size_t n) const {
         target_tree_hex = tree::tree_oid_for_commit(inner_->repo, target_hex);
     }
 
-    lock::with_repo_lock(inner_->path, [&]() {
-        std::lock_guard<std::mutex> lk(inner_->mutex);
-
-        // Stale-snapshot check
-        {
-            git_reference* cur_ref = nullptr;
-            if (git_reference_lookup(&cur_ref, inner_->repo, refname.c_str()) == 0) {
-                git_object* obj = nullptr;
-                git_reference_peel(&obj, cur_ref, GIT_OBJECT_COMMIT);
-                git_reference_free(cur_ref);
-                if (obj) {
-                    char buf[GIT_OID_HEXSZ + 1];
-                    git_oid_tostr(buf, sizeof(buf), git_object_id(obj));
-                    git_object_free(obj);
-                    std::string cur_hex(buf, GIT_OID_HEXSZ);
-                    if (cur_hex != commit_oid_hex_) {
-                        throw StaleSnapshotError(
-                            "branch '" + ref + "' has advanced (concurrent write)");
-                    }
-                }
-            }
-        }
-
-        // Update ref to target
-        git_oid target_oid;
-        if (git_oid_fromstr(&target_oid, target_hex.c_str()) != 0)
-            throw GitError("invalid target oid");
-
-        git_reference* existing = nullptr;
-        if (git_reference_lookup(&existing, inner_->repo, refname.c_str()) != 0)
-            throw_git("git_reference_lookup");
-
-        git_reference* out_ref = nullptr;
-        std::string msg = "redo: " + std::to_string(n) + " commit(s)";
-        int rc = git_reference_set_target(&out_ref, existing, &target_oid, msg.c_str());
-        git_reference_free(existing);
-        if (out_ref) git_reference_free(out_ref);
-        if (rc != 0) throw_git("git_reference_set_target (redo)");
-    });
+    move_branch(*inner_, ref, commit_oid_hex_, target_hex, target_tree_hex,
+                "redo: " + std::to_string(n) + " commit(s)");
 
     return Fs(inner_, target_hex, target_tree_hex, ref_name_, true);
 }
@@ -966,6 +984,7 @@ Fs Fs::redo(size_t n) const {
 // ---------------------------------------------------------------------------
 
 std::vector<CommitInfo> Fs::log(LogOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::log");
     if (commit_oid_hex_.empty()) return {};
 
     std::vector<CommitInfo> results;
@@ -1043,6 +1062,7 @@ std::vector<CommitInfo> Fs::log(LogOptions opts) const {
 // ---------------------------------------------------------------------------
 
 Fs Fs::squash(std::optional<Fs> parent_fs, const std::string& message) const {
+    observe::Operation obs_op(*inner_, "Fs::squash");
     const auto& tree_hex = require_tree();
 
     std::vector<std::string> parent_oids;
@@ -1065,6 +1085,153 @@ Fs Fs::squash(std::optional<Fs> parent_fs, const std::string& message) const {
     return Fs(inner_, new_commit_hex, tree_hex, std::nullopt, false);
 }
 
+// ---------------------------------------------------------------------------
+// History compaction
+// ---------------------------------------------------------------------------
+
+Fs Fs::compact_history(const HistoryRetention& policy) const {
+    observe::Operation obs_op(*inner_, "Fs::compact_history");
+    const std::string& ref = require_writable("compact history");
+    if (commit_oid_hex_.empty()) return *this;
+    if (!policy.keep_commits && !policy.keep_age)
+        throw std::invalid_argument(
+            "compact_history: set keep_commits and/or keep_age");
+
+    uint64_t cutoff = 0;
+    if (policy.keep_age) {
+        auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        cutoff = now > *policy.keep_age ? now - *policy.keep_age : 0;
+    }
+    auto retained = [&](size_t index, uint64_t time) {
+        if (policy.keep_commits && index < *policy.keep_commits) return true;
+        return policy.keep_age && time >= cutoff;
+    };
+
+    // Walk the first-parent chain until the first commit that falls outside
+    // the policy.  Only retained commits are visited.
+    std::vector<std::string> keep; // newest first
+    std::string boundary_hex;
+    std::string boundary_tree;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        std::string cur = commit_oid_hex_;
+        while (!cur.empty()) {
+            auto meta = tree::read_commit(inner_->repo, cur);
+            if (!retained(keep.size(), meta.time)) {
+                // Already a root: nothing older to fold in.
+                if (meta.parent_oid_hex.empty()) return *this;
+                boundary_hex = cur;
+                boundary_tree = meta.tree_oid_hex;
+                break;
+            }
+            keep.push_back(cur);
+            cur = meta.parent_oid_hex;
+        }
+    }
+    if (boundary_hex.empty()) return *this; // whole history retained
+
+    // New root with the boundary's tree, then replay retained commits on it.
+    Fs boundary(inner_, boundary_hex, boundary_tree, std::nullopt, false);
+    std::string msg = policy.message.value_or(
+        "compact: squashed history before " + boundary_hex.substr(0, 12));
+    std::string tip = *boundary.squash(std::nullopt, msg).commit_hash();
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        for (auto it = keep.rbegin(); it != keep.rend(); ++it)
+            tip = tree::rewrite_commit(inner_->repo, *it, {tip});
+    }
+
+    move_branch(*inner_, ref, commit_oid_hex_, tip, tree_oid_hex_,
+                "compact: kept " + std::to_string(keep.size()) + " commit(s)");
+
+    if (policy.gc) maintenance::pack(*inner_);
+
+    return Fs(inner_, tip, tree_oid_hex_, ref_name_, true);
+}
+
+// ---------------------------------------------------------------------------
+// Merge
+// ---------------------------------------------------------------------------
+
+MergeConflictError::MergeConflictError(std::vector<MergeConflict> conflicts)
+    : VostError([&] {
+          std::string msg = "merge conflict:";
+          for (size_t i = 0; i < conflicts.size(); ++i)
+              msg += (i ? ", " : " ") + conflicts[i].path;
+          return msg;
+      }())
+    , conflicts_(std::make_shared<const std::vector<MergeConflict>>(
+          std::move(conflicts))) {}
+
+Fs Fs::merge(const Fs& other, std::optional<Fs> base, MergeOptions opts) const {
+    observe::Operation obs_op(*inner_, "Fs::merge");
+    const std::string& ref = require_writable("merge");
+    const std::string& ours_tree = require_tree();
+    if (!other.commit_hash())
+        throw NotFoundError("merge source has no commit");
+    if (other.inner_->path != inner_->path)
+        throw std::invalid_argument("merge: snapshots belong to different repositories");
+    const std::string& theirs_hex = other.commit_oid_hex_;
+    if (theirs_hex == commit_oid_hex_) return *this;
+
+    std::string merged_tree;
+    std::vector<MergeConflict> conflicts;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+
+        // Base: explicit snapshot, else the merge base ("" = unrelated histories).
+        std::string base_commit, base_tree;
+        if (base) {
+            base_commit = base->commit_oid_hex_;
+            base_tree = base->tree_oid_hex_;
+        } else {
+            git_oid ours_oid, theirs_oid, base_oid;
+            if (git_oid_fromstr(&ours_oid, commit_oid_hex_.c_str()) != 0 ||
+                git_oid_fromstr(&theirs_oid, theirs_hex.c_str()) != 0)
+                throw GitError("invalid commit oid");
+            int rc = git_merge_base(&base_oid, inner_->repo, &ours_oid, &theirs_oid);
+            if (rc == 0) {
+                char buf[GIT_OID_HEXSZ + 1];
+                git_oid_tostr(buf, sizeof(buf), &base_oid);
+                base_commit.assign(buf, GIT_OID_HEXSZ);
+                base_tree = tree::tree_oid_for_commit(inner_->repo, base_commit);
+            } else if (rc != GIT_ENOTFOUND) {
+                throw_git("git_merge_base");
+            }
+        }
+
+        // Already merged: the other side is an ancestor of this snapshot.
+        if (!base_commit.empty() && base_commit == theirs_hex) return *this;
+
+        merged_tree = tree::merge_trees(inner_->repo, base_tree, ours_tree,
+                                        other.tree_oid_hex_, opts.favor, conflicts);
+    }
+    if (!conflicts.empty() && !opts.favor)
+        throw MergeConflictError(std::move(conflicts));
+
+    // The tree is complete, so the commit is written directly rather than
+    // replayed through commit_changes; move_branch does the CAS under the
+    // repo lock.  No fast-forward: an ancestor still gets a merge commit.
+    std::string label = other.ref_name_.value_or(theirs_hex.substr(0, 12));
+    std::string msg = paths::format_message("merge: " + label, opts.message);
+    std::string new_commit_hex;
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        new_commit_hex = tree::write_commit(inner_->repo, merged_tree,
+                                            {commit_oid_hex_, theirs_hex},
+                                            inner_->signature, msg);
+    }
+    move_branch(*inner_, ref, commit_oid_hex_, new_commit_hex, merged_tree, msg);
+
+    // Conflicts settled by opts.favor are reported as warnings.
+    ChangeReport report;
+    const char* side = opts.favor == MergeFavor::Theirs ? "theirs" : "ours";
+    for (const auto& c : conflicts)
+        report.warnings.push_back({c.path, std::string("conflict resolved in favor of ") + side});
+    return Fs(inner_, new_commit_hex, merged_tree, ref_name_, true, std::move(report));
+}
+
 // ---------------------------------------------------------------------------
 // FsWriter
 // ---------------------------------------------------------------------------
@@ -8,6 +8,7 @@
 #include <cstring>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 
 namespace vost {
 
@@ -69,6 +70,7 @@ static void init_branch(git_repository* repo,
     git_treebuilder_free(tb);
 
     git_tree* tree = nullptr;
+    observe::count(Counter::TreeLookups);
     if (git_tree_lookup(&tree, repo, &tree_oid) != 0)
         throw_git("git_tree_lookup");
 
@@ -146,6 +148,14 @@ GitStore GitStore::open(const std::filesystem::path& path, OpenOptions opts) {
     }
 
     auto inner = std::make_shared<GitStoreInner>(repo, path, sig);
+    if (opts.ref_cache) inner->ref_cache = std::make_unique<RefCache>();
+    inner->reflog_retention = opts.reflog_retention;
+    inner->hash = opts.hash;
+    if (opts.compression) inner->loose_level = *opts.compression;
+    inner->compression_policy = opts.compression_policy;
+    if (inner->compression_policy && !inner->compression_policy->default_level)
+        inner->compression_policy->default_level =
+            opts.compression ? *opts.compression : 6;
     return GitStore(std::move(inner));
 }
 
@@ -169,15 +179,15 @@ NoteDict GitStore::notes() {
 }
 
 Fs GitStore::fs(const std::string& ref) {
-    // Try branch first
-    auto br = branches();
-    if (br.contains(ref)) {
-        return br.get(ref);
-    }
-    // Try tag
-    auto tg = tags();
-    if (tg.contains(ref)) {
-        return tg.get(ref);
+    observe::Operation obs_op(*inner_, "GitStore::fs");
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        // Try branch first
+        if (auto r = refcache::resolve(*inner_, "refs/heads/" + ref))
+            return Fs(inner_, r->commit_hex, r->tree_hex, ref, true);
+        // Try tag
+        if (auto r = refcache::resolve(*inner_, "refs/tags/" + ref))
+            return Fs(inner_, r->commit_hex, r->tree_hex, ref, false);
     }
     // Fall back to commit hash
     git_oid oid;
@@ -197,11 +207,17 @@ Fs GitStore::fs(const std::string& ref) {
     return Fs(inner_, ref, tree_hex, std::nullopt, false);
 }
 
-size_t GitStore::pack() {
-    std::lock_guard<std::mutex> lk(inner_->mutex);
+// ---------------------------------------------------------------------------
+// maintenance
+// ---------------------------------------------------------------------------
+
+namespace maintenance {
+
+size_t pack(GitStoreInner& inner) {
+    std::lock_guard<std::mutex> lk(inner.mutex);
 
     git_odb* odb = nullptr;
-    if (git_repository_odb(&odb, inner_->repo) != 0)
+    if (git_repository_odb(&odb, inner.repo) != 0)
         throw_git("git_repository_odb");
 
     // Collect all object OIDs
@@ -226,31 +242,62 @@ size_t GitStore::pack() {
         return 0;
     }
 
-    // Create pack builder and insert all objects
+    // With a compression policy, loose blobs it calls incompressible (by
+    // probe, or written at level 0 by a path rule) skip delta search and
+    // go into a pack of their own at the policy's level.
+    std::vector<std::pair<git_oid, int>> flat;
+    std::vector<git_oid> rest;
+    if (const auto& policy = inner.compression_policy) {
+        std::vector<uint8_t> head;
+        for (auto& oid : collector.oids) {
+            bool stored = false;
+            if (odb::probe_loose(inner.repo, oid, policy->probe_bytes, head, stored) &&
+                (stored || odb::probe_incompressible(*policy, head.data(), head.size())))
+                flat.emplace_back(oid, stored ? 0 : policy->incompressible_level);
+            else
+                rest.push_back(oid);
+        }
+    }
+    const auto& delta_oids = inner.compression_policy ? rest : collector.oids;
+
+    // Create pack builder and insert the remaining objects
+    observe::PhaseTimer pack_write(Phase::PackWrite);
     git_packbuilder* pb = nullptr;
-    if (git_packbuilder_new(&pb, inner_->repo) != 0) {
+    if (git_packbuilder_new(&pb, inner.repo) != 0) {
         git_odb_free(odb);
         throw_git("git_packbuilder_new");
     }
 
     size_t count = 0;
-    for (auto& oid : collector.oids) {
+    for (auto& oid : delta_oids) {
         if (git_packbuilder_insert(pb, &oid, nullptr) == 0)
             ++count;
     }
 
+    auto pack_dir = inner.path / "objects" / "pack";
     if (count > 0) {
         // Write packfile to objects/pack/
-        auto pack_dir = inner_->path / "objects" / "pack";
         std::filesystem::create_directories(pack_dir);
         if (git_packbuilder_write(pb, pack_dir.string().c_str(), 0644, nullptr, nullptr) != 0) {
             git_packbuilder_free(pb);
             git_odb_free(odb);
             throw_git("git_packbuilder_write");
         }
+    }
+    if (!flat.empty()) {
+        try {
+            odb::write_flat_pack(inner.repo, flat);
+        } catch (...) {
+            git_packbuilder_free(pb);
+            git_odb_free(odb);
+            throw;
+        }
+        count += flat.size();
+    }
 
+    if (count > 0) {
         // Remove loose object files
-        auto objects_dir = inner_->path / "objects";
+        auto objects_dir = inner.path / "objects";
         for (auto& oid : collector.oids) {
             char hex[GIT_OID_HEXSZ + 1];
             git_oid_tostr(hex, sizeof(hex), &oid);
@@ -270,42 +317,65 @@ size_t GitStore::pack() {
     return count;
 }
 
+} // namespace maintenance
+
+size_t GitStore::pack() {
+    observe::Operation obs_op(*inner_, "GitStore::pack");
+    return maintenance::pack(*inner_);
+}
+
 size_t GitStore::gc() {
+    observe::Operation obs_op(*inner_, "GitStore::gc");
     return pack();
 }
 
 MirrorDiff GitStore::backup(const std::string& dest, const BackupOptions& opts) {
+    observe::Operation obs_op(*inner_, "GitStore::backup");
     return mirror::backup(inner_, dest, opts);
 }
 
 MirrorDiff GitStore::restore(const std::string& src, const RestoreOptions& opts) {
-    return mirror::restore(inner_, src, opts);
+    observe::Operation obs_op(*inner_, "GitStore::restore");
+    auto diff = mirror::restore(inner_, src, opts);
+    if (!opts.dry_run && !diff.in_sync()) {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        watch::notify(*inner_, "");
+    }
+    return diff;
 }
 
 void GitStore::bundle_export(const std::string& path,
                              const std::vector<std::string>& refs,
                              const std::map<std::string, std::string>& ref_map,
                              bool squash) {
+    observe::Operation obs_op(*inner_, "GitStore::bundle_export");
     mirror::bundle_export(inner_, path, refs, ref_map, squash);
 }
 
 void GitStore::bundle_import(const std::string& path,
                              const std::vector<std::string>& refs,
                              const std::map<std::string, std::string>& ref_map) {
+    observe::Operation obs_op(*inner_, "GitStore::bundle_import");
     mirror::bundle_import(inner_, path, refs, ref_map);
+    std::lock_guard<std::mutex> lk(inner_->mutex);
+    watch::notify(*inner_, "");
 }
 
 std::vector<uint8_t> GitStore::read_by_hash(const std::string& hash,
                                              size_t offset,
                                              size_t size) const {
+    observe::Operation obs_op(*inner_, "GitStore::read_by_hash");
     git_oid oid;
     if (git_oid_fromstr(&oid, hash.c_str()) != 0)
         throw InvalidHashError(hash);
 
     std::lock_guard<std::mutex> lk(inner_->mutex);
+    observe::PhaseTimer phase(Phase::BlobRead);
     git_blob* blob = nullptr;
     if (git_blob_lookup(&blob, inner_->repo, &oid) != 0)
         throw_git("git_blob_lookup");
+    observe::count(Counter::BlobLookups);
+    observe::count(Counter::BytesInflated, static_cast<uint64_t>(git_blob_rawsize(blob)));
 
     const void* raw = git_blob_rawcontent(blob);
     size_t rawsz = static_cast<size_t>(git_blob_rawsize(blob));
@@ -322,12 +392,43 @@ std::vector<uint8_t> GitStore::read_by_hash(const std::string& hash,
 }
 
 bool GitStore::has_hash(const std::string& hash) const {
-    try {
-        read_by_hash(hash, 0, 0);
-        return true;
-    } catch (...) {
+    observe::Operation obs_op(*inner_, "GitStore::has_hash");
+    git_oid oid;
+    if (hash.size() != GIT_OID_HEXSZ || git_oid_fromstr(&oid, hash.c_str()) != 0)
         return false;
+    std::lock_guard<std::mutex> lk(inner_->mutex);
+    return odb::absent_blobs(inner_->repo, {oid}).empty();
+}
+
+std::vector<std::string> GitStore::missing(const std::vector<std::string>& hashes) const {
+    observe::Operation obs_op(*inner_, "GitStore::missing");
+    std::vector<git_oid> oids;
+    std::vector<const std::string*> names;
+    std::unordered_set<std::string> seen;
+    for (const auto& h : hashes) {
+        git_oid oid;
+        if (h.size() != GIT_OID_HEXSZ || git_oid_fromstr(&oid, h.c_str()) != 0)
+            throw InvalidHashError(h);
+        if (!seen.insert(h).second) continue;
+        oids.push_back(oid);
+        names.push_back(&h);
+    }
+
+    // Other threads get the lock between chunks.
+    constexpr size_t kChunk = 4096;
+    std::vector<std::string> out;
+    for (size_t start = 0; start < oids.size(); start += kChunk) {
+        std::vector<git_oid> chunk(
+            oids.begin() + static_cast<std::ptrdiff_t>(start),
+            oids.begin() + static_cast<std::ptrdiff_t>(std::min(start + kChunk, oids.size())));
+        std::vector<size_t> gone;
+        {
+            std::lock_guard<std::mutex> lk(inner_->mutex);
+            gone = odb::absent_blobs(inner_->repo, chunk);
+        }
+        for (size_t i : gone) out.push_back(*names[start + i]);
     }
+    return out;
 }
 
 const std::filesystem::path& GitStore::path() const {
@@ -352,28 +453,15 @@ RefDict::RefDict(std::shared_ptr<GitStoreInner> inner,
 Fs RefDict::operator[](const std::string& name) { return get(name); }
 
 Fs RefDict::get(const std::string& name) {
+    observe::Operation obs_op(*inner_, "RefDict::get");
     std::string refname = prefix_ + name;
     std::lock_guard<std::mutex> lk(inner_->mutex);
 
-    git_reference* ref = nullptr;
-    if (git_reference_lookup(&ref, inner_->repo, refname.c_str()) != 0) {
-        throw KeyNotFoundError(name);
-    }
-
-    // Peel to commit
-    git_object* obj = nullptr;
-    int rc = git_reference_peel(&obj, ref, GIT_OBJECT_COMMIT);
-    git_reference_free(ref);
-    if (rc != 0) throw_git("git_reference_peel (commit)");
+    auto resolved = refcache::resolve(*inner_, refname);
+    if (!resolved) throw KeyNotFoundError(name);
 
-    std::string commit_hex = oid_hex(git_object_id(obj));
-    git_commit* commit = reinterpret_cast<git_commit*>(obj);
-
-    const git_oid* tid = git_commit_tree_id(commit);
-    std::string tree_hex = oid_hex(tid);
-    git_object_free(obj);
-
-    return Fs(inner_, commit_hex, tree_hex, name, writable_);
+    return Fs(inner_, std::move(resolved->commit_hex),
+              std::move(resolved->tree_hex), name, writable_);
 }
 
 Fs RefDict::set_and_get(const std::string& name, const Fs& fs) {
@@ -382,6 +470,7 @@ Fs RefDict::set_and_get(const std::string& name, const Fs& fs) {
 }
 
 void RefDict::set(const std::string& name, const Fs& fs) {
+    observe::Operation obs_op(*inner_, "RefDict::set");
     // Validate ref name
     paths::validate_ref_name(name);
 
@@ -399,34 +488,43 @@ void RefDict::set(const std::string& name, const Fs& fs) {
     if (!commit_hex) throw GitError("Fs has no commit");
 
     std::string refname = prefix_ + name;
-    std::lock_guard<std::mutex> lk(inner_->mutex);
-
-    git_reference* existing = nullptr;
-    bool ref_exists = (git_reference_lookup(&existing, inner_->repo,
-                                             refname.c_str()) == 0);
-    if (ref_exists) {
-        if (!writable_) {
-            git_reference_free(existing);
-            throw KeyExistsError("tag '" + name + "' already exists");
-        }
-        git_reference_free(existing);
-    }
 
     git_oid new_oid;
     if (git_oid_fromstr(&new_oid, commit_hex->c_str()) != 0)
         throw InvalidHashError(*commit_hex);
 
-    git_reference* out_ref = nullptr;
-    int rc = git_reference_create(&out_ref, inner_->repo,
-                                   refname.c_str(), &new_oid,
-                                   1 /*force*/, "refdict: set");
-    if (rc != 0) {
-        throw_git("git_reference_create");
-    }
-    git_reference_free(out_ref);
+    // The repo lock covers the reflog rewrite in enforce(), like every
+    // other ref update that trims it.
+    lock::with_repo_lock(inner_->path, [&]() {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+
+        git_reference* existing = nullptr;
+        bool ref_exists = (git_reference_lookup(&existing, inner_->repo,
+                                                 refname.c_str()) == 0);
+        if (ref_exists) {
+            if (!writable_) {
+                git_reference_free(existing);
+                throw KeyExistsError("tag '" + name + "' already exists");
+            }
+            git_reference_free(existing);
+        }
+
+        git_reference* out_ref = nullptr;
+        refcache::invalidate(*inner_, refname);
+        int rc = git_reference_create(&out_ref, inner_->repo,
+                                       refname.c_str(), &new_oid,
+                                       1 /*force*/, "refdict: set");
+        if (rc != 0) {
+            throw_git("git_reference_create");
+        }
+        git_reference_free(out_ref);
+        reflog::enforce(*inner_, refname);
+        watch::notify(*inner_, refname);
+    });
 }
 
 void RefDict::del(const std::string& name) {
+    observe::Operation obs_op(*inner_, "RefDict::del");
     std::string refname = prefix_ + name;
     std::lock_guard<std::mutex> lk(inner_->mutex);
 
@@ -434,14 +532,17 @@ void RefDict::del(const std::string& name) {
     if (git_reference_lookup(&ref, inner_->repo, refname.c_str()) != 0)
         throw KeyNotFoundError(name);
 
+    refcache::invalidate(*inner_, refname);
     int rc = git_reference_delete(ref);
     git_reference_free(ref);
     if (rc != 0) throw_git("git_reference_delete");
+    watch::notify(*inner_, refname);
 }
 
 bool RefDict::contains(const std::string& name) {
     std::string refname = prefix_ + name;
     std::lock_guard<std::mutex> lk(inner_->mutex);
+    if (refcache::is_cached(*inner_, refname)) return true;
     git_reference* ref = nullptr;
     bool found = (git_reference_lookup(&ref, inner_->repo, refname.c_str()) == 0);
     if (found) git_reference_free(ref);
@@ -519,34 +620,14 @@ void RefDict::set_current(const std::string& name) {
 }
 
 std::vector<ReflogEntry> RefDict::reflog(const std::string& name) {
+    return reflog(name, ReflogOptions{});
+}
+
+std::vector<ReflogEntry> RefDict::reflog(const std::string& name,
+                                         const ReflogOptions& opts) {
     std::string refname = prefix_ + name;
     std::lock_guard<std::mutex> lk(inner_->mutex);
-
-    git_reflog* rlog = nullptr;
-    if (git_reflog_read(&rlog, inner_->repo, refname.c_str()) != 0)
-        return {};
-
-    size_t n = git_reflog_entrycount(rlog);
-    std::vector<ReflogEntry> result;
-    result.reserve(n);
-
-    for (size_t i = 0; i < n; ++i) {
-        const git_reflog_entry* e = git_reflog_entry_byindex(rlog, i);
-        ReflogEntry re;
-        re.old_sha   = oid_hex(git_reflog_entry_id_old(e));
-        re.new_sha   = oid_hex(git_reflog_entry_id_new(e));
-        const git_signature* sig = git_reflog_entry_committer(e);
-        if (sig) {
-            re.committer = std::string(sig->name ? sig->name : "") +
-                           " <" + (sig->email ? sig->email : "") + ">";
-            re.timestamp = static_cast<uint64_t>(sig->when.time);
-        }
-        const char* msg = git_reflog_entry_message(e);
-        re.message = msg ? msg : "";
-        result.push_back(std::move(re));
-    }
-    git_reflog_free(rlog);
-    return result;
+    return reflog::read(inner_->path, refname, opts.skip.value_or(0), opts.limit);
 }
 
 } // namespace vost
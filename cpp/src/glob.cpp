@@ -3,11 +3,66 @@
 
 #include <algorithm>
 #include <filesystem>
-#include <sstream>
 
 namespace vost {
 namespace glob {
 
+namespace {
+
+/// Match the character class starting after '[' at `pi` against `ch`,
+/// advancing `pi` past the closing ']'.
+bool match_class(const std::string& pattern, size_t& pi, char ch) {
+    size_t plen = pattern.size();
+    bool negate = (pi < plen && pattern[pi] == '!');
+    if (negate) ++pi;
+    bool matched = false;
+    while (pi < plen && pattern[pi] != ']') {
+        if (pi + 2 < plen && pattern[pi + 1] == '-') {
+            if (ch >= pattern[pi] && ch <= pattern[pi + 2])
+                matched = true;
+            pi += 3;
+        } else {
+            if (ch == pattern[pi]) matched = true;
+            ++pi;
+        }
+    }
+    if (pi < plen) ++pi; // skip ']'
+    return matched != negate;
+}
+
+/// Step `pattern` over the literal `prefix` without crossing a `*`.
+/// Returns false on a mismatch; otherwise `pi` is where the pattern
+/// stands after the prefix and `star` says a `*` stopped the walk early.
+bool step_prefix(const std::string& pattern, const std::string& prefix,
+                 size_t& pi, bool& star) {
+    size_t plen = pattern.size();
+    pi = 0;
+    star = false;
+    for (size_t ni = 0; ni < prefix.size(); ++ni) {
+        if (pi == plen) return false;
+        char pc = pattern[pi];
+        if (pc == '*') { star = true; return true; }
+        if (pc == '?') {
+            ++pi;
+        } else if (pc == '[') {
+            ++pi;
+            if (!match_class(pattern, pi, prefix[ni])) return false;
+        } else {
+            if (pc != prefix[ni]) return false;
+            ++pi;
+        }
+    }
+    return true;
+}
+
+/// glob_match's leading-dot rule, applied to a path starting with `prefix`.
+bool dot_allows(const std::string& pattern, const std::string& prefix) {
+    return prefix.empty() || prefix[0] != '.' ||
+           (!pattern.empty() && pattern[0] == '.') || pattern == "**";
+}
+
+} // anonymous namespace
+
 /// Match a single pattern segment against a name.
 /// Supports `*` (any sequence, not matching leading `.`),
 ///          `?` (any single char, not matching leading `.`),
@@ -34,22 +89,7 @@ bool fnmatch(const std::string& pattern, const std::string& name) {
         } else if (pc == '[') {
             // Character class
             ++pi;
-            bool negate = (pi < plen && pattern[pi] == '!');
-            if (negate) ++pi;
-            bool matched = false;
-            char ch = name[ni];
-            while (pi < plen && pattern[pi] != ']') {
-                if (pi + 2 < plen && pattern[pi + 1] == '-') {
-                    if (ch >= pattern[pi] && ch <= pattern[pi + 2])
-                        matched = true;
-                    pi += 3;
-                } else {
-                    if (ch == pattern[pi]) matched = true;
-                    ++pi;
-                }
-            }
-            if (pi < plen) ++pi; // skip ']'
-            if (matched == negate) return false;
+            if (!match_class(pattern, pi, name[ni])) return false;
             ++ni;
         } else {
             if (pc != name[ni]) return false;
@@ -75,6 +115,38 @@ bool glob_match(const std::string& pattern, const std::string& name) {
     return fnmatch(pattern, name);
 }
 
+bool may_match_under(const std::string& pattern, const std::string& prefix) {
+    if (!dot_allows(pattern, prefix)) return false;
+    size_t pi;
+    bool star;
+    if (!step_prefix(pattern, prefix, pi, star)) return false;
+    return star || pi < pattern.size(); // something left for a non-empty rest
+}
+
+bool matches_all_under(const std::string& pattern, const std::string& prefix) {
+    if (!dot_allows(pattern, prefix)) return false;
+    size_t pi;
+    bool star;
+    if (!step_prefix(pattern, prefix, pi, star) || star) return false;
+    if (pi == pattern.size()) return false;
+    return pattern.find_first_not_of('*', pi) == std::string::npos;
+}
+
+bool can_match_basename(const std::string& pattern) {
+    bool in_class = false;
+    for (char c : pattern) {
+        if (in_class) { if (c == ']') in_class = false; continue; }
+        if (c == '[') in_class = true;
+        else if (c == '/') return false;
+    }
+    return true;
+}
+
+std::string literal_dir(const std::string& pattern) {
+    auto slash = pattern.rfind('/', pattern.find_first_of("*?["));
+    return slash == std::string::npos ? "" : pattern.substr(0, slash);
+}
+
 } // namespace glob
 
 // ---------------------------------------------------------------------------
@@ -133,14 +205,7 @@ void disk_glob_recursive(const std::filesystem::path& root,
 std::vector<std::string> disk_glob(const std::string& pattern,
                                     const std::string& root) {
     // Split pattern by '/'
-    std::vector<std::string> segments;
-    {
-        std::istringstream iss(pattern);
-        std::string seg;
-        while (std::getline(iss, seg, '/')) {
-            if (!seg.empty()) segments.push_back(seg);
-        }
-    }
+    auto segments = paths::split(pattern);
     if (segments.empty()) return {};
 
     std::filesystem::path root_path(root);
@@ -3,28 +3,89 @@
 /// Not part of the public API.
 
 #include "vost/error.h"
+#include "vost/observe.h"
 #include "vost/types.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <functional>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 struct git_repository;
+struct git_blob;
+struct git_oid;
 
 namespace vost {
 
+struct GitStoreInner;
+
 // ---------------------------------------------------------------------------
 // paths — path normalization and validation
 // ---------------------------------------------------------------------------
 
 namespace paths {
 
-std::string normalize(const std::string& path);
+/// Iterates the non-empty '/'-separated segments of a path as views into
+/// it, without allocating.  "a//b/" yields "a", "b".
+class Segments {
+public:
+    class iterator {
+    public:
+        iterator(std::string_view path, size_t pos) : path_(path), pos_(pos) {
+            skip();
+        }
+        std::string_view operator*() const {
+            return path_.substr(pos_, end_ - pos_);
+        }
+        iterator& operator++() {
+            pos_ = end_;
+            skip();
+            return *this;
+        }
+        bool operator!=(const iterator& o) const { return pos_ != o.pos_; }
+        bool operator==(const iterator& o) const { return pos_ == o.pos_; }
+
+    private:
+        void skip() {
+            while (pos_ < path_.size() && path_[pos_] == '/') ++pos_;
+            end_ = std::min(path_.find('/', pos_), path_.size());
+        }
+        std::string_view path_;
+        size_t           pos_;
+        size_t           end_ = 0;
+    };
+
+    explicit Segments(std::string_view path) : path_(path) {}
+    iterator begin() const { return {path_, 0}; }
+    iterator end() const { return {path_, path_.size()}; }
+
+private:
+    std::string_view path_;
+};
+
+/// Split into owned segments (for glob patterns and other callers that
+/// keep them).
+std::vector<std::string> split(std::string_view path);
+
+/// True if `path` is already in normalized form ("" or "a/b", no empty,
+/// "." or ".." segments).
+bool is_normalized(std::string_view path);
+
+std::string normalize(std::string_view path);
+
+/// Normalize without allocating when `path` is already normalized: returns
+/// `path` itself, or a view of `buf` holding the normalized form.
+std::string_view normalize_view(std::string_view path, std::string& buf);
+
 void        validate_ref_name(const std::string& name);
-bool        is_root(const std::string& path);
+bool        is_root(std::string_view path);
 std::string format_message(const std::string& op,
                            const std::optional<std::string>& msg);
 
@@ -41,51 +102,431 @@ void with_repo_lock(const std::filesystem::path& gitdir,
 
 } // namespace lock
 
+// ---------------------------------------------------------------------------
+// refcache — in-process cache of resolved refs
+// ---------------------------------------------------------------------------
+
+/// Cheap identity of a file's current contents (stat fields).
+struct FileStamp {
+    bool     exists = false;
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    uint64_t size = 0;
+    int64_t  mtime_ns = 0;
+    int64_t  ctime_ns = 0;
+
+    bool operator==(const FileStamp& o) const {
+        return exists == o.exists && dev == o.dev && ino == o.ino &&
+               size == o.size && mtime_ns == o.mtime_ns &&
+               ctime_ns == o.ctime_ns;
+    }
+};
+
+/// Resolved refs keyed by full ref name.  Guarded by GitStoreInner::mutex.
+struct RefCache {
+    struct Entry {
+        std::string commit_hex;
+        std::string tree_hex;
+        FileStamp   loose;   ///< Stamp of <gitdir>/<refname> when resolved.
+        FileStamp   packed;  ///< Stamp of <gitdir>/packed-refs when resolved.
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+};
+
+namespace refcache {
+
+struct ResolvedRef {
+    std::string commit_hex;
+    std::string tree_hex;
+};
+
+FileStamp stamp_file(const std::filesystem::path& p);
+
+/// Resolve a full ref name to its peeled commit and tree, or nullopt if the
+/// ref does not exist.  Caller must hold inner.mutex.
+std::optional<ResolvedRef> resolve(GitStoreInner& inner,
+                                   const std::string& refname);
+
+/// True if the ref has a cache entry that is still valid on disk.
+bool is_cached(GitStoreInner& inner, const std::string& refname);
+
+/// Record a ref update made by this process.  Caller must hold inner.mutex.
+void store(GitStoreInner& inner, const std::string& refname,
+           const std::string& commit_hex, const std::string& tree_hex);
+
+/// Drop a single entry.  Caller must hold inner.mutex.
+void invalidate(GitStoreInner& inner, const std::string& refname);
+
+/// Drop every entry.  Caller must hold inner.mutex.
+void clear(GitStoreInner& inner);
+
+} // namespace refcache
+
+// ---------------------------------------------------------------------------
+// reflog — tail reads and retention
+// ---------------------------------------------------------------------------
+
+namespace reflog {
+
+/// Visit reflog entries of `refname`, newest first, until `fn` returns false.
+/// Reads the log file backwards, so cost scales with the entries visited.
+void for_each_recent(const std::filesystem::path& gitdir,
+                     const std::string& refname,
+                     const std::function<bool(ReflogEntry&&)>& fn);
+
+/// Newest-first page of reflog entries.
+std::vector<ReflogEntry> read(const std::filesystem::path& gitdir,
+                              const std::string& refname,
+                              size_t skip,
+                              std::optional<size_t> limit);
+
+/// Apply inner.reflog_retention after `refname` was updated.
+/// Caller must hold inner.mutex (and the repo lock).
+void enforce(GitStoreInner& inner, const std::string& refname);
+
+} // namespace reflog
+
+// ---------------------------------------------------------------------------
+// maintenance — object store housekeeping
+// ---------------------------------------------------------------------------
+
+namespace maintenance {
+
+/// Pack all objects into a new packfile and remove loose copies.
+/// Takes inner.mutex itself.  Returns the number of objects packed.
+size_t pack(GitStoreInner& inner);
+
+} // namespace maintenance
+
+// ---------------------------------------------------------------------------
+// watch — in-process wakeups for RefWatch subscriptions
+// ---------------------------------------------------------------------------
+
+namespace watch {
+
+/// Wake every live RefWatch interested in `refname` (empty = all).
+/// Caller must hold inner.mutex.
+void notify(GitStoreInner& inner, const std::string& refname);
+
+} // namespace watch
+
+// ---------------------------------------------------------------------------
+// observe — Observer plumbing
+// ---------------------------------------------------------------------------
+
+namespace observe {
+
+/// The outermost observed operation running on a thread.
+struct Frame {
+    std::shared_ptr<Observer> observer;
+    OperationStats            stats;
+};
+
+/// Frame of the calling thread's observed operation, or null.
+extern thread_local Frame* current;
+
+/// steady_clock time in nanoseconds.
+uint64_t now_ns();
+
+/// Scope of a public operation.  Reports to the store's observer on exit,
+/// unless an outer operation on this thread is already being observed.
+class Operation {
+public:
+    Operation(const GitStoreInner& inner, const char* name);
+    ~Operation() { if (frame_) finish(); }
+    Operation(const Operation&) = delete;
+    Operation& operator=(const Operation&) = delete;
+
+private:
+    void finish();
+    std::unique_ptr<Frame> frame_;
+    int uncaught_ = 0;
+};
+
+/// Times a phase of the current operation; free when nothing is observed.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : frame_(current), phase_(phase) {
+        if (frame_) start_ = now_ns();
+    }
+    ~PhaseTimer() { stop(); }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    /// End the phase early.  Idempotent.
+    void stop() {
+        if (frame_) finish();
+        frame_ = nullptr;
+    }
+
+private:
+    void finish();
+    Frame*   frame_;
+    Phase    phase_;
+    uint64_t start_ = 0;
+};
+
+/// Add @p n to a counter of the current operation, if observed.
+inline void count(Counter c, uint64_t n = 1) {
+    if (Frame* f = current) f->stats.counters[static_cast<size_t>(c)] += n;
+}
+
+} // namespace observe
+
+// ---------------------------------------------------------------------------
+// sha1 — SHA-1 for HashBackend::Fast
+// ---------------------------------------------------------------------------
+
+namespace sha1 {
+
+/// True if the CPU's SHA extensions are in use.
+bool accelerated();
+
+/// Incremental SHA-1 (no collision detection).
+class Context {
+public:
+    Context();
+    void update(const void* data, size_t size);
+    void finish(uint8_t out[20]);
+
+private:
+    uint32_t state_[5];
+    uint8_t  buf_[64];
+    size_t   buffered_ = 0;
+    uint64_t total_ = 0;
+};
+
+} // namespace sha1
+
+// ---------------------------------------------------------------------------
+// odb — blob ingest
+// ---------------------------------------------------------------------------
+
+namespace odb {
+
+/// Stores blobs the way a store's OpenOptions::hash and
+/// compression_policy ask.  Safe with no policy goes through libgit2.
+/// Otherwise blobs are hashed first (SHA1DC for Safe, sha1::Context for
+/// Fast), objects the odb already has are skipped, and new ones are written
+/// as loose objects here (temp file then rename) at the policy's level for
+/// the path, or `level`, in the same format git writes.
+/// Callers hold the store mutex.
+struct BlobWriter {
+    git_repository*          repo;
+    HashBackend              hash   = HashBackend::Safe;
+    int                      level  = 1;
+    const CompressionPolicy* policy = nullptr;
+
+    explicit BlobWriter(git_repository* r) : repo(r) {}
+    explicit BlobWriter(const GitStoreInner& inner);
+
+    /// Store `data`; `path` (the blob's path in the tree, if any) feeds
+    /// the compression policy.
+    void write(const uint8_t* data, size_t size, git_oid* out,
+               std::string_view path = {}) const;
+
+    /// zlib level for a blob at `path` whose content starts with `head`.
+    int level_for(std::string_view path, const uint8_t* head, size_t n) const;
+};
+
+/// True if `name` has the extension of an already-compressed format.
+bool compressed_extension(std::string_view name);
+
+/// Shannon entropy of the bytes in `p`, in bits per byte (0-8).
+double byte_entropy(const uint8_t* p, size_t n);
+
+/// True if a sample of at least `policy.probe_bytes` looks incompressible.
+bool probe_incompressible(const CompressionPolicy& policy, const uint8_t* p, size_t n);
+
+/// Blob id of `data` under `hash`, without storing anything.
+void hash_blob(HashBackend hash, const uint8_t* data, size_t size, git_oid* out);
+
+/// Blob id of the file at `path` under `hash`, without storing anything.
+/// @throws IoError if the file cannot be read.
+void hash_file(HashBackend hash, const std::filesystem::path& path, git_oid* out);
+
+/// Streams a blob of known size into a loose object at zlib `level`.
+/// The id is computed with sha1::Context unless the caller passes the one
+/// it already has in `known`.  Destroying it before finish() discards the
+/// temp file.
+class LooseWriter {
+public:
+    LooseWriter(const BlobWriter& writer, uint64_t size, int level,
+                const git_oid* known = nullptr);
+    ~LooseWriter();
+    LooseWriter(const LooseWriter&) = delete;
+    LooseWriter& operator=(const LooseWriter&) = delete;
+
+    void write(const uint8_t* data, size_t size);
+
+    /// Move the object into place (dropping it if the odb already has it).
+    /// @throws IoError if fewer or more than `size` bytes were written.
+    void finish(git_oid* out);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Indices of the `oids` the odb does not have as blobs, checked with one
+/// git_odb_expand_ids call.  Callers hold the store mutex.
+std::vector<size_t> absent_blobs(git_repository* repo, const std::vector<git_oid>& oids);
+
+/// `hash` as a lowercase 40-char hex id.
+/// @throws InvalidHashError if it is not one.
+std::string canonical_hex(const std::string& hash);
+
+/// Check that every (path, (oid hex, mode)) entry names a blob in the odb,
+/// as WriteEntry::from_oid / Batch::write_oid promise.  Callers hold the
+/// store mutex.
+/// @throws NotFoundError naming the first entry whose blob is missing.
+void require_blobs(git_repository* repo,
+                   const std::vector<std::pair<std::string,
+                                               std::pair<std::string, uint32_t>>>& entries);
+
+/// Leading content of the loose blob `oid`: up to `n` bytes after the
+/// object header, and whether its zlib stream starts with a stored (level
+/// 0) block.  Returns false if the object is not loose or not a blob.
+bool probe_loose(git_repository* repo, const git_oid& oid, size_t n,
+                 std::vector<uint8_t>& head, bool& stored);
+
+/// Write `objects` (id, zlib level) into a new pack under objects/pack
+/// without delta compression, indexed with git_indexer.
+void write_flat_pack(git_repository* repo,
+                     const std::vector<std::pair<git_oid, int>>& objects);
+
+} // namespace odb
+
 // ---------------------------------------------------------------------------
 // tree — libgit2-based tree operations
 // ---------------------------------------------------------------------------
 
 namespace tree {
 
+/// Entry found by find().  `oid` holds the raw 20 bytes of the git_oid, so
+/// lookups on hot read paths never format hex strings.
+struct Entry {
+    unsigned char oid[20];
+    uint32_t      mode;
+
+    std::string oid_hex() const;
+};
+
+/// Entry at `norm_path` (a normalized path; "" is the root tree), or
+/// nullopt if missing.  Allocation-free.
+std::optional<Entry>
+find(git_repository* repo,
+     const std::string& tree_oid_hex,
+     std::string_view norm_path);
+
 std::optional<std::pair<std::string, uint32_t>>
 lookup(git_repository* repo,
        const std::string& tree_oid_hex,
-       const std::string& norm_path);
+       std::string_view norm_path);
+
+/// A loaded blob, freed on destruction.  Lets readers copy straight from
+/// libgit2's buffer into whatever result type they return.
+class BlobRef {
+public:
+    explicit BlobRef(git_blob* blob = nullptr) : blob_(blob) {}
+    ~BlobRef();
+    BlobRef(BlobRef&& o) noexcept : blob_(o.blob_) { o.blob_ = nullptr; }
+    BlobRef& operator=(BlobRef&&) = delete;
+    BlobRef(const BlobRef&) = delete;
+
+    const uint8_t* data() const;
+    size_t         size() const;
+
+private:
+    git_blob* blob_;
+};
+
+/// Load the blob at `norm_path`.
+/// @throws NotFoundError / IsADirectoryError.
+BlobRef load_blob(git_repository* repo,
+                  const std::string& tree_oid_hex,
+                  std::string_view norm_path);
+
+/// Load the blob `blob_oid_hex` directly, without a path lookup.
+BlobRef load_blob_by_oid(git_repository* repo, const std::string& blob_oid_hex);
 
 std::vector<uint8_t>
 read_blob(git_repository* repo,
           const std::string& tree_oid_hex,
-          const std::string& norm_path);
+          std::string_view norm_path);
 
 std::vector<WalkEntry>
 list_tree(git_repository* repo,
           const std::string& tree_oid_hex,
-          const std::string& norm_path);
+          std::string_view norm_path);
+
+/// Callbacks that narrow a walk_tree.  Paths are relative to the walked
+/// subtree.  `descend(dir)` returning false skips that subtree without
+/// reading it; `keep(path)` returning false drops that leaf.
+struct WalkPrune {
+    std::function<bool(const std::string&)> descend;
+    std::function<bool(const std::string&)> keep;
+};
 
 std::vector<std::pair<std::string, WalkEntry>>
 walk_tree(git_repository* repo,
           const std::string& tree_oid_hex,
-          const std::string& norm_path);
+          std::string_view norm_path,
+          const WalkPrune* prune = nullptr);
 
 std::vector<WalkDirEntry>
 walk_tree_dirs(git_repository* repo,
                const std::string& tree_oid_hex,
-               const std::string& norm_path);
+               std::string_view norm_path);
 
 uint32_t count_subdirs(git_repository* repo,
                         const std::string& tree_oid_hex);
 
+/// Size of the object `oid` read from its header, without inflating it.
+uint64_t blob_size(git_repository* repo, const git_oid& oid);
+
 /// List immediate children of a tree given its OID hex.
 std::vector<WalkEntry>
 list_tree_by_oid(git_repository* repo,
                  const std::string& tree_oid_hex);
 
+/// Apply `writes` (content still to be stored, through `blobs` when
+/// given), `removes` and `stored` (path -> (blob oid hex, mode) for blobs
+/// already in the odb) to a tree.
 std::string rebuild_tree(
     git_repository* repo,
     const std::string& base_tree_oid_hex,
     const std::vector<std::pair<std::string,
                                 std::pair<std::vector<uint8_t>, uint32_t>>>& writes,
-    const std::vector<std::string>& removes);
+    const std::vector<std::string>& removes,
+    const std::vector<std::pair<std::string,
+                                std::pair<std::string, uint32_t>>>& stored = {},
+    const odb::BlobWriter* blobs = nullptr);
+
+/// Three-way tree merge; see Fs::merge.  Returns the merged tree's hex and
+/// appends conflicting paths to `conflicts`.
+std::string merge_trees(git_repository* repo,
+                        const std::string& base_tree_oid_hex,
+                        const std::string& ours_tree_oid_hex,
+                        const std::string& theirs_tree_oid_hex,
+                        std::optional<MergeFavor> favor,
+                        std::vector<MergeConflict>& conflicts);
+
+/// A path whose leaf entry (blob, executable or symlink) differs between
+/// two trees.  nullopt means the path has no leaf entry on that side.
+struct TreeChange {
+    std::string              path;
+    std::optional<WalkEntry> old_entry;
+    std::optional<WalkEntry> new_entry;
+};
+
+/// Leaf-level differences from `old_tree_oid_hex` to `new_tree_oid_hex`
+/// ("" = empty tree), in path order.  Deletions under a path come before
+/// a new entry at that path, so changes can be applied in order.
+std::vector<TreeChange> diff_trees(git_repository* repo,
+                                   const std::string& old_tree_oid_hex,
+                                   const std::string& new_tree_oid_hex);
 
 std::string write_commit(git_repository* repo,
                           const std::string& tree_oid_hex,
@@ -93,6 +534,12 @@ std::string write_commit(git_repository* repo,
                           const Signature& sig,
                           const std::string& message);
 
+/// Re-create a commit on new parents, keeping tree, author, committer
+/// and message.  Returns the new commit's OID hex.
+std::string rewrite_commit(git_repository* repo,
+                           const std::string& commit_oid_hex,
+                           const std::vector<std::string>& parent_oids);
+
 std::string tree_oid_for_commit(git_repository* repo,
                                  const std::string& commit_oid_hex);
 
@@ -122,6 +569,22 @@ bool fnmatch(const std::string& pattern, const std::string& name);
 /// Match a glob pattern against a name (dot-awareness).
 bool glob_match(const std::string& pattern, const std::string& name);
 
+/// True if glob_match(pattern, prefix + rest) can hold for some non-empty
+/// `rest`.  Conservative: may say true when no such path exists.
+bool may_match_under(const std::string& pattern, const std::string& prefix);
+
+/// True if glob_match(pattern, prefix + rest) holds for every non-empty
+/// `rest`.  Conservative: may say false when it does.
+bool matches_all_under(const std::string& pattern, const std::string& prefix);
+
+/// False if `pattern` has a `/` outside a character class, so it can only
+/// match a full path, never a bare filename.
+bool can_match_basename(const std::string& pattern);
+
+/// The literal directory part of `pattern` before any wildcard
+/// ("docs/api/*.md" -> "docs/api"), or "".
+std::string literal_dir(const std::string& pattern);
+
 } // namespace glob
 
 // ---------------------------------------------------------------------------
@@ -130,18 +593,107 @@ bool glob_match(const std::string& pattern, const std::string& name);
 
 namespace copy {
 
+/// include/exclude patterns compiled for use during a traversal, so
+/// subtrees that cannot hold a match are never read.  Paths are relative
+/// to the copy source, as for matches_filters.
+class PathFilter {
+public:
+    PathFilter(const std::optional<std::vector<std::string>>& include,
+               const std::optional<std::vector<std::string>>& exclude);
+
+    /// False when there are no patterns and every path passes.
+    bool active() const { return include_.has_value() || exclude_.has_value(); }
+
+    /// matches_filters() for a leaf path.
+    bool matches(const std::string& path) const;
+
+    /// False if no path under directory `dir` can pass.
+    bool may_contain(const std::string& dir) const;
+
+    /// Directories a walk needs to start from ("" = the whole source),
+    /// from the literal prefixes of the include patterns.  No entry is
+    /// below another.
+    const std::vector<std::string>& roots() const { return roots_; }
+
+private:
+    std::optional<std::vector<std::string>> include_;
+    std::optional<std::vector<std::string>> exclude_;
+    bool                                    include_any_dir_ = false;
+    std::vector<std::string>                roots_;
+};
+
 /// Walk a local directory recursively, returning relative paths.
+/// Directories `filter` rules out are not entered.
 std::vector<std::string>
-disk_walk(const std::filesystem::path& root);
+disk_walk(const std::filesystem::path& root, const PathFilter* filter = nullptr);
 
 /// Check if a relative path matches include/exclude filter sets.
 bool matches_filters(const std::string& path,
                      const std::optional<std::vector<std::string>>& include,
                      const std::optional<std::vector<std::string>>& exclude);
 
+/// tree::walk_tree of `norm_path` keeping only leaves that pass `filter`.
+/// Starts at the filter's roots and skips subtrees it rules out, so the
+/// work follows the size of the match rather than of the subtree.
+/// @throws NotFoundError / NotADirectoryError as walk_tree does.
+std::vector<std::pair<std::string, WalkEntry>>
+walk_filtered(git_repository* repo,
+              const std::string& tree_oid_hex,
+              const std::string& norm_path,
+              const PathFilter& filter);
+
 /// Detect git mode from a local file's metadata.
 uint32_t mode_from_disk(const std::filesystem::path& p);
 
+/// A file already in the store, keyed by its path relative to the copy
+/// destination.  `size` is filled in by read_sizes().
+struct Stored {
+    std::string oid;
+    uint32_t    mode;
+    std::optional<uint64_t> size;
+};
+
+/// Fill Stored::size for every entry that also appears in `disk_files`,
+/// reading object headers in one pass under the store lock.
+void read_sizes(GitStoreInner& inner,
+                std::map<std::string, Stored>& existing,
+                const std::vector<std::string>& disk_files);
+
+/// True if the local file `p` (of git mode `mode`) has the same content
+/// and mode as `stored`.  A size mismatch answers without hashing; only
+/// same-size files are hashed, streamed from disk, with `hash`.
+bool unchanged(const std::filesystem::path& p, uint32_t mode,
+               const Stored& stored, HashBackend hash = HashBackend::Safe);
+
+/// True if `filter` excludes `rel` or any directory above it.
+bool excluded(const ExcludeFilter& filter, const std::string& rel);
+
+/// Replace `path` with a file (or symlink, for MODE_LINK) holding `data`.
+/// The content is written to a temporary next to `path` and renamed over
+/// it, so readers see either the old or the new file, never a partial one.
+void replace_file(const std::filesystem::path& path,
+                  const std::vector<uint8_t>& data, uint32_t mode);
+
+/// Path of blob `oid_hex` (checked out with `mode`) in the blob cache
+/// directory `cache`, storing it there first if it is missing.  Cached
+/// files are read-only; executables are cached apart from plain files.
+std::filesystem::path cache_blob(GitStoreInner& inner,
+                                 const std::filesystem::path& cache,
+                                 const std::string& oid_hex, uint32_t mode);
+
+/// Atomically replace `path` with a reflink, hard link or copy of the
+/// cache file `cached`, as `link` allows.
+void link_from_cache(const std::filesystem::path& cached,
+                     const std::filesystem::path& path, CacheLink link);
+
+/// Remove `path` if it is a hard link shared with other names (such as a
+/// blob cache entry), so writing to it cannot change the others.
+void unshare(const std::filesystem::path& path);
+
+/// Remove empty directories from `dir` up to (not including) `root`.
+void prune_empty_dirs(const std::filesystem::path& root,
+                      std::filesystem::path dir);
+
 } // namespace copy
 
 } // namespace vost
@@ -1,6 +1,7 @@
 #include "vost/mirror.h"
 #include "vost/gitstore.h"
 #include "vost/error.h"
+#include "internal.h"
 
 #include <git2.h>
 
@@ -365,6 +366,7 @@ void bundle_export_impl(git_repository* repo, const std::string& path,
     // Build packfile containing all commits and their objects.
     // Use revwalk + insert_walk to include full ancestry (insert_commit
     // only adds a single commit and its tree, not parent commits).
+    observe::PhaseTimer pack_write(Phase::PackWrite);
     git_packbuilder* pb = nullptr;
     if (git_packbuilder_new(&pb, repo) != 0)
         throw_git("git_packbuilder_new");
@@ -402,6 +404,7 @@ void bundle_export_impl(git_repository* repo, const std::string& path,
         throw_git("git_packbuilder_write_buf");
     }
     git_packbuilder_free(pb);
+    pack_write.stop();
 
     // Build bundle v2 header (use destination names if rename map provided,
     // and squashed OIDs if squash is enabled)
@@ -505,6 +508,7 @@ void bundle_import_impl(git_repository* repo, const std::string& path,
     std::filesystem::path odb_pack = std::filesystem::path(repo_path_str) / "objects" / "pack";
     std::filesystem::create_directories(odb_pack);
 
+    observe::PhaseTimer pack_index(Phase::PackIndex);
     git_indexer* idx = nullptr;
 #if LIBGIT2_VER_MAJOR > 1 || (LIBGIT2_VER_MAJOR == 1 && LIBGIT2_VER_MINOR >= 4)
     git_indexer_options idx_opts = GIT_INDEXER_OPTIONS_INIT;
@@ -524,6 +528,7 @@ void bundle_import_impl(git_repository* repo, const std::string& path,
         throw_git("git_indexer_commit");
     }
     git_indexer_free(idx);
+    pack_index.stop();
 
     // Set refs (apply rename map if provided)
     for (const auto& [name, sha] : refs_to_import) {
@@ -629,7 +634,9 @@ void mirror_push(git_repository* repo, const std::string& url,
     git_push_options push_opts;
     git_push_options_init(&push_opts, GIT_PUSH_OPTIONS_VERSION);
 
+    observe::PhaseTimer transfer(Phase::Transfer);
     int rc = git_remote_push(remote, &arr, &push_opts);
+    transfer.stop();
     git_remote_free(remote);
     if (rc != 0) throw_git("git_remote_push");
 }
@@ -666,7 +673,9 @@ void targeted_push(git_repository* repo, const std::string& url,
     git_push_options push_opts;
     git_push_options_init(&push_opts, GIT_PUSH_OPTIONS_VERSION);
 
+    observe::PhaseTimer transfer(Phase::Transfer);
     int rc = git_remote_push(remote, &arr, &push_opts);
+    transfer.stop();
     git_remote_free(remote);
     if (rc != 0) throw_git("git_remote_push");
 }
@@ -714,7 +723,9 @@ void additive_fetch(git_repository* repo, const std::string& url,
     git_fetch_options fetch_opts;
     git_fetch_options_init(&fetch_opts, GIT_FETCH_OPTIONS_VERSION);
 
+    observe::PhaseTimer transfer(Phase::Transfer);
     int rc = git_remote_fetch(remote, &arr, &fetch_opts, nullptr);
+    transfer.stop();
     git_remote_free(remote);
     if (rc != 0) throw_git("git_remote_fetch");
 
@@ -835,6 +846,7 @@ MirrorDiff restore(const std::shared_ptr<GitStoreInner>& inner,
     bool use_bundle = opts.format == "bundle" || is_bundle_path(src);
 
     std::lock_guard<std::mutex> lk(inner->mutex);
+    if (!opts.dry_run) refcache::clear(*inner);
 
     // ref_map takes precedence over refs
     if (!opts.ref_map.empty()) {
@@ -941,6 +953,7 @@ void bundle_import(const std::shared_ptr<GitStoreInner>& inner,
                    const std::vector<std::string>& refs,
                    const std::map<std::string, std::string>& ref_map) {
     std::lock_guard<std::mutex> lk(inner->mutex);
+    refcache::clear(*inner);
     if (!ref_map.empty()) {
         // Parse bundle to get its refs for resolving the map
         std::ifstream in_file(path, std::ios::binary);
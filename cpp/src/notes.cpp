@@ -430,6 +430,8 @@ void NoteNamespace::commit_note_tree(const std::string& new_tree_hex,
         }
         if (out_ref) git_reference_free(out_ref);
         if (rc != 0) throw_git("notes ref update");
+        reflog::enforce(*inner_, ref_name_);
+        watch::notify(*inner_, ref_name_);
     });
 }
 
@@ -0,0 +1,100 @@
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <chrono>
+#include <exception>
+
+namespace vost {
+
+const char* phase_name(Phase phase) {
+    switch (phase) {
+        case Phase::LockWait:    return "lock_wait";
+        case Phase::CasCheck:    return "cas_check";
+        case Phase::RebuildTree: return "rebuild_tree";
+        case Phase::BlobWrite:   return "blob_write";
+        case Phase::WriteCommit: return "write_commit";
+        case Phase::RefUpdate:   return "ref_update";
+        case Phase::TreeLookup:  return "tree_lookup";
+        case Phase::TreeWalk:    return "tree_walk";
+        case Phase::BlobRead:    return "blob_read";
+        case Phase::PackWrite:   return "pack_write";
+        case Phase::PackIndex:   return "pack_index";
+        case Phase::Transfer:    return "transfer";
+    }
+    return "unknown";
+}
+
+const char* counter_name(Counter counter) {
+    switch (counter) {
+        case Counter::TreeLookups:   return "tree_lookups";
+        case Counter::BlobLookups:   return "blob_lookups";
+        case Counter::BytesInflated: return "bytes_inflated";
+        case Counter::BlobsWritten:  return "blobs_written";
+        case Counter::BytesWritten:  return "bytes_written";
+    }
+    return "unknown";
+}
+
+namespace observe {
+
+thread_local Frame* current = nullptr;
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Operation::Operation(const GitStoreInner& inner, const char* name) {
+    if (!inner.observed.load(std::memory_order_relaxed) || current) return;
+    auto obs = std::atomic_load(&inner.observer);
+    if (!obs) return;
+    frame_ = std::make_unique<Frame>();
+    frame_->observer = std::move(obs);
+    frame_->stats.operation = name;
+    frame_->stats.start_ns = now_ns();
+    uncaught_ = std::uncaught_exceptions();
+    current = frame_.get();
+}
+
+void Operation::finish() {
+    current = nullptr;
+    auto& st = frame_->stats;
+    st.duration_ns = now_ns() - st.start_ns;
+    st.failed = std::uncaught_exceptions() > uncaught_;
+    try {
+        frame_->observer->on_operation(st);
+    } catch (...) {
+        // Observers must not break the operation they are observing.
+    }
+}
+
+void PhaseTimer::finish() {
+    uint64_t dur = now_ns() - start_;
+    frame_->stats.phase_ns[static_cast<size_t>(phase_)] += dur;
+    try {
+        frame_->observer->on_phase(frame_->stats.operation, phase_, start_, dur);
+    } catch (...) {
+    }
+}
+
+} // namespace observe
+
+// ---------------------------------------------------------------------------
+// GitStore registration
+// ---------------------------------------------------------------------------
+
+void GitStore::set_observer(std::shared_ptr<Observer> observer) {
+    if (observer) {
+        std::atomic_store(&inner_->observer, std::move(observer));
+        inner_->observed.store(true, std::memory_order_relaxed);
+    } else {
+        inner_->observed.store(false, std::memory_order_relaxed);
+        std::atomic_store(&inner_->observer, std::shared_ptr<Observer>());
+    }
+}
+
+std::shared_ptr<Observer> GitStore::observer() const {
+    return std::atomic_load(&inner_->observer);
+}
+
+} // namespace vost
@@ -0,0 +1,500 @@
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <git2.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifdef __unix__
+#  include <unistd.h>
+#endif
+
+namespace vost {
+namespace odb {
+
+// ---------------------------------------------------------------------------
+// Loose objects
+// ---------------------------------------------------------------------------
+//
+// A loose object is zlib("blob <size>\0" + content) at
+// objects/<2 hex>/<38 hex>.  HashBackend::Fast and compression policies
+// write them here rather than through git_odb_write, which would hash the
+// content again with SHA1DC and always deflate at libgit2's level.
+
+namespace {
+
+[[noreturn]] void throw_git(const std::string& ctx) {
+    const git_error* e = git_error_last();
+    std::string msg = ctx;
+    if (e && e->message) { msg += ": "; msg += e->message; }
+    throw GitError(msg);
+}
+
+std::string blob_header(uint64_t size) {
+    std::string h = "blob " + std::to_string(size);
+    h.push_back('\0');
+    return h;
+}
+
+void hash_buffer(const uint8_t* data, size_t size, git_oid* out) {
+    sha1::Context ctx;
+    auto header = blob_header(size);
+    ctx.update(header.data(), header.size());
+    ctx.update(data, size);
+    ctx.finish(out->id);
+}
+
+std::filesystem::path objects_dir(git_repository* repo) {
+    return std::filesystem::path(git_repository_path(repo)) / "objects";
+}
+
+bool odb_has(git_repository* repo, const git_oid* oid) {
+    git_odb* odb = nullptr;
+    if (git_repository_odb(&odb, repo) != 0) throw_git("git_repository_odb");
+    bool found = git_odb_exists(odb, oid) != 0;
+    git_odb_free(odb);
+    return found;
+}
+
+} // anonymous namespace
+
+struct LooseWriter::Impl {
+    git_repository*       repo;
+    std::filesystem::path tmp;
+    std::ofstream         out;
+    z_stream              z{};
+    sha1::Context         sha;
+    bool                  hashing = true;
+    git_oid               known{};
+    uint64_t              expected;
+    uint64_t              written = 0;
+    bool                  deflating = false;
+    bool                  done = false;
+    unsigned char         buf[64 * 1024];
+
+    // Runs even when the LooseWriter constructor throws, so a half-built
+    // writer never leaves its temp file in objects/.
+    ~Impl() {
+        if (deflating) deflateEnd(&z);
+        if (!done && !tmp.empty()) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+        }
+    }
+
+    void deflate_some(const uint8_t* data, size_t size, int flush) {
+        z.next_in = const_cast<Bytef*>(data);
+        z.avail_in = static_cast<uInt>(size);
+        do {
+            z.next_out = buf;
+            z.avail_out = sizeof(buf);
+            if (::deflate(&z, flush) == Z_STREAM_ERROR)
+                throw IoError("deflate failed for " + tmp.string());
+            out.write(reinterpret_cast<const char*>(buf),
+                      static_cast<std::streamsize>(sizeof(buf) - z.avail_out));
+        } while (z.avail_out == 0);
+    }
+
+    void add(const uint8_t* data, size_t size) {
+        if (hashing) sha.update(data, size);
+        // zlib counts input in uInt; feed very large buffers in pieces
+        while (size > 0) {
+            size_t n = std::min<size_t>(size, 1u << 30);
+            deflate_some(data, n, Z_NO_FLUSH);
+            data += n;
+            size -= n;
+        }
+    }
+};
+
+LooseWriter::LooseWriter(const BlobWriter& writer, uint64_t size, int level,
+                         const git_oid* known)
+    : impl_(std::make_unique<Impl>()) {
+    static std::atomic<uint64_t> counter{0};
+    impl_->repo = writer.repo;
+    impl_->expected = size;
+    if (known) {
+        impl_->hashing = false;
+        impl_->known = *known;
+    }
+    auto dir = objects_dir(writer.repo);
+    std::string name = ".vost-tmp-";
+#ifdef __unix__
+    name += std::to_string(::getpid()) + "-";
+#endif
+    name += std::to_string(counter++);
+    if (deflateInit(&impl_->z, level) != Z_OK)
+        throw IoError("deflateInit failed");
+    impl_->deflating = true;
+    impl_->tmp = dir / name;
+    impl_->out.open(impl_->tmp, std::ios::binary | std::ios::trunc);
+    if (!impl_->out) throw IoError("cannot create " + impl_->tmp.string());
+    auto header = blob_header(size);
+    impl_->add(reinterpret_cast<const uint8_t*>(header.data()), header.size());
+}
+
+LooseWriter::~LooseWriter() = default;
+
+void LooseWriter::write(const uint8_t* data, size_t size) {
+    impl_->written += size;
+    if (impl_->written > impl_->expected)
+        throw IoError("blob larger than its declared size");
+    impl_->add(data, size);
+}
+
+void LooseWriter::finish(git_oid* out) {
+    namespace fs = std::filesystem;
+    if (impl_->written != impl_->expected)
+        throw IoError("blob shorter than its declared size");
+    impl_->deflate_some(nullptr, 0, Z_FINISH);
+    impl_->out.close();
+    if (!impl_->out) throw IoError("cannot write " + impl_->tmp.string());
+    if (impl_->hashing) impl_->sha.finish(out->id);
+    else *out = impl_->known;
+
+    char hex[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(hex, sizeof(hex), out);
+    auto dir = objects_dir(impl_->repo) / std::string(hex, 2);
+    auto dest = dir / std::string(hex + 2);
+    std::error_code ec;
+    if (fs::exists(dest) || odb_has(impl_->repo, out)) {
+        fs::remove(impl_->tmp, ec);
+    } else {
+        fs::create_directories(dir);
+        fs::permissions(impl_->tmp, fs::perms::owner_read | fs::perms::group_read |
+                                    fs::perms::others_read, ec);
+        fs::rename(impl_->tmp, dest, ec);
+        if (ec && !fs::exists(dest))
+            throw IoError("cannot store object " + dest.string() + ": " + ec.message());
+    }
+    impl_->done = true;
+}
+
+// ---------------------------------------------------------------------------
+// BlobWriter
+// ---------------------------------------------------------------------------
+
+BlobWriter::BlobWriter(const GitStoreInner& inner)
+    : repo(inner.repo), hash(inner.hash), level(inner.loose_level),
+      policy(inner.compression_policy ? &*inner.compression_policy : nullptr) {}
+
+void BlobWriter::write(const uint8_t* data, size_t size, git_oid* out,
+                       std::string_view path) const {
+    if (hash == HashBackend::Safe && !policy) {
+        if (git_blob_create_from_buffer(out, repo, data, size) != 0)
+            throw_git("git_blob_create_from_buffer");
+        return;
+    }
+    // Hash first: content the odb already has costs no compression.
+    hash_blob(hash, data, size, out);
+    if (odb_has(repo, out)) return;
+    LooseWriter loose(*this, size, level_for(path, data, size), out);
+    loose.write(data, size);
+    loose.finish(out);
+}
+
+int BlobWriter::level_for(std::string_view path, const uint8_t* head, size_t n) const {
+    if (!policy) return level;
+    if (!path.empty()) {
+        std::string full(path);
+        auto slash = full.rfind('/');
+        std::string base = slash == std::string::npos ? full : full.substr(slash + 1);
+        for (const auto& rule : policy->rules) {
+            if (glob::glob_match(rule.pattern, base) || glob::glob_match(rule.pattern, full))
+                return rule.level;
+        }
+        if (policy->known_extensions && compressed_extension(path))
+            return policy->incompressible_level;
+    }
+    if (probe_incompressible(*policy, head, n)) return policy->incompressible_level;
+    return policy->default_level.value_or(level);
+}
+
+// ---------------------------------------------------------------------------
+// Compressibility
+// ---------------------------------------------------------------------------
+
+bool compressed_extension(std::string_view name) {
+    static const char* const kExts[] = {
+        "7z", "aac", "apk", "avif", "br", "bz2", "docx", "flac", "gif", "gz",
+        "heic", "jar", "jpeg", "jpg", "lz4", "mkv", "mov", "mp3", "mp4", "odt",
+        "ogg", "parquet", "png", "pptx", "tgz", "webm", "webp", "whl", "woff",
+        "woff2", "xlsx", "xz", "zip", "zst",
+    };
+    auto dot = name.rfind('.');
+    if (dot == std::string_view::npos || name.find('/', dot) != std::string_view::npos)
+        return false;
+    std::string ext(name.substr(dot + 1));
+    for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    for (const char* e : kExts)
+        if (ext == e) return true;
+    return false;
+}
+
+double byte_entropy(const uint8_t* p, size_t n) {
+    if (n == 0) return 0;
+    size_t hist[256] = {};
+    for (size_t i = 0; i < n; ++i) ++hist[p[i]];
+    double bits = 0;
+    for (size_t c : hist) {
+        if (!c) continue;
+        double f = static_cast<double>(c) / static_cast<double>(n);
+        bits -= f * std::log2(f);
+    }
+    return bits;
+}
+
+bool probe_incompressible(const CompressionPolicy& policy, const uint8_t* p, size_t n) {
+    // Shorter samples cannot reach the threshold even when random, and
+    // small blobs are cheap to deflate anyway.
+    if (policy.probe_bytes == 0 || n < policy.probe_bytes) return false;
+    return byte_entropy(p, policy.probe_bytes) > 7.5;
+}
+
+// ---------------------------------------------------------------------------
+// Hashing
+// ---------------------------------------------------------------------------
+
+void hash_blob(HashBackend hash, const uint8_t* data, size_t size, git_oid* out) {
+    if (hash == HashBackend::Fast) {
+        hash_buffer(data, size, out);
+        return;
+    }
+    if (git_odb_hash(out, data, size, GIT_OBJECT_BLOB) != 0)
+        throw_git("git_odb_hash");
+}
+
+void hash_file(HashBackend hash, const std::filesystem::path& path, git_oid* out) {
+    if (hash == HashBackend::Safe) {
+        if (git_odb_hashfile(out, path.c_str(), GIT_OBJECT_BLOB) != 0)
+            throw IoError("cannot hash " + path.string());
+        return;
+    }
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    std::ifstream in(path, std::ios::binary);
+    if (ec || !in) throw IoError("cannot hash " + path.string());
+    sha1::Context ctx;
+    auto header = blob_header(size);
+    ctx.update(header.data(), header.size());
+    char buf[64 * 1024];
+    uint64_t seen = 0;
+    while (in) {
+        in.read(buf, sizeof(buf));
+        ctx.update(buf, static_cast<size_t>(in.gcount()));
+        seen += static_cast<uint64_t>(in.gcount());
+    }
+    if (seen != size) throw IoError("file changed while hashing: " + path.string());
+    ctx.finish(out->id);
+}
+
+// ---------------------------------------------------------------------------
+// Existence
+// ---------------------------------------------------------------------------
+
+std::vector<size_t> absent_blobs(git_repository* repo, const std::vector<git_oid>& oids) {
+    std::vector<git_odb_expand_id> ids(oids.size());
+    for (size_t i = 0; i < oids.size(); ++i) {
+        ids[i].id = oids[i];
+        ids[i].length = GIT_OID_HEXSZ;
+        ids[i].type = GIT_OBJECT_BLOB;
+    }
+    git_odb* odb = nullptr;
+    if (git_repository_odb(&odb, repo) != 0) throw_git("git_repository_odb");
+    int rc = ids.empty() ? 0 : git_odb_expand_ids(odb, ids.data(), ids.size());
+    git_odb_free(odb);
+    if (rc != 0) throw_git("git_odb_expand_ids");
+
+    // expand_ids zeroes the length of every id it could not find
+    std::vector<size_t> out;
+    for (size_t i = 0; i < ids.size(); ++i)
+        if (ids[i].length == 0) out.push_back(i);
+    return out;
+}
+
+std::string canonical_hex(const std::string& hash) {
+    git_oid oid;
+    if (hash.size() != GIT_OID_HEXSZ || git_oid_fromstr(&oid, hash.c_str()) != 0)
+        throw InvalidHashError(hash);
+    char hex[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(hex, sizeof(hex), &oid);
+    return std::string(hex, GIT_OID_HEXSZ);
+}
+
+void require_blobs(git_repository* repo,
+                   const std::vector<std::pair<std::string,
+                                               std::pair<std::string, uint32_t>>>& entries) {
+    std::vector<git_oid> oids(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (git_oid_fromstr(&oids[i], entries[i].second.first.c_str()) != 0)
+            throw InvalidHashError(entries[i].second.first);
+    }
+    auto gone = absent_blobs(repo, oids);
+    if (!gone.empty()) {
+        const auto& [path, ref] = entries[gone.front()];
+        throw NotFoundError("blob not found: " + ref.first + " (for " + path + ")");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Packs
+// ---------------------------------------------------------------------------
+
+bool probe_loose(git_repository* repo, const git_oid& oid, size_t n,
+                 std::vector<uint8_t>& head, bool& stored) {
+    char hex[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(hex, sizeof(hex), &oid);
+    std::ifstream in(objects_dir(repo) / std::string(hex, 2) / std::string(hex + 2),
+                     std::ios::binary);
+    if (!in) return false;
+
+    unsigned char src[4096];
+    in.read(reinterpret_cast<char*>(src), sizeof(src));
+    size_t got = static_cast<size_t>(in.gcount());
+    if (got < 3) return false;
+    // Skip the 2-byte zlib header; BTYPE 00 in the first block = stored.
+    stored = (src[2] & 0x06) == 0;
+
+    // Inflate just enough for the object header plus n bytes.
+    z_stream z{};
+    if (inflateInit(&z) != Z_OK) return false;
+    std::vector<uint8_t> out(64 + n);
+    z.next_out = out.data();
+    z.avail_out = static_cast<uInt>(out.size());
+    int rc = Z_OK;
+    while (rc == Z_OK && z.avail_out > 0) {
+        z.next_in = src;
+        z.avail_in = static_cast<uInt>(got);
+        rc = inflate(&z, Z_NO_FLUSH);
+        if (z.avail_out == 0 || rc != Z_OK) break;
+        in.read(reinterpret_cast<char*>(src), sizeof(src));
+        got = static_cast<size_t>(in.gcount());
+        if (got == 0) break;
+    }
+    size_t len = out.size() - z.avail_out;
+    inflateEnd(&z);
+    if (rc != Z_OK && rc != Z_STREAM_END) return false;
+
+    auto nul = std::find(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(len), 0);
+    static const char kBlob[] = "blob ";
+    if (nul == out.begin() + static_cast<std::ptrdiff_t>(len) ||
+        std::memcmp(out.data(), kBlob, sizeof(kBlob) - 1) != 0)
+        return false;
+    head.assign(nul + 1, out.begin() + static_cast<std::ptrdiff_t>(len));
+    if (head.size() > n) head.resize(n);
+    return true;
+}
+
+void write_flat_pack(git_repository* repo,
+                     const std::vector<std::pair<git_oid, int>>& objects) {
+    auto pack_dir = objects_dir(repo) / "pack";
+    std::filesystem::create_directories(pack_dir);
+
+    git_odb* odb = nullptr;
+    if (git_repository_odb(&odb, repo) != 0) throw_git("git_repository_odb");
+    git_indexer* idx = nullptr;
+#if LIBGIT2_VER_MAJOR > 1 || (LIBGIT2_VER_MAJOR == 1 && LIBGIT2_VER_MINOR >= 4)
+    git_indexer_options idx_opts = GIT_INDEXER_OPTIONS_INIT;
+    int rc = git_indexer_new(&idx, pack_dir.string().c_str(), 0, nullptr, &idx_opts);
+#else
+    int rc = git_indexer_new(&idx, pack_dir.string().c_str(), 0, nullptr, nullptr);
+#endif
+    if (rc != 0) {
+        git_odb_free(odb);
+        throw_git("git_indexer_new");
+    }
+    struct Guard {
+        git_odb* odb;
+        git_indexer* idx;
+        ~Guard() { git_indexer_free(idx); git_odb_free(odb); }
+    } guard{odb, idx};
+
+    // The pack is fed to the indexer in 1 MiB pieces as it is produced;
+    // everything but the trailer goes into its checksum.
+    sha1::Context sum;
+    std::vector<uint8_t> buf;
+    git_indexer_progress stats = {};
+    auto flush = [&] {
+        if (git_indexer_append(idx, buf.data(), buf.size(), &stats) != 0)
+            throw_git("git_indexer_append");
+        buf.clear();
+    };
+    auto put = [&](const uint8_t* p, size_t size) {
+        sum.update(p, size);
+        buf.insert(buf.end(), p, p + size);
+        if (buf.size() >= (1u << 20)) flush();
+    };
+    auto put32 = [&](uint32_t v) {
+        uint8_t b[4] = {uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v)};
+        put(b, 4);
+    };
+
+    put(reinterpret_cast<const uint8_t*>("PACK"), 4);
+    put32(2);
+    put32(static_cast<uint32_t>(objects.size()));
+
+    unsigned char zbuf[64 * 1024];
+    for (const auto& [oid, level] : objects) {
+        git_odb_object* obj = nullptr;
+        if (git_odb_read(&obj, odb, &oid) != 0) throw_git("git_odb_read");
+        struct ObjGuard {
+            git_odb_object* o;
+            ~ObjGuard() { git_odb_object_free(o); }
+        } obj_guard{obj};
+        auto* data = static_cast<const uint8_t*>(git_odb_object_data(obj));
+        size_t size = git_odb_object_size(obj);
+
+        // Entry header: type and size, 4 bits then 7 bits per byte.
+        uint8_t hdr[16];
+        size_t h = 0;
+        uint64_t left = size;
+        uint8_t c = static_cast<uint8_t>((git_odb_object_type(obj) << 4) | (left & 15));
+        for (left >>= 4; left; left >>= 7) {
+            hdr[h++] = c | 0x80;
+            c = left & 0x7f;
+        }
+        hdr[h++] = c;
+        put(hdr, h);
+
+        z_stream z{};
+        if (deflateInit(&z, level) != Z_OK) throw IoError("deflateInit failed");
+        int zrc = Z_OK;
+        for (size_t off = 0; zrc != Z_STREAM_END;) {
+            // zlib counts input in uInt; feed very large objects in pieces
+            size_t n = std::min<size_t>(size - off, 1u << 30);
+            z.next_in = const_cast<Bytef*>(data + off);
+            z.avail_in = static_cast<uInt>(n);
+            off += n;
+            int flush = off == size ? Z_FINISH : Z_NO_FLUSH;
+            do {
+                z.next_out = zbuf;
+                z.avail_out = sizeof(zbuf);
+                zrc = ::deflate(&z, flush);
+                if (zrc == Z_STREAM_ERROR) {
+                    deflateEnd(&z);
+                    throw IoError("deflate failed");
+                }
+                put(zbuf, sizeof(zbuf) - z.avail_out);
+            } while (z.avail_out == 0);
+        }
+        deflateEnd(&z);
+    }
+
+    uint8_t trailer[20];
+    sum.finish(trailer);
+    buf.insert(buf.end(), trailer, trailer + sizeof(trailer));
+    flush();
+    if (git_indexer_commit(idx, &stats) != 0) throw_git("git_indexer_commit");
+}
+
+} // namespace odb
+} // namespace vost
@@ -1,7 +1,7 @@
 #include "internal.h"
 #include "vost/error.h"
 
-#include <sstream>
+#include <algorithm>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -9,49 +9,56 @@
 namespace vost {
 namespace paths {
 
-/// Normalize a store path: strip leading/trailing slashes, reject ./..,
-/// collapse repeated slashes.  An empty input returns "" (root).
-std::string normalize(const std::string& path) {
-    if (path.empty()) return {};
+std::vector<std::string> split(std::string_view path) {
+    std::vector<std::string> out;
+    for (auto seg : Segments(path)) out.emplace_back(seg);
+    return out;
+}
 
-    std::vector<std::string_view> segments;
-    std::string_view sv(path);
+bool is_normalized(std::string_view path) {
+    if (path.empty()) return true;
+    if (path.front() == '/' || path.back() == '/') return false;
     size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = std::min(path.find('/', start), path.size());
+        std::string_view seg = path.substr(start, end - start);
+        if (seg.empty() || seg == "." || seg == "..") return false;
+        start = end + 1;
+    }
+    return true;
+}
 
-    while (start < sv.size()) {
-        size_t end = sv.find('/', start);
-        if (end == std::string_view::npos) end = sv.size();
+/// Normalize a store path: strip leading/trailing slashes, reject ./..,
+/// collapse repeated slashes.  An empty input returns "" (root).
+std::string normalize(std::string_view path) {
+    std::string buf;
+    auto view = normalize_view(path, buf);
+    return view.data() == buf.data() ? std::move(buf) : std::string(view);
+}
 
-        std::string_view seg = sv.substr(start, end - start);
-        start = end + 1;
+std::string_view normalize_view(std::string_view path, std::string& buf) {
+    if (is_normalized(path)) return path;
 
-        if (seg.empty()) continue; // skip empty from leading/trailing/double slashes
+    buf.clear();
+    buf.reserve(path.size());
+    bool dropped = false;
+    for (auto seg : Segments(path)) {
         if (seg == "..") {
             throw InvalidPathError(std::string("path segment '") +
                                    std::string(seg) + "' is not allowed");
         }
-        if (seg == ".") continue; // collapse current-directory markers
-        segments.push_back(seg);
-    }
-
-    if (segments.empty()) {
-        // Only-slash paths like "///" mean root (empty string).
-        // Paths with actual content that collapsed away (e.g. ".") are errors.
-        bool all_slashes = true;
-        for (char c : path) {
-            if (c != '/') { all_slashes = false; break; }
+        if (seg == ".") { // collapse current-directory markers
+            dropped = true;
+            continue;
         }
-        if (all_slashes) return {};
-        throw InvalidPathError("path must not be empty");
+        if (!buf.empty()) buf += '/';
+        buf += seg;
     }
 
-    std::string out;
-    out.reserve(path.size());
-    for (size_t i = 0; i < segments.size(); ++i) {
-        if (i > 0) out += '/';
-        out += std::string(segments[i]);
-    }
-    return out;
+    // Only-slash paths like "///" mean root (empty string).
+    // Paths with actual content that collapsed away (e.g. ".") are errors.
+    if (buf.empty() && dropped) throw InvalidPathError("path must not be empty");
+    return buf;
 }
 
 /// Validate a git reference name.
@@ -90,7 +97,7 @@ void validate_ref_name(const std::string& name) {
 }
 
 /// Returns true when path is the root (empty or all slashes).
-bool is_root(const std::string& path) {
+bool is_root(std::string_view path) {
     for (char c : path) {
         if (c != '/') return false;
     }
@@ -0,0 +1,164 @@
+#include "vost/pool.h"
+
+#include <git2.h>
+
+#include <iterator>
+
+namespace vost {
+
+// ---------------------------------------------------------------------------
+// StorePool
+// ---------------------------------------------------------------------------
+//
+// `lru_` holds one entry per open store, most recently opened first, and
+// `index_` maps canonical paths into it.  A path being opened outside the
+// lock is parked in `opening_`; other callers for it wait on `opened_`
+// rather than opening a second repository.  Closed entries are spliced
+// out under the lock and destroyed after it, since freeing a repository
+// closes its packs.
+
+StorePool::StorePool(PoolOptions opts) : opts_(std::move(opts)) {
+    // The pool may outlive (or predate) GitStore's own static init.
+    git_libgit2_init();
+}
+
+void StorePool::set_process_limits(const ProcessLimits& limits) {
+    git_libgit2_init();
+    if (limits.max_pack_files)
+        git_libgit2_opts(GIT_OPT_SET_MWINDOW_FILE_LIMIT, *limits.max_pack_files);
+    if (limits.max_mapped_bytes)
+        git_libgit2_opts(GIT_OPT_SET_MWINDOW_MAPPED_LIMIT, *limits.max_mapped_bytes);
+    if (limits.cache_bytes)
+        git_libgit2_opts(GIT_OPT_SET_CACHE_MAX_SIZE, static_cast<ssize_t>(*limits.cache_bytes));
+    git_libgit2_shutdown();
+}
+
+StorePool::~StorePool() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        lru_.clear();
+        index_.clear();
+    }
+    git_libgit2_shutdown();
+}
+
+std::string StorePool::key_for(const std::filesystem::path& path) {
+    auto p = std::filesystem::weakly_canonical(std::filesystem::absolute(path))
+                 .lexically_normal();
+    if (!p.has_filename() && p.has_parent_path()) p = p.parent_path();
+    return p.string();
+}
+
+GitStore StorePool::open(const std::filesystem::path& path) {
+    std::string key = key_for(path);
+    Lru closed;
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    for (;;) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            it->second->last_used = Clock::now();
+            ++hits_;
+            return GitStore(it->second->inner);
+        }
+        if (!opening_.count(key)) break;
+        opened_.wait(lk);
+    }
+
+    opening_.insert(key);
+    ++misses_;
+    lk.unlock();
+
+    std::shared_ptr<GitStoreInner> inner;
+    try {
+        inner = GitStore::open(key, opts_.open).inner();
+    } catch (...) {
+        lk.lock();
+        opening_.erase(key);
+        lk.unlock();
+        opened_.notify_all();
+        throw;
+    }
+
+    lk.lock();
+    opening_.erase(key);
+    auto now = Clock::now();
+    lru_.push_front(Entry{key, inner, now});
+    index_[key] = lru_.begin();
+    closed = evict_locked(now);
+    lk.unlock();
+    opened_.notify_all();
+    return GitStore(std::move(inner));
+}
+
+bool StorePool::contains(const std::filesystem::path& path) const {
+    std::string key = key_for(path);
+    std::lock_guard<std::mutex> lk(mutex_);
+    return index_.count(key) != 0;
+}
+
+bool StorePool::close(const std::filesystem::path& path) {
+    std::string key = key_for(path);
+    Lru closed;
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end() || !idle(*it->second)) return false;
+    closed.splice(closed.end(), lru_, it->second);
+    index_.erase(it);
+    ++evictions_;
+    return true;
+}
+
+size_t StorePool::trim() {
+    Lru closed;
+    std::lock_guard<std::mutex> lk(mutex_);
+    closed = evict_locked(Clock::now());
+    return closed.size();
+}
+
+StorePool::Lru StorePool::evict_locked(Clock::time_point now) {
+    Lru closed;
+    auto timeout = std::chrono::milliseconds(opts_.idle_ms);
+    auto it = lru_.end();
+    while (it != lru_.begin()) {
+        auto cur = std::prev(it);
+        bool over = lru_.size() > opts_.max_open;
+        bool expired = opts_.idle_ms && now - cur->last_used >= timeout;
+        // Entries further forward are newer, so nothing there qualifies either.
+        if (!over && !expired) break;
+        if (idle(*cur)) {
+            index_.erase(cur->key);
+            closed.splice(closed.end(), lru_, cur);
+            ++evictions_;
+        } else {
+            it = cur;
+        }
+    }
+    return closed;
+}
+
+size_t StorePool::size() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return lru_.size();
+}
+
+PoolStats StorePool::stats() const {
+    PoolStats s;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        s.open = lru_.size();
+        for (const auto& e : lru_)
+            if (idle(e)) ++s.idle;
+        s.hits = hits_;
+        s.misses = misses_;
+        s.evictions = evictions_;
+    }
+    ssize_t current = 0, allowed = 0;
+    git_libgit2_opts(GIT_OPT_GET_CACHED_MEMORY, &current, &allowed);
+    s.cached_bytes = current;
+    s.cache_limit = allowed;
+    return s;
+}
+
+} // namespace vost
@@ -0,0 +1,162 @@
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <git2.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#  include <sys/stat.h>
+#endif
+
+namespace vost {
+
+// ---------------------------------------------------------------------------
+// RefCache
+// ---------------------------------------------------------------------------
+//
+// Resolving a ref through libgit2 means reading the loose ref file (or the
+// packed-refs table), peeling to a commit, and loading the commit object to
+// find its tree.  The cache keeps the resolved (commit, tree) pair per ref and
+// revalidates it on every lookup against the on-disk stamps of the two files
+// that can define the ref: `<gitdir>/<refname>` and `<gitdir>/packed-refs`.
+//
+// git (and libgit2) always replaces ref files by renaming a lockfile into
+// place, so any update changes the inode and ctime even when the size and a
+// coarse-grained mtime stay the same.  Writes made through this process also
+// refresh or drop the entry directly (see refcache::store / invalidate).
+
+namespace {
+
+std::string oid_hex(const git_oid* o) {
+    char buf[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(buf, sizeof(buf), o);
+    return std::string(buf, GIT_OID_HEXSZ);
+}
+
+} // anonymous namespace
+
+namespace refcache {
+
+FileStamp stamp_file(const std::filesystem::path& p) {
+    FileStamp s;
+#ifndef _WIN32
+    struct ::stat st;
+    if (::stat(p.c_str(), &st) != 0) return s;
+    s.exists = true;
+    s.dev  = static_cast<uint64_t>(st.st_dev);
+    s.ino  = static_cast<uint64_t>(st.st_ino);
+    s.size = static_cast<uint64_t>(st.st_size);
+#  ifdef __APPLE__
+    s.mtime_ns = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+    s.ctime_ns = int64_t(st.st_ctimespec.tv_sec) * 1000000000 + st.st_ctimespec.tv_nsec;
+#  else
+    s.mtime_ns = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    s.ctime_ns = int64_t(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+#  endif
+#else
+    std::error_code ec;
+    auto size = std::filesystem::file_size(p, ec);
+    if (ec) return s;
+    auto mtime = std::filesystem::last_write_time(p, ec);
+    if (ec) return s;
+    s.exists = true;
+    s.size = static_cast<uint64_t>(size);
+    s.mtime_ns = static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            mtime.time_since_epoch()).count());
+#endif
+    return s;
+}
+
+std::optional<ResolvedRef> resolve(GitStoreInner& inner,
+                                   const std::string& refname) {
+    RefCache* cache = inner.ref_cache.get();
+    FileStamp loose, packed;
+
+    if (cache) {
+        loose  = stamp_file(inner.path / refname);
+        packed = stamp_file(inner.path / "packed-refs");
+        if (!loose.exists && !packed.exists) return std::nullopt;
+
+        auto it = cache->entries.find(refname);
+        if (it != cache->entries.end()) {
+            if (it->second.loose == loose && it->second.packed == packed)
+                return ResolvedRef{it->second.commit_hex, it->second.tree_hex};
+            cache->entries.erase(it);
+        }
+    }
+
+    git_reference* ref = nullptr;
+    if (git_reference_lookup(&ref, inner.repo, refname.c_str()) != 0)
+        return std::nullopt;
+    // Symbolic refs depend on a second file; leave them uncached.
+    bool direct = git_reference_target(ref) != nullptr;
+
+    git_object* obj = nullptr;
+    int rc = git_reference_peel(&obj, ref, GIT_OBJECT_COMMIT);
+    git_reference_free(ref);
+    if (rc != 0) {
+        const git_error* e = git_error_last();
+        std::string msg = "git_reference_peel (commit)";
+        if (e && e->message) { msg += ": "; msg += e->message; }
+        throw GitError(msg);
+    }
+
+    ResolvedRef out;
+    out.commit_hex = oid_hex(git_object_id(obj));
+    out.tree_hex = oid_hex(
+        git_commit_tree_id(reinterpret_cast<git_commit*>(obj)));
+    git_object_free(obj);
+
+    if (cache && direct) {
+        cache->entries[refname] =
+            RefCache::Entry{out.commit_hex, out.tree_hex, loose, packed};
+    }
+    return out;
+}
+
+bool is_cached(GitStoreInner& inner, const std::string& refname) {
+    RefCache* cache = inner.ref_cache.get();
+    if (!cache) return false;
+    auto it = cache->entries.find(refname);
+    return it != cache->entries.end() &&
+           it->second.loose == stamp_file(inner.path / refname) &&
+           it->second.packed == stamp_file(inner.path / "packed-refs");
+}
+
+void store(GitStoreInner& inner, const std::string& refname,
+           const std::string& commit_hex, const std::string& tree_hex) {
+    RefCache* cache = inner.ref_cache.get();
+    if (!cache) return;
+    cache->entries.erase(refname);
+
+    // Stamp first, then confirm the loose file holds our commit: if anything
+    // rewrites the ref in between, the stamp no longer matches on lookup.
+    auto loose_path = inner.path / refname;
+    FileStamp loose  = stamp_file(loose_path);
+    FileStamp packed = stamp_file(inner.path / "packed-refs");
+    if (!loose.exists) return;
+
+    std::ifstream in(loose_path, std::ios::binary);
+    char buf[GIT_OID_HEXSZ];
+    if (!in.read(buf, GIT_OID_HEXSZ)) return;
+    if (commit_hex.compare(0, std::string::npos, buf, GIT_OID_HEXSZ) != 0) return;
+
+    cache->entries[refname] =
+        RefCache::Entry{commit_hex, tree_hex, loose, packed};
+}
+
+void invalidate(GitStoreInner& inner, const std::string& refname) {
+    if (inner.ref_cache) inner.ref_cache->entries.erase(refname);
+}
+
+void clear(GitStoreInner& inner) {
+    if (inner.ref_cache) inner.ref_cache->entries.clear();
+}
+
+} // namespace refcache
+
+} // namespace vost
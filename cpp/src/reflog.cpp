@@ -0,0 +1,167 @@
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <git2.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace vost {
+namespace reflog {
+
+// ---------------------------------------------------------------------------
+// Reading
+// ---------------------------------------------------------------------------
+//
+// Reflog files are append-only text, oldest entry first:
+//
+//   <old-sha> <new-sha> <name> <<email>> <time> <tz>\t<message>\n
+//
+// Callers almost always want the newest entries (pagination, redo), so the
+// file is read backwards in fixed-size chunks and parsing stops as soon as
+// the visitor has seen enough.  Cost is proportional to the entries visited,
+// not to the size of the file.
+
+namespace {
+
+constexpr size_t kChunk = 64 * 1024;
+
+bool parse_line(const std::string& line, ReflogEntry& out) {
+    if (line.size() < 82 || line[40] != ' ' || line[81] != ' ') return false;
+    out.old_sha = line.substr(0, 40);
+    out.new_sha = line.substr(41, 40);
+
+    size_t tab = line.find('\t', 82);
+    std::string sig = line.substr(82, tab == std::string::npos
+                                          ? std::string::npos : tab - 82);
+    out.message = tab == std::string::npos ? "" : line.substr(tab + 1);
+
+    size_t gt = sig.rfind('>');
+    if (gt == std::string::npos) {
+        out.committer = sig;
+        out.timestamp = 0;
+    } else {
+        out.committer = sig.substr(0, gt + 1);
+        out.timestamp = std::strtoull(sig.c_str() + gt + 1, nullptr, 10);
+    }
+    return true;
+}
+
+std::filesystem::path log_path(const std::filesystem::path& gitdir,
+                               const std::string& refname) {
+    return gitdir / "logs" / refname;
+}
+
+} // anonymous namespace
+
+void for_each_recent(const std::filesystem::path& gitdir,
+                     const std::string& refname,
+                     const std::function<bool(ReflogEntry&&)>& fn) {
+    std::ifstream in(log_path(gitdir, refname), std::ios::binary);
+    if (!in) return;
+    in.seekg(0, std::ios::end);
+    auto pos = static_cast<size_t>(in.tellg());
+
+    auto emit = [&](const std::string& line) {
+        ReflogEntry e;
+        if (!parse_line(line, e)) return true; // skip malformed lines
+        return fn(std::move(e));
+    };
+
+    std::string carry; // start of a line whose beginning is in an earlier chunk
+    while (pos > 0) {
+        size_t n = std::min(kChunk, pos);
+        pos -= n;
+        std::string buf(n, '\0');
+        in.seekg(static_cast<std::streamoff>(pos));
+        if (!in.read(&buf[0], static_cast<std::streamsize>(n))) return;
+        buf += carry;
+
+        size_t end = buf.size();
+        while (end > 0) {
+            size_t nl = buf.rfind('\n', end - 1);
+            if (nl == std::string::npos) break;
+            if (end - nl > 1 && !emit(buf.substr(nl + 1, end - nl - 1)))
+                return;
+            end = nl;
+        }
+        carry = buf.substr(0, end);
+    }
+    if (!carry.empty()) emit(carry);
+}
+
+std::vector<ReflogEntry> read(const std::filesystem::path& gitdir,
+                              const std::string& refname,
+                              size_t skip,
+                              std::optional<size_t> limit) {
+    std::vector<ReflogEntry> out;
+    if (limit && *limit == 0) return out;
+    size_t seen = 0;
+    for_each_recent(gitdir, refname, [&](ReflogEntry&& e) {
+        if (seen++ < skip) return true;
+        out.push_back(std::move(e));
+        return !limit || out.size() < *limit;
+    });
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Retention
+// ---------------------------------------------------------------------------
+//
+// Trimming rewrites the whole reflog, so it is batched: a ref is trimmed on
+// its first update in this process and then once every `slack` updates
+// (an eighth of max_entries, or 64 for age-only policies).  The file thus
+// stays within max_entries + slack entries and each write pays an amortized
+// constant cost.
+
+void enforce(GitStoreInner& inner, const std::string& refname) {
+    const auto& policy = inner.reflog_retention;
+    if (!policy.max_entries && !policy.max_age) return;
+
+    size_t slack = policy.max_entries
+        ? std::max<size_t>(1, *policy.max_entries / 8) : 64;
+    auto it = inner.reflog_pending.find(refname);
+    if (it != inner.reflog_pending.end() && ++it->second < slack) return;
+    inner.reflog_pending[refname] = 0;
+
+    git_reflog* rlog = nullptr;
+    if (git_reflog_read(&rlog, inner.repo, refname.c_str()) != 0) return;
+
+    // Entries are indexed newest first.
+    size_t n = git_reflog_entrycount(rlog);
+    size_t keep = policy.max_entries ? std::min(n, *policy.max_entries) : n;
+    if (policy.max_age) {
+        auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        uint64_t cutoff = now > *policy.max_age ? now - *policy.max_age : 0;
+        for (size_t i = 0; i < keep; ++i) {
+            const git_signature* sig =
+                git_reflog_entry_committer(git_reflog_entry_byindex(rlog, i));
+            if (sig && static_cast<uint64_t>(sig->when.time) < cutoff) {
+                keep = i;
+                break;
+            }
+        }
+    }
+
+    int rc = 0;
+    if (keep < n) {
+        for (size_t i = n; i > keep; --i)
+            git_reflog_drop(rlog, i - 1, 0);
+        rc = git_reflog_write(rlog);
+    }
+    git_reflog_free(rlog);
+    if (rc != 0) {
+        const git_error* e = git_error_last();
+        std::string msg = "git_reflog_write";
+        if (e && e->message) { msg += ": "; msg += e->message; }
+        throw GitError(msg);
+    }
+}
+
+} // namespace reflog
+} // namespace vost
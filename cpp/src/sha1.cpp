@@ -0,0 +1,209 @@
+#include "internal.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define VOST_SHA1_X86 1
+#  include <cpuid.h>
+#  include <immintrin.h>
+#endif
+
+namespace vost {
+namespace sha1 {
+
+// ---------------------------------------------------------------------------
+// Block functions
+// ---------------------------------------------------------------------------
+//
+// Plain FIPS 180-4 SHA-1 -- no collision detection, unlike libgit2's
+// default SHA1DC -- with a SHA-NI version picked at run time on x86-64
+// CPUs that have the SHA extensions.
+
+namespace {
+
+using CompressFn = void (*)(uint32_t state[5], const uint8_t* data, size_t blocks);
+
+inline uint32_t rol(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+void compress_portable(uint32_t state[5], const uint8_t* data, size_t blocks) {
+    uint32_t w[80];
+    for (; blocks > 0; --blocks, data += 64) {
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t(data[4 * i]) << 24) | (uint32_t(data[4 * i + 1]) << 16) |
+                   (uint32_t(data[4 * i + 2]) << 8) | uint32_t(data[4 * i + 3]);
+        }
+        for (int i = 16; i < 80; ++i)
+            w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        auto step = [&](uint32_t f, uint32_t k, uint32_t wi) {
+            uint32_t t = rol(a, 5) + f + e + k + wi;
+            e = d;
+            d = c;
+            c = rol(b, 30);
+            b = a;
+            a = t;
+        };
+        for (int i = 0; i < 20; ++i) step((b & c) | (~b & d), 0x5A827999, w[i]);
+        for (int i = 20; i < 40; ++i) step(b ^ c ^ d, 0x6ED9EBA1, w[i]);
+        for (int i = 40; i < 60; ++i) step((b & c) | (b & d) | (c & d), 0x8F1BBCDC, w[i]);
+        for (int i = 60; i < 80; ++i) step(b ^ c ^ d, 0xCA62C1D6, w[i]);
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+#ifdef VOST_SHA1_X86
+
+// Four rounds per step.  From round 12 on every step has the same shape,
+// with the roles of E0/E1 and of the four message registers rotating;
+// the message schedule work in the last steps is unused but harmless.
+#define VOST_SHA1_STEP(FN, EIN, EOUT, M0, M1, M2, M3)  \
+    EIN  = _mm_sha1nexte_epu32(EIN, M0);                \
+    EOUT = abcd;                                        \
+    M1   = _mm_sha1msg2_epu32(M1, M0);                  \
+    abcd = _mm_sha1rnds4_epu32(abcd, EIN, FN);          \
+    M3   = _mm_sha1msg1_epu32(M3, M0);                  \
+    M2   = _mm_xor_si128(M2, M0);
+
+__attribute__((target("sha,sse4.1,ssse3")))
+inline __m128i load_be(const uint8_t* p, __m128i mask) {
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), mask);
+}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void compress_shani(uint32_t state[5], const uint8_t* data, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+    __m128i abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+
+    for (; blocks > 0; --blocks, data += 64) {
+        __m128i abcd_save = abcd, e0_save = e0, e1;
+
+        // Rounds 0-11, loading the message as it is needed
+        __m128i m0 = load_be(data + 0, mask);
+        e0 = _mm_add_epi32(e0, m0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        __m128i m1 = load_be(data + 16, mask);
+        e1 = _mm_sha1nexte_epu32(e1, m1);
+        e0 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        m0 = _mm_sha1msg1_epu32(m0, m1);
+
+        __m128i m2 = load_be(data + 32, mask);
+        e0 = _mm_sha1nexte_epu32(e0, m2);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        m1 = _mm_sha1msg1_epu32(m1, m2);
+        m0 = _mm_xor_si128(m0, m2);
+
+        __m128i m3 = load_be(data + 48, mask);
+
+        // Rounds 12-79
+        VOST_SHA1_STEP(0, e1, e0, m3, m0, m1, m2)
+        VOST_SHA1_STEP(0, e0, e1, m0, m1, m2, m3)
+        VOST_SHA1_STEP(1, e1, e0, m1, m2, m3, m0)
+        VOST_SHA1_STEP(1, e0, e1, m2, m3, m0, m1)
+        VOST_SHA1_STEP(1, e1, e0, m3, m0, m1, m2)
+        VOST_SHA1_STEP(1, e0, e1, m0, m1, m2, m3)
+        VOST_SHA1_STEP(1, e1, e0, m1, m2, m3, m0)
+        VOST_SHA1_STEP(2, e0, e1, m2, m3, m0, m1)
+        VOST_SHA1_STEP(2, e1, e0, m3, m0, m1, m2)
+        VOST_SHA1_STEP(2, e0, e1, m0, m1, m2, m3)
+        VOST_SHA1_STEP(2, e1, e0, m1, m2, m3, m0)
+        VOST_SHA1_STEP(2, e0, e1, m2, m3, m0, m1)
+        VOST_SHA1_STEP(3, e1, e0, m3, m0, m1, m2)
+        VOST_SHA1_STEP(3, e0, e1, m0, m1, m2, m3)
+        VOST_SHA1_STEP(3, e1, e0, m1, m2, m3, m0)
+        VOST_SHA1_STEP(3, e0, e1, m2, m3, m0, m1)
+        VOST_SHA1_STEP(3, e1, e0, m3, m0, m1, m2)
+
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#undef VOST_SHA1_STEP
+
+bool cpu_has_sha() {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return false;
+    bool ssse3 = c & (1u << 9), sse41 = c & (1u << 19);
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+    return ssse3 && sse41 && (b & (1u << 29));
+}
+
+#endif // VOST_SHA1_X86
+
+CompressFn pick() {
+#ifdef VOST_SHA1_X86
+    if (cpu_has_sha()) return compress_shani;
+#endif
+    return compress_portable;
+}
+
+const CompressFn compress = pick();
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------
+// Context
+// ---------------------------------------------------------------------------
+
+bool accelerated() {
+    return compress != compress_portable;
+}
+
+Context::Context()
+    : state_{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0} {}
+
+void Context::update(const void* data, size_t size) {
+    auto* p = static_cast<const uint8_t*>(data);
+    total_ += size;
+    if (buffered_) {
+        size_t n = std::min(size, sizeof(buf_) - buffered_);
+        std::memcpy(buf_ + buffered_, p, n);
+        buffered_ += n;
+        p += n;
+        size -= n;
+        if (buffered_ < sizeof(buf_)) return;
+        compress(state_, buf_, 1);
+        buffered_ = 0;
+    }
+    if (size >= 64) {
+        compress(state_, p, size / 64);
+        p += size & ~size_t(63);
+        size &= 63;
+    }
+    if (size) std::memcpy(buf_, p, size);
+    buffered_ = size;
+}
+
+void Context::finish(uint8_t out[20]) {
+    uint64_t bits = total_ * 8;
+    uint8_t pad[72] = {0x80};
+    size_t pad_len = (buffered_ < 56 ? 56 : 120) - buffered_;
+    for (int i = 0; i < 8; ++i)
+        pad[pad_len + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    update(pad, pad_len + 8);
+    for (int i = 0; i < 5; ++i) {
+        out[4 * i]     = static_cast<uint8_t>(state_[i] >> 24);
+        out[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        out[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        out[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+    }
+}
+
+} // namespace sha1
+} // namespace vost
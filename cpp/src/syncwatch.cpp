@@ -0,0 +1,380 @@
+#include "vost/watch.h"
+#include "vost/fs.h"
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+namespace vost {
+
+// ---------------------------------------------------------------------------
+// SyncWatchState
+// ---------------------------------------------------------------------------
+//
+// A SyncWatcher owns a background thread that turns inotify events under
+// `src` into scoped sync_in commits:
+//
+//   * every directory under `src` (minus ones the ExcludeFilter drops) has
+//     its own watch; directories created or moved in are added as their
+//     events arrive;
+//   * each event marks one path relative to `src` dirty.  After the first
+//     event the thread waits debounce_ms, then syncs the dirty paths -- a
+//     file, a whole directory, or a path that is gone -- in one commit;
+//   * IN_Q_OVERFLOW means events were lost, so the next batch is a full
+//     sync_in of `src` instead;
+//   * without inotify, the thread does a full sync_in every
+//     poll_interval_ms.
+//
+// The branch snapshot a batch builds on is the previous batch's result.
+// If another writer moved the branch meanwhile, the batch is retried once
+// on the new tip.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Drop paths whose ancestor directory is also in `paths`.
+std::vector<std::string> collapse(const std::set<std::string>& paths) {
+    std::vector<std::string> out;
+    for (const auto& rel : paths) {
+        bool covered = false;
+        for (auto slash = rel.find('/'); slash != std::string::npos;
+             slash = rel.find('/', slash + 1)) {
+            if (paths.count(rel.substr(0, slash))) { covered = true; break; }
+        }
+        if (!covered) out.push_back(rel);
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+struct SyncWatchState {
+    Fs                    fs;       ///< Latest snapshot (guarded by mutex).
+    std::filesystem::path src;
+    std::string           dest;
+    SyncWatchOptions      opts;
+    SyncWatchCallback     callback;
+
+    std::atomic<bool>          stopping{false};
+    std::thread                thread;
+    mutable std::mutex         mutex;
+    std::optional<std::string> last_error;  ///< Guarded by mutex.
+    std::atomic<uint64_t>      commits{0};
+    std::atomic<uint64_t>      rescans{0};
+
+    // Owned by the background thread.
+    std::set<std::string> dirty;          ///< Paths relative to src.
+    bool                  rescan = false; ///< Next batch is a full sync.
+
+#ifdef __linux__
+    int inotify_fd = -1;
+    int wake_fd = -1;
+    std::unordered_map<int, std::string> dirs; ///< inotify wd -> dir relative to src
+#endif
+    std::mutex              wake_mutex;
+    std::condition_variable wake_cv;
+    bool                    woken = false;
+
+    explicit SyncWatchState(Fs base) : fs(std::move(base)) {}
+
+    ~SyncWatchState() {
+#ifdef __linux__
+        if (inotify_fd >= 0) ::close(inotify_fd);
+        if (wake_fd >= 0) ::close(wake_fd);
+#endif
+    }
+
+    void wake() {
+#ifdef __linux__
+        if (wake_fd >= 0) {
+            uint64_t one = 1;
+            ssize_t n = ::write(wake_fd, &one, sizeof(one));
+            (void)n;
+            return;
+        }
+#endif
+        {
+            std::lock_guard<std::mutex> lk(wake_mutex);
+            woken = true;
+        }
+        wake_cv.notify_one();
+    }
+
+    /// Sync `scope` (or everything, when null) onto the latest snapshot.
+    std::pair<ChangeReport, Fs> sync(const Fs& base,
+                                     const std::vector<std::string>* scope) {
+        observe::Operation obs_op(*base.inner_, "Fs::sync_in");
+        return base.sync_in_scoped(src, dest, opts.sync, &opts.filter, scope);
+    }
+
+    /// Commit the paths gathered since the last batch.
+    void sync_batch() {
+        bool full = rescan;
+        std::vector<std::string> scope = collapse(dirty);
+        dirty.clear();
+        rescan = false;
+        if (full) {
+            ++rescans;
+#ifdef __linux__
+            if (inotify_fd >= 0) watch_tree("");
+#endif
+        }
+
+        Fs base = [&] {
+            std::lock_guard<std::mutex> lk(mutex);
+            return fs;
+        }();
+        try {
+            std::pair<ChangeReport, Fs> result = [&] {
+                try {
+                    return sync(base, full ? nullptr : &scope);
+                } catch (const StaleSnapshotError&) {
+                    RefDict branches(base.inner_, "refs/heads/", true);
+                    base = branches.get(*base.ref_name());
+                    return sync(base, full ? nullptr : &scope);
+                }
+            }();
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                fs = result.second;
+                last_error.reset();
+            }
+            if (result.first.in_sync()) return;
+            ++commits;
+            if (callback && !stopping.load()) {
+                try {
+                    callback(result.first, result.second);
+                } catch (...) {
+                    // A throwing callback must not end the watch.
+                }
+            }
+        } catch (const std::exception& e) {
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                last_error = e.what();
+            }
+            // Retry with the next batch rather than spinning on the error.
+            if (full) rescan = true;
+            else dirty.insert(scope.begin(), scope.end());
+        }
+    }
+
+#ifdef __linux__
+    /// Watch the directory `rel` (relative to src) and everything below it.
+    void watch_tree(const std::string& rel) {
+        if (!rel.empty() && (opts.filter.is_excluded(rel, true) ||
+                             copy::excluded(opts.filter, rel)))
+            return;
+        auto dir = rel.empty() ? src : src / rel;
+        int wd = inotify_add_watch(
+            inotify_fd, dir.c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM |
+            IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR | IN_DONT_FOLLOW);
+        if (wd < 0) return;
+        dirs[wd] = rel;
+        std::error_code ec;
+        for (auto it = std::filesystem::directory_iterator(dir, ec);
+             !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            if (it->is_directory(ec) && !it->is_symlink(ec)) {
+                auto name = it->path().filename().string();
+                watch_tree(rel.empty() ? name : rel + "/" + name);
+            }
+        }
+    }
+
+    bool start_inotify() {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotify_fd < 0 || wake_fd < 0) {
+            if (inotify_fd >= 0) { ::close(inotify_fd); inotify_fd = -1; }
+            if (wake_fd >= 0) { ::close(wake_fd); wake_fd = -1; }
+            return false;
+        }
+        watch_tree("");
+        return !dirs.empty();
+    }
+
+    /// Drain pending inotify events into `dirty`.  Returns true if any
+    /// event may change what is in the store.
+    bool drain_inotify() {
+        alignas(struct inotify_event) char buf[16384];
+        bool relevant = false;
+        while (true) {
+            ssize_t n = ::read(inotify_fd, buf, sizeof(buf));
+            if (n <= 0) break;
+            for (char* p = buf; p < buf + n;) {
+                auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + ev->len;
+
+                if (ev->mask & IN_Q_OVERFLOW) { rescan = relevant = true; continue; }
+                if (ev->mask & IN_IGNORED) { dirs.erase(ev->wd); continue; }
+                if (!ev->len) continue;
+
+                auto dir = dirs.find(ev->wd);
+                if (dir == dirs.end()) continue;
+                std::string name = ev->name;
+                std::string rel = dir->second.empty() ? name : dir->second + "/" + name;
+
+                // A directory created or moved in: watch it (and anything
+                // already inside) before syncing it as a whole.
+                if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO)))
+                    watch_tree(rel);
+                dirty.insert(std::move(rel));
+                relevant = true;
+            }
+        }
+        return relevant;
+    }
+#endif
+
+    void run() {
+        bool pending = false;
+        Clock::time_point deadline;
+        auto mark_pending = [&]() {
+            if (!pending) {
+                pending = true;
+                deadline = Clock::now() + std::chrono::milliseconds(opts.debounce_ms);
+            }
+        };
+
+#ifdef __linux__
+        if (inotify_fd >= 0) {
+            while (!stopping.load()) {
+                int timeout = -1;
+                if (pending) {
+                    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count();
+                    timeout = left > 0 ? static_cast<int>(left) : 0;
+                }
+                struct pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+                ::poll(fds, 2, timeout);
+                if (stopping.load()) break;
+
+                if ((fds[0].revents & POLLIN) && drain_inotify()) mark_pending();
+
+                if (pending && Clock::now() >= deadline) {
+                    pending = false;
+                    sync_batch();
+                }
+            }
+            return;
+        }
+#endif
+
+        // Portable fallback: a full sync every poll_interval_ms.
+        auto period = std::chrono::milliseconds(
+            opts.poll_interval_ms ? opts.poll_interval_ms : 1);
+        while (!stopping.load()) {
+            {
+                std::unique_lock<std::mutex> lk(wake_mutex);
+                wake_cv.wait_for(lk, period, [&] { return woken || stopping.load(); });
+                woken = false;
+            }
+            if (stopping.load()) break;
+            rescan = true;
+            sync_batch();
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Fs::watch_sync_in
+// ---------------------------------------------------------------------------
+
+SyncWatcher Fs::watch_sync_in(const std::filesystem::path& src,
+                              const std::string& dest,
+                              SyncWatchOptions opts,
+                              SyncWatchCallback callback) const {
+    require_writable("watch_sync_in");
+    opts.sync.dry_run = false;
+
+    auto state = std::make_shared<SyncWatchState>(*this);
+    state->src = src;
+    state->dest = dest;
+    state->opts = std::move(opts);
+    state->callback = std::move(callback);
+
+#ifdef __linux__
+    // Watches go in before the initial sync so nothing written during it
+    // is missed; paths it already covered just sync as unchanged.
+    state->start_inotify();
+#endif
+    state->fs = state->sync(*this, nullptr).second;
+
+    state->thread = std::thread([self = state]() { self->run(); });
+    return SyncWatcher(std::move(state));
+}
+
+// ---------------------------------------------------------------------------
+// SyncWatcher
+// ---------------------------------------------------------------------------
+
+SyncWatcher::SyncWatcher(std::shared_ptr<SyncWatchState> state)
+    : state_(std::move(state)) {}
+
+SyncWatcher::~SyncWatcher() {
+    stop();
+}
+
+SyncWatcher& SyncWatcher::operator=(SyncWatcher&& other) noexcept {
+    if (this != &other) {
+        stop();
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
+
+void SyncWatcher::stop() {
+    if (!state_) return;
+    auto state = std::move(state_);
+    if (state->stopping.exchange(true)) return;
+    state->wake();
+    if (state->thread.joinable()) {
+        if (state->thread.get_id() == std::this_thread::get_id())
+            state->thread.detach();  // stop() from inside the callback
+        else
+            state->thread.join();
+    }
+}
+
+bool SyncWatcher::active() const {
+    return state_ && !state_->stopping.load();
+}
+
+Fs SyncWatcher::fs() const {
+    if (!state_) throw std::logic_error("SyncWatcher: not watching");
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    return state_->fs;
+}
+
+uint64_t SyncWatcher::commits() const {
+    return state_ ? state_->commits.load() : 0;
+}
+
+uint64_t SyncWatcher::rescans() const {
+    return state_ ? state_->rescans.load() : 0;
+}
+
+std::optional<std::string> SyncWatcher::last_error() const {
+    if (!state_) return std::nullopt;
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    return state_->last_error;
+}
+
+} // namespace vost
@@ -0,0 +1,113 @@
+#include "vost/trace.h"
+#include "vost/error.h"
+#include "internal.h"
+
+#include <atomic>
+#include <fstream>
+#include <ostream>
+
+namespace vost {
+
+namespace {
+
+/// Small sequential id for the calling thread (1, 2, ...), stable for its
+/// lifetime; trace viewers render these far better than hashed ids.
+uint32_t trace_tid() {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t tid = next.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+}
+
+/// Nanoseconds as fractional microseconds, the trace-event time unit.
+void write_us(std::ostream& out, uint64_t ns) {
+    out << ns / 1000 << '.';
+    uint64_t frac = ns % 1000;
+    if (frac < 100) out << '0';
+    if (frac < 10) out << '0';
+    out << frac;
+}
+
+} // anonymous namespace
+
+Tracer::Tracer(std::shared_ptr<Observer> next, size_t max_events)
+    : next_(std::move(next))
+    , max_events_(max_events)
+    , origin_ns_(observe::now_ns())
+{}
+
+void Tracer::record(Span span) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (spans_.size() >= max_events_) {
+        ++dropped_;
+        return;
+    }
+    spans_.push_back(span);
+}
+
+void Tracer::on_operation(const OperationStats& stats) {
+    // Operation names are string literals inside the library, so keeping
+    // the view past the callback is safe.
+    record({stats.operation, {}, false, stats.failed, trace_tid(),
+            stats.start_ns, stats.duration_ns, stats.counters});
+    if (next_) next_->on_operation(stats);
+}
+
+void Tracer::on_phase(std::string_view operation, Phase phase,
+                      uint64_t start_ns, uint64_t duration_ns) {
+    record({phase_name(phase), operation, true, false, trace_tid(),
+            start_ns, duration_ns, {}});
+    if (next_) next_->on_phase(operation, phase, start_ns, duration_ns);
+}
+
+void Tracer::write_json(std::ostream& out) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\","
+           "\"args\":{\"name\":\"vost\"}}";
+    for (const auto& s : spans_) {
+        uint64_t ts = s.start_ns > origin_ns_ ? s.start_ns - origin_ns_ : 0;
+        out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << s.tid
+            << ",\"cat\":\"" << (s.is_phase ? "phase" : "op") << "\""
+            << ",\"name\":\"" << s.name << "\",\"ts\":";
+        write_us(out, ts);
+        out << ",\"dur\":";
+        write_us(out, s.duration_ns);
+        out << ",\"args\":{";
+        if (s.is_phase) {
+            out << "\"operation\":\"" << s.parent << "\"";
+        } else {
+            out << "\"failed\":" << (s.failed ? "true" : "false");
+            for (size_t i = 0; i < kCounterCount; ++i)
+                out << ",\"" << counter_name(static_cast<Counter>(i)) << "\":"
+                    << s.counters[i];
+        }
+        out << "}}";
+    }
+    out << "\n],\"otherData\":{\"dropped\":" << dropped_ << "}}\n";
+}
+
+void Tracer::write_json(const std::filesystem::path& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw IoError("cannot open trace file: " + path.string());
+    write_json(out);
+    out.close();
+    if (!out) throw IoError("cannot write trace file: " + path.string());
+}
+
+size_t Tracer::size() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return spans_.size();
+}
+
+size_t Tracer::dropped() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return dropped_;
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    spans_.clear();
+    dropped_ = 0;
+}
+
+} // namespace vost
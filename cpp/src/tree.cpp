@@ -5,10 +5,10 @@
 #include <git2.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <map>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -77,53 +77,48 @@ struct BuilderGuard {
 // entry_at_path — walk tree to a path, return oid + mode
 // ---------------------------------------------------------------------------
 
-struct EntryResult {
-    std::string oid_hex;
-    uint32_t    mode;
-};
-
-/// Return the (oid, mode) of the entry at `norm_path`, or nullopt if missing.
-std::optional<EntryResult>
+/// Return the entry at `norm_path`, or nullopt if missing.  Segments are
+/// walked as views and copied into a stack buffer for libgit2's
+/// NUL-terminated lookup, so ordinary paths allocate nothing.
+std::optional<tree::Entry>
 entry_at_path(git_repository* repo,
               const std::string& tree_oid_hex,
-              const std::string& norm_path) {
-    if (norm_path.empty()) {
-        return EntryResult{tree_oid_hex, MODE_TREE};
-    }
-
-    // Split path into segments
-    std::vector<std::string> segs;
-    {
-        std::istringstream ss(norm_path);
-        std::string tok;
-        while (std::getline(ss, tok, '/')) {
-            if (!tok.empty()) segs.push_back(tok);
-        }
-    }
-
+              std::string_view norm_path) {
     git_oid cur_oid = hex_to_oid(tree_oid_hex);
+    uint32_t mode = MODE_TREE;
+    if (!norm_path.empty()) {
+        observe::PhaseTimer phase(Phase::TreeLookup);
+        char name[256];
+        std::string long_name;
+        for (auto seg : paths::Segments(norm_path)) {
+            // Intermediate must be a tree
+            if (mode != MODE_TREE) return std::nullopt;
 
-    for (size_t i = 0; i < segs.size(); ++i) {
-        TreeGuard tg;
-        if (git_tree_lookup(&tg.t, repo, &cur_oid) != 0) {
-            throw_git_error("git_tree_lookup");
-        }
-
-        const git_tree_entry* entry =
-            git_tree_entry_byname(tg.t, segs[i].c_str());
-        if (!entry) return std::nullopt;
+            TreeGuard tg;
+            observe::count(Counter::TreeLookups);
+            if (git_tree_lookup(&tg.t, repo, &cur_oid) != 0) {
+                throw_git_error("git_tree_lookup");
+            }
 
-        cur_oid = *git_tree_entry_id(entry);
-        uint32_t mode = static_cast<uint32_t>(git_tree_entry_filemode(entry));
+            const char* cname = name;
+            if (seg.size() < sizeof(name)) {
+                std::memcpy(name, seg.data(), seg.size());
+                name[seg.size()] = '\0';
+            } else {
+                long_name.assign(seg);
+                cname = long_name.c_str();
+            }
+            const git_tree_entry* entry = git_tree_entry_byname(tg.t, cname);
+            if (!entry) return std::nullopt;
 
-        if (i == segs.size() - 1) {
-            return EntryResult{oid_to_hex(&cur_oid), mode};
+            cur_oid = *git_tree_entry_id(entry);
+            mode = static_cast<uint32_t>(git_tree_entry_filemode(entry));
         }
-        // Intermediate must be a tree
-        if (mode != MODE_TREE) return std::nullopt;
     }
-
-    return std::nullopt; // unreachable
+    tree::Entry out;
+    std::memcpy(out.oid, cur_oid.id, sizeof(out.oid));
+    out.mode = mode;
+    return out;
 }
 
 } // anonymous namespace
@@ -134,51 +129,101 @@ entry_at_path(git_repository* repo,
 
 namespace tree {
 
+std::string Entry::oid_hex() const {
+    git_oid oid;
+    std::memcpy(oid.id, this->oid, sizeof(this->oid));
+    return oid_to_hex(&oid);
+}
+
+std::optional<Entry>
+find(git_repository* repo,
+     const std::string& tree_oid_hex,
+     std::string_view norm_path) {
+    return entry_at_path(repo, tree_oid_hex, norm_path);
+}
+
 /// Return (oid_hex, mode) of `norm_path` in `tree_oid_hex`, or nullopt.
 std::optional<std::pair<std::string, uint32_t>>
 lookup(git_repository* repo,
        const std::string& tree_oid_hex,
-       const std::string& norm_path) {
+       std::string_view norm_path) {
     auto res = entry_at_path(repo, tree_oid_hex, norm_path);
     if (!res) return std::nullopt;
-    return std::make_pair(res->oid_hex, res->mode);
+    return std::make_pair(res->oid_hex(), res->mode);
 }
 
-/// Read blob at `norm_path` or throw NotFoundError / IsADirectoryError.
-std::vector<uint8_t>
-read_blob(git_repository* repo,
-          const std::string& tree_oid_hex,
-          const std::string& norm_path) {
+BlobRef::~BlobRef() {
+    if (blob_) git_blob_free(blob_);
+}
+
+const uint8_t* BlobRef::data() const {
+    return static_cast<const uint8_t*>(git_blob_rawcontent(blob_));
+}
+
+size_t BlobRef::size() const {
+    return static_cast<size_t>(git_blob_rawsize(blob_));
+}
+
+/// Load the blob at `norm_path` or throw NotFoundError / IsADirectoryError.
+BlobRef load_blob(git_repository* repo,
+                  const std::string& tree_oid_hex,
+                  std::string_view norm_path) {
     auto entry = entry_at_path(repo, tree_oid_hex, norm_path);
-    if (!entry) throw NotFoundError(norm_path);
-    if (entry->mode == MODE_TREE) throw IsADirectoryError(norm_path);
+    if (!entry) throw NotFoundError(std::string(norm_path));
+    if (entry->mode == MODE_TREE) throw IsADirectoryError(std::string(norm_path));
 
-    git_oid oid = hex_to_oid(entry->oid_hex);
-    BlobGuard bg;
-    if (git_blob_lookup(&bg.b, repo, &oid) != 0) {
+    observe::PhaseTimer phase(Phase::BlobRead);
+    git_oid oid;
+    std::memcpy(oid.id, entry->oid, sizeof(entry->oid));
+    git_blob* blob = nullptr;
+    if (git_blob_lookup(&blob, repo, &oid) != 0) {
         throw_git_error("git_blob_lookup");
     }
-    const void* raw = git_blob_rawcontent(bg.b);
-    size_t       sz  = static_cast<size_t>(git_blob_rawsize(bg.b));
-    auto ptr = static_cast<const uint8_t*>(raw);
-    return std::vector<uint8_t>(ptr, ptr + sz);
+    BlobRef ref(blob);
+    observe::count(Counter::BlobLookups);
+    observe::count(Counter::BytesInflated, ref.size());
+    return ref;
+}
+
+BlobRef load_blob_by_oid(git_repository* repo, const std::string& blob_oid_hex) {
+    observe::PhaseTimer phase(Phase::BlobRead);
+    git_oid oid = hex_to_oid(blob_oid_hex);
+    git_blob* blob = nullptr;
+    if (git_blob_lookup(&blob, repo, &oid) != 0) {
+        throw_git_error("git_blob_lookup");
+    }
+    BlobRef ref(blob);
+    observe::count(Counter::BlobLookups);
+    observe::count(Counter::BytesInflated, ref.size());
+    return ref;
+}
+
+/// Read blob at `norm_path` or throw NotFoundError / IsADirectoryError.
+std::vector<uint8_t>
+read_blob(git_repository* repo,
+          const std::string& tree_oid_hex,
+          std::string_view norm_path) {
+    auto blob = load_blob(repo, tree_oid_hex, norm_path);
+    return std::vector<uint8_t>(blob.data(), blob.data() + blob.size());
 }
 
 /// List immediate children of the tree at `norm_path`.
 std::vector<WalkEntry>
 list_tree(git_repository* repo,
           const std::string& tree_oid_hex,
-          const std::string& norm_path) {
+          std::string_view norm_path) {
     std::string target_oid_hex = tree_oid_hex;
     if (!norm_path.empty()) {
         auto entry = entry_at_path(repo, tree_oid_hex, norm_path);
-        if (!entry) throw NotFoundError(norm_path);
-        if (entry->mode != MODE_TREE) throw NotADirectoryError(norm_path);
-        target_oid_hex = entry->oid_hex;
+        if (!entry) throw NotFoundError(std::string(norm_path));
+        if (entry->mode != MODE_TREE) throw NotADirectoryError(std::string(norm_path));
+        target_oid_hex = entry->oid_hex();
     }
 
+    observe::PhaseTimer phase(Phase::TreeWalk);
     git_oid oid = hex_to_oid(target_oid_hex);
     TreeGuard tg;
+    observe::count(Counter::TreeLookups);
     if (git_tree_lookup(&tg.t, repo, &oid) != 0) {
         throw_git_error("git_tree_lookup");
     }
@@ -201,8 +246,10 @@ list_tree(git_repository* repo,
 std::vector<WalkEntry>
 list_tree_by_oid(git_repository* repo,
                  const std::string& tree_oid_hex) {
+    observe::PhaseTimer phase(Phase::TreeWalk);
     git_oid oid = hex_to_oid(tree_oid_hex);
     TreeGuard tg;
+    observe::count(Counter::TreeLookups);
     if (git_tree_lookup(&tg.t, repo, &oid) != 0)
         throw_git_error("git_tree_lookup");
 
@@ -225,24 +272,28 @@ list_tree_by_oid(git_repository* repo,
 std::vector<std::pair<std::string, WalkEntry>>
 walk_tree(git_repository* repo,
           const std::string& tree_oid_hex,
-          const std::string& norm_path) {
+          std::string_view norm_path,
+          const WalkPrune* prune) {
     std::string target_oid_hex = tree_oid_hex;
     if (!norm_path.empty()) {
         auto entry = entry_at_path(repo, tree_oid_hex, norm_path);
-        if (!entry) throw NotFoundError(norm_path);
-        if (entry->mode != MODE_TREE) throw NotADirectoryError(norm_path);
-        target_oid_hex = entry->oid_hex;
+        if (!entry) throw NotFoundError(std::string(norm_path));
+        if (entry->mode != MODE_TREE) throw NotADirectoryError(std::string(norm_path));
+        target_oid_hex = entry->oid_hex();
     }
 
+    observe::PhaseTimer phase(Phase::TreeWalk);
     std::vector<std::pair<std::string, WalkEntry>> results;
 
     struct Ctx {
         git_repository* repo;
         std::vector<std::pair<std::string, WalkEntry>>* results;
-    } ctx{repo, &results};
+        const WalkPrune* prune;
+    } ctx{repo, &results, prune};
 
     git_oid root_oid = hex_to_oid(target_oid_hex);
     TreeGuard tg;
+    observe::count(Counter::TreeLookups);
     if (git_tree_lookup(&tg.t, repo, &root_oid) != 0) {
         throw_git_error("git_tree_lookup");
     }
@@ -252,11 +303,18 @@ walk_tree(git_repository* repo,
                         void* payload) -> int {
         auto* c = static_cast<Ctx*>(payload);
         uint32_t mode = static_cast<uint32_t>(git_tree_entry_filemode(entry));
-        if (mode == MODE_TREE) return 0; // recurse, don't add dirs
+        if (mode == MODE_TREE) {
+            // Recurse (a positive return skips the subtree), don't add dirs
+            if (c->prune && c->prune->descend &&
+                !c->prune->descend(std::string(root) + git_tree_entry_name(entry)))
+                return 1;
+            return 0;
+        }
 
         std::string rel = std::string(root) + git_tree_entry_name(entry);
         // Strip trailing slash that git_tree_walk adds to root
         if (!rel.empty() && rel.back() == '/') rel.pop_back();
+        if (c->prune && c->prune->keep && !c->prune->keep(rel)) return 0;
 
         WalkEntry we;
         we.name = git_tree_entry_name(entry);
@@ -273,7 +331,7 @@ walk_tree(git_repository* repo,
     if (!norm_path.empty()) {
         // Prefix all paths with norm_path
         for (auto& [p, e] : results) {
-            p = norm_path + "/" + p;
+            p = std::string(norm_path) + "/" + p;
         }
     }
 
@@ -284,13 +342,13 @@ walk_tree(git_repository* repo,
 std::vector<WalkDirEntry>
 walk_tree_dirs(git_repository* repo,
                const std::string& tree_oid_hex,
-               const std::string& norm_path) {
+               std::string_view norm_path) {
     std::string target_oid_hex = tree_oid_hex;
     if (!norm_path.empty()) {
         auto entry = entry_at_path(repo, tree_oid_hex, norm_path);
-        if (!entry) throw NotFoundError(norm_path);
-        if (entry->mode != MODE_TREE) throw NotADirectoryError(norm_path);
-        target_oid_hex = entry->oid_hex;
+        if (!entry) throw NotFoundError(std::string(norm_path));
+        if (entry->mode != MODE_TREE) throw NotADirectoryError(std::string(norm_path));
+        target_oid_hex = entry->oid_hex();
     }
 
     std::vector<WalkDirEntry> results;
@@ -300,6 +358,7 @@ walk_tree_dirs(git_repository* repo,
         [&](const std::string& oid_hex, const std::string& prefix) {
         git_oid oid = hex_to_oid(oid_hex);
         TreeGuard tg;
+        observe::count(Counter::TreeLookups);
         if (git_tree_lookup(&tg.t, repo, &oid) != 0)
             throw_git_error("git_tree_lookup");
 
@@ -335,7 +394,8 @@ walk_tree_dirs(git_repository* repo,
         }
     };
 
-    recurse(target_oid_hex, norm_path);
+    observe::PhaseTimer phase(Phase::TreeWalk);
+    recurse(target_oid_hex, std::string(norm_path));
     return results;
 }
 
@@ -343,6 +403,7 @@ walk_tree_dirs(git_repository* repo,
 uint32_t count_subdirs(git_repository* repo, const std::string& tree_oid_hex) {
     git_oid oid = hex_to_oid(tree_oid_hex);
     TreeGuard tg;
+    observe::count(Counter::TreeLookups);
     if (git_tree_lookup(&tg.t, repo, &oid) != 0) {
         throw_git_error("git_tree_lookup");
     }
@@ -357,6 +418,18 @@ uint32_t count_subdirs(git_repository* repo, const std::string& tree_oid_hex) {
     return count;
 }
 
+uint64_t blob_size(git_repository* repo, const git_oid& oid) {
+    git_odb* odb = nullptr;
+    if (git_repository_odb(&odb, repo) != 0)
+        throw_git_error("git_repository_odb");
+    size_t len = 0;
+    git_object_t type = GIT_OBJECT_INVALID;
+    int rc = git_odb_read_header(&len, &type, odb, &oid);
+    git_odb_free(odb);
+    if (rc != 0) throw_git_error("git_odb_read_header");
+    return static_cast<uint64_t>(len);
+}
+
 // ---------------------------------------------------------------------------
 // Tree rebuild — apply writes/removes to produce a new root tree OID
 // ---------------------------------------------------------------------------
@@ -370,44 +443,48 @@ std::string rebuild_tree(
     const std::string& base_tree_oid_hex,
     const std::vector<std::pair<std::string,
                                 std::pair<std::vector<uint8_t>, uint32_t>>>& writes,
-    const std::vector<std::string>& removes)
+    const std::vector<std::string>& removes,
+    const std::vector<std::pair<std::string,
+                                std::pair<std::string, uint32_t>>>& stored,
+    const odb::BlobWriter* blobs)
 {
     // Build a recursive representation of the tree mutations:
     // We process path by path, rebuilding trees bottom-up.
 
     // Helper: split path into segments
-    auto split = [](const std::string& p) {
-        std::vector<std::string> segs;
-        std::istringstream ss(p);
-        std::string tok;
-        while (std::getline(ss, tok, '/')) {
-            if (!tok.empty()) segs.push_back(tok);
-        }
+    // Segments are views into the caller's path strings, which outlive us.
+    auto split = [](std::string_view p) {
+        std::vector<std::string_view> segs;
+        for (auto seg : paths::Segments(p)) segs.push_back(seg);
         return segs;
     };
 
     // Write blobs first and collect (path, oid_hex, mode)
     struct PendingWrite {
-        std::vector<std::string> segs;
+        std::vector<std::string_view> segs;
         std::string              oid_hex;
         uint32_t                 mode;
     };
 
     std::vector<PendingWrite> pending;
+    for (auto& [norm_path, oid_mode] : stored)
+        pending.push_back({split(norm_path), oid_mode.first, oid_mode.second});
+    observe::PhaseTimer blob_write(Phase::BlobWrite);
     for (auto& [norm_path, data_mode] : writes) {
         auto& [data, mode] = data_mode;
 
         // Write blob
         git_oid blob_oid;
-        if (git_blob_create_from_buffer(&blob_oid, repo,
-                                        data.data(), data.size()) != 0) {
-            throw_git_error("git_blob_create_from_buffer");
-        }
+        (blobs ? *blobs : odb::BlobWriter(repo)).write(data.data(), data.size(), &blob_oid,
+                                                       norm_path);
+        observe::count(Counter::BlobsWritten);
+        observe::count(Counter::BytesWritten, data.size());
         pending.push_back({split(norm_path), oid_to_hex(&blob_oid), mode});
     }
+    blob_write.stop();
 
     // Set of paths to remove (as segment vectors)
-    std::vector<std::vector<std::string>> remove_segs;
+    std::vector<std::vector<std::string_view>> remove_segs;
     for (auto& p : removes) {
         remove_segs.push_back(split(p));
     }
@@ -424,7 +501,7 @@ std::string rebuild_tree(
         int depth = static_cast<int>(prefix.size());
 
         // Helper: check if a path's first `depth` segments match `prefix`
-        auto matches_prefix = [&](const std::vector<std::string>& segs) {
+        auto matches_prefix = [&](const std::vector<std::string_view>& segs) {
             if (static_cast<int>(segs.size()) <= depth) return false;
             for (int i = 0; i < depth; ++i) {
                 if (segs[i] != prefix[i]) return false;
@@ -440,6 +517,7 @@ std::string rebuild_tree(
             // If oid is all-zeros (sentinel for empty tree), init empty builder
             bool is_empty = (cur_tree_oid_hex ==
                              std::string(GIT_OID_HEXSZ, '0'));
+            if (!is_empty) observe::count(Counter::TreeLookups);
             if (!is_empty && git_tree_lookup(&tg.t, repo, &base_oid) == 0) {
                 if (git_treebuilder_new(&bg.tb, repo, tg.t) != 0) {
                     throw_git_error("git_treebuilder_new");
@@ -462,10 +540,10 @@ std::string rebuild_tree(
             if (!matches_prefix(pw.segs)) continue;
             if (pw.segs.size() == static_cast<size_t>(depth + 1)) {
                 // Leaf at this level
-                inserts[pw.segs[depth]] = {pw.oid_hex, pw.mode};
+                inserts[std::string(pw.segs[depth])] = {pw.oid_hex, pw.mode};
             } else {
                 // Goes deeper — record that we need to recurse into subtree
-                std::string name = pw.segs[depth];
+                std::string name(pw.segs[depth]);
                 if (subtree_writes.find(name) == subtree_writes.end()) {
                     // Get current subtree oid (if exists)
                     const git_tree_entry* e =
@@ -484,10 +562,10 @@ std::string rebuild_tree(
             if (!matches_prefix(rv)) continue;
             if (rv.size() == static_cast<size_t>(depth + 1)) {
                 // Remove at this level
-                git_treebuilder_remove(bg.tb, rv[depth].c_str());
+                git_treebuilder_remove(bg.tb, std::string(rv[depth]).c_str());
             } else {
                 // Goes deeper
-                std::string name = rv[depth];
+                std::string name(rv[depth]);
                 if (subtree_writes.find(name) == subtree_writes.end()) {
                     const git_tree_entry* e =
                         git_treebuilder_get(bg.tb, name.c_str());
@@ -535,6 +613,159 @@ std::string rebuild_tree(
     return rebuild(base_tree_oid_hex, {});
 }
 
+// ---------------------------------------------------------------------------
+// merge_trees — three-way merge at the tree-entry level
+// ---------------------------------------------------------------------------
+
+namespace {
+
+bool same_entry(const std::optional<WalkEntry>& a,
+                const std::optional<WalkEntry>& b) {
+    if (!a || !b) return !a && !b;
+    return a->oid == b->oid && a->mode == b->mode;
+}
+
+bool is_tree(const std::optional<WalkEntry>& e) {
+    return e && e->mode == MODE_TREE;
+}
+
+/// Merge one directory level.  Empty hex means "no tree on this side".
+/// Returns the merged tree's hex, or "" if it would be empty (and !root).
+std::string merge_level(git_repository* repo,
+                        const std::string& base,
+                        const std::string& ours,
+                        const std::string& theirs,
+                        const std::string& prefix,
+                        bool root,
+                        std::optional<MergeFavor> favor,
+                        std::vector<MergeConflict>& conflicts) {
+    // Identical on two sides: take the result by OID without descending.
+    if (ours == theirs || base == theirs) return ours;
+    if (base == ours) return theirs;
+
+    std::map<std::string, std::array<std::optional<WalkEntry>, 3>> slots;
+    const std::string* sides[3] = {&base, &ours, &theirs};
+    for (size_t i = 0; i < 3; ++i) {
+        if (sides[i]->empty()) continue;
+        for (auto& e : list_tree_by_oid(repo, *sides[i])) {
+            std::string name = e.name;
+            slots[name][i] = std::move(e);
+        }
+    }
+
+    BuilderGuard bg;
+    if (git_treebuilder_new(&bg.tb, repo, nullptr) != 0)
+        throw_git_error("git_treebuilder_new");
+
+    for (auto& [name, slot] : slots) {
+        const auto& b = slot[0];
+        const auto& o = slot[1];
+        const auto& t = slot[2];
+        std::string path = prefix.empty() ? name : prefix + "/" + name;
+
+        std::optional<WalkEntry> pick;
+        if (same_entry(o, t) || same_entry(b, t)) {
+            pick = o;
+        } else if (same_entry(b, o)) {
+            pick = t;
+        } else if (is_tree(o) && is_tree(t)) {
+            std::string sub = merge_level(repo, is_tree(b) ? b->oid : "",
+                                          o->oid, t->oid, path, false,
+                                          favor, conflicts);
+            if (!sub.empty()) {
+                pick = o;
+                pick->oid = sub;
+            }
+        } else {
+            conflicts.push_back({path, b, o, t});
+            pick = favor == MergeFavor::Theirs ? t : o;
+        }
+        if (!pick) continue;
+
+        git_oid oid = hex_to_oid(pick->oid);
+        if (git_treebuilder_insert(nullptr, bg.tb, name.c_str(), &oid,
+                                   static_cast<git_filemode_t>(pick->mode)) != 0)
+            throw_git_error("git_treebuilder_insert");
+    }
+
+    if (!root && git_treebuilder_entrycount(bg.tb) == 0) return "";
+    git_oid out;
+    if (git_treebuilder_write(&out, bg.tb) != 0)
+        throw_git_error("git_treebuilder_write");
+    return oid_to_hex(&out);
+}
+
+} // anonymous namespace
+
+/// Three-way merge of `ours` and `theirs` against `base` ("" = no common
+/// ancestor).  Subtrees equal on two sides are taken by OID, so the cost is
+/// proportional to the paths that differ.  Conflicting paths are appended to
+/// `conflicts` and resolved in favour of `favor` (ours if unset).
+std::string merge_trees(git_repository* repo,
+                        const std::string& base_tree_oid_hex,
+                        const std::string& ours_tree_oid_hex,
+                        const std::string& theirs_tree_oid_hex,
+                        std::optional<MergeFavor> favor,
+                        std::vector<MergeConflict>& conflicts) {
+    return merge_level(repo, base_tree_oid_hex, ours_tree_oid_hex,
+                       theirs_tree_oid_hex, "", true, favor, conflicts);
+}
+
+// ---------------------------------------------------------------------------
+// diff_trees — leaf changes between two trees
+// ---------------------------------------------------------------------------
+
+namespace {
+
+void diff_level(git_repository* repo,
+                const std::string& old_hex,
+                const std::string& new_hex,
+                const std::string& prefix,
+                std::vector<TreeChange>& out) {
+    // Equal subtrees are skipped by OID without descending.
+    if (old_hex == new_hex) return;
+
+    std::map<std::string, std::array<std::optional<WalkEntry>, 2>> slots;
+    const std::string* sides[2] = {&old_hex, &new_hex};
+    for (size_t i = 0; i < 2; ++i) {
+        if (sides[i]->empty()) continue;
+        for (auto& e : list_tree_by_oid(repo, *sides[i])) {
+            std::string name = e.name;
+            slots[name][i] = std::move(e);
+        }
+    }
+
+    for (auto& [name, slot] : slots) {
+        const auto& o = slot[0];
+        const auto& n = slot[1];
+        if (same_entry(o, n)) continue;
+        std::string path = prefix.empty() ? name : prefix + "/" + name;
+
+        std::optional<WalkEntry> o_leaf, n_leaf;
+        if (o && !is_tree(o)) o_leaf = o;
+        if (n && !is_tree(n)) n_leaf = n;
+
+        // A file becoming a directory is removed before the directory's
+        // contents are added; a directory becoming a file is emptied first.
+        bool leaf_first = o_leaf && !n_leaf;
+        if (leaf_first) out.push_back({path, o_leaf, std::nullopt});
+        if (is_tree(o) || is_tree(n))
+            diff_level(repo, is_tree(o) ? o->oid : "", is_tree(n) ? n->oid : "",
+                       path, out);
+        if (!leaf_first && (o_leaf || n_leaf)) out.push_back({path, o_leaf, n_leaf});
+    }
+}
+
+} // anonymous namespace
+
+std::vector<TreeChange> diff_trees(git_repository* repo,
+                                   const std::string& old_tree_oid_hex,
+                                   const std::string& new_tree_oid_hex) {
+    std::vector<TreeChange> out;
+    diff_level(repo, old_tree_oid_hex, new_tree_oid_hex, "", out);
+    return out;
+}
+
 /// Write a new commit and return its 40-char hex SHA.
 std::string write_commit(
     git_repository* repo,
@@ -545,6 +776,7 @@ std::string write_commit(
 {
     git_oid tree_oid = hex_to_oid(tree_oid_hex);
     TreeGuard tg;
+    observe::count(Counter::TreeLookups);
     if (git_tree_lookup(&tg.t, repo, &tree_oid) != 0) {
         throw_git_error("git_tree_lookup (write_commit)");
     }
@@ -605,6 +837,41 @@ std::string write_commit(
     return oid_to_hex(&new_commit_oid);
 }
 
+/// Re-create a commit on new parents, keeping its tree, author, committer
+/// and message.
+std::string rewrite_commit(git_repository* repo,
+                           const std::string& commit_oid_hex,
+                           const std::vector<std::string>& parent_oids) {
+    git_oid commit_oid = hex_to_oid(commit_oid_hex);
+    CommitGuard cg;
+    if (git_commit_lookup(&cg.c, repo, &commit_oid) != 0)
+        throw_git_error("git_commit_lookup (rewrite_commit)");
+    TreeGuard tg;
+    if (git_commit_tree(&tg.t, cg.c) != 0)
+        throw_git_error("git_commit_tree (rewrite_commit)");
+
+    std::vector<CommitGuard> parents(parent_oids.size());
+    std::vector<const git_commit*> parents_vec;
+    for (size_t i = 0; i < parent_oids.size(); ++i) {
+        git_oid poid = hex_to_oid(parent_oids[i]);
+        if (git_commit_lookup(&parents[i].c, repo, &poid) != 0)
+            throw_git_error("git_commit_lookup (parent)");
+        parents_vec.push_back(parents[i].c);
+    }
+
+    git_oid new_oid;
+    if (git_commit_create(&new_oid, repo, nullptr,
+                          git_commit_author(cg.c),
+                          git_commit_committer(cg.c),
+                          git_commit_message_encoding(cg.c),
+                          git_commit_message(cg.c),
+                          tg.t,
+                          parents_vec.size(),
+                          parents_vec.empty() ? nullptr : parents_vec.data()) != 0)
+        throw_git_error("git_commit_create (rewrite_commit)");
+    return oid_to_hex(&new_oid);
+}
+
 /// Resolve the tree OID for a commit.
 std::string tree_oid_for_commit(git_repository* repo,
                                  const std::string& commit_oid_hex) {
@@ -0,0 +1,409 @@
+#include "vost/watch.h"
+#include "vost/gitstore.h"
+#include "internal.h"
+
+#include <git2.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+namespace vost {
+
+// ---------------------------------------------------------------------------
+// RefWatchState
+// ---------------------------------------------------------------------------
+//
+// Each RefWatch owns a background thread with its own git_repository handle,
+// so rescans never contend with GitStoreInner::mutex.  The thread sleeps
+// until something may have changed:
+//
+//   * on Linux, inotify reports a ref file (or packed-refs) being renamed into
+//     place or removed -- i.e. a ref lock being released;
+//   * vost's own writes in this process call watch::notify(), which wakes the
+//     thread directly (eventfd on Linux, a condition variable elsewhere);
+//   * without inotify, the thread rescans every poll_interval_ms.
+//
+// After the first signal the thread waits coalesce_ms for further signals,
+// then re-reads the watched refs and reports one RefChange per ref whose
+// target differs from the last delivered value.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using RefTargets = std::map<std::string, std::string>;
+
+std::string oid_hex(const git_oid* o) {
+    char buf[GIT_OID_HEXSZ + 1];
+    git_oid_tostr(buf, sizeof(buf), o);
+    return std::string(buf, GIT_OID_HEXSZ);
+}
+
+bool is_branch_or_tag(const std::string& name) {
+    return name.compare(0, 11, "refs/heads/") == 0 ||
+           name.compare(0, 10, "refs/tags/") == 0;
+}
+
+} // anonymous namespace
+
+struct RefWatchState {
+    std::shared_ptr<GitStoreInner> inner;
+    git_repository*                repo = nullptr;
+    std::vector<std::string>       refs;     ///< Full names; empty = all branches and tags.
+    RefWatchCallback               callback;
+    WatchOptions                   opts;
+    RefTargets                     known;    ///< Last delivered target per ref.
+
+    std::atomic<bool> stopping{false};
+    std::thread       thread;
+
+#ifdef __linux__
+    int inotify_fd = -1;
+    int wake_fd = -1;
+    int gitdir_wd = -1;
+    std::unordered_map<int, std::filesystem::path> dirs; ///< inotify wd -> directory
+#endif
+    std::mutex              wake_mutex;
+    std::condition_variable wake_cv;
+    bool                    woken = false;
+
+    ~RefWatchState() {
+#ifdef __linux__
+        if (inotify_fd >= 0) ::close(inotify_fd);
+        if (wake_fd >= 0) ::close(wake_fd);
+#endif
+        if (repo) git_repository_free(repo);
+    }
+
+    bool watches(const std::string& refname) const {
+        if (refs.empty()) return is_branch_or_tag(refname);
+        for (const auto& r : refs)
+            if (r == refname) return true;
+        return false;
+    }
+
+    void wake() {
+#ifdef __linux__
+        if (wake_fd >= 0) {
+            uint64_t one = 1;
+            ssize_t n = ::write(wake_fd, &one, sizeof(one));
+            (void)n;
+            return;
+        }
+#endif
+        {
+            std::lock_guard<std::mutex> lk(wake_mutex);
+            woken = true;
+        }
+        wake_cv.notify_one();
+    }
+
+    /// Read the current target of every watched ref.
+    RefTargets scan() const {
+        RefTargets out;
+        if (refs.empty()) {
+            git_reference_iterator* iter = nullptr;
+            if (git_reference_iterator_new(&iter, repo) != 0) return out;
+            git_reference* ref = nullptr;
+            while (git_reference_next(&ref, iter) == 0) {
+                const char* name = git_reference_name(ref);
+                git_reference* resolved = nullptr;
+                if (name && is_branch_or_tag(name) &&
+                    git_reference_resolve(&resolved, ref) == 0) {
+                    if (const git_oid* oid = git_reference_target(resolved))
+                        out[name] = oid_hex(oid);
+                    git_reference_free(resolved);
+                }
+                git_reference_free(ref);
+            }
+            git_reference_iterator_free(iter);
+            return out;
+        }
+        for (const auto& name : refs) {
+            git_oid oid;
+            if (git_reference_name_to_id(&oid, repo, name.c_str()) == 0)
+                out[name] = oid_hex(&oid);
+        }
+        return out;
+    }
+
+    /// Rescan and deliver one event per ref whose target changed.
+    void deliver() {
+        RefTargets now = scan();
+        std::vector<RefChange> changes;
+        for (const auto& [name, target] : now) {
+            auto it = known.find(name);
+            if (it == known.end())
+                changes.push_back({name, std::nullopt, target});
+            else if (it->second != target)
+                changes.push_back({name, it->second, target});
+        }
+        for (const auto& [name, target] : known) {
+            if (!now.count(name))
+                changes.push_back({name, target, std::nullopt});
+        }
+        known = std::move(now);
+
+        for (const auto& change : changes) {
+            if (stopping.load()) return;
+            try {
+                callback(change);
+            } catch (...) {
+                // A throwing callback must not end the subscription.
+            }
+        }
+    }
+
+#ifdef __linux__
+    /// Watch `dir` and every directory below it.
+    void watch_tree(const std::filesystem::path& dir) {
+        int wd = inotify_add_watch(
+            inotify_fd, dir.c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM |
+            IN_CLOSE_WRITE | IN_ONLYDIR | IN_DONT_FOLLOW);
+        if (wd < 0) return;
+        dirs[wd] = dir;
+        std::error_code ec;
+        for (auto it = std::filesystem::directory_iterator(dir, ec);
+             !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            if (it->is_directory(ec) && !it->is_symlink(ec))
+                watch_tree(it->path());
+        }
+    }
+
+    bool start_inotify() {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotify_fd < 0 || wake_fd < 0) {
+            if (inotify_fd >= 0) { ::close(inotify_fd); inotify_fd = -1; }
+            if (wake_fd >= 0) { ::close(wake_fd); wake_fd = -1; }
+            return false;
+        }
+        // The git dir itself only matters for packed-refs.
+        gitdir_wd = inotify_add_watch(
+            inotify_fd, inner->path.c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR);
+        watch_tree(inner->path / "refs");
+        return gitdir_wd >= 0;
+    }
+
+    /// Drain pending inotify events.  Returns true if any may affect refs.
+    bool drain_inotify() {
+        alignas(struct inotify_event) char buf[16384];
+        bool relevant = false;
+        while (true) {
+            ssize_t n = ::read(inotify_fd, buf, sizeof(buf));
+            if (n <= 0) break;
+            for (char* p = buf; p < buf + n;) {
+                auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + ev->len;
+
+                if (ev->mask & IN_Q_OVERFLOW) { relevant = true; continue; }
+                if (ev->mask & IN_IGNORED) { dirs.erase(ev->wd); continue; }
+
+                std::string name = ev->len ? ev->name : "";
+                if (ev->wd == gitdir_wd) {
+                    if (name == "packed-refs") relevant = true;
+                    continue;
+                }
+                auto dir = dirs.find(ev->wd);
+                if (dir == dirs.end()) continue;
+
+                if ((ev->mask & IN_ISDIR) &&
+                    (ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+                    watch_tree(dir->second / name);
+                    relevant = true;
+                    continue;
+                }
+                // Lock files come and go while a ref is being written; the
+                // rename of the lock onto the ref name is what matters.
+                if (name.size() >= 5 &&
+                    name.compare(name.size() - 5, 5, ".lock") == 0)
+                    continue;
+                relevant = true;
+            }
+        }
+        return relevant;
+    }
+#endif
+
+    void run() {
+        bool dirty = false;
+        Clock::time_point deadline;
+        auto mark_dirty = [&]() {
+            if (!dirty) {
+                dirty = true;
+                deadline = Clock::now() + std::chrono::milliseconds(opts.coalesce_ms);
+            }
+        };
+        auto poll_period = std::chrono::milliseconds(
+            opts.poll_interval_ms ? opts.poll_interval_ms : 1);
+
+#ifdef __linux__
+        if (inotify_fd >= 0) {
+            while (!stopping.load()) {
+                int timeout = -1;
+                if (dirty) {
+                    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count();
+                    timeout = left > 0 ? static_cast<int>(left) : 0;
+                }
+                struct pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+                ::poll(fds, 2, timeout);
+                if (stopping.load()) break;
+
+                if (fds[1].revents & POLLIN) {
+                    uint64_t count;
+                    ssize_t n = ::read(wake_fd, &count, sizeof(count));
+                    (void)n;
+                    mark_dirty();
+                }
+                if ((fds[0].revents & POLLIN) && drain_inotify()) mark_dirty();
+
+                if (dirty && Clock::now() >= deadline) {
+                    dirty = false;
+                    deliver();
+                }
+            }
+            return;
+        }
+#endif
+
+        // Portable fallback: periodic rescans, woken early by in-process writes.
+        auto next_poll = Clock::now() + poll_period;
+        while (!stopping.load()) {
+            auto until = dirty ? std::min(deadline, next_poll) : next_poll;
+            {
+                std::unique_lock<std::mutex> lk(wake_mutex);
+                wake_cv.wait_until(lk, until, [&] { return woken || stopping.load(); });
+                if (woken) { woken = false; mark_dirty(); }
+            }
+            if (stopping.load()) break;
+
+            auto now = Clock::now();
+            if (now >= next_poll) {
+                mark_dirty();
+                deadline = now;
+                next_poll = now + poll_period;
+            }
+            if (dirty && now >= deadline) {
+                dirty = false;
+                deliver();
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// watch::notify
+// ---------------------------------------------------------------------------
+
+namespace watch {
+
+void notify(GitStoreInner& inner, const std::string& refname) {
+    auto& list = inner.watches;
+    for (auto it = list.begin(); it != list.end();) {
+        auto state = it->lock();
+        if (!state) {
+            it = list.erase(it);
+            continue;
+        }
+        if (refname.empty() || state->watches(refname)) state->wake();
+        ++it;
+    }
+}
+
+} // namespace watch
+
+// ---------------------------------------------------------------------------
+// GitStore::watch
+// ---------------------------------------------------------------------------
+
+RefWatch GitStore::watch(const std::vector<std::string>& refs,
+                         RefWatchCallback callback,
+                         WatchOptions opts) {
+    if (!callback) throw std::invalid_argument("watch: callback is required");
+
+    auto state = std::make_shared<RefWatchState>();
+    state->inner = inner_;
+    state->callback = std::move(callback);
+    state->opts = opts;
+    for (const auto& r : refs) {
+        if (r.compare(0, 5, "refs/") == 0) {
+            state->refs.push_back(r);
+        } else {
+            paths::validate_ref_name(r);
+            state->refs.push_back("refs/heads/" + r);
+        }
+    }
+
+    if (git_repository_open_bare(&state->repo, inner_->path.string().c_str()) != 0) {
+        const git_error* e = git_error_last();
+        std::string msg = "git_repository_open_bare";
+        if (e && e->message) { msg += ": "; msg += e->message; }
+        throw GitError(msg);
+    }
+
+#ifdef __linux__
+    state->start_inotify();
+#endif
+    // Baseline: only changes after watch() returns are reported.
+    state->known = state->scan();
+
+    {
+        std::lock_guard<std::mutex> lk(inner_->mutex);
+        inner_->watches.push_back(state);
+    }
+    state->thread = std::thread([self = state]() { self->run(); });
+    return RefWatch(std::move(state));
+}
+
+// ---------------------------------------------------------------------------
+// RefWatch
+// ---------------------------------------------------------------------------
+
+RefWatch::RefWatch(std::shared_ptr<RefWatchState> state)
+    : state_(std::move(state)) {}
+
+RefWatch::~RefWatch() {
+    stop();
+}
+
+RefWatch& RefWatch::operator=(RefWatch&& other) noexcept {
+    if (this != &other) {
+        stop();
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
+
+void RefWatch::stop() {
+    if (!state_) return;
+    auto state = std::move(state_);
+    if (state->stopping.exchange(true)) return;
+    state->wake();
+    if (state->thread.joinable()) {
+        if (state->thread.get_id() == std::this_thread::get_id())
+            state->thread.detach();  // stop() from inside the callback
+        else
+            state->thread.join();
+    }
+}
+
+bool RefWatch::active() const {
+    return state_ && !state_->stopping.load();
+}
+
+} // namespace vost
@@ -0,0 +1,28 @@
+# Fail unless every dynamic symbol defined by the vost_c library is a
+# vost_* function.  Run with -DNM=<nm> -DLIB=<libvost_c.so>.
+
+execute_process(
+    COMMAND "${NM}" -D --defined-only "${LIB}"
+    OUTPUT_VARIABLE out
+    RESULT_VARIABLE rc
+)
+if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "nm failed on ${LIB}")
+endif()
+
+string(REPLACE "\n" ";" lines "${out}")
+set(api 0)
+foreach(line IN LISTS lines)
+    if(line MATCHES "^[0-9a-fA-F]* +[A-Za-z] +([^ @]+)")
+        set(sym "${CMAKE_MATCH_1}")
+        if(sym MATCHES "^vost_")
+            math(EXPR api "${api} + 1")
+        elseif(NOT sym MATCHES "^VOST_C_1$")
+            message(FATAL_ERROR "unexpected exported symbol: ${sym}")
+        endif()
+    endif()
+endforeach()
+if(api EQUAL 0)
+    message(FATAL_ERROR "no vost_* symbols exported from ${LIB}")
+endif()
+message(STATUS "${api} vost_* symbols exported")
@@ -405,3 +405,54 @@ TEST_CASE("apply: WriteEntry blob with target throws", "[apply]") {
     REQUIRE_THROWS_AS(snap.apply(writes), vost::InvalidPathError);
     fs::remove_all(path);
 }
+
+// ---------------------------------------------------------------------------
+// apply: WriteEntry::from_oid
+// ---------------------------------------------------------------------------
+
+TEST_CASE("apply: from_oid references existing blobs", "[apply][oid]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("src/a.txt", "shared content");
+    auto hash = snap.object_hash("src/a.txt");
+
+    std::vector<std::pair<std::string, vost::WriteEntry>> writes;
+    writes.push_back({"copy.txt", vost::WriteEntry::from_oid(hash)});
+    writes.push_back({"run.sh", vost::WriteEntry::from_oid(hash, vost::MODE_BLOB_EXEC)});
+    writes.push_back({"new.txt", vost::WriteEntry::from_text("fresh")});
+    snap = snap.apply(writes);
+
+    CHECK(snap.read_text("copy.txt") == "shared content");
+    CHECK(snap.object_hash("copy.txt") == hash);
+    CHECK(snap.file_type("run.sh") == vost::FileType::Executable);
+    CHECK(snap.read_text("new.txt") == "fresh");
+    fs::remove_all(path);
+}
+
+TEST_CASE("apply: from_oid with a missing or malformed hash throws", "[apply][oid]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("a.txt", "a");
+    auto tip = snap.commit_hash();
+
+    std::vector<std::pair<std::string, vost::WriteEntry>> writes;
+    writes.push_back({"x.txt", vost::WriteEntry::from_oid(std::string(40, 'e'))});
+    REQUIRE_THROWS_AS(snap.apply(writes), vost::NotFoundError);
+
+    // A tree hash is not a blob.
+    writes[0].second = vost::WriteEntry::from_oid(*snap.tree_hash());
+    REQUIRE_THROWS_AS(snap.apply(writes), vost::NotFoundError);
+
+    writes[0].second = vost::WriteEntry::from_oid("abc123");
+    REQUIRE_THROWS_AS(snap.apply(writes), vost::InvalidHashError);
+
+    auto bad = vost::WriteEntry::from_oid(snap.object_hash("a.txt"));
+    bad.data = std::vector<uint8_t>{'x'};
+    writes[0].second = bad;
+    REQUIRE_THROWS_AS(snap.apply(writes), vost::InvalidPathError);
+
+    CHECK(store.branches().get("main").commit_hash() == tip);
+    fs::remove_all(path);
+}
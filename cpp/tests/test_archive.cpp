@@ -0,0 +1,592 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_archive_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost::GitStore open_store(const fs::path& path) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    return vost::GitStore::open(path, opts);
+}
+
+static std::string export_tar(const vost::Fs& snap, const std::string& path,
+                              vost::TarExportOptions opts = {}) {
+    std::string out;
+    snap.export_tar(path, [&](const uint8_t* p, size_t n) {
+        out.append(reinterpret_cast<const char*>(p), n);
+    }, opts);
+    return out;
+}
+
+/// One parsed tar member, with pax path/linkpath applied.
+struct TarMember {
+    std::string name;
+    char        type;
+    uint32_t    mode;
+    uint64_t    mtime;
+    std::string link;
+    std::string data;
+};
+
+static uint64_t parse_octal(const char* p, size_t n) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < n && p[i] >= '0' && p[i] <= '7'; ++i) v = v * 8 + (p[i] - '0');
+    return v;
+}
+
+static std::string field(const char* p, size_t n) {
+    return std::string(p, strnlen(p, n));
+}
+
+static std::vector<TarMember> parse_tar(const std::string& tar) {
+    REQUIRE(tar.size() % 512 == 0);
+    std::vector<TarMember> out;
+    std::string pax_path, pax_link;
+    size_t pos = 0;
+    while (pos + 512 <= tar.size()) {
+        const char* h = tar.data() + pos;
+        if (h[0] == '\0') break;
+        unsigned sum = 0;
+        for (size_t i = 0; i < 512; ++i)
+            sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(h[i]);
+        CHECK(sum == parse_octal(h + 148, 8));
+        CHECK(std::memcmp(h + 257, "ustar\0" "00", 8) == 0);
+
+        TarMember m;
+        m.name  = field(h, 100);
+        m.type  = h[156];
+        m.mode  = static_cast<uint32_t>(parse_octal(h + 100, 8));
+        m.mtime = parse_octal(h + 136, 12);
+        m.link  = field(h + 157, 100);
+        size_t size = parse_octal(h + 124, 12);
+        m.data = tar.substr(pos + 512, size);
+        pos += 512 + (size + 511) / 512 * 512;
+
+        if (m.type == 'x') {
+            for (size_t i = 0; i < m.data.size();) {
+                size_t sp = m.data.find(' ', i);
+                size_t len = std::stoul(m.data.substr(i, sp - i));
+                std::string rec = m.data.substr(sp + 1, len - (sp - i) - 2);
+                auto eq = rec.find('=');
+                if (rec.substr(0, eq) == "path") pax_path = rec.substr(eq + 1);
+                if (rec.substr(0, eq) == "linkpath") pax_link = rec.substr(eq + 1);
+                i += len;
+            }
+            continue;
+        }
+        if (!pax_path.empty()) m.name = pax_path;
+        if (!pax_link.empty()) m.link = pax_link;
+        pax_path.clear();
+        pax_link.clear();
+        out.push_back(std::move(m));
+    }
+    CHECK(tar.size() - pos >= 1024);
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Archive: export_tar writes files, dirs, modes and symlinks", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto b = snap.batch();
+        b.write_text("src/a.txt", "alpha");
+        b.write_text("src/sub/b.txt", "bravo");
+        b.write_with_mode("src/run.sh", std::vector<uint8_t>{'#', '!'}, vost::MODE_BLOB_EXEC);
+        b.write_symlink("src/link", "a.txt");
+        b.write_text("other.txt", "not exported");
+        snap = b.commit();
+
+        auto members = parse_tar(export_tar(snap, "src"));
+        REQUIRE(members.size() == 5);
+        CHECK(members[0].name == "a.txt");
+        CHECK(members[0].type == '0');
+        CHECK(members[0].mode == 0644);
+        CHECK(members[0].data == "alpha");
+        CHECK(members[0].mtime == snap.time());
+        CHECK(members[1].name == "link");
+        CHECK(members[1].type == '2');
+        CHECK(members[1].link == "a.txt");
+        CHECK(members[2].name == "run.sh");
+        CHECK(members[2].mode == 0755);
+        CHECK(members[2].data == "#!");
+        CHECK(members[3].name == "sub/");
+        CHECK(members[3].type == '5');
+        CHECK(members[3].mode == 0755);
+        CHECK(members[4].name == "sub/b.txt");
+        CHECK(members[4].data == "bravo");
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: export_tar uses pax records for long names", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        std::string dir(60, 'd'), file(70, 'f'), target(120, 't');
+        auto snap = store.branches()["main"]
+                        .write_text(dir + "/" + file, "deep")
+                        .write_symlink("ln", target);
+
+        auto members = parse_tar(export_tar(snap, ""));
+        REQUIRE(members.size() == 3);
+        CHECK(members[0].name == dir + "/");
+        CHECK(members[1].name == dir + "/" + file);
+        CHECK(members[1].data == "deep");
+        CHECK(members[2].name == "ln");
+        CHECK(members[2].link == target);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: export_tar of a single file with a prefix", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("a/b/c.txt", "one");
+
+        auto members = parse_tar(export_tar(snap, "a/b/c.txt", {"pkg-1.0/", 0}));
+        REQUIRE(members.size() == 2);
+        CHECK(members[0].name == "pkg-1.0/");
+        CHECK(members[0].type == '5');
+        CHECK(members[1].name == "pkg-1.0/c.txt");
+        CHECK(members[1].data == "one");
+
+        CHECK_THROWS_AS(export_tar(snap, "nope"), vost::NotFoundError);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: export_tar prefetch produces identical bytes", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto b = store.branches()["main"].batch();
+        for (int i = 0; i < 200; ++i)
+            b.write_text("d" + std::to_string(i % 7) + "/f" + std::to_string(i),
+                         std::string(static_cast<size_t>(i * 37), static_cast<char>('a' + i % 26)));
+        b.write_text("big.bin", std::string(300000, 'z'));
+        auto snap = b.commit();
+
+        auto inline_tar = export_tar(snap, "");
+        CHECK(parse_tar(inline_tar).size() == 208);
+        CHECK(export_tar(snap, "", {"", 4}) == inline_tar);
+        CHECK(export_tar(snap, "", {"", 64}) == inline_tar);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: sink exceptions abort the export", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto b = store.branches()["main"].batch();
+        for (int i = 0; i < 50; ++i)
+            b.write_text("f" + std::to_string(i), std::string(70000, 'x'));
+        auto snap = b.commit();
+
+        for (size_t prefetch : {size_t(0), size_t(3)}) {
+            size_t calls = 0;
+            auto sink = [&](const uint8_t*, size_t) {
+                if (++calls == 3) throw std::runtime_error("disk full");
+            };
+            CHECK_THROWS_AS(snap.export_tar("", sink, {"", prefetch}),
+                            std::runtime_error);
+            CHECK(calls == 3);
+        }
+        // The store is still usable afterwards.
+        CHECK(snap.read_text("f0").size() == 70000);
+    }
+    fs::remove_all(path);
+}
+
+/// Observer keeping the TreeLookups count of the last export.
+struct TreeCounter : vost::Observer {
+    std::atomic<uint64_t> trees{0};
+    void on_operation(const vost::OperationStats& stats) override {
+        trees = stats.count(vost::Counter::TreeLookups);
+    }
+};
+
+TEST_CASE("Archive: exports emit bytes before the whole tree is read", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        // Incompressible members, so each one fills the writers' buffers.
+        std::mt19937 gen(5);
+        std::string noise(70000, '\0');
+        for (auto& c : noise) c = static_cast<char>(gen() & 0xff);
+        auto b = store.branches()["main"].batch();
+        for (int d = 0; d < 40; ++d)
+            for (int f = 0; f < 2; ++f)
+                b.write_text("d" + std::to_string(d) + "/f" + std::to_string(f),
+                             noise + std::to_string(d * 2 + f));
+        auto snap = b.commit();
+        auto counter = std::make_shared<TreeCounter>();
+        store.set_observer(counter);
+
+        auto first_write_fails = [](const uint8_t*, size_t) {
+            throw std::runtime_error("stop");
+        };
+        for (size_t threads : {size_t(0), size_t(2)}) {
+            CHECK_THROWS_AS(snap.export_tar("", first_write_fails, {"", threads}),
+                            std::runtime_error);
+            CHECK(counter->trees < 10);
+            vost::ZipExportOptions zo;
+            zo.threads = threads;
+            CHECK_THROWS_AS(snap.export_zip("", first_write_fails, zo), std::runtime_error);
+            CHECK(counter->trees < 10);
+        }
+
+        // A complete export reads every tree once.
+        snap.export_tar("", [](const uint8_t*, size_t) {});
+        CHECK(counter->trees == 41);
+        store.set_observer(nullptr);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: a throwing sink frees its blob under the store lock", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto b = store.branches()["main"].batch();
+        for (int i = 0; i < 20; ++i)
+            b.write_text("f" + std::to_string(i), std::string(70000, static_cast<char>('a' + i)));
+        auto snap = b.commit();
+
+        // Readers share the repository while exports unwind mid-member.
+        std::atomic<bool> stop{false};
+        std::atomic<int> bad{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t)
+            readers.emplace_back([&, t] {
+                while (!stop)
+                    if (snap.read_text("f" + std::to_string(t)).size() != 70000) ++bad;
+            });
+        for (int round = 0; round < 50; ++round) {
+            size_t calls = 0;
+            auto sink = [&](const uint8_t*, size_t) {
+                if (++calls == 2 + round % 5) throw std::runtime_error("disk full");
+            };
+            CHECK_THROWS_AS(snap.export_tar("", sink), std::runtime_error);
+        }
+        stop = true;
+        for (auto& t : readers) t.join();
+        CHECK(bad == 0);
+        CHECK(snap.read_text("f19") == std::string(70000, 't'));
+    }
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// export_zip
+// ---------------------------------------------------------------------------
+
+static std::string export_zip(const vost::Fs& snap, const std::string& path,
+                              vost::ZipExportOptions opts = {}) {
+    std::string out;
+    snap.export_zip(path, [&](const uint8_t* p, size_t n) {
+        out.append(reinterpret_cast<const char*>(p), n);
+    }, opts);
+    return out;
+}
+
+/// One member read back through the central directory.
+struct ZipMember {
+    std::string name;
+    uint16_t    method;
+    uint32_t    mode;
+    std::string data; ///< Uncompressed.
+};
+
+static uint32_t le(const std::string& s, size_t pos, int bytes) {
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i)
+        v = (v << 8) | static_cast<unsigned char>(s[pos + static_cast<size_t>(i)]);
+    return v;
+}
+
+static std::vector<ZipMember> parse_zip(const std::string& zip) {
+    size_t eocd = zip.size() - 22;
+    REQUIRE(le(zip, eocd, 4) == 0x06054b50);
+    size_t count = le(zip, eocd + 10, 2);
+    size_t pos = le(zip, eocd + 16, 4);
+    std::vector<ZipMember> out;
+    for (size_t i = 0; i < count; ++i) {
+        REQUIRE(le(zip, pos, 4) == 0x02014b50);
+        ZipMember m;
+        m.method = static_cast<uint16_t>(le(zip, pos + 10, 2));
+        uint32_t crc = le(zip, pos + 16, 4);
+        size_t csize = le(zip, pos + 20, 4), usize = le(zip, pos + 24, 4);
+        size_t nlen = le(zip, pos + 28, 2), xlen = le(zip, pos + 30, 2);
+        m.mode = le(zip, pos + 38, 4) >> 16;
+        size_t local = le(zip, pos + 42, 4);
+        m.name = zip.substr(pos + 46, nlen);
+        pos += 46 + nlen + xlen;
+
+        // Local header must agree and the data follows it directly.
+        REQUIRE(le(zip, local, 4) == 0x04034b50);
+        CHECK(le(zip, local + 14, 4) == crc);
+        CHECK(zip.substr(local + 30, nlen) == m.name);
+        size_t data = local + 30 + nlen + le(zip, local + 28, 2);
+        std::string raw = zip.substr(data, csize);
+        if (m.method == 8) {
+            m.data.resize(usize);
+            z_stream zs{};
+            REQUIRE(inflateInit2(&zs, -15) == Z_OK);
+            zs.next_in = reinterpret_cast<Bytef*>(raw.data());
+            zs.avail_in = static_cast<uInt>(raw.size());
+            zs.next_out = reinterpret_cast<Bytef*>(m.data.data());
+            zs.avail_out = static_cast<uInt>(usize);
+            CHECK(inflate(&zs, Z_FINISH) == Z_STREAM_END);
+            inflateEnd(&zs);
+        } else {
+            CHECK(m.method == 0);
+            m.data = raw;
+        }
+        CHECK(crc32(0, reinterpret_cast<const Bytef*>(m.data.data()),
+                    static_cast<uInt>(m.data.size())) == crc);
+        out.push_back(std::move(m));
+    }
+    return out;
+}
+
+TEST_CASE("Archive: export_zip writes members in tree order", "[archive][zip]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto b = store.branches()["main"].batch();
+        std::string text;
+        for (int i = 0; i < 500; ++i) text += "line " + std::to_string(i) + "\n";
+        std::string noise(20000, '\0');
+        uint32_t x = 12345;
+        for (auto& c : noise) { x = x * 1103515245 + 12345; c = static_cast<char>(x >> 24); }
+        b.write_text("doc/readme.txt", text);
+        b.write_text("doc/photo.PNG", text);
+        b.write_text("noise.bin", noise);
+        b.write_text("empty", "");
+        b.write_with_mode("run.sh", std::vector<uint8_t>{'#', '!'}, vost::MODE_BLOB_EXEC);
+        b.write_symlink("latest", "doc/readme.txt");
+        auto snap = b.commit();
+
+        auto members = parse_zip(export_zip(snap, "", {"rel", 0, 6, true}));
+        REQUIRE(members.size() == 8);
+        CHECK(members[0].name == "rel/");
+        CHECK(members[0].mode == 040755);
+        CHECK(members[1].name == "rel/doc/");
+        CHECK(members[2].name == "rel/doc/photo.PNG");
+        CHECK(members[2].method == 0);   // extension says compressed
+        CHECK(members[3].name == "rel/doc/readme.txt");
+        CHECK(members[3].method == 8);
+        CHECK(members[3].data == text);
+        CHECK(members[3].mode == 0100644);
+        CHECK(members[4].name == "rel/empty");
+        CHECK(members[4].data.empty());
+        CHECK(members[5].name == "rel/latest");
+        CHECK(members[5].mode == 0120777);
+        CHECK(members[5].method == 0);
+        CHECK(members[5].data == "doc/readme.txt");
+        CHECK(members[6].name == "rel/noise.bin");
+        CHECK(members[6].method == 0);   // high entropy
+        CHECK(members[6].data == noise);
+        CHECK(members[7].name == "rel/run.sh");
+        CHECK(members[7].mode == 0100755);
+
+        // Without detection, compressible-looking names are deflated.
+        auto all = parse_zip(export_zip(snap, "doc", {"", 0, 9, false}));
+        REQUIRE(all.size() == 2);
+        CHECK(all[0].method == 8);
+        CHECK(all[0].data == text);
+
+        CHECK_THROWS_AS(export_zip(snap, "nope"), vost::NotFoundError);
+        CHECK_THROWS_AS(export_zip(snap, "", {"", 0, 0, true}), std::invalid_argument);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: export_zip with workers produces identical bytes", "[archive][zip]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto b = store.branches()["main"].batch();
+        for (int i = 0; i < 150; ++i) {
+            std::string body;
+            for (int j = 0; j < i * 20; ++j) body += std::to_string(i * j) + ",";
+            b.write_text("d" + std::to_string(i % 5) + "/f" + std::to_string(i) + ".csv", body);
+        }
+        auto snap = b.commit();
+
+        auto inline_zip = export_zip(snap, "");
+        CHECK(parse_zip(inline_zip).size() == 155);
+        CHECK(export_zip(snap, "", {"", 4, 6, true}) == inline_zip);
+        CHECK(export_zip(snap, "d3", {"", 16, 6, true}) == export_zip(snap, "d3"));
+    }
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// import_tar
+// ---------------------------------------------------------------------------
+
+static vost::ArchiveSource string_source(const std::string& tar, size_t step = 4096) {
+    auto pos = std::make_shared<size_t>(0);
+    return [tar, pos, step](uint8_t* buf, size_t size) {
+        size_t n = std::min({size, step, tar.size() - *pos});
+        std::memcpy(buf, tar.data() + *pos, n);
+        *pos += n;
+        return n;
+    };
+}
+
+/// Minimal ustar member: header plus padded data.
+static std::string tar_member(const std::string& name, char type,
+                              const std::string& data = {},
+                              uint32_t mode = 0644,
+                              const std::string& link = {}) {
+    char h[512] = {};
+    std::memcpy(h, name.data(), name.size());
+    std::snprintf(h + 100, 8, "%07o", mode);
+    std::snprintf(h + 124, 12, "%011o", static_cast<unsigned>(data.size()));
+    std::snprintf(h + 136, 12, "%011o", 0u);
+    std::memset(h + 148, ' ', 8);
+    h[156] = type;
+    std::memcpy(h + 157, link.data(), link.size());
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+    unsigned sum = 0;
+    for (unsigned char c : h) sum += c;
+    std::snprintf(h + 148, 8, "%06o", sum);
+    std::string out(h, 512);
+    out += data;
+    out.append((512 - data.size() % 512) % 512, '\0');
+    return out;
+}
+
+TEST_CASE("Archive: import_tar round-trips an exported tree", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto b = store.branches()["main"].batch();
+        b.write_text("a.txt", "alpha");
+        b.write_text(std::string(80, 'd') + "/" + std::string(40, 'f'), "long");
+        b.write_with_mode("bin/run", std::vector<uint8_t>{'x'}, vost::MODE_BLOB_EXEC);
+        b.write_symlink("bin/link", "run");
+        b.write_text("big.dat", std::string(200000, 'q'));
+        auto src = b.commit();
+        auto tar = export_tar(src, "", {"pkg", 0});
+
+        auto dst = store.branches()["main"];
+        store.branches().set("import", dst);
+        dst = store.branches()["import"];
+        vost::TarImportOptions opts;
+        opts.strip_components = 1;
+        opts.message = "upload";
+        auto [report, out] = dst.import_tar(string_source(tar, 1000), "vendor", opts);
+
+        CHECK(report.add.size() == 5);
+        CHECK(report.update.empty());
+        CHECK(out.message() == "upload");
+        CHECK(out.read_text("vendor/a.txt") == "alpha");
+        CHECK(out.read_text("vendor/big.dat").size() == 200000);
+        CHECK(out.file_type("vendor/bin/run") == vost::FileType::Executable);
+        CHECK(out.file_type("vendor/bin/link") == vost::FileType::Link);
+        CHECK(out.readlink("vendor/bin/link") == "run");
+        CHECK(out.read_text("vendor/" + std::string(80, 'd') + "/" + std::string(40, 'f')) == "long");
+
+        // Blobs are shared with the source tree.
+        CHECK(out.object_hash("vendor/big.dat") == src.object_hash("big.dat"));
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: import_tar reports updates and skips unchanged members", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"]
+                        .write_text("same.txt", "same")
+                        .write_text("changed.txt", "old");
+        auto tar = tar_member("./", '5') +
+                   tar_member("./same.txt", '0', "same") +
+                   tar_member("./changed.txt", '0', "new", 0755) +
+                   tar_member("./hard.txt", '1', {}, 0644, "./changed.txt") +
+                   tar_member("./fifo", '6') +
+                   std::string(1024, '\0');
+
+        auto [report, out] = snap.import_tar(string_source(tar));
+        REQUIRE(report.update.size() == 1);
+        CHECK(report.update[0].path == "changed.txt");
+        REQUIRE(report.add.size() == 1);
+        CHECK(report.add[0].path == "hard.txt");
+        REQUIRE(report.warnings.size() == 1);
+        CHECK(report.warnings[0].path == "fifo");
+        CHECK(out.read_text("changed.txt") == "new");
+        CHECK(out.file_type("changed.txt") == vost::FileType::Executable);
+        CHECK(out.read_text("hard.txt") == "new");
+        CHECK(out.log().size() == snap.log().size() + 1);
+
+        // Importing the same archive again is a no-op.
+        auto [again, same] = out.import_tar(string_source(tar));
+        CHECK(again.in_sync());
+        CHECK(same.commit_hash() == out.commit_hash());
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Archive: import_tar rejects bad archives", "[archive]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto head = snap.commit_hash();
+
+        auto truncated = tar_member("a.txt", '0', std::string(2000, 'a')).substr(0, 1024);
+        CHECK_THROWS_AS(snap.import_tar(string_source(truncated)), vost::IoError);
+
+        auto corrupt = tar_member("a.txt", '0', "a");
+        corrupt[0] = 'b';
+        CHECK_THROWS_AS(snap.import_tar(string_source(corrupt)), vost::IoError);
+
+        auto escape = tar_member("../etc/passwd", '0', "x");
+        CHECK_THROWS_AS(snap.import_tar(string_source(escape)), vost::InvalidPathError);
+
+        CHECK(store.branches()["main"].commit_hash() == head);
+    }
+    fs::remove_all(path);
+}
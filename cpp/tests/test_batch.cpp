@@ -559,3 +559,46 @@ TEST_CASE("BatchWriter: write after close throws", "[batch][writer]") {
     REQUIRE_THROWS_AS(w.write("more"), vost::BatchClosedError);
     fs::remove_all(path);
 }
+
+// ---------------------------------------------------------------------------
+// Batch::write_oid
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Batch: write_oid stages existing blobs by hash", "[batch][oid]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    snap = snap.write_text("orig.txt", "payload");
+    auto hash = snap.object_hash("orig.txt");
+
+    auto batch = snap.batch();
+    batch.write_oid("a/ref.txt", hash);
+    batch.write_oid("a/link", store.branches().get("main").object_hash("orig.txt"),
+                    vost::MODE_LINK);
+    batch.write_text("a/over.txt", "text");
+    batch.write_oid("a/over.txt", hash);     // replaces the staged write
+    batch.write_oid("a/gone.txt", hash);
+    batch.remove("a/gone.txt");              // and a remove replaces a ref
+    CHECK(batch.pending_writes() == 3);
+    snap = batch.commit();
+
+    CHECK(snap.read_text("a/ref.txt") == "payload");
+    CHECK(snap.read_text("a/over.txt") == "payload");
+    CHECK(snap.readlink("a/link") == "payload");
+    CHECK_FALSE(snap.exists("a/gone.txt"));
+    fs::remove_all(path);
+}
+
+TEST_CASE("Batch: write_oid validates the hash", "[batch][oid]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+
+    auto batch = snap.batch();
+    REQUIRE_THROWS_AS(batch.write_oid("x", "not-a-hash"), vost::InvalidHashError);
+    REQUIRE_THROWS_AS(batch.write_oid("x", std::string(40, 'a'), vost::MODE_TREE),
+                      vost::InvalidPathError);
+    batch.write_oid("x", std::string(40, 'a'));
+    REQUIRE_THROWS_AS(batch.commit(), vost::NotFoundError);
+    fs::remove_all(path);
+}
@@ -0,0 +1,298 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost_c.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// These tests link only against the vost_c shared library and see only
+// the C header, as a foreign-language binding would.
+
+namespace fs = std::filesystem;
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_ctest_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost_store* open_store(const fs::path& path) {
+    vost_open_options opts;
+    vost_open_options_init(&opts);
+    opts.create = 1;
+    opts.branch = "main";
+    vost_store* store = nullptr;
+    REQUIRE(vost_store_open(path.string().c_str(), &opts, &store) == VOST_OK);
+    return store;
+}
+
+static std::string buf_string(const vost_buf* buf) {
+    return std::string(reinterpret_cast<const char*>(vost_buf_data(buf)), vost_buf_size(buf));
+}
+
+/// Write `text` at `path` on branch main and return the new snapshot.
+static vost_fs* write_text(vost_store* store, const char* path, const std::string& text) {
+    vost_fs* snap = nullptr;
+    REQUIRE(vost_store_branch(store, "main", &snap) == VOST_OK);
+    vost_fs* next = nullptr;
+    REQUIRE(vost_fs_write(snap, path, text.data(), text.size(), 0, nullptr, &next) == VOST_OK);
+    vost_fs_free(snap);
+    return next;
+}
+
+// ---------------------------------------------------------------------------
+// Basics
+// ---------------------------------------------------------------------------
+
+TEST_CASE("C API: version and status names", "[c_api]") {
+    CHECK(vost_abi_version() == VOST_C_ABI_VERSION);
+    CHECK(std::string(vost_status_name(VOST_OK)) == "VOST_OK");
+    CHECK(std::string(vost_status_name(VOST_ERR_NOT_FOUND)) == "VOST_ERR_NOT_FOUND");
+}
+
+TEST_CASE("C API: write, read, stat and ls round-trip", "[c_api]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+
+    vost_fs* snap = write_text(store, "dir/a.txt", "hello world");
+
+    char commit[VOST_HASH_BUFSZ];
+    REQUIRE(vost_fs_commit_hash(snap, commit) == VOST_OK);
+    CHECK(std::strlen(commit) == 40);
+
+    vost_buf* buf = nullptr;
+    REQUIRE(vost_fs_read(snap, "dir/a.txt", &buf) == VOST_OK);
+    CHECK(buf_string(buf) == "hello world");
+
+    vost_stat st;
+    REQUIRE(vost_fs_stat(snap, "dir/a.txt", &st) == VOST_OK);
+    CHECK(st.mode == VOST_MODE_BLOB);
+    CHECK(st.size == 11);
+    CHECK(std::strlen(st.hash) == 40);
+
+    int exists = -1;
+    REQUIRE(vost_fs_exists(snap, "dir/a.txt", &exists) == VOST_OK);
+    CHECK(exists == 1);
+    REQUIRE(vost_fs_exists(snap, "nope", &exists) == VOST_OK);
+    CHECK(exists == 0);
+
+    vost_strlist* names = nullptr;
+    REQUIRE(vost_fs_ls(snap, "dir", &names) == VOST_OK);
+    REQUIRE(vost_strlist_count(names) == 1);
+    CHECK(std::string(vost_strlist_get(names, 0)) == "a.txt");
+    CHECK(vost_strlist_get(names, 1) == nullptr);
+    vost_strlist_free(names);
+
+    vost_buf* by_hash = nullptr;
+    REQUIRE(vost_store_read_by_hash(store, st.hash, &by_hash) == VOST_OK);
+    CHECK(buf_string(by_hash) == "hello world");
+
+    vost_buf_release(by_hash);
+    vost_buf_release(buf);
+    vost_fs_free(snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Buffers
+// ---------------------------------------------------------------------------
+
+TEST_CASE("C API: read_range slices the blob", "[c_api][buf]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* snap = write_text(store, "f.bin", "0123456789");
+
+    vost_buf* mid = nullptr;
+    REQUIRE(vost_fs_read_range(snap, "f.bin", 3, 4, &mid) == VOST_OK);
+    CHECK(buf_string(mid) == "3456");
+
+    vost_buf* tail = nullptr;
+    REQUIRE(vost_fs_read_range(snap, "f.bin", 7, 0, &tail) == VOST_OK);
+    CHECK(buf_string(tail) == "789");
+
+    vost_buf* past = nullptr;
+    REQUIRE(vost_fs_read_range(snap, "f.bin", 50, 4, &past) == VOST_OK);
+    CHECK(vost_buf_size(past) == 0);
+
+    vost_buf_release(mid);
+    vost_buf_release(tail);
+    vost_buf_release(past);
+    vost_fs_free(snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
+
+TEST_CASE("C API: buffers outlive their snapshot and store handles", "[c_api][buf]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* snap = write_text(store, "a.txt", "kept alive");
+
+    vost_buf* buf = nullptr;
+    REQUIRE(vost_fs_read(snap, "a.txt", &buf) == VOST_OK);
+    const uint8_t* data = vost_buf_data(buf);
+
+    vost_fs_free(snap);
+    vost_store_free(store);
+
+    // Retain hands out the same view, not a copy
+    vost_buf* again = vost_buf_retain(buf);
+    CHECK(again == buf);
+    CHECK(vost_buf_data(again) == data);
+    vost_buf_release(buf);
+    CHECK(buf_string(again) == "kept alive");
+    vost_buf_release(again);
+
+    vost_buf_release(nullptr); // no-op
+    fs::remove_all(path);
+}
+
+TEST_CASE("C API: buffers may be released on another thread", "[c_api][buf]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* snap = write_text(store, "a.txt", "threads");
+
+    std::vector<vost_buf*> bufs(16, nullptr);
+    for (auto& b : bufs) REQUIRE(vost_fs_read(snap, "a.txt", &b) == VOST_OK);
+
+    std::thread releaser([&] {
+        for (auto* b : bufs) vost_buf_release(b);
+    });
+    vost_buf* mine = nullptr;
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(vost_fs_read(snap, "a.txt", &mine) == VOST_OK);
+        CHECK(buf_string(mine) == "threads");
+        vost_buf_release(mine);
+    }
+    releaser.join();
+
+    vost_fs_free(snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Errors
+// ---------------------------------------------------------------------------
+
+TEST_CASE("C API: errors map to status codes", "[c_api][errors]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* snap = write_text(store, "dir/a.txt", "x");
+
+    vost_buf* buf = reinterpret_cast<vost_buf*>(0x1);
+    CHECK(vost_fs_read(snap, "missing.txt", &buf) == VOST_ERR_NOT_FOUND);
+    CHECK(buf == reinterpret_cast<vost_buf*>(0x1)); // untouched on error
+    CHECK(std::string(vost_last_error()).find("missing.txt") != std::string::npos);
+
+    CHECK(vost_fs_read(snap, "dir", &buf) == VOST_ERR_IS_A_DIRECTORY);
+    CHECK(vost_store_read_by_hash(store, "zz", &buf) == VOST_ERR_INVALID_HASH);
+
+    vost_fs* out = nullptr;
+    CHECK(vost_store_branch(store, "nope", &out) == VOST_ERR_KEY_NOT_FOUND);
+    CHECK(vost_fs_read(nullptr, "a", &buf) == VOST_ERR_INVALID_ARGUMENT);
+    CHECK(vost_fs_read(snap, nullptr, &buf) == VOST_ERR_INVALID_ARGUMENT);
+
+    // A successful call clears the message
+    int exists = 0;
+    REQUIRE(vost_fs_exists(snap, "dir/a.txt", &exists) == VOST_OK);
+    CHECK(std::string(vost_last_error()).empty());
+
+    vost_fs_free(snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
+
+TEST_CASE("C API: writing to a stale snapshot fails", "[c_api][errors]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* old_snap = write_text(store, "a.txt", "one");
+    vost_fs* new_snap = write_text(store, "a.txt", "two");
+
+    vost_fs* out = nullptr;
+    CHECK(vost_fs_write(old_snap, "b.txt", "x", 1, 0, nullptr, &out) == VOST_ERR_STALE_SNAPSHOT);
+
+    vost_fs_free(old_snap);
+    vost_fs_free(new_snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Batch and objects
+// ---------------------------------------------------------------------------
+
+TEST_CASE("C API: batch write, write_oid, remove and commit", "[c_api][batch]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* snap = write_text(store, "old.txt", "shared");
+
+    vost_stat st;
+    REQUIRE(vost_fs_stat(snap, "old.txt", &st) == VOST_OK);
+
+    vost_batch* batch = nullptr;
+    REQUIRE(vost_fs_batch(snap, "batch from C", &batch) == VOST_OK);
+    REQUIRE(vost_batch_write(batch, "new.txt", "fresh", 5, 0) == VOST_OK);
+    REQUIRE(vost_batch_write(batch, "run.sh", "#!", 2, VOST_MODE_BLOB_EXEC) == VOST_OK);
+    REQUIRE(vost_batch_write_oid(batch, "copy.txt", st.hash, 0) == VOST_OK);
+    REQUIRE(vost_batch_remove(batch, "old.txt") == VOST_OK);
+
+    vost_fs* next = nullptr;
+    REQUIRE(vost_batch_commit(batch, &next) == VOST_OK);
+    CHECK(vost_batch_write(batch, "late.txt", "x", 1, 0) == VOST_ERR_BATCH_CLOSED);
+    vost_batch_free(batch);
+
+    vost_buf* buf = nullptr;
+    REQUIRE(vost_fs_read(next, "copy.txt", &buf) == VOST_OK);
+    CHECK(buf_string(buf) == "shared");
+    vost_buf_release(buf);
+
+    vost_stat exec_st;
+    REQUIRE(vost_fs_stat(next, "run.sh", &exec_st) == VOST_OK);
+    CHECK(exec_st.mode == VOST_MODE_BLOB_EXEC);
+
+    int exists = 1;
+    REQUIRE(vost_fs_exists(next, "old.txt", &exists) == VOST_OK);
+    CHECK(exists == 0);
+
+    vost_fs_free(next);
+    vost_fs_free(snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
+
+TEST_CASE("C API: missing flags absent blobs", "[c_api][objects]") {
+    auto path = make_temp_repo();
+    vost_store* store = open_store(path);
+    vost_fs* snap = write_text(store, "a.txt", "present");
+
+    vost_stat st;
+    REQUIRE(vost_fs_stat(snap, "a.txt", &st) == VOST_OK);
+
+    const char* hashes[] = {st.hash, "0123456789abcdef0123456789abcdef01234567"};
+    uint8_t flags[2] = {9, 9};
+    REQUIRE(vost_store_missing(store, hashes, 2, flags) == VOST_OK);
+    CHECK(flags[0] == 0);
+    CHECK(flags[1] == 1);
+
+    const char* bad[] = {"xyz"};
+    CHECK(vost_store_missing(store, bad, 1, flags) == VOST_ERR_INVALID_HASH);
+
+    vost_strlist* branches = nullptr;
+    REQUIRE(vost_store_branches(store, &branches) == VOST_OK);
+    REQUIRE(vost_strlist_count(branches) == 1);
+    CHECK(std::string(vost_strlist_get(branches, 0)) == "main");
+    vost_strlist_free(branches);
+
+    vost_fs_free(snap);
+    vost_store_free(store);
+    fs::remove_all(path);
+}
@@ -5,7 +5,11 @@
 #include <fstream>
 #include <string>
 #include <thread>
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -86,6 +90,28 @@ TEST_CASE("Copy: copy_in with dest prefix", "[copy]") {
     fs::remove_all(src);
 }
 
+TEST_CASE("Copy: copy_in into an existing dest prefix", "[copy]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+
+    auto src = make_src_dir();
+    write_file(src / "a.txt", "alpha");
+    snap = snap.copy_in(src, "imported").second;
+
+    write_file(src / "b.txt", "beta");
+    auto [report, new_snap] = snap.copy_in(src, "imported");
+    CHECK(report.add.size() == 1);
+    CHECK(report.add[0].path == "imported/b.txt");
+    CHECK(new_snap.read_text("imported/a.txt") == "alpha");
+
+    auto sync_report = new_snap.sync_in(src, "imported").first;
+    CHECK(sync_report.in_sync());
+
+    fs::remove_all(repo_path);
+    fs::remove_all(src);
+}
+
 TEST_CASE("Copy: copy_in with include filter", "[copy]") {
     auto repo_path = make_temp_repo();
     auto store = open_store(repo_path);
@@ -235,6 +261,163 @@ TEST_CASE("Copy: copy_out with filter", "[copy]") {
     fs::remove_all(dest);
 }
 
+TEST_CASE("Copy: copy_out hard-links from a blob cache", "[copy][blob_cache]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("a.txt", "same");
+    snap = snap.write_text("dir/b.txt", "same");
+    vost::WriteOptions exec;
+    exec.mode = vost::MODE_BLOB_EXEC;
+    snap = snap.write_text("run.sh", "same", exec);
+    snap = snap.write_symlink("link", "a.txt");
+
+    auto cache = make_src_dir();
+    auto one = make_src_dir();
+    auto two = make_src_dir();
+    vost::CopyOutOptions opts;
+    opts.blob_cache = cache;
+    opts.link = vost::CacheLink::Hardlink;
+    CHECK(snap.copy_out("", one, opts).add.size() == 4);
+    CHECK(snap.copy_out("", two, opts).add.size() == 4);
+
+    // One cached inode per (blob, exec bit), shared by both checkouts.
+    CHECK(fs::hard_link_count(one / "a.txt") == 5);
+    CHECK(fs::equivalent(one / "a.txt", two / "dir/b.txt"));
+    CHECK(fs::hard_link_count(one / "run.sh") == 3);
+    CHECK_FALSE(fs::equivalent(one / "a.txt", one / "run.sh"));
+    CHECK((fs::status(one / "run.sh").permissions() & fs::perms::owner_exec) != fs::perms::none);
+    CHECK((fs::status(one / "a.txt").permissions() & fs::perms::owner_write) == fs::perms::none);
+    CHECK(fs::is_symlink(fs::symlink_status(one / "link")));
+    std::ifstream in(two / "dir/b.txt");
+    CHECK(std::string(std::istreambuf_iterator<char>(in), {}) == "same");
+
+    fs::remove_all(repo_path);
+    fs::remove_all(cache);
+    fs::remove_all(one);
+    fs::remove_all(two);
+}
+
+TEST_CASE("Copy: blob cache entries survive later checkouts", "[copy][blob_cache]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main").write_text("f.txt", "v1");
+
+    auto cache = make_src_dir();
+    auto dest = make_src_dir();
+    vost::SyncOptions opts;
+    opts.blob_cache = cache;
+    opts.link = vost::CacheLink::Hardlink;
+    snap.sync_out("", dest, opts);
+    REQUIRE(fs::hard_link_count(dest / "f.txt") == 2);
+
+    // A checkout without the cache must not write through the shared inode.
+    auto v2 = snap.write_text("f.txt", "v2");
+    v2.sync_out("", dest);
+    std::ifstream in(dest / "f.txt");
+    CHECK(std::string(std::istreambuf_iterator<char>(in), {}) == "v2");
+    auto cached = cache / snap.object_hash("f.txt").substr(0, 2) /
+                  snap.object_hash("f.txt").substr(2);
+    std::ifstream cin(cached);
+    CHECK(std::string(std::istreambuf_iterator<char>(cin), {}) == "v1");
+
+    // Reflink mode never shares an inode: it clones or copies.
+    auto copy = make_src_dir();
+    vost::CopyOutOptions copts;
+    copts.blob_cache = cache;
+    copts.link = vost::CacheLink::Reflink;
+    snap.copy_out("", copy, copts);
+    CHECK(fs::hard_link_count(copy / "f.txt") == 1);
+    CHECK((fs::status(copy / "f.txt").permissions() & fs::perms::owner_write) != fs::perms::none);
+
+    fs::remove_all(repo_path);
+    fs::remove_all(cache);
+    fs::remove_all(dest);
+    fs::remove_all(copy);
+}
+
+/// Delete the loose object for `hex`, so any attempt to read it fails.
+static void drop_object(const fs::path& repo_path, const std::string& hex) {
+    REQUIRE(fs::remove(repo_path / "objects" / hex.substr(0, 2) / hex.substr(2)));
+}
+
+TEST_CASE("Copy: filtered copy_out never reads ruled-out subtrees", "[copy][filter]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("docs/a.md", "a");
+    snap = snap.write_text("docs/sub/b.md", "b");
+    snap = snap.write_text("docs/sub/c.txt", "c");
+    snap = snap.write_text("big/x.md", "x");
+    snap = snap.write_text("big/deep/y.md", "y");
+    snap = snap.write_text("README.md", "r");
+    drop_object(repo_path, snap.object_hash("big"));
+
+    // Literal prefix: only docs/ is walked.
+    auto dest = make_src_dir();
+    vost::CopyOutOptions opts;
+    opts.include = std::vector<std::string>{"docs/*.md"};
+    auto report = snap.copy_out("", dest, opts);
+    CHECK(report.add.size() == 2);
+    CHECK(fs::exists(dest / "docs/a.md"));
+    CHECK(fs::exists(dest / "docs/sub/b.md"));
+    CHECK_FALSE(fs::exists(dest / "docs/sub/c.txt"));
+    CHECK_FALSE(fs::exists(dest / "README.md"));
+
+    // An exclude that covers a whole directory prunes it.
+    auto dest2 = make_src_dir();
+    vost::SyncOptions sopts;
+    sopts.exclude = std::vector<std::string>{"big/*"};
+    report = snap.sync_out("", dest2, sopts);
+    CHECK(report.add.size() == 4);
+    CHECK(fs::exists(dest2 / "README.md"));
+    CHECK_FALSE(fs::exists(dest2 / "big"));
+
+    // A name-only pattern has to look everywhere.
+    vost::CopyOutOptions any;
+    any.include = std::vector<std::string>{"*.md"};
+    CHECK_THROWS(snap.copy_out("", dest, any));
+
+    fs::remove_all(repo_path);
+    fs::remove_all(dest);
+    fs::remove_all(dest2);
+}
+
+TEST_CASE("Copy: filtered walks match unfiltered results", "[copy][filter]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    for (auto* p : {"a.md", "a.txt", "docs/a.md", "docs/b.txt", "docs/api/c.md",
+                    "docs-old/d.md", "src/e.cpp", "src/docs/f.md", ".hidden/g.md",
+                    "build/h.o", "build/sub/i.o"})
+        snap = snap.write_text(p, p);
+
+    std::vector<std::pair<std::vector<std::string>, std::vector<std::string>>> cases = {
+        {{"docs/*.md"}, {"docs/a.md", "docs/api/c.md"}},
+        {{"docs/api/*", "docs/b.txt"}, {"docs/api/c.md", "docs/b.txt"}},
+        {{"docs*/*.md"}, {"docs-old/d.md", "docs/a.md", "docs/api/c.md"}},
+        {{"*.md"}, {".hidden/g.md", "a.md", "docs-old/d.md", "docs/a.md",
+                    "docs/api/c.md", "src/docs/f.md"}},
+        {{"?rc/*"}, {"src/docs/f.md", "src/e.cpp"}},
+        {{"[bs]*/*.o"}, {"build/h.o", "build/sub/i.o"}},
+    };
+    for (auto& [include, expected] : cases) {
+        auto dest = make_src_dir();
+        vost::CopyOutOptions opts;
+        opts.include = include;
+        opts.exclude = std::vector<std::string>{"build/sub/*"};
+        std::vector<std::string> got;
+        for (auto& e : snap.copy_out("", dest, opts).add) got.push_back(e.path);
+        std::sort(got.begin(), got.end());
+        auto want = expected;
+        want.erase(std::remove(want.begin(), want.end(), "build/sub/i.o"), want.end());
+        CHECK(got == want);
+        fs::remove_all(dest);
+    }
+
+    fs::remove_all(repo_path);
+}
+
 // ---------------------------------------------------------------------------
 // sync_in tests
 // ---------------------------------------------------------------------------
@@ -399,6 +582,70 @@ TEST_CASE("Copy: copy_from_ref basic cross-branch copy", "[copy][copy_from_ref]"
     fs::remove_all(repo_path);
 }
 
+TEST_CASE("Copy: copy_from_ref with include/exclude", "[copy][copy_from_ref][filter]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto main_snap = store.branches().get("main");
+    main_snap = main_snap.write_text("site/old.md", "old");
+    main_snap = main_snap.write_text("site/keep.txt", "keep");
+
+    store.branches().set("dev", main_snap);
+    auto dev = store.branches().get("dev");
+    dev = dev.write_text("site/new.md", "new");
+    dev = dev.write_text("site/draft.md", "draft");
+    dev = dev.write_text("site/img/logo.png", "png");
+    dev = dev.remove({"site/old.md"});
+
+    vost::CopyFromRefOptions opts;
+    opts.include = std::vector<std::string>{"*.md"};
+    opts.exclude = std::vector<std::string>{"draft.md"};
+    opts.delete_extra = true;
+    main_snap = main_snap.copy_from_ref(dev, {"site/"}, "site", opts);
+
+    CHECK(main_snap.read_text("site/new.md") == "new");
+    CHECK_FALSE(main_snap.exists("site/draft.md"));
+    CHECK_FALSE(main_snap.exists("site/img/logo.png"));
+    CHECK_FALSE(main_snap.exists("site/old.md"));      // matched, not in source
+    CHECK(main_snap.read_text("site/keep.txt") == "keep"); // not matched, kept
+
+    fs::remove_all(repo_path);
+}
+
+TEST_CASE("Copy: copy_from_ref filters a directory source relative to its target",
+          "[copy][copy_from_ref][filter]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto main_snap = store.branches().get("main");
+    main_snap = main_snap.write_text("site/a.md", "a");
+    main_snap = main_snap.write_text("site/docs/x.md", "old x");
+    main_snap = main_snap.write_text("site/docs/stale.md", "stale");
+    main_snap = main_snap.write_text("docs/root.md", "outside the target");
+
+    store.branches().set("dev", main_snap);
+    auto dev = store.branches().get("dev");
+    dev = dev.write_text("site/c.md", "c");
+    dev = dev.write_text("site/docs/x.md", "new x");
+    dev = dev.remove({"site/docs/stale.md"});
+
+    // "site" without a trailing slash lands at "site"; patterns are relative
+    // to it on both sides, so "site/*" matches nothing and nothing changes.
+    vost::CopyFromRefOptions opts;
+    opts.include = std::vector<std::string>{"site/*"};
+    opts.delete_extra = true;
+    auto same = main_snap.copy_from_ref(dev, {"site"}, "", opts);
+    CHECK(same.commit_hash() == main_snap.commit_hash());
+
+    opts.include = std::vector<std::string>{"docs/*.md"};
+    main_snap = main_snap.copy_from_ref(dev, {"site"}, "", opts);
+    CHECK(main_snap.read_text("site/docs/x.md") == "new x");
+    CHECK_FALSE(main_snap.exists("site/docs/stale.md")); // matched, not in source
+    CHECK(main_snap.read_text("site/a.md") == "a");      // not matched, kept
+    CHECK_FALSE(main_snap.exists("site/c.md"));          // not matched, not copied
+    CHECK(main_snap.read_text("docs/root.md") == "outside the target");
+
+    fs::remove_all(repo_path);
+}
+
 TEST_CASE("Copy: copy_from_ref directory copy", "[copy][copy_from_ref]") {
     auto repo_path = make_temp_repo();
     auto store = open_store(repo_path);
@@ -889,3 +1136,349 @@ TEST_CASE("Copy: copy_from_ref prefers branch over tag with same name", "[copy][
 
     fs::remove_all(repo_path);
 }
+
+// ---------------------------------------------------------------------------
+// Checksum comparison
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Copy: sync_in checksum classifies size and content changes", "[copy][checksum]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+
+    auto src = make_src_dir();
+    write_file(src / "same.txt", "unchanged");
+    write_file(src / "grow.txt", "short");
+    write_file(src / "swap.txt", "abcd");
+    write_file(src / "run.sh", "echo");
+    auto [r0, first] = snap.sync_in(src, "data");
+    CHECK(r0.add.size() == 4);
+
+    write_file(src / "grow.txt", "much longer now");
+    write_file(src / "swap.txt", "dcba");
+    fs::permissions(src / "run.sh", fs::perms::owner_exec, fs::perm_options::add);
+
+    auto [r1, second] = first.sync_in(src, "data");
+    std::vector<std::string> updated;
+    for (auto& fe : r1.update) updated.push_back(fe.path);
+    std::sort(updated.begin(), updated.end());
+    CHECK(updated == std::vector<std::string>{
+        "data/grow.txt", "data/run.sh", "data/swap.txt"});
+    CHECK(r1.add.empty());
+    CHECK(r1.del.empty());
+    CHECK(second.read_text("data/swap.txt") == "dcba");
+    CHECK(second.file_type("data/run.sh") == vost::FileType::Executable);
+
+    auto [r2, third] = second.sync_in(src, "data");
+    CHECK(r2.in_sync());
+    CHECK(third.commit_hash() == second.commit_hash());
+
+    fs::remove_all(repo_path);
+    fs::remove_all(src);
+}
+
+TEST_CASE("Copy: unchanged copy_in writes no blobs", "[copy][checksum]") {
+    struct Counter : vost::Observer {
+        uint64_t blobs = 0;
+        void on_operation(const vost::OperationStats& st) override {
+            blobs += st.count(vost::Counter::BlobsWritten);
+        }
+    };
+
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    auto src = make_src_dir();
+    write_file(src / "a.txt", "alpha");
+    write_file(src / "b/c.txt", "gamma");
+    snap = snap.copy_in(src).second;
+
+    auto counter = std::make_shared<Counter>();
+    store.set_observer(counter);
+    auto [report, same] = snap.copy_in(src);
+    CHECK(report.in_sync());
+    CHECK(counter->blobs == 0);
+
+    fs::remove_all(repo_path);
+    fs::remove_all(src);
+}
+
+// ---------------------------------------------------------------------------
+// Report modes
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Copy: sync_in counts-only report", "[copy][report]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("keep.txt", "same");
+    snap = snap.write_text("edit.txt", "old");
+    snap = snap.write_text("gone.txt", "bye");
+
+    auto src = make_src_dir();
+    write_file(src / "keep.txt", "same");
+    write_file(src / "edit.txt", "new");
+    write_file(src / "new1.txt", "1");
+    write_file(src / "new2.txt", "2");
+
+    vost::SyncOptions opts;
+    opts.report = vost::ReportMode::Counts;
+    auto [report, result] = snap.sync_in(src, "", opts);
+
+    CHECK(report.add.empty());
+    CHECK(report.update.empty());
+    CHECK(report.del.empty());
+    auto counts = report.counts();
+    CHECK(counts.add == 2);
+    CHECK(counts.update == 1);
+    CHECK(counts.del == 1);
+    CHECK(report.total() == 4);
+    CHECK_FALSE(report.in_sync());
+    CHECK(report.actions().empty());
+    CHECK(result.read_text("edit.txt") == "new");
+    CHECK_FALSE(result.exists("gone.txt"));
+    REQUIRE(result.changes().has_value());
+    CHECK(result.changes()->total() == 4);
+
+    auto [again, _] = result.sync_in(src, "", opts);
+    CHECK(again.in_sync());
+
+    fs::remove_all(repo_path);
+    fs::remove_all(src);
+}
+
+TEST_CASE("Copy: copy_in streams changes to the callback", "[copy][report]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+
+    auto src = make_src_dir();
+    write_file(src / "a.txt", "a");
+    write_file(src / "sub/b.txt", "b");
+
+    std::vector<std::pair<vost::ChangeActionKind, std::string>> seen;
+    vost::CopyInOptions opts;
+    opts.report = vost::ReportMode::Stream;
+    opts.on_change = [&](vost::ChangeActionKind kind, const vost::FileEntry& fe) {
+        CHECK(fe.src.has_value());
+        seen.emplace_back(kind, fe.path);
+    };
+    auto [report, result] = snap.copy_in(src, "dest", opts);
+
+    REQUIRE(seen.size() == 2);
+    CHECK(seen[0].first == vost::ChangeActionKind::Add);
+    CHECK(seen[0].second == "dest/a.txt");
+    CHECK(seen[1].second == "dest/sub/b.txt");
+    CHECK(report.add.empty());
+    CHECK(report.counts().add == 2);
+    CHECK(result.read_text("dest/sub/b.txt") == "b");
+
+    fs::remove_all(repo_path);
+    fs::remove_all(src);
+}
+
+TEST_CASE("Copy: streamed copy_in/sync_in changes follow the commit", "[copy][report]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto stale = store.branches().get("main");
+    auto moved = stale.write_text("other.txt", "moved on");
+
+    auto src = make_src_dir();
+    write_file(src / "a.txt", "a");
+
+    size_t calls = 0;
+    vost::CopyInOptions copts;
+    copts.report = vost::ReportMode::Stream;
+    copts.on_change = [&](vost::ChangeActionKind, const vost::FileEntry&) { ++calls; };
+
+    // A commit that fails reports nothing.
+    CHECK_THROWS_AS(stale.copy_in(src, "", copts), vost::StaleSnapshotError);
+    CHECK(calls == 0);
+
+    vost::SyncOptions sopts;
+    sopts.report = vost::ReportMode::Stream;
+    sopts.on_change = copts.on_change;
+    CHECK_THROWS_AS(stale.sync_in(src, "", sopts), vost::StaleSnapshotError);
+    CHECK(calls == 0);
+
+    // On success, the changes are visible on the branch by the time they
+    // are reported.
+    std::string seen_tip;
+    copts.on_change = [&](vost::ChangeActionKind, const vost::FileEntry&) {
+        ++calls;
+        seen_tip = *store.branches().get("main").commit_hash();
+    };
+    auto result = moved.copy_in(src, "", copts).second;
+    CHECK(calls == 1);
+    CHECK(seen_tip == *result.commit_hash());
+
+    // A dry run still streams what it would do (b.txt; a.txt is unchanged).
+    copts.dry_run = true;
+    write_file(src / "b.txt", "b");
+    result.copy_in(src, "", copts);
+    CHECK(calls == 2);
+
+    fs::remove_all(repo_path);
+    fs::remove_all(src);
+}
+
+TEST_CASE("Copy: sync_out counts-only report", "[copy][report]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("a.txt", "a");
+    snap = snap.write_text("b.txt", "b");
+
+    auto dest = make_src_dir();
+    write_file(dest / "stale.txt", "x");
+
+    vost::SyncOptions opts;
+    opts.report = vost::ReportMode::Counts;
+    auto report = snap.sync_out("", dest, opts);
+    CHECK(report.add.empty());
+    CHECK(report.counts().add == 2);
+    CHECK(report.counts().del == 1);
+    CHECK_FALSE(fs::exists(dest / "stale.txt"));
+
+    fs::remove_all(repo_path);
+    fs::remove_all(dest);
+}
+
+// ---------------------------------------------------------------------------
+// sync_out_diff
+// ---------------------------------------------------------------------------
+
+static std::string read_local(const fs::path& p) {
+    std::ifstream ifs(p, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), {});
+}
+
+TEST_CASE("Copy: sync_out_diff applies only the tree difference", "[copy][sync_out_diff]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto a = store.branches().get("main");
+    a = a.write_text("src/a.txt", "a");
+    a = a.write_text("src/dir/b.txt", "b");
+    a = a.write_text("src/run.sh", "echo");
+    a = a.write_symlink("src/link", "a.txt");
+    a = a.write_text("src/old/x.txt", "x");
+    a = a.write_text("src/f", "file");
+    a = a.write_text("other.txt", "outside src");
+
+    auto dest = make_src_dir();
+    a.sync_out("src", dest);
+    write_file(dest / "local.txt", "untracked");
+
+    auto b = a.write_text("src/a.txt", "changed");
+    vost::RemoveOptions rm;
+    rm.recursive = true;
+    b = b.remove({"src/dir/b.txt", "src/old", "src/f"}, rm);
+    b = b.write_text("src/dir/c/d.txt", "d");
+    vost::WriteOptions exec;
+    exec.mode = vost::MODE_BLOB_EXEC;
+    b = b.write_text("src/run.sh", "echo", exec);
+    b = b.write_symlink("src/link", "dir");
+    b = b.write_text("src/old", "now a file");
+    b = b.write_text("src/f/g", "now a dir");
+    b = b.write_text("other.txt", "ignored");
+
+    auto report = b.sync_out_diff(*a.tree_hash(), "src", dest);
+    CHECK(read_local(dest / "a.txt") == "changed");
+    CHECK_FALSE(fs::exists(dest / "dir/b.txt"));
+    CHECK(read_local(dest / "dir/c/d.txt") == "d");
+    CHECK(fs::read_symlink(dest / "link") == "dir");
+    CHECK((fs::status(dest / "run.sh").permissions() & fs::perms::owner_exec) != fs::perms::none);
+    CHECK(read_local(dest / "old") == "now a file");
+    CHECK(read_local(dest / "f/g") == "now a dir");
+    CHECK(read_local(dest / "local.txt") == "untracked");
+    CHECK_FALSE(fs::exists(dest / "other.txt"));
+
+    auto counts = report.counts();
+    CHECK(counts.add == 3);    // dir/c/d.txt, old, f/g
+    CHECK(counts.update == 3); // a.txt, run.sh, link
+    CHECK(counts.del == 3);    // dir/b.txt, old/x.txt, f
+
+    // Nothing changed: nothing to do.
+    CHECK(b.sync_out_diff(*b.tree_hash(), "src", dest).in_sync());
+
+    fs::remove_all(repo_path);
+    fs::remove_all(dest);
+}
+
+TEST_CASE("Copy: sync_out_diff from an empty tree checks everything out", "[copy][sync_out_diff]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto snap = store.branches().get("main");
+    snap = snap.write_text("a/b.txt", "b");
+
+    auto dest = make_src_dir();
+    auto report = snap.sync_out_diff("", "", dest);
+    CHECK(report.add.size() == 1);
+    CHECK(read_local(dest / "a/b.txt") == "b");
+    CHECK_THROWS_AS(snap.sync_out_diff("not-a-hash", "", dest), vost::InvalidHashError);
+
+    fs::remove_all(repo_path);
+    fs::remove_all(dest);
+}
+
+#ifdef __unix__
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_CASE("Copy: processes sharing a blob cache never see partial entries",
+          "[copy][blob_cache]") {
+    auto repo_path = make_temp_repo();
+    auto store = open_store(repo_path);
+    auto batch = store.branches().get("main").batch();
+    for (int i = 0; i < 40; ++i)
+        batch.write_text("f" + std::to_string(i), std::string(20000 + i, char('a' + i % 26)));
+    auto snap = batch.commit();
+
+    // Every round uses an empty cache, so all writers race to fill it.
+    constexpr int kRounds = 8, kWriters = 4;
+    auto caches = make_src_dir();
+    auto dests = make_src_dir();
+
+    std::vector<pid_t> children;
+    for (int w = 0; w < kWriters; ++w) {
+        pid_t pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            int status = 0;
+            try {
+                auto child = vost::GitStore::open(repo_path).branches().get("main");
+                for (int r = 0; r < kRounds; ++r) {
+                    vost::CopyOutOptions opts;
+                    opts.blob_cache = caches / std::to_string(r);
+                    opts.link = r % 2 ? vost::CacheLink::Hardlink : vost::CacheLink::Reflink;
+                    auto dest = dests / (std::to_string(r) + "-" + std::to_string(w));
+                    child.copy_out("", dest, opts);
+                    for (int i = 0; i < 40; ++i) {
+                        std::ifstream in(dest / ("f" + std::to_string(i)), std::ios::binary);
+                        std::string got(std::istreambuf_iterator<char>(in), {});
+                        if (got != std::string(20000 + i, char('a' + i % 26))) status = 1;
+                    }
+                }
+            } catch (...) {
+                status = 2;
+            }
+            ::_exit(status);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = -1;
+        REQUIRE(::waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+    }
+
+    // No temp files are left behind in the caches.
+    for (auto& e : fs::recursive_directory_iterator(caches))
+        CHECK(e.path().filename().string().find(".vost-tmp") == std::string::npos);
+
+    fs::remove_all(repo_path);
+    fs::remove_all(caches);
+    fs::remove_all(dests);
+}
+#endif
@@ -1,13 +1,38 @@
 #include <catch2/catch_test_macros.hpp>
 #include <vost/vost.h>
 
+#include <chrono>
+#include <cstdlib>
 #include <filesystem>
+#include <new>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <chrono>
 
 namespace fs = std::filesystem;
 
+// Counts operator new calls made by the current thread while armed, so the
+// read tests below can assert the hot paths stay allocation-free.
+static thread_local bool   g_count_allocs = false;
+static thread_local size_t g_allocs = 0;
+
+void* operator new(std::size_t n) {
+    if (g_count_allocs) ++g_allocs;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+template <typename F>
+static size_t count_allocs(F&& fn) {
+    g_allocs = 0;
+    g_count_allocs = true;
+    fn();
+    g_count_allocs = false;
+    return g_allocs;
+}
+
 // ---------------------------------------------------------------------------
 // Helpers
 // ---------------------------------------------------------------------------
@@ -816,3 +841,59 @@ TEST_CASE("Fs: path with trailing slash returns directory entries", "[fs][read]"
     CHECK(ls1[0] == ls2[0]);
     fs::remove_all(path);
 }
+
+// ---------------------------------------------------------------------------
+// string_view paths
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Fs: read APIs accept string_view slices", "[fs][read]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    snap = snap.write_text("a/b/c.txt", "hello");
+
+    std::string buf = "a/b/c.txt|trailing";
+    std::string_view p = std::string_view(buf).substr(0, 9);
+    CHECK(snap.read_text(p) == "hello");
+    CHECK(snap.exists(p));
+    CHECK(snap.size(p) == 5);
+    CHECK(snap.read_range(p, 1, 3) == std::vector<uint8_t>{'e', 'l', 'l'});
+    CHECK(snap.is_dir(std::string_view(buf).substr(0, 3)));
+    CHECK_FALSE(snap.exists(std::string_view(buf).substr(0, 8)));
+    fs::remove_all(path);
+}
+
+TEST_CASE("Fs: non-normalized string_view paths resolve", "[fs][read]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    snap = snap.write_text("a/b/c.txt", "hello");
+
+    CHECK(snap.read_text("/a//b/./c.txt") == "hello");
+    CHECK(snap.object_hash("a/b/") == snap.object_hash("a/b"));
+    CHECK(snap.stat("./a/b/c.txt").size == 5);
+    CHECK_THROWS_AS(snap.read("a/../c.txt"), vost::InvalidPathError);
+    CHECK_THROWS_AS(snap.read_text("a/b/missing"), vost::NotFoundError);
+    fs::remove_all(path);
+}
+
+TEST_CASE("Fs: small-path reads do not allocate beyond the result", "[fs][read]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    snap = snap.write_text("src/lib/module/file.txt", "contents");
+    const char* p = "src/lib/module/file.txt";
+    snap.read(p); // warm up lazily-initialised state
+
+    bool found = false, dir = false;
+    uint64_t sz = 0;
+    CHECK(count_allocs([&] { found = snap.exists(p); }) == 0);
+    CHECK(count_allocs([&] { dir = snap.is_dir("src/lib"); }) == 0);
+    CHECK(count_allocs([&] { sz = snap.size(p); }) == 0);
+    CHECK(found);
+    CHECK(dir);
+    CHECK(sz == 8);
+    CHECK(count_allocs([&] { snap.read(p); }) == 1);
+    CHECK(count_allocs([&] { snap.read_range(p, 0, 4); }) == 1);
+    fs::remove_all(path);
+}
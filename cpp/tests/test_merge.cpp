@@ -0,0 +1,263 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+#include <git2.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_merge_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost::GitStore open_store(const fs::path& path,
+                                  const std::string& branch = "main") {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = branch;
+    return vost::GitStore::open(path, opts);
+}
+
+/// Parent hashes of a commit, in order.
+static std::vector<std::string> parents_of(const fs::path& repo_path,
+                                           const std::string& commit_hex) {
+    git_repository* repo = nullptr;
+    REQUIRE(git_repository_open(&repo, repo_path.c_str()) == 0);
+    git_oid oid;
+    REQUIRE(git_oid_fromstr(&oid, commit_hex.c_str()) == 0);
+    git_commit* commit = nullptr;
+    REQUIRE(git_commit_lookup(&commit, repo, &oid) == 0);
+
+    std::vector<std::string> out;
+    for (unsigned int i = 0; i < git_commit_parentcount(commit); ++i) {
+        char buf[GIT_OID_HEXSZ + 1];
+        git_oid_tostr(buf, sizeof(buf), git_commit_parent_id(commit, i));
+        out.emplace_back(buf, GIT_OID_HEXSZ);
+    }
+    git_commit_free(commit);
+    git_repository_free(repo);
+    return out;
+}
+
+/// Branch "main" and "dev" forked from a common commit with a few files.
+struct Forked {
+    fs::path       path;
+    vost::GitStore store;
+    vost::Fs       base;
+
+    Forked() : path(make_temp_repo()), store(open_store(path)),
+               base(store.branches()["main"]) {
+        auto b = base.batch();
+        b.write_text("shared.txt", "shared");
+        b.write_text("docs/readme.md", "readme");
+        b.write_text("src/lib/a.c", "a");
+        b.write_text("src/lib/b.c", "b");
+        base = b.commit();
+        store.branches().set("dev", base);
+    }
+    ~Forked() { fs::remove_all(path); }
+
+    vost::Fs main() { return store.branches()["main"]; }
+    vost::Fs dev()  { return store.branches()["dev"]; }
+};
+
+// ---------------------------------------------------------------------------
+// Clean merges
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Merge: disjoint changes combine with two parents", "[merge]") {
+    Forked f;
+    auto ours   = f.main().write_text("src/lib/a.c", "a2");
+    auto theirs = f.dev().write_text("docs/new.md", "new");
+
+    auto merged = ours.merge(theirs);
+    CHECK(merged.read_text("src/lib/a.c") == "a2");
+    CHECK(merged.read_text("docs/new.md") == "new");
+    CHECK(merged.read_text("docs/readme.md") == "readme");
+    CHECK(merged.message() == "merge: dev");
+
+    auto parents = parents_of(f.path, *merged.commit_hash());
+    REQUIRE(parents.size() == 2);
+    CHECK(parents[0] == *ours.commit_hash());
+    CHECK(parents[1] == *theirs.commit_hash());
+    CHECK(f.main().commit_hash() == merged.commit_hash());
+
+    // Untouched subtree is shared by OID with both sides.
+    CHECK(merged.object_hash("src/lib") == ours.object_hash("src/lib"));
+}
+
+TEST_CASE("Merge: identical change on both sides is not a conflict", "[merge]") {
+    Forked f;
+    auto ours   = f.main().write_text("shared.txt", "same");
+    auto theirs = f.dev().write_text("shared.txt", "same");
+
+    auto merged = ours.merge(theirs);
+    CHECK(merged.read_text("shared.txt") == "same");
+}
+
+TEST_CASE("Merge: deletions and nested edits", "[merge]") {
+    Forked f;
+    vost::RemoveOptions rm;
+    rm.recursive = true;
+    auto ours = f.main().remove({"docs"}, rm);
+    auto theirs = f.dev().write_text("src/lib/b.c", "b2");
+    theirs = theirs.write_text("src/lib/deep/c.c", "c");
+
+    auto merged = ours.merge(theirs);
+    CHECK_FALSE(merged.exists("docs"));
+    CHECK(merged.read_text("src/lib/a.c") == "a");
+    CHECK(merged.read_text("src/lib/b.c") == "b2");
+    CHECK(merged.read_text("src/lib/deep/c.c") == "c");
+}
+
+TEST_CASE("Merge: directory emptied by the merge is dropped", "[merge]") {
+    Forked f;
+    auto ours   = f.main().remove({"src/lib/a.c"});
+    auto theirs = f.dev().remove({"src/lib/b.c"});
+
+    auto merged = ours.merge(theirs);
+    CHECK_FALSE(merged.exists("src"));
+    CHECK(merged.read_text("shared.txt") == "shared");
+}
+
+TEST_CASE("Merge: already merged returns the same snapshot", "[merge]") {
+    Forked f;
+    auto ours = f.main().write_text("x.txt", "x");
+
+    auto same = ours.merge(f.base);
+    CHECK(same.commit_hash() == ours.commit_hash());
+    CHECK(ours.merge(ours).commit_hash() == ours.commit_hash());
+}
+
+TEST_CASE("Merge: merging a descendant creates a merge commit", "[merge]") {
+    Forked f;
+    auto theirs = f.dev().write_text("docs/new.md", "new");
+
+    auto merged = f.main().merge(theirs);
+    CHECK(merged.commit_hash() != theirs.commit_hash());
+    CHECK(merged.tree_hash() == theirs.tree_hash());
+    auto parents = parents_of(f.path, *merged.commit_hash());
+    REQUIRE(parents.size() == 2);
+    CHECK(parents[0] == *f.base.commit_hash());
+    CHECK(parents[1] == *theirs.commit_hash());
+}
+
+TEST_CASE("Merge: unrelated histories and detached sources", "[merge]") {
+    Forked f;
+    auto orphan = f.main().write_text("other.txt", "o").squash();
+    REQUIRE_FALSE(orphan.ref_name().has_value());
+    auto other = f.store.branches()["dev"].write_text("dev.txt", "d");
+
+    // orphan shares no history with dev; both added other.txt/dev.txt only
+    // on one side, and the common files are identical.
+    auto merged = other.merge(orphan);
+    CHECK(merged.read_text("other.txt") == "o");
+    CHECK(merged.read_text("dev.txt") == "d");
+    CHECK(merged.message() == "merge: " + orphan.commit_hash()->substr(0, 12));
+}
+
+TEST_CASE("Merge: explicit base overrides the merge base", "[merge]") {
+    Forked f;
+    auto ours   = f.main().write_text("shared.txt", "ours");
+    auto theirs = f.dev().write_text("docs/readme.md", "theirs");
+
+    // Using `ours` as the base makes the merge take theirs' view of everything
+    // theirs changed relative to it, including reverting shared.txt.
+    auto merged = ours.merge(theirs, ours);
+    CHECK(merged.read_text("shared.txt") == "shared");
+    CHECK(merged.read_text("docs/readme.md") == "theirs");
+}
+
+// ---------------------------------------------------------------------------
+// Conflicts
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Merge: conflicting edits are reported as structured entries", "[merge]") {
+    Forked f;
+    auto ours   = f.main().write_text("src/lib/a.c", "ours");
+    auto theirs = f.dev().write_text("src/lib/a.c", "theirs");
+    theirs = theirs.remove({"docs/readme.md"});
+    ours = ours.write_text("docs/readme.md", "edited");
+
+    try {
+        ours.merge(theirs);
+        FAIL("expected MergeConflictError");
+    } catch (const vost::MergeConflictError& e) {
+        const auto& c = e.conflicts();
+        REQUIRE(c.size() == 2);
+        CHECK(c[0].path == "docs/readme.md");
+        REQUIRE(c[0].base.has_value());
+        REQUIRE(c[0].ours.has_value());
+        CHECK_FALSE(c[0].theirs.has_value());
+        CHECK(c[0].ours->oid == ours.object_hash("docs/readme.md"));
+
+        CHECK(c[1].path == "src/lib/a.c");
+        CHECK(c[1].base->oid == f.base.object_hash("src/lib/a.c"));
+        CHECK(c[1].ours->oid == ours.object_hash("src/lib/a.c"));
+        CHECK(c[1].theirs->oid == theirs.object_hash("src/lib/a.c"));
+        CHECK(std::string(e.what()).find("src/lib/a.c") != std::string::npos);
+    }
+    // Branch untouched on failure.
+    CHECK(f.main().commit_hash() == ours.commit_hash());
+}
+
+TEST_CASE("Merge: favor resolves conflicts", "[merge]") {
+    Forked f;
+    auto ours   = f.main().write_text("shared.txt", "ours");
+    auto theirs = f.dev().write_text("shared.txt", "theirs");
+
+    vost::MergeOptions opts;
+    opts.favor = vost::MergeFavor::Theirs;
+    opts.message = "take theirs";
+    auto merged = ours.merge(theirs, std::nullopt, opts);
+    CHECK(merged.read_text("shared.txt") == "theirs");
+    CHECK(merged.message() == "take theirs");
+    REQUIRE(merged.changes().has_value());
+    REQUIRE(merged.changes()->warnings.size() == 1);
+    CHECK(merged.changes()->warnings[0].path == "shared.txt");
+    CHECK(merged.changes()->warnings[0].error == "conflict resolved in favor of theirs");
+
+    opts.favor = vost::MergeFavor::Ours;
+    merged = merged.write_text("shared.txt", "mine");
+    auto again = f.dev().write_text("shared.txt", "theirs again");
+    merged = merged.merge(again, std::nullopt, opts);
+    CHECK(merged.read_text("shared.txt") == "mine");
+    REQUIRE(merged.changes()->warnings.size() == 1);
+    CHECK(merged.changes()->warnings[0].error == "conflict resolved in favor of ours");
+}
+
+TEST_CASE("Merge: a clean merge reports no resolved conflicts", "[merge]") {
+    Forked f;
+    auto ours   = f.main().write_text("a.txt", "ours");
+    auto theirs = f.dev().write_text("b.txt", "theirs");
+
+    vost::MergeOptions opts;
+    opts.favor = vost::MergeFavor::Ours;
+    auto merged = ours.merge(theirs, std::nullopt, opts);
+    REQUIRE(merged.changes().has_value());
+    CHECK(merged.changes()->warnings.empty());
+}
+
+TEST_CASE("Merge: stale snapshot and read-only errors", "[merge]") {
+    Forked f;
+    auto stale  = f.main();
+    auto ours   = stale.write_text("x.txt", "x");
+    auto theirs = f.dev().write_text("y.txt", "y");
+
+    CHECK_THROWS_AS(stale.merge(theirs), vost::StaleSnapshotError);
+    CHECK_THROWS_AS(ours.squash().merge(theirs), vost::PermissionError);
+}
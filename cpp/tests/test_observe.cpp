@@ -0,0 +1,344 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_observe_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost::GitStore open_store(const fs::path& path) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    return vost::GitStore::open(path, opts);
+}
+
+/// Observer that keeps copies of everything it is told.
+struct Recorder : vost::Observer {
+    struct Op {
+        std::string          name;
+        vost::OperationStats stats;
+    };
+    struct PhaseEvent {
+        std::string name;
+        vost::Phase phase;
+        uint64_t    duration_ns;
+    };
+
+    std::mutex              m;
+    std::vector<Op>         ops;
+    std::vector<PhaseEvent> phases;
+
+    void on_operation(const vost::OperationStats& stats) override {
+        std::lock_guard<std::mutex> lk(m);
+        ops.push_back({std::string(stats.operation), stats});
+    }
+    void on_phase(std::string_view op, vost::Phase phase,
+                  uint64_t, uint64_t duration_ns) override {
+        std::lock_guard<std::mutex> lk(m);
+        phases.push_back({std::string(op), phase, duration_ns});
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Observe: write reports phases and counters", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+        CHECK(store.observer() == rec);
+
+        snap = snap.write_text("a/b.txt", "hello");
+
+        REQUIRE(rec->ops.size() == 1);
+        auto& st = rec->ops[0].stats;
+        CHECK(rec->ops[0].name == "Fs::write");
+        CHECK_FALSE(st.failed);
+        CHECK(st.duration_ns > 0);
+        CHECK(st.count(vost::Counter::BlobsWritten) == 1);
+        CHECK(st.count(vost::Counter::BytesWritten) == 5);
+        CHECK(st.phase(vost::Phase::RebuildTree) > 0);
+        CHECK(st.phase(vost::Phase::WriteCommit) > 0);
+        CHECK(st.phase(vost::Phase::RefUpdate) > 0);
+        CHECK(st.phase(vost::Phase::RebuildTree) <= st.duration_ns);
+
+        bool saw_blob_write = false;
+        for (auto& p : rec->phases) {
+            CHECK(p.name == "Fs::write");
+            if (p.phase == vost::Phase::BlobWrite) saw_blob_write = true;
+        }
+        CHECK(saw_blob_write);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: reads count tree and blob lookups", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("x/y/z.txt", "payload");
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+
+        CHECK(snap.read_text("x/y/z.txt") == "payload");
+
+        REQUIRE(rec->ops.size() == 1);
+        auto& st = rec->ops[0].stats;
+        CHECK(rec->ops[0].name == "Fs::read");
+        CHECK(st.count(vost::Counter::TreeLookups) >= 3);
+        CHECK(st.count(vost::Counter::BlobLookups) == 1);
+        CHECK(st.count(vost::Counter::BytesInflated) == 7);
+        CHECK(st.count(vost::Counter::BlobsWritten) == 0);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: nested operations are reported once", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+
+        auto b = snap.batch();
+        b.write_text("one.txt", "1");
+        b.write_text("two.txt", "22");
+        b.commit();
+
+        REQUIRE(rec->ops.size() == 1);
+        CHECK(rec->ops[0].name == "Batch::commit");
+        CHECK(rec->ops[0].stats.count(vost::Counter::BlobsWritten) == 2);
+        CHECK(rec->ops[0].stats.count(vost::Counter::BytesWritten) == 3);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: failed operations are flagged", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("f.txt", "x");
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+
+        CHECK_THROWS_AS(snap.read("missing.txt"), vost::NotFoundError);
+
+        REQUIRE(rec->ops.size() == 1);
+        CHECK(rec->ops[0].name == "Fs::read");
+        CHECK(rec->ops[0].stats.failed);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: stale write times the CAS check", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("f.txt", "x");
+        snap.write_text("f.txt", "y");
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+
+        CHECK_THROWS_AS(snap.write_text("f.txt", "z"), vost::StaleSnapshotError);
+
+        REQUIRE(rec->ops.size() == 1);
+        auto& st = rec->ops[0].stats;
+        CHECK(st.failed);
+        CHECK(st.phase(vost::Phase::CasCheck) > 0);
+        CHECK(st.phase(vost::Phase::WriteCommit) == 0);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: throwing observer does not break the operation", "[observe]") {
+    struct Thrower : vost::Observer {
+        void on_operation(const vost::OperationStats&) override {
+            throw std::runtime_error("observer failure");
+        }
+    };
+
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        store.set_observer(std::make_shared<Thrower>());
+
+        snap = snap.write_text("f.txt", "ok");
+        CHECK(snap.read_text("f.txt") == "ok");
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: clearing the observer stops delivery", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+        snap = snap.write_text("f.txt", "1");
+        REQUIRE(rec->ops.size() == 1);
+
+        store.set_observer(nullptr);
+        CHECK(store.observer() == nullptr);
+        snap = snap.write_text("f.txt", "2");
+        snap.read("f.txt");
+        CHECK(rec->ops.size() == 1);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: observer is shared by handles of the same store", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+
+        auto snap = store.branches()["main"];
+        snap = snap.write_text("f.txt", "1");
+        store.branches().set("copy", snap);
+        store.pack();
+
+        std::vector<std::string> names;
+        for (auto& op : rec->ops) names.push_back(op.name);
+        CHECK(names == std::vector<std::string>{
+            "RefDict::get", "Fs::write", "RefDict::set", "GitStore::pack"});
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Observe: reads time tree lookup and blob read phases", "[observe]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("d/f.txt", "x");
+        auto rec = std::make_shared<Recorder>();
+        store.set_observer(rec);
+
+        snap.read("d/f.txt");
+        snap.listdir("d");
+
+        std::vector<vost::Phase> seen;
+        for (auto& p : rec->phases) seen.push_back(p.phase);
+        CHECK(std::count(seen.begin(), seen.end(), vost::Phase::TreeLookup) == 2);
+        CHECK(std::count(seen.begin(), seen.end(), vost::Phase::BlobRead) == 1);
+        CHECK(std::count(seen.begin(), seen.end(), vost::Phase::TreeWalk) == 1);
+    }
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Tracer
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Tracer: records operations and phases as trace events", "[observe][trace]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto tracer = std::make_shared<vost::Tracer>();
+        store.set_observer(tracer);
+
+        snap = snap.write_text("a.txt", "a");
+        snap.read("a.txt");
+        CHECK(tracer->size() > 2);
+
+        std::ostringstream out;
+        tracer->write_json(out);
+        auto json = out.str();
+        CHECK(json.rfind("{\"displayTimeUnit\"", 0) == 0);
+        CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+        CHECK(json.find("\"name\":\"Fs::write\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"Fs::read\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"rebuild_tree\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"lock_wait\"") != std::string::npos);
+        CHECK(json.find("\"blobs_written\":1") != std::string::npos);
+        CHECK(json.find("\"operation\":\"Fs::write\"") != std::string::npos);
+
+        auto file = path / "trace.json";
+        tracer->write_json(file);
+        CHECK(fs::file_size(file) == json.size());
+
+        tracer->clear();
+        CHECK(tracer->size() == 0);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Tracer: spans carry per-thread ids", "[observe][trace]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("a.txt", "a");
+        auto tracer = std::make_shared<vost::Tracer>();
+        store.set_observer(tracer);
+
+        snap.read("a.txt");
+        std::thread([&] { snap.read("a.txt"); }).join();
+
+        std::ostringstream out;
+        tracer->write_json(out);
+        auto json = out.str();
+        std::set<std::string> tids;
+        for (size_t pos = 0; (pos = json.find("\"ph\":\"X\",\"pid\":1,\"tid\":", pos)) != std::string::npos;) {
+            pos += 23;
+            tids.insert(json.substr(pos, json.find(',', pos) - pos));
+        }
+        CHECK(tids.size() == 2);
+    }
+    fs::remove_all(path);
+}
+
+TEST_CASE("Tracer: forwards to next observer and caps events", "[observe][trace]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+        auto rec = std::make_shared<Recorder>();
+        auto tracer = std::make_shared<vost::Tracer>(rec, 3);
+        store.set_observer(tracer);
+
+        snap = snap.write_text("a.txt", "a");
+        snap = snap.write_text("b.txt", "b");
+
+        CHECK(rec->ops.size() == 2);
+        CHECK(tracer->size() == 3);
+        CHECK(tracer->dropped() > 0);
+
+        std::ostringstream out;
+        tracer->write_json(out);
+        CHECK(out.str().find("\"dropped\":" + std::to_string(tracer->dropped())) !=
+              std::string::npos);
+    }
+    fs::remove_all(path);
+}
@@ -2,7 +2,11 @@
 #include <vost/vost.h>
 
 #include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
 #include <thread>
 
 namespace fs = std::filesystem;
@@ -69,3 +73,176 @@ TEST_CASE("gc preserves data", "[pack]") {
     CHECK(snap2.read("a.txt") == std::vector<uint8_t>({'h', 'e', 'l', 'l', 'o'}));
     fs::remove_all(path);
 }
+
+// ---------------------------------------------------------------------------
+// CompressionPolicy
+// ---------------------------------------------------------------------------
+
+static vost::GitStore open_with_policy(const fs::path& path,
+                                       vost::HashBackend hash = vost::HashBackend::Safe) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    opts.hash = hash;
+    vost::CompressionPolicy policy;
+    policy.rules.push_back({"*.dat", 9});
+    policy.rules.push_back({"raw/**", 0});
+    opts.compression_policy = policy;
+    return vost::GitStore::open(path, opts);
+}
+
+static std::string random_bytes(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::string s(n, '\0');
+    for (auto& c : s) c = static_cast<char>(gen() & 0xff);
+    return s;
+}
+
+static std::string text_bytes(size_t n) {
+    std::string s;
+    while (s.size() < n) s += "{\"key\": \"value\", \"n\": " + std::to_string(s.size()) + "}\n";
+    return s;
+}
+
+/// First three bytes of the loose object for `hash`: zlib CMF/FLG and the
+/// first deflate block header.
+static std::string loose_prefix(const fs::path& repo, const std::string& hash) {
+    std::ifstream in(repo / "objects" / hash.substr(0, 2) / hash.substr(2), std::ios::binary);
+    std::string b(3, '\0');
+    in.read(&b[0], 3);
+    REQUIRE(in.gcount() == 3);
+    return b;
+}
+
+static int flevel(const std::string& prefix) {
+    return (static_cast<unsigned char>(prefix[1]) >> 6) & 3;
+}
+
+static bool stored_block(const std::string& prefix) {
+    return (static_cast<unsigned char>(prefix[2]) & 0x06) == 0;
+}
+
+TEST_CASE("compression_policy picks a level per blob", "[pack][compression]") {
+    for (auto hash : {vost::HashBackend::Safe, vost::HashBackend::Fast}) {
+        auto path = make_temp_repo();
+        auto plain_path = path;
+        plain_path += "_plain";
+        auto snap = open_with_policy(path, hash).branches()["main"];
+        auto plain = open_store(plain_path).branches()["main"];
+
+        auto text = text_bytes(20000);
+        auto noise = random_bytes(20000, 1);
+        auto b = snap.batch();
+        b.write_text("doc.json", text);
+        b.write_text("photo.JPG", text + "jpg");        // known extension
+        b.write_text("noise.bin", noise);               // entropy probe
+        b.write_text("table.dat", text + "dat");        // rule: level 9
+        b.write_text("raw/keep.txt", text + "raw");     // rule: level 0
+        b.write_text("tiny.bin", noise.substr(0, 100)); // too small to probe
+        snap = b.commit();
+
+        CHECK(flevel(loose_prefix(path, snap.object_hash("doc.json"))) == 2);
+        CHECK(stored_block(loose_prefix(path, snap.object_hash("photo.JPG"))));
+        CHECK(stored_block(loose_prefix(path, snap.object_hash("noise.bin"))));
+        CHECK(flevel(loose_prefix(path, snap.object_hash("table.dat"))) == 3);
+        CHECK(stored_block(loose_prefix(path, snap.object_hash("raw/keep.txt"))));
+        CHECK(flevel(loose_prefix(path, snap.object_hash("tiny.bin"))) == 2);
+
+        CHECK(snap.read_text("noise.bin") == noise);
+        CHECK(snap.read_text("raw/keep.txt") == text + "raw");
+
+        // Levels change the files, never the object ids.
+        auto pb = plain.batch();
+        for (const auto& name : {"doc.json", "photo.JPG", "noise.bin", "table.dat",
+                                 "raw/keep.txt", "tiny.bin"})
+            pb.write_text(name, snap.read_text(name));
+        CHECK(pb.commit().tree_hash() == snap.tree_hash());
+
+        fs::remove_all(path);
+        fs::remove_all(plain_path);
+    }
+}
+
+TEST_CASE("compression_policy: pack keeps incompressible blobs out of delta packs",
+          "[pack][compression]") {
+    auto path = make_temp_repo();
+    auto store = open_with_policy(path);
+    auto snap = store.branches()["main"];
+    std::vector<std::string> noise;
+    auto b = snap.batch();
+    for (unsigned i = 0; i < 5; ++i) {
+        noise.push_back(random_bytes(30000 + i, i));
+        b.write_text("media/" + std::to_string(i) + ".bin", noise.back());
+        b.write_text("text/" + std::to_string(i) + ".json", text_bytes(5000 + i));
+    }
+    b.write_text("raw/a.txt", text_bytes(7000));
+    snap = b.commit();
+
+    auto count = store.pack();
+    CHECK(count > 11);
+
+    size_t packs = 0;
+    for (auto& e : fs::directory_iterator(path / "objects" / "pack"))
+        if (e.path().extension() == ".pack") ++packs;
+    CHECK(packs == 2);
+
+    // Everything reads back, from this handle and a fresh one.
+    auto packed = store.branches()["main"];
+    for (unsigned i = 0; i < 5; ++i) {
+        CHECK(packed.read_text("media/" + std::to_string(i) + ".bin") == noise[i]);
+        CHECK(packed.read_text("text/" + std::to_string(i) + ".json") == text_bytes(5000 + i));
+    }
+    auto reopened = vost::GitStore::open(path, {});
+    auto tip = reopened.branches()["main"];
+    CHECK(tip.read_text("media/3.bin") == noise[3]);
+    CHECK(tip.read_text("raw/a.txt") == text_bytes(7000));
+    CHECK(tip.tree_hash() == snap.tree_hash());
+    fs::remove_all(path);
+}
+
+TEST_CASE("compression_policy: a rejected level leaves no temp file", "[pack][compression]") {
+    auto path = make_temp_repo();
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    vost::CompressionPolicy policy;
+    policy.rules.push_back({"*.bad", 42}); // deflateInit refuses it
+    opts.compression_policy = policy;
+    auto snap = vost::GitStore::open(path, opts).branches()["main"];
+
+    CHECK_THROWS_AS(snap.write_text("x.bad", text_bytes(1000)), vost::IoError);
+    for (auto& e : fs::recursive_directory_iterator(path / "objects"))
+        CHECK(e.path().filename().string().rfind(".vost-tmp-", 0) != 0);
+    fs::remove_all(path);
+}
+
+TEST_CASE("compression_policy applies to import_tar members", "[pack][compression]") {
+    auto src_path = make_temp_repo();
+    auto path = src_path;
+    path += "_dst";
+    auto text = text_bytes(10000);
+    auto noise = random_bytes(10000, 7);
+    auto src = open_store(src_path).branches()["main"];
+    src = src.write_text("a/doc.json", text);
+    src = src.write_text("a/noise.bin", noise);
+
+    std::string tar;
+    src.export_tar("a", [&](const uint8_t* p, size_t n) {
+        tar.append(reinterpret_cast<const char*>(p), n);
+    });
+    size_t pos = 0;
+    auto source = [&](uint8_t* buf, size_t size) {
+        size_t n = std::min(size, tar.size() - pos);
+        std::memcpy(buf, tar.data() + pos, n);
+        pos += n;
+        return n;
+    };
+    auto dst = open_with_policy(path, vost::HashBackend::Fast).branches()["main"];
+    auto [report, out] = dst.import_tar(source, "a");
+    CHECK(out.tree_hash() == src.tree_hash());
+    CHECK(flevel(loose_prefix(path, out.object_hash("a/doc.json"))) == 2);
+    CHECK(stored_block(loose_prefix(path, out.object_hash("a/noise.bin"))));
+
+    fs::remove_all(src_path);
+    fs::remove_all(path);
+}
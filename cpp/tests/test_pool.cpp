@@ -0,0 +1,207 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static fs::path make_temp_dir() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_pooltest_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    fs::create_directories(tmp);
+    return tmp;
+}
+
+/// Create `n` stores "t0.git" ... under `dir`.
+static std::vector<fs::path> make_tenants(const fs::path& dir, int n) {
+    std::vector<fs::path> paths;
+    for (int i = 0; i < n; ++i) {
+        auto p = dir / ("t" + std::to_string(i) + ".git");
+        vost::OpenOptions opts;
+        opts.create = true;
+        opts.branch = "main";
+        vost::GitStore::open(p, opts);
+        paths.push_back(p);
+    }
+    return paths;
+}
+
+// ---------------------------------------------------------------------------
+// Deduplication
+// ---------------------------------------------------------------------------
+
+TEST_CASE("StorePool: repeated opens share one store", "[pool]") {
+    auto dir = make_temp_dir();
+    auto paths = make_tenants(dir, 1);
+    vost::StorePool pool;
+
+    auto a = pool.open(paths[0]);
+    auto b = pool.open(paths[0].string() + "/");
+    auto c = pool.open(dir / "." / "t0.git");
+    CHECK(a.inner() == b.inner());
+    CHECK(a.inner() == c.inner());
+
+    auto st = pool.stats();
+    CHECK(st.open == 1);
+    CHECK(st.misses == 1);
+    CHECK(st.hits == 2);
+
+    // Writes through one handle are visible through the others
+    a.branches()["main"].write_text("x.txt", "shared");
+    CHECK(c.branches()["main"].read_text("x.txt") == "shared");
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("StorePool: concurrent opens of one path open it once", "[pool]") {
+    auto dir = make_temp_dir();
+    auto paths = make_tenants(dir, 1);
+    vost::StorePool pool;
+
+    std::vector<std::thread> threads;
+    std::vector<std::shared_ptr<vost::GitStoreInner>> seen(8);
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i] { seen[i] = pool.open(paths[0]).inner(); });
+    }
+    for (auto& t : threads) t.join();
+
+    for (auto& s : seen) CHECK(s == seen[0]);
+    CHECK(pool.stats().misses == 1);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("StorePool: open failure is not cached", "[pool]") {
+    auto dir = make_temp_dir();
+    vost::StorePool pool;
+
+    CHECK_THROWS_AS(pool.open(dir / "nope.git"), vost::NotFoundError);
+    CHECK_FALSE(pool.contains(dir / "nope.git"));
+    CHECK_THROWS_AS(pool.open(dir / "nope.git"), vost::NotFoundError);
+
+    vost::OpenOptions opts;
+    opts.create = true;
+    vost::GitStore::open(dir / "nope.git", opts);
+    CHECK_NOTHROW(pool.open(dir / "nope.git"));
+
+    fs::remove_all(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Eviction
+// ---------------------------------------------------------------------------
+
+TEST_CASE("StorePool: least recently used idle stores are closed", "[pool]") {
+    auto dir = make_temp_dir();
+    auto paths = make_tenants(dir, 4);
+    vost::PoolOptions opts;
+    opts.max_open = 2;
+    vost::StorePool pool(opts);
+
+    pool.open(paths[0]);
+    pool.open(paths[1]);
+    pool.open(paths[0]); // refresh t0
+    pool.open(paths[2]);
+
+    CHECK(pool.size() == 2);
+    CHECK(pool.contains(paths[0]));
+    CHECK_FALSE(pool.contains(paths[1]));
+    CHECK(pool.contains(paths[2]));
+    CHECK(pool.stats().evictions == 1);
+
+    // A closed store reopens on demand
+    pool.open(paths[1]);
+    CHECK(pool.contains(paths[1]));
+    CHECK(pool.size() == 2);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("StorePool: stores in use are not closed", "[pool]") {
+    auto dir = make_temp_dir();
+    auto paths = make_tenants(dir, 3);
+    vost::PoolOptions opts;
+    opts.max_open = 1;
+    vost::StorePool pool(opts);
+
+    auto held = pool.open(paths[0]).branches()["main"]; // an Fs keeps it busy
+    pool.open(paths[1]);
+    pool.open(paths[2]);
+
+    CHECK(pool.contains(paths[0]));
+    CHECK_FALSE(pool.contains(paths[1]));
+    CHECK(pool.stats().idle == 1); // t2
+    CHECK_FALSE(pool.close(paths[0]));
+
+    // The held snapshot still works and the pool returns the same store
+    held = held.write_text("a.txt", "still open");
+    CHECK(pool.open(paths[0]).inner() == held.inner());
+
+    held = vost::Fs(pool.open(paths[2]).branches()["main"]);
+    CHECK(pool.close(paths[0]));
+    CHECK_FALSE(pool.contains(paths[0]));
+    CHECK_FALSE(pool.close(paths[0]));
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("StorePool: idle timeout closes stores on trim", "[pool]") {
+    auto dir = make_temp_dir();
+    auto paths = make_tenants(dir, 2);
+    vost::PoolOptions opts;
+    opts.idle_ms = 20;
+    vost::StorePool pool(opts);
+
+    pool.open(paths[0]);
+    auto busy = pool.open(paths[1]);
+    CHECK(pool.trim() == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    CHECK(pool.trim() == 1);
+    CHECK_FALSE(pool.contains(paths[0]));
+    CHECK(pool.contains(paths[1]));
+
+    fs::remove_all(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Budgets
+// ---------------------------------------------------------------------------
+
+TEST_CASE("StorePool: process limits are set explicitly", "[pool]") {
+    auto dir = make_temp_dir();
+    auto paths = make_tenants(dir, 2);
+
+    // Constructing a pool leaves the process-wide budgets alone.
+    vost::ProcessLimits limits;
+    limits.cache_bytes = size_t(128) << 20;
+    vost::StorePool::set_process_limits(limits);
+    vost::StorePool other;
+    CHECK(other.stats().cache_limit == int64_t(128) << 20);
+
+    limits.cache_bytes = size_t(256) << 20; // libgit2's default, so other tests see no change
+    limits.max_pack_files = 0;              // unlimited, also the default
+    vost::StorePool::set_process_limits(limits);
+    vost::StorePool pool;
+
+    auto st = pool.stats();
+    CHECK(st.cache_limit == int64_t(256) << 20);
+
+    auto fs0 = pool.open(paths[0]).branches()["main"].write_text("a.txt", "a");
+    auto fs1 = pool.open(paths[1]).branches()["main"].write_text("b.txt", "b");
+    CHECK(fs0.read_text("a.txt") == "a");
+    CHECK(fs1.read_text("b.txt") == "b");
+    CHECK(pool.stats().cached_bytes >= 0);
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,165 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_refcache_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost::GitStore open_store(const fs::path& path,
+                                  const std::string& branch = "main") {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = branch;
+    return vost::GitStore::open(path, opts);
+}
+
+static std::string read_file(const fs::path& p) {
+    std::ifstream in(p, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+}
+
+// ---------------------------------------------------------------------------
+// Same-process reads
+// ---------------------------------------------------------------------------
+
+TEST_CASE("RefCache: repeated get returns the same snapshot", "[refcache]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    auto a = store.branches().get("main");
+    auto b = store.branches().get("main");
+    auto c = store.fs("main");
+    REQUIRE(a.commit_hash() == b.commit_hash());
+    REQUIRE(a.tree_hash() == b.tree_hash());
+    REQUIRE(a.commit_hash() == c.commit_hash());
+    REQUIRE(c.writable());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("RefCache: own writes are visible immediately", "[refcache]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    auto fs1 = store.branches()["main"].write_text("a.txt", "one");
+    auto got = store.branches()["main"];
+    REQUIRE(got.commit_hash() == fs1.commit_hash());
+    REQUIRE(got.read_text("a.txt") == "one");
+
+    auto fs2 = got.write_text("a.txt", "two");
+    REQUIRE(store.branches()["main"].commit_hash() == fs2.commit_hash());
+
+    auto undone = fs2.undo();
+    REQUIRE(store.branches()["main"].commit_hash() == fs1.commit_hash());
+    auto redone = undone.redo();
+    REQUIRE(store.branches()["main"].commit_hash() == fs2.commit_hash());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("RefCache: set and del invalidate", "[refcache]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    auto main = store.branches()["main"].write_text("a.txt", "x");
+    store.branches().set("dev", main);
+    REQUIRE(store.branches().contains("dev"));
+    REQUIRE(store.branches()["dev"].commit_hash() == main.commit_hash());
+
+    store.branches().del("dev");
+    REQUIRE_FALSE(store.branches().contains("dev"));
+    REQUIRE_THROWS_AS(store.branches().get("dev"), vost::KeyNotFoundError);
+
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Writes from other handles / processes
+// ---------------------------------------------------------------------------
+
+TEST_CASE("RefCache: observes writes through another handle", "[refcache]") {
+    auto path = make_temp_repo();
+    auto reader = open_store(path);
+    auto writer = vost::GitStore::open(path);
+
+    auto before = reader.branches()["main"];
+    auto written = writer.branches()["main"].write_text("f.txt", "hello");
+
+    auto after = reader.branches()["main"];
+    REQUIRE(after.commit_hash() == written.commit_hash());
+    REQUIRE(after.read_text("f.txt") == "hello");
+    REQUIRE(reader.fs("main").commit_hash() == written.commit_hash());
+
+    writer.branches().del("main");
+    REQUIRE_FALSE(reader.branches().contains("main"));
+    REQUIRE_THROWS_AS(reader.branches().get("main"), vost::KeyNotFoundError);
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("RefCache: follows refs moved into packed-refs", "[refcache]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    auto first = store.branches()["main"].write_text("a.txt", "1");
+    auto second = first.write_text("a.txt", "2");
+    REQUIRE(store.branches()["main"].commit_hash() == second.commit_hash());
+
+    // Simulate `git pack-refs`: the ref now lives only in packed-refs,
+    // pointing at an older commit.
+    fs::remove(path / "refs" / "heads" / "main");
+    {
+        std::ofstream out(path / "packed-refs", std::ios::binary);
+        out << "# pack-refs with: peeled fully-peeled sorted \n"
+            << *first.commit_hash() << " refs/heads/main\n";
+    }
+    REQUIRE(store.branches()["main"].commit_hash() == first.commit_hash());
+    REQUIRE(store.branches()["main"].read_text("a.txt") == "1");
+
+    // And back to a loose ref shadowing the packed entry.
+    auto third = store.branches()["main"].write_text("a.txt", "3");
+    REQUIRE(read_file(path / "refs" / "heads" / "main").substr(0, 40) ==
+            *third.commit_hash());
+    REQUIRE(store.branches()["main"].commit_hash() == third.commit_hash());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("RefCache: disabled cache still resolves refs", "[refcache]") {
+    auto path = make_temp_repo();
+    {
+        auto store = open_store(path);
+        store.branches()["main"].write_text("a.txt", "x");
+    }
+    vost::OpenOptions opts;
+    opts.ref_cache = false;
+    auto store = vost::GitStore::open(path, opts);
+    auto other = vost::GitStore::open(path);
+
+    REQUIRE(store.branches()["main"].read_text("a.txt") == "x");
+    auto written = other.branches()["main"].write_text("a.txt", "y");
+    REQUIRE(store.branches()["main"].commit_hash() == written.commit_hash());
+    REQUIRE(store.branches().contains("main"));
+
+    fs::remove_all(path);
+}
@@ -0,0 +1,224 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_reflog_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost::GitStore open_store(const fs::path& path,
+                                  vost::OpenOptions opts = {}) {
+    opts.create = true;
+    opts.branch = "main";
+    return vost::GitStore::open(path, opts);
+}
+
+static vost::Fs write_n(vost::Fs fs, int n) {
+    for (int i = 0; i < n; ++i)
+        fs = fs.write_text("n.txt", std::to_string(i));
+    return fs;
+}
+
+// ---------------------------------------------------------------------------
+// Pagination
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Reflog: pages match the full listing", "[reflog]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto last = write_n(store.branches()["main"], 10);
+
+    auto all = store.branches().reflog("main");
+    REQUIRE(all.size() == 11); // init + 10 writes
+    REQUIRE(all[0].new_sha == *last.commit_hash());
+    REQUIRE(all.back().message.find("Initialize") != std::string::npos);
+
+    vost::ReflogOptions page;
+    page.limit = 3;
+    auto first = store.branches().reflog("main", page);
+    REQUIRE(first.size() == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(first[i].new_sha == all[i].new_sha);
+        REQUIRE(first[i].old_sha == all[i].old_sha);
+        REQUIRE(first[i].message == all[i].message);
+        REQUIRE(first[i].committer == all[i].committer);
+        REQUIRE(first[i].timestamp == all[i].timestamp);
+    }
+
+    page.skip = 9;
+    auto tail = store.branches().reflog("main", page);
+    REQUIRE(tail.size() == 2);
+    REQUIRE(tail[1].new_sha == all[10].new_sha);
+
+    page.skip = 20;
+    REQUIRE(store.branches().reflog("main", page).empty());
+    REQUIRE(store.branches().reflog("missing").empty());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Reflog: entries parsed from the log file", "[reflog]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto fs1 = store.branches()["main"].write_text("a.txt", "x");
+
+    auto log = store.branches().reflog("main");
+    REQUIRE(log.size() == 2);
+    REQUIRE(log[0].old_sha == log[1].new_sha);
+    REQUIRE(log[0].new_sha == *fs1.commit_hash());
+    REQUIRE(log[0].committer.find('<') != std::string::npos);
+    REQUIRE(log[0].committer.back() == '>');
+    REQUIRE(log[0].timestamp > 0);
+    REQUIRE(log[0].message == fs1.message());
+
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Retention
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Reflog: max_entries is enforced on write", "[reflog]") {
+    auto path = make_temp_repo();
+    vost::OpenOptions opts;
+    opts.reflog_retention.max_entries = 5;
+    auto store = open_store(path, opts);
+
+    auto last = write_n(store.branches()["main"], 30);
+    auto log = store.branches().reflog("main");
+    REQUIRE(log.size() == 5);
+    REQUIRE(log[0].new_sha == *last.commit_hash());
+
+    fs::remove_all(path);
+}
+
+#ifdef __unix__
+TEST_CASE("Reflog: RefDict::set trims under the repo lock", "[reflog]") {
+    auto path = make_temp_repo();
+    vost::OpenOptions opts;
+    opts.reflog_retention.max_entries = 5;
+    auto store = open_store(path, opts);
+    auto first = write_n(store.branches()["main"], 1);
+    auto second = write_n(first, 1);
+
+    // Another process holding the repo lock must hold off the ref update
+    // and its reflog rewrite.
+    int fd = ::open((path / "vost.lock").c_str(), O_RDWR | O_CREAT, 0600);
+    REQUIRE(fd >= 0);
+    REQUIRE(::flock(fd, LOCK_EX) == 0);
+
+    std::atomic<bool> done{false};
+    std::thread setter([&] {
+        for (int i = 0; i < 10; ++i) store.branches().set("copy", i % 2 ? second : first);
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK_FALSE(done);
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+    setter.join();
+
+    CHECK(store.branches().reflog("copy").size() == 5);
+
+    fs::remove_all(path);
+}
+#endif
+
+TEST_CASE("Reflog: large max_entries trims in batches", "[reflog]") {
+    auto path = make_temp_repo();
+    vost::OpenOptions opts;
+    opts.reflog_retention.max_entries = 16; // slack of 2
+    auto store = open_store(path, opts);
+
+    write_n(store.branches()["main"], 40);
+    auto size = store.branches().reflog("main").size();
+    REQUIRE(size >= 16);
+    REQUIRE(size <= 18);
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Reflog: max_age drops old entries", "[reflog]") {
+    auto path = make_temp_repo();
+    auto fs0 = open_store(path).branches()["main"];
+
+    // Prepend an entry dated 1970 to the log.
+    auto log_file = path / "logs" / "refs" / "heads" / "main";
+    std::string body;
+    {
+        std::ifstream in(log_file, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        body = ss.str();
+    }
+    {
+        std::ofstream out(log_file, std::ios::binary | std::ios::trunc);
+        out << std::string(40, '0') << ' ' << *fs0.commit_hash()
+            << " Old <old@example.com> 100 +0000\tancient\n" << body;
+    }
+    REQUIRE(vost::GitStore::open(path).branches().reflog("main").back().message == "ancient");
+
+    vost::OpenOptions opts;
+    opts.reflog_retention.max_age = 3600;
+    auto store = vost::GitStore::open(path, opts);
+    store.branches()["main"].write_text("a.txt", "x");
+
+    auto log = store.branches().reflog("main");
+    for (const auto& e : log) REQUIRE(e.message != "ancient");
+    REQUIRE(log.size() == 2);
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Reflog: undo/redo still work with retention", "[reflog]") {
+    auto path = make_temp_repo();
+    vost::OpenOptions opts;
+    opts.reflog_retention.max_entries = 4;
+    auto store = open_store(path, opts);
+
+    auto last = write_n(store.branches()["main"], 10);
+    auto undone = last.undo().undo();
+    auto redone = undone.redo(2);
+    REQUIRE(redone.commit_hash() == last.commit_hash());
+    REQUIRE(store.branches().reflog("main").size() == 4);
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Reflog: redo finds targets behind long histories", "[reflog]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    auto last = write_n(store.branches()["main"], 50);
+    auto undone = last.undo();
+    auto redone = undone.redo();
+    REQUIRE(redone.commit_hash() == last.commit_hash());
+
+    fs::remove_all(path);
+}
@@ -125,3 +125,113 @@ TEST_CASE("Squash: assign to branch", "[squash]") {
 
     fs::remove_all(path);
 }
+
+// ---------------------------------------------------------------------------
+// compact_history
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Compact: keep_commits squashes older history", "[squash][compact]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+
+    for (int i = 0; i < 20; ++i)
+        snap = snap.write_text("f" + std::to_string(i) + ".txt", std::to_string(i));
+    auto before = snap.log();
+    REQUIRE(before.size() == 21);
+
+    vost::HistoryRetention policy;
+    policy.keep_commits = 5;
+    auto compacted = snap.compact_history(policy);
+
+    CHECK(compacted.tree_hash() == snap.tree_hash());
+    CHECK(compacted.commit_hash() != snap.commit_hash());
+    CHECK(store.branches().get("main").commit_hash() == compacted.commit_hash());
+
+    auto after = compacted.log();
+    REQUIRE(after.size() == 6);
+    for (size_t i = 0; i < 5; ++i) {
+        CHECK(after[i].message == before[i].message);
+        CHECK(after[i].time == before[i].time);
+        CHECK(after[i].author_name == before[i].author_name);
+    }
+    // The root carries the tree of the newest squashed commit.
+    auto root = compacted.back(5);
+    CHECK_FALSE(root.parent().has_value());
+    CHECK(root.exists("f14.txt"));
+    CHECK_FALSE(root.exists("f15.txt"));
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Compact: retained snapshots keep their trees", "[squash][compact]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    for (int i = 0; i < 6; ++i) snap = snap.write_text("x.txt", std::to_string(i));
+
+    vost::HistoryRetention policy;
+    policy.keep_commits = 3;
+    policy.gc = false;
+    auto compacted = snap.compact_history(policy);
+
+    for (size_t i = 0; i < 3; ++i)
+        CHECK(compacted.back(i).tree_hash() == snap.back(i).tree_hash());
+    CHECK(compacted.back(2).read_text("x.txt") == "3");
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Compact: no-op when history is within policy", "[squash][compact]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main").write_text("a.txt", "a");
+
+    vost::HistoryRetention by_count;
+    by_count.keep_commits = 10;
+    CHECK(snap.compact_history(by_count).commit_hash() == snap.commit_hash());
+
+    vost::HistoryRetention by_age;
+    by_age.keep_age = 3600;
+    CHECK(snap.compact_history(by_age).commit_hash() == snap.commit_hash());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Compact: keep nothing leaves a single root", "[squash][compact]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    snap = snap.write_text("a.txt", "a");
+    snap = snap.write_text("b.txt", "b");
+
+    vost::HistoryRetention policy;
+    policy.keep_commits = 0;
+    policy.message = "fresh start";
+    auto compacted = snap.compact_history(policy);
+
+    CHECK(compacted.log().size() == 1);
+    CHECK(compacted.message() == "fresh start");
+    CHECK(compacted.read_text("b.txt") == "b");
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Compact: stale snapshot and read-only errors", "[squash][compact]") {
+    auto path  = make_temp_repo();
+    auto store = open_store(path);
+    auto snap  = store.branches().get("main");
+    snap = snap.write_text("a.txt", "a");
+    snap = snap.write_text("b.txt", "b");
+    auto stale = snap;
+    snap = snap.write_text("c.txt", "c");
+
+    vost::HistoryRetention policy;
+    policy.keep_commits = 1;
+    CHECK_THROWS_AS(stale.compact_history(policy), vost::StaleSnapshotError);
+    CHECK_THROWS_AS(snap.squash().compact_history(policy), vost::PermissionError);
+    CHECK_THROWS_AS(snap.compact_history(vost::HistoryRetention{}),
+                    std::invalid_argument);
+
+    fs::remove_all(path);
+}
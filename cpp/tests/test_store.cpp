@@ -1,8 +1,11 @@
 #include <catch2/catch_test_macros.hpp>
 #include <vost/vost.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <string>
 #include <thread>
 
@@ -507,3 +510,153 @@ TEST_CASE("store.fs branch priority over tag", "[store][fs]") {
 
     fs::remove_all(path);
 }
+
+// ---------------------------------------------------------------------------
+// OpenOptions::hash
+// ---------------------------------------------------------------------------
+
+static vost::GitStore open_hashed(const fs::path& path, vost::HashBackend hash) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    opts.hash = hash;
+    return vost::GitStore::open(path, opts);
+}
+
+static std::string pattern(size_t size, unsigned seed) {
+    std::string s(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+        s[i] = static_cast<char>((i * 131 + seed * 7 + (i >> 9)) & 0xff);
+    return s;
+}
+
+TEST_CASE("HashBackend::Fast stores the same blobs as Safe", "[store][hash]") {
+    auto safe_path = make_temp_repo();
+    auto fast_path = safe_path;
+    fast_path += "_fast";
+    auto safe = open_hashed(safe_path, vost::HashBackend::Safe).branches()["main"];
+    auto fast = open_hashed(fast_path, vost::HashBackend::Fast).branches()["main"];
+
+    // Sizes around the 64-byte block and the 55/56-byte padding boundary.
+    const size_t sizes[] = {0, 1, 55, 56, 63, 64, 65, 119, 120, 1000, 100000,
+                            (size_t(1) << 20) + 7};
+    unsigned seed = 0;
+    for (size_t size : sizes) {
+        auto data = pattern(size, seed++);
+        auto name = "f" + std::to_string(size);
+        safe = safe.write_text(name, data);
+        fast = fast.write_text(name, data);
+        REQUIRE(fast.object_hash(name) == safe.object_hash(name));
+        REQUIRE(fast.read_text(name) == data);
+    }
+    REQUIRE(fast.tree_hash() == safe.tree_hash());
+
+    // Rewriting content the store already has is a no-op.
+    auto again = fast.write_text("copy", pattern(1000, 9));
+    auto twice = again.write_text("copy2", pattern(1000, 9));
+    REQUIRE(twice.object_hash("copy2") == again.object_hash("copy"));
+
+    fs::remove_all(safe_path);
+    fs::remove_all(fast_path);
+}
+
+TEST_CASE("HashBackend::Fast copy_in and import_tar match Safe", "[store][hash]") {
+    auto safe_path = make_temp_repo();
+    auto fast_path = safe_path;
+    fast_path += "_fast";
+    auto src = safe_path;
+    src += "_src";
+    fs::create_directories(src / "sub");
+    for (unsigned i = 0; i < 8; ++i) {
+        std::ofstream(src / ("a" + std::to_string(i)), std::ios::binary)
+            << pattern(i * 4099, i);
+        std::ofstream(src / "sub" / ("b" + std::to_string(i)), std::ios::binary)
+            << pattern(70000 + i, i + 20);
+    }
+
+    auto safe = open_hashed(safe_path, vost::HashBackend::Safe).branches()["main"];
+    auto fast = open_hashed(fast_path, vost::HashBackend::Fast).branches()["main"];
+
+    auto [safe_report, safe_out] = safe.copy_in({src.string() + "/"}, "data");
+    auto [fast_report, fast_out] = fast.copy_in({src.string() + "/"}, "data");
+    REQUIRE(fast_out.tree_hash() == safe_out.tree_hash());
+
+    // A second checksum copy_in hashes the files against the stored blobs.
+    vost::CopyInOptions checksum;
+    checksum.checksum = true;
+    auto [same_report, same] = fast_out.copy_in({src.string() + "/"}, "data", checksum);
+    REQUIRE(same_report.add.empty());
+    REQUIRE(same_report.update.empty());
+
+    // import_tar streams members through the loose-object writer.
+    std::string tar;
+    safe_out.export_tar("data", [&](const uint8_t* p, size_t n) {
+        tar.append(reinterpret_cast<const char*>(p), n);
+    });
+    size_t pos = 0;
+    auto source = [&](uint8_t* buf, size_t size) {
+        size_t n = std::min(size, tar.size() - pos);
+        std::memcpy(buf, tar.data() + pos, n);
+        pos += n;
+        return n;
+    };
+    auto tar_path = safe_path;
+    tar_path += "_tar";
+    auto target = open_hashed(tar_path, vost::HashBackend::Fast).branches()["main"];
+    auto [tar_report, imported] = target.import_tar(source, "data");
+    REQUIRE(imported.tree_hash() == safe_out.tree_hash());
+    REQUIRE(imported.read_text("data/sub/b3") == pattern(70003, 23));
+
+    fs::remove_all(safe_path);
+    fs::remove_all(fast_path);
+    fs::remove_all(tar_path);
+    fs::remove_all(src);
+}
+
+// ---------------------------------------------------------------------------
+// has_hash / missing
+// ---------------------------------------------------------------------------
+
+TEST_CASE("has_hash checks blobs without reading them", "[store][missing]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto snap = store.branches()["main"].write_text("a.txt", std::string(100000, 'a'));
+
+    CHECK(store.has_hash(snap.object_hash("a.txt")));
+    CHECK_FALSE(store.has_hash(std::string(40, '0')));
+    CHECK_FALSE(store.has_hash(*snap.tree_hash()));  // not a blob
+    CHECK_FALSE(store.has_hash("xyz"));
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("missing returns absent blob hashes in order", "[store][missing]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto b = store.branches()["main"].batch();
+    for (int i = 0; i < 50; ++i) b.write_text("f" + std::to_string(i), std::to_string(i));
+    auto snap = b.commit();
+    store.pack();
+    snap = snap.write_text("loose.txt", "loose");
+
+    std::vector<std::string> query;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 50; ++i) {
+        query.push_back(snap.object_hash("f" + std::to_string(i)));  // packed
+        std::string absent(40, '0');
+        auto n = std::to_string(i);
+        absent.replace(40 - n.size(), n.size(), n);
+        query.push_back(absent);
+        expected.push_back(absent);
+    }
+    query.push_back(snap.object_hash("loose.txt"));
+    query.push_back(expected.front());  // duplicate
+    query.push_back(*snap.tree_hash()); // not a blob
+    expected.push_back(*snap.tree_hash());
+
+    CHECK(store.missing(query) == expected);
+    CHECK(store.missing({}).empty());
+    REQUIRE_THROWS_AS(store.missing({"abc"}), vost::InvalidHashError);
+
+    fs::remove_all(path);
+}
@@ -0,0 +1,400 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vost/vost.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static fs::path make_temp_repo() {
+    auto tmp = fs::temp_directory_path() /
+               ("vost_watch_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())
+                    ^ static_cast<size_t>(
+                          std::chrono::steady_clock::now()
+                              .time_since_epoch()
+                              .count())));
+    return tmp;
+}
+
+static vost::GitStore open_store(const fs::path& path,
+                                  const std::string& branch = "main") {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = branch;
+    return vost::GitStore::open(path, opts);
+}
+
+/// Thread-safe event sink for watch callbacks.
+struct Events {
+    std::mutex                   m;
+    std::condition_variable      cv;
+    std::vector<vost::RefChange> items;
+
+    void push(const vost::RefChange& c) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            items.push_back(c);
+        }
+        cv.notify_all();
+    }
+
+    /// Wait until at least `n` events arrived (or timeout); return a copy.
+    std::vector<vost::RefChange> wait_for(size_t n,
+                                          std::chrono::milliseconds t =
+                                              std::chrono::seconds(5)) {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait_for(lk, t, [&] { return items.size() >= n; });
+        return items;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lk(m);
+        return items.size();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Delivery
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Watch: own write delivers old and new target", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto before = store.branches()["main"];
+
+    Events events;
+    auto w = store.watch({"main"}, [&](const vost::RefChange& c) { events.push(c); });
+    REQUIRE(w.active());
+
+    auto after = before.write_text("a.txt", "hello");
+    auto got = events.wait_for(1);
+    REQUIRE(got.size() == 1);
+    REQUIRE(got[0].ref_name == "refs/heads/main");
+    REQUIRE(got[0].old_target == before.commit_hash());
+    REQUIRE(got[0].new_target == after.commit_hash());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Watch: write through another handle is observed", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto other = vost::GitStore::open(path);
+
+    Events events;
+    auto w = store.watch({"main"}, [&](const vost::RefChange& c) { events.push(c); });
+
+    auto after = other.branches()["main"].write_text("a.txt", "from elsewhere");
+    auto got = events.wait_for(1);
+    REQUIRE(got.size() == 1);
+    REQUIRE(got[0].new_target == after.commit_hash());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Watch: rapid writes are coalesced", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto start = store.branches()["main"];
+
+    vost::WatchOptions opts;
+    opts.coalesce_ms = 300;
+    Events events;
+    auto w = store.watch({"main"},
+                         [&](const vost::RefChange& c) { events.push(c); }, opts);
+
+    auto cur = start;
+    for (int i = 0; i < 5; ++i)
+        cur = cur.write_text("n.txt", std::to_string(i));
+
+    auto got = events.wait_for(1);
+    REQUIRE(got.size() == 1);
+    REQUIRE(got[0].old_target == start.commit_hash());
+    REQUIRE(got[0].new_target == cur.commit_hash());
+
+    // Nothing further arrives once the window has closed.
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    REQUIRE(events.size() == 1);
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Watch: empty ref list reports created and deleted branches", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    auto main = store.branches()["main"];
+
+    Events events;
+    auto w = store.watch({}, [&](const vost::RefChange& c) { events.push(c); });
+
+    store.branches().set("feature/x", main);
+    auto got = events.wait_for(1);
+    REQUIRE(got.size() == 1);
+    REQUIRE(got[0].ref_name == "refs/heads/feature/x");
+    REQUIRE_FALSE(got[0].old_target.has_value());
+    REQUIRE(got[0].new_target == main.commit_hash());
+
+    store.branches().del("feature/x");
+    got = events.wait_for(2);
+    REQUIRE(got.size() == 2);
+    REQUIRE(got[1].ref_name == "refs/heads/feature/x");
+    REQUIRE(got[1].old_target == main.commit_hash());
+    REQUIRE_FALSE(got[1].new_target.has_value());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Watch: other refs do not trigger events", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    store.branches().set("dev", store.branches()["main"]);
+
+    Events events;
+    auto w = store.watch({"main"}, [&](const vost::RefChange& c) { events.push(c); });
+
+    store.branches()["dev"].write_text("a.txt", "x");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    REQUIRE(events.size() == 0);
+
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// Lifetime
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Watch: stop ends delivery", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    Events events;
+    auto w = store.watch({"main"}, [&](const vost::RefChange& c) { events.push(c); });
+    w.stop();
+    REQUIRE_FALSE(w.active());
+    w.stop(); // idempotent
+
+    store.branches()["main"].write_text("a.txt", "x");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(events.size() == 0);
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Watch: stop from inside the callback", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+
+    Events events;
+    vost::RefWatch w;
+    w = store.watch({"main"}, [&](const vost::RefChange& c) {
+        events.push(c);
+        w.stop();
+    });
+
+    store.branches()["main"].write_text("a.txt", "x");
+    REQUIRE(events.wait_for(1).size() == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE_FALSE(w.active());
+
+    fs::remove_all(path);
+}
+
+TEST_CASE("Watch: invalid short name throws", "[watch]") {
+    auto path = make_temp_repo();
+    auto store = open_store(path);
+    REQUIRE_THROWS_AS(store.watch({"bad..name"}, [](const vost::RefChange&) {}),
+                      vost::InvalidRefNameError);
+    fs::remove_all(path);
+}
+
+// ---------------------------------------------------------------------------
+// SyncWatcher
+// ---------------------------------------------------------------------------
+
+static fs::path make_src_dir() {
+    auto dir = make_temp_repo();
+    dir += "_src";
+    fs::create_directories(dir);
+    return dir;
+}
+
+static void write_file(const fs::path& p, const std::string& content) {
+    fs::create_directories(p.parent_path());
+    std::ofstream(p, std::ios::binary) << content;
+}
+
+/// Thread-safe sink for SyncWatcher commits.
+struct Commits {
+    std::mutex                        m;
+    std::condition_variable           cv;
+    std::vector<vost::ChangeReport>   reports;
+
+    void push(const vost::ChangeReport& r) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            reports.push_back(r);
+        }
+        cv.notify_all();
+    }
+
+    std::vector<vost::ChangeReport> wait_for(size_t n) {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait_for(lk, std::chrono::seconds(5), [&] { return reports.size() >= n; });
+        return reports;
+    }
+};
+
+TEST_CASE("SyncWatcher: initial sync then incremental commits", "[watch][syncwatch]") {
+    auto path = make_temp_repo();
+    auto src = make_src_dir();
+    write_file(src / "a.txt", "a");
+    write_file(src / "dir/b.txt", "b");
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+
+        Commits commits;
+        vost::SyncWatchOptions opts;
+        opts.debounce_ms = 20;
+        auto w = snap.watch_sync_in(src, "mirror", opts,
+            [&](const vost::ChangeReport& r, const vost::Fs&) { commits.push(r); });
+        REQUIRE(w.active());
+        CHECK(w.fs().read_text("mirror/dir/b.txt") == "b");
+        CHECK(w.commits() == 0);
+
+        write_file(src / "a.txt", "changed");
+        write_file(src / "dir/sub/c.txt", "c");
+        fs::remove(src / "dir/b.txt");
+
+        CHECK_FALSE(commits.wait_for(1).empty());
+        // Give a second batch time to land if the events were split.
+        for (int i = 0; i < 100; ++i) {
+            auto now = w.fs();
+            if (now.exists("mirror/dir/sub/c.txt") && !now.exists("mirror/dir/b.txt") &&
+                now.read_text("mirror/a.txt") == "changed")
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        auto now = w.fs();
+        CHECK(now.read_text("mirror/a.txt") == "changed");
+        CHECK(now.read_text("mirror/dir/sub/c.txt") == "c");
+        CHECK_FALSE(now.exists("mirror/dir/b.txt"));
+        CHECK(store.branches()["main"].commit_hash() == now.commit_hash());
+        CHECK(w.commits() >= 1);
+        CHECK(w.rescans() == 0);
+        CHECK_FALSE(w.last_error().has_value());
+
+        w.stop();
+        CHECK_FALSE(w.active());
+    }
+    fs::remove_all(path);
+    fs::remove_all(src);
+}
+
+TEST_CASE("SyncWatcher: honors include globs and ExcludeFilter", "[watch][syncwatch]") {
+    auto path = make_temp_repo();
+    auto src = make_src_dir();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"];
+
+        Commits commits;
+        vost::SyncWatchOptions opts;
+        opts.debounce_ms = 20;
+        opts.sync.exclude = std::vector<std::string>{"*.tmp"};
+        opts.filter.add_patterns({"build/"});
+        auto w = snap.watch_sync_in(src, "", opts,
+            [&](const vost::ChangeReport& r, const vost::Fs&) { commits.push(r); });
+
+        write_file(src / "build/out.o", "obj");
+        write_file(src / "scratch.tmp", "tmp");
+        write_file(src / "keep.txt", "keep");
+
+        auto got = commits.wait_for(1);
+        REQUIRE_FALSE(got.empty());
+        auto now = w.fs();
+        CHECK(now.read_text("keep.txt") == "keep");
+        CHECK_FALSE(now.exists("build"));
+        CHECK_FALSE(now.exists("scratch.tmp"));
+    }
+    fs::remove_all(path);
+    fs::remove_all(src);
+}
+
+TEST_CASE("SyncWatcher: read-only snapshot throws", "[watch][syncwatch]") {
+    auto path = make_temp_repo();
+    auto src = make_src_dir();
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("x", "x");
+        store.tags().set("v1", snap);
+        CHECK_THROWS_AS(store.tags()["v1"].watch_sync_in(src), vost::PermissionError);
+    }
+    fs::remove_all(path);
+    fs::remove_all(src);
+}
+
+// ---------------------------------------------------------------------------
+// SyncFollower
+// ---------------------------------------------------------------------------
+
+static std::string read_local(const fs::path& p) {
+    std::ifstream ifs(p, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), {});
+}
+
+TEST_CASE("SyncFollower: follows a branch incrementally", "[watch][follow]") {
+    auto path = make_temp_repo();
+    auto dest = make_src_dir();
+    auto state_file = fs::path(dest.string() + ".state");
+    {
+        auto store = open_store(path);
+        auto snap = store.branches()["main"].write_text("site/index.html", "v1");
+        snap = snap.write_text("site/old.html", "old");
+
+        Commits updates;
+        vost::FollowOptions opts;
+        opts.state_file = state_file;
+        auto f = store.follow("main", "site", dest, opts,
+            [&](const vost::ChangeReport& r, const vost::Fs&) { updates.push(r); });
+        REQUIRE(f.active());
+        CHECK(read_local(dest / "index.html") == "v1");
+        CHECK(f.tree_hash() == *snap.tree_hash());
+        CHECK(f.updates() == 0);
+
+        snap = snap.write_text("site/index.html", "v2");
+        snap = snap.remove({"site/old.html"});
+        for (int i = 0; i < 250 && f.tree_hash() != *snap.tree_hash(); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(f.tree_hash() == *snap.tree_hash());
+        CHECK(read_local(dest / "index.html") == "v2");
+        CHECK_FALSE(fs::exists(dest / "old.html"));
+        CHECK(f.updates() >= 1);
+        CHECK_FALSE(updates.wait_for(1).empty());
+        CHECK_FALSE(f.last_error().has_value());
+        f.stop();
+
+        // A new follower resumes from the state file with a diff: files
+        // outside the diff (like this local one) are left alone.
+        write_file(dest / "local.txt", "mine");
+        snap = snap.write_text("site/new.html", "new");
+        auto g = store.follow("main", "site", dest, opts);
+        CHECK(read_local(dest / "new.html") == "new");
+        CHECK(read_local(dest / "local.txt") == "mine");
+        CHECK(g.tree_hash() == *snap.tree_hash());
+    }
+    fs::remove_all(path);
+    fs::remove_all(dest);
+    fs::remove(state_file);
+}
@@ -0,0 +1,83 @@
+#!/usr/bin/env bash
+# Cross-language performance comparison.
+# Runs the same workload (bench_workload.json) through every available
+# implementation against one shared generated repo and prints throughput
+# (items/s) side by side.
+#
+# Usage: interop/bench.sh [--workload FILE] [--json FILE] [--keep]
+set -euo pipefail
+cd "$(dirname "$0")/.."
+
+WORKLOAD="interop/bench_workload.json"
+JSON_OUT=""
+KEEP=false
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --workload) WORKLOAD="$2"; shift 2 ;;
+        --json)     JSON_OUT="$2"; shift 2 ;;
+        --keep)     KEEP=true; shift ;;
+        *) echo "unknown option: $1" >&2; exit 1 ;;
+    esac
+done
+
+TMPDIR=$(mktemp -d)
+if $KEEP; then
+    echo "(keeping $TMPDIR)"
+else
+    trap 'rm -rf "$TMPDIR"' EXIT
+fi
+RESULTS="$TMPDIR/results.jsonl"
+: > "$RESULTS"
+
+HAS_RUST=false
+if command -v cargo &>/dev/null && [[ -f rs/Cargo.toml ]]; then
+    HAS_RUST=true
+fi
+
+HAS_CPP=false
+if [[ -x cpp/build/cpp_bench ]]; then
+    HAS_CPP=true
+fi
+
+HAS_KOTLIN=false
+KT_JAR="kotlin/build/libs/vost-interop.jar"
+if [[ -f "$KT_JAR" ]]; then
+    HAS_KOTLIN=true
+fi
+
+echo "=== Interop benchmark (workdir: $TMPDIR) ==="
+
+echo ""
+echo "--- Setup (Python) ---"
+uv run python interop/py_bench.py setup "$WORKLOAD" "$TMPDIR"
+
+# Drivers print JSON lines; anything else (build noise) is filtered out.
+
+if $HAS_CPP; then
+    echo "--- C++ ---"
+    cpp/build/cpp_bench "$WORKLOAD" "$TMPDIR" | grep '^{' | tee -a "$RESULTS"
+fi
+
+if $HAS_RUST; then
+    echo "--- Rust ---"
+    cargo run --quiet --release --manifest-path rs/Cargo.toml --example rs_bench -- \
+        "$WORKLOAD" "$TMPDIR" | grep '^{' | tee -a "$RESULTS"
+fi
+
+echo "--- Python ---"
+uv run python interop/py_bench.py run "$WORKLOAD" "$TMPDIR" | grep '^{' | tee -a "$RESULTS"
+
+echo "--- TypeScript ---"
+(cd ts && npx tsx ../interop/ts_bench.ts "../$WORKLOAD" "$TMPDIR") | grep '^{' | tee -a "$RESULTS"
+
+if $HAS_KOTLIN; then
+    echo "--- Kotlin ---"
+    java -jar "$KT_JAR" bench "$WORKLOAD" "$TMPDIR" | grep '^{' | tee -a "$RESULTS"
+fi
+
+echo ""
+if [[ -n "$JSON_OUT" ]]; then
+    uv run python interop/py_bench.py report "$RESULTS" --json "$JSON_OUT"
+else
+    uv run python interop/py_bench.py report "$RESULTS"
+fi
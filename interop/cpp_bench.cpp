@@ -0,0 +1,114 @@
+/**
+ * Run the cross-implementation benchmark workload through the C++ port.
+ * Usage: cpp_bench <bench_workload.json> <workdir>
+ *
+ * Expects `py_bench.py setup` to have populated <workdir>; prints one JSON
+ * line per operation (see py_bench.py).
+ */
+
+#include <vost/vost.h>
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+namespace sfs = std::filesystem;
+
+static std::vector<uint8_t> content(size_t i, size_t size) {
+    std::vector<uint8_t> out(size);
+    for (size_t j = 0; j < size; ++j)
+        out[j] = static_cast<uint8_t>((i * 31 + j) % 251);
+    return out;
+}
+
+static double best_of(int repeat, const std::function<void(int)>& fn) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repeat; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn(r);
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        if (dt.count() < best) best = dt.count();
+    }
+    return best;
+}
+
+static void emit(const std::string& op, size_t items, double seconds) {
+    std::cout << json{{"impl", "cpp"}, {"op", op}, {"items", items},
+                      {"seconds", seconds}}.dump() << std::endl;
+}
+
+static vost::Fs fresh_branch(const sfs::path& path) {
+    vost::OpenOptions opts;
+    opts.create = true;
+    opts.branch = "main";
+    return vost::GitStore::open(path, opts).branches()["main"];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: cpp_bench <bench_workload.json> <workdir>\n";
+        return 1;
+    }
+    json w;
+    std::ifstream(argv[1]) >> w;
+    sfs::path workdir = argv[2];
+    sfs::path out = workdir / "cpp";
+    sfs::remove_all(out);
+    sfs::create_directories(out);
+    int repeat = w["repeat"].get<int>();
+    size_t file_size = w["file_size"].get<size_t>();
+
+    // bulk_write
+    std::vector<std::vector<uint8_t>> blobs;
+    for (size_t i = 0; i < w["bulk_files"].get<size_t>(); ++i)
+        blobs.push_back(content(i, file_size));
+    emit("bulk_write", blobs.size(), best_of(repeat, [&](int r) {
+        auto b = fresh_branch(out / ("bulk" + std::to_string(r) + ".git")).batch();
+        char name[64];
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            std::snprintf(name, sizeof(name), "bulk/d%02zu/f%05zu.bin", i % 50, i);
+            b.write(name, blobs[i]);
+        }
+        b.commit();
+    }));
+
+    auto fs = vost::GitStore::open(workdir / "base.git").branches()["main"];
+
+    // random_read
+    std::vector<std::string> reads;
+    {
+        std::ifstream in(workdir / "read_paths.txt");
+        for (std::string line; std::getline(in, line);)
+            if (!line.empty()) reads.push_back(line);
+    }
+    emit("random_read", reads.size(), best_of(repeat, [&](int) {
+        for (auto& p : reads) fs.read(p);
+    }));
+
+    // glob
+    auto pattern = w["glob"].get<std::string>();
+    size_t matched = fs.glob(pattern).size();
+    emit("glob", matched, best_of(repeat, [&](int) { fs.glob(pattern); }));
+
+    // log_by_path
+    vost::LogOptions log_opts;
+    log_opts.path = w["log_path"].get<std::string>();
+    size_t found = fs.log(log_opts).size();
+    emit("log_by_path", found, best_of(repeat, [&](int) { fs.log(log_opts); }));
+
+    // copy_in
+    emit("copy_in", w["copy_in_files"].get<size_t>(), best_of(repeat, [&](int r) {
+        fresh_branch(out / ("copy" + std::to_string(r) + ".git"))
+            .copy_in(workdir / "disk", "in");
+    }));
+
+    return 0;
+}
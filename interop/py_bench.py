@@ -0,0 +1,181 @@
+"""Cross-implementation benchmark: shared setup, Python driver and report.
+
+Usage:
+    py_bench.py setup  <workload.json> <workdir>
+    py_bench.py run    <workload.json> <workdir>
+    py_bench.py report <results.jsonl> [--json FILE]
+
+``setup`` creates the shared inputs every driver reads:
+
+- ``base.git``    -- ``dirs`` x ``files_per_dir`` files (``.txt``/``.bin``
+  alternating) plus ``history_commits`` commits, every ``hot_every``-th of
+  which rewrites ``log_path``
+- ``disk/``       -- ``copy_in_files`` files for the copy-in workload
+- ``read_paths.txt`` -- ``reads`` paths sampled from base.git
+
+Each driver (``run`` here, ``cpp_bench``, ``rs_bench``, ``ts_bench.ts``,
+``vost-interop bench``) prints one JSON line per operation:
+``{"impl": ..., "op": ..., "items": N, "seconds": best-of-repeat}``.
+"""
+
+import json
+import random
+import shutil
+import sys
+import time
+from pathlib import Path
+
+from vost import GitStore
+
+
+def content(i: int, size: int) -> bytes:
+    """Deterministic file content; every driver implements the same formula."""
+    return bytes((i * 31 + j) % 251 for j in range(size))
+
+
+def seed_path(d: int, f: int) -> str:
+    ext = "txt" if f % 2 == 0 else "bin"
+    return f"d{d:03d}/f{f:03d}.{ext}"
+
+
+# ---------------------------------------------------------------------------
+# Setup
+# ---------------------------------------------------------------------------
+
+
+def setup(w: dict, workdir: Path) -> None:
+    workdir.mkdir(parents=True, exist_ok=True)
+    store = GitStore.open(workdir / "base.git", branch="main")
+    fs = store.branches["main"]
+
+    paths = []
+    with fs.batch(message="seed") as batch:
+        for d in range(w["dirs"]):
+            for f in range(w["files_per_dir"]):
+                p = seed_path(d, f)
+                batch.write(p, content(len(paths), w["file_size"]))
+                paths.append(p)
+    fs = batch.fs
+
+    for c in range(w["history_commits"]):
+        if c % w["hot_every"] == 0:
+            fs = fs.write(w["log_path"], f"revision {c}\n".encode())
+        else:
+            fs = fs.write(f"cold/c{c:05d}.txt", f"cold {c}\n".encode())
+
+    rng = random.Random(w["seed"])
+    reads = [rng.choice(paths) for _ in range(w["reads"])]
+    (workdir / "read_paths.txt").write_text("\n".join(reads) + "\n")
+
+    disk = workdir / "disk"
+    for i in range(w["copy_in_files"]):
+        p = disk / f"g{i % 20:02d}" / f"f{i:05d}.dat"
+        p.parent.mkdir(parents=True, exist_ok=True)
+        p.write_bytes(content(i, w["file_size"]))
+
+    print(f"  setup: {len(paths)} files, {w['history_commits']} commits -> {workdir}")
+
+
+# ---------------------------------------------------------------------------
+# Python driver
+# ---------------------------------------------------------------------------
+
+
+def best_of(repeat: int, fn) -> float:
+    best = float("inf")
+    for r in range(repeat):
+        t0 = time.perf_counter()
+        fn(r)
+        best = min(best, time.perf_counter() - t0)
+    return best
+
+
+def emit(op: str, items: int, seconds: float) -> None:
+    print(json.dumps({"impl": "py", "op": op, "items": items, "seconds": seconds}), flush=True)
+
+
+def run(w: dict, workdir: Path) -> None:
+    out = workdir / "py"
+    shutil.rmtree(out, ignore_errors=True)
+    out.mkdir()
+    repeat = w["repeat"]
+
+    blobs = [content(i, w["file_size"]) for i in range(w["bulk_files"])]
+
+    def bulk_write(r):
+        fs = GitStore.open(out / f"bulk{r}.git", branch="main").branches["main"]
+        with fs.batch(message="bulk") as batch:
+            for i, data in enumerate(blobs):
+                batch.write(f"bulk/d{i % 50:02d}/f{i:05d}.bin", data)
+
+    emit("bulk_write", len(blobs), best_of(repeat, bulk_write))
+
+    fs = GitStore.open(workdir / "base.git", create=False).branches["main"]
+    reads = (workdir / "read_paths.txt").read_text().split()
+
+    def random_read(_):
+        for p in reads:
+            fs.read(p)
+
+    emit("random_read", len(reads), best_of(repeat, random_read))
+
+    matched = len(fs.glob(w["glob"]))
+    emit("glob", matched, best_of(repeat, lambda _: fs.glob(w["glob"])))
+
+    found = sum(1 for _ in fs.log(w["log_path"]))
+    emit("log_by_path", found, best_of(repeat, lambda _: list(fs.log(w["log_path"]))))
+
+    def copy_in(r):
+        dest = GitStore.open(out / f"copy{r}.git", branch="main").branches["main"]
+        dest.copy_in(str(workdir / "disk") + "/", "in")
+
+    emit("copy_in", w["copy_in_files"], best_of(repeat, copy_in))
+
+
+# ---------------------------------------------------------------------------
+# Report
+# ---------------------------------------------------------------------------
+
+OPS = ["bulk_write", "random_read", "glob", "log_by_path", "copy_in"]
+IMPLS = ["cpp", "rs", "py", "ts", "kt"]
+
+
+def report(results_path: Path, json_out: str | None) -> None:
+    rows = [json.loads(line) for line in results_path.read_text().splitlines() if line.startswith("{")]
+    impls = [i for i in IMPLS if any(r["impl"] == i for r in rows)]
+    by = {(r["impl"], r["op"]): r for r in rows}
+
+    print(f"{'items/s':<14}" + "".join(f"{i:>12}" for i in impls))
+    for op in OPS:
+        cells = []
+        for i in impls:
+            r = by.get((i, op))
+            cells.append(f"{r['items'] / r['seconds']:>12,.0f}" if r and r["seconds"] > 0 else f"{'-':>12}")
+        print(f"{op:<14}" + "".join(cells))
+
+    if json_out:
+        Path(json_out).write_text(json.dumps(rows, indent=2) + "\n")
+
+
+def main() -> None:
+    if len(sys.argv) < 3:
+        print(__doc__, file=sys.stderr)
+        sys.exit(1)
+    cmd = sys.argv[1]
+    if cmd == "report":
+        json_out = sys.argv[4] if len(sys.argv) > 4 and sys.argv[3] == "--json" else None
+        report(Path(sys.argv[2]), json_out)
+        return
+    w = json.loads(Path(sys.argv[2]).read_text())
+    workdir = Path(sys.argv[3])
+    if cmd == "setup":
+        setup(w, workdir)
+    elif cmd == "run":
+        run(w, workdir)
+    else:
+        print(f"unknown command: {cmd}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
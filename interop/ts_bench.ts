@@ -0,0 +1,102 @@
+/**
+ * Run the cross-implementation benchmark workload through the TypeScript port.
+ * Usage: npx tsx interop/ts_bench.ts <bench_workload.json> <workdir>
+ *
+ * Expects `py_bench.py setup` to have populated <workdir>; prints one JSON
+ * line per operation (see py_bench.py).
+ */
+
+import * as fs from 'node:fs';
+import * as path from 'node:path';
+import { GitStore, FS } from '../ts/src/index.js';
+
+interface Workload {
+  file_size: number;
+  log_path: string;
+  glob: string;
+  bulk_files: number;
+  copy_in_files: number;
+  repeat: number;
+}
+
+function content(i: number, size: number): Uint8Array {
+  const out = new Uint8Array(size);
+  for (let j = 0; j < size; j++) out[j] = (i * 31 + j) % 251;
+  return out;
+}
+
+async function bestOf(repeat: number, fn: (r: number) => Promise<void>): Promise<number> {
+  let best = Infinity;
+  for (let r = 0; r < repeat; r++) {
+    const t0 = performance.now();
+    await fn(r);
+    best = Math.min(best, (performance.now() - t0) / 1000);
+  }
+  return best;
+}
+
+function emit(op: string, items: number, seconds: number) {
+  console.log(JSON.stringify({ impl: 'ts', op, items, seconds }));
+}
+
+async function freshBranch(repoPath: string): Promise<FS> {
+  const store = await GitStore.open(repoPath, { fs, branch: 'main' });
+  return store.branches.get('main');
+}
+
+async function main() {
+  const w: Workload = JSON.parse(fs.readFileSync(process.argv[2], 'utf-8'));
+  const workdir = process.argv[3];
+  const out = path.join(workdir, 'ts');
+  fs.rmSync(out, { recursive: true, force: true });
+  fs.mkdirSync(out, { recursive: true });
+
+  // bulk_write
+  const blobs = Array.from({ length: w.bulk_files }, (_, i) => content(i, w.file_size));
+  emit('bulk_write', blobs.length, await bestOf(w.repeat, async (r) => {
+    const batch = (await freshBranch(path.join(out, `bulk${r}.git`))).batch();
+    for (let i = 0; i < blobs.length; i++) {
+      const d = String(i % 50).padStart(2, '0');
+      const f = String(i).padStart(5, '0');
+      await batch.write(`bulk/d${d}/f${f}.bin`, blobs[i]);
+    }
+    await batch.commit();
+  }));
+
+  const store = await GitStore.open(path.join(workdir, 'base.git'), { fs, create: false });
+  const snapshot = await store.branches.get('main');
+
+  // random_read
+  const reads = fs.readFileSync(path.join(workdir, 'read_paths.txt'), 'utf-8').split(/\s+/).filter(Boolean);
+  emit('random_read', reads.length, await bestOf(w.repeat, async () => {
+    for (const p of reads) await snapshot.read(p);
+  }));
+
+  // glob
+  const matched = (await snapshot.glob(w.glob)).length;
+  emit('glob', matched, await bestOf(w.repeat, async () => {
+    await snapshot.glob(w.glob);
+  }));
+
+  // log_by_path
+  const logAll = async () => {
+    let n = 0;
+    for await (const _ of snapshot.log({ path: w.log_path })) n++;
+    return n;
+  };
+  const found = await logAll();
+  emit('log_by_path', found, await bestOf(w.repeat, async () => {
+    await logAll();
+  }));
+
+  // copy_in
+  emit('copy_in', w.copy_in_files, await bestOf(w.repeat, async (r) => {
+    const dest = await freshBranch(path.join(out, `copy${r}.git`));
+    await dest.copyIn(path.join(workdir, 'disk') + '/', 'in');
+  }));
+}
+
+main().catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
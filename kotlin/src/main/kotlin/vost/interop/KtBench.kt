@@ -0,0 +1,82 @@
+package vost.interop
+
+import com.google.gson.Gson
+import com.google.gson.JsonObject
+import vost.GitStore
+import java.io.File
+
+/**
+ * Run the cross-implementation benchmark workload through the Kotlin port.
+ *
+ * Expects `py_bench.py setup` to have populated the work directory; prints
+ * one JSON line per operation (see interop/py_bench.py).
+ */
+object KtBench {
+
+    private fun content(i: Int, size: Int): ByteArray =
+        ByteArray(size) { j -> ((i.toLong() * 31 + j) % 251).toByte() }
+
+    private fun bestOf(repeat: Int, fn: (Int) -> Unit): Double {
+        var best = Double.POSITIVE_INFINITY
+        for (r in 0 until repeat) {
+            val t0 = System.nanoTime()
+            fn(r)
+            best = minOf(best, (System.nanoTime() - t0) / 1e9)
+        }
+        return best
+    }
+
+    private fun emit(op: String, items: Int, seconds: Double) {
+        val obj = JsonObject()
+        obj.addProperty("impl", "kt")
+        obj.addProperty("op", op)
+        obj.addProperty("items", items)
+        obj.addProperty("seconds", seconds)
+        println(obj.toString())
+    }
+
+    fun main(workloadPath: String, workdir: String) {
+        val w = Gson().fromJson(File(workloadPath).readText(), JsonObject::class.java)
+        val fileSize = w.get("file_size").asInt
+        val repeat = w.get("repeat").asInt
+        val out = File(workdir, "kt")
+        out.deleteRecursively()
+        out.mkdirs()
+
+        // bulk_write
+        val blobs = List(w.get("bulk_files").asInt) { content(it, fileSize) }
+        emit("bulk_write", blobs.size, bestOf(repeat) { r ->
+            GitStore.open("${out.path}/bulk$r.git").use { store ->
+                val batch = store.branches["main"].batch()
+                blobs.forEachIndexed { i, data ->
+                    batch.write("bulk/d%02d/f%05d.bin".format(i % 50, i), data)
+                }
+                batch.commit()
+            }
+        })
+
+        GitStore.open("$workdir/base.git", create = false).use { store ->
+            val fs = store.branches["main"]
+
+            // random_read
+            val reads = File(workdir, "read_paths.txt").readLines().filter { it.isNotEmpty() }
+            emit("random_read", reads.size, bestOf(repeat) { reads.forEach { p -> fs.read(p) } })
+
+            // glob
+            val pattern = w.get("glob").asString
+            emit("glob", fs.glob(pattern).size, bestOf(repeat) { fs.glob(pattern) })
+
+            // log_by_path
+            val logPath = w.get("log_path").asString
+            emit("log_by_path", fs.log(logPath).size, bestOf(repeat) { fs.log(logPath) })
+        }
+
+        // copy_in
+        val disk = File(workdir, "disk").path + "/"
+        emit("copy_in", w.get("copy_in_files").asInt, bestOf(repeat) { r ->
+            GitStore.open("${out.path}/copy$r.git").use { store ->
+                store.branches["main"].copyIn(listOf(disk), "in")
+            }
+        })
+    }
+}
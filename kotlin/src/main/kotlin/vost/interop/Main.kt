@@ -2,7 +2,7 @@ package vost.interop
 
 fun main(args: Array<String>) {
     if (args.isEmpty()) {
-        System.err.println("Usage: vost-interop <write|read> ...")
+        System.err.println("Usage: vost-interop <write|read|bench> ...")
         System.exit(1)
     }
     when (args[0]) {
@@ -22,6 +22,13 @@ fun main(args: Array<String>) {
             val mode = if (args.size > 4) args[4] else "repo"
             KtRead.main(args[1], args[2], prefix, mode)
         }
+        "bench" -> {
+            if (args.size < 3) {
+                System.err.println("Usage: vost-interop bench <bench_workload.json> <workdir>")
+                System.exit(1)
+            }
+            KtBench.main(args[1], args[2])
+        }
         else -> {
             System.err.println("Unknown command: ${args[0]}")
             System.exit(1)
@@ -0,0 +1,113 @@
+//! Run the cross-implementation benchmark workload through the Rust port.
+//! Usage: cargo run --release --manifest-path rs/Cargo.toml --example rs_bench -- <bench_workload.json> <workdir>
+//!
+//! Expects `py_bench.py setup` to have populated <workdir>; prints one JSON
+//! line per operation (see interop/py_bench.py).
+
+use std::path::{Path, PathBuf};
+use std::time::Instant;
+
+use serde::Deserialize;
+
+use vost::fs::{BatchOptions, CopyInOptions, LogOptions};
+use vost::{Fs, GitStore, OpenOptions};
+
+#[derive(Deserialize)]
+struct Workload {
+    file_size: usize,
+    log_path: String,
+    glob: String,
+    bulk_files: usize,
+    copy_in_files: usize,
+    repeat: usize,
+}
+
+fn content(i: usize, size: usize) -> Vec<u8> {
+    (0..size).map(|j| ((i * 31 + j) % 251) as u8).collect()
+}
+
+fn best_of(repeat: usize, mut f: impl FnMut(usize)) -> f64 {
+    let mut best = f64::INFINITY;
+    for r in 0..repeat {
+        let t0 = Instant::now();
+        f(r);
+        best = best.min(t0.elapsed().as_secs_f64());
+    }
+    best
+}
+
+fn emit(op: &str, items: usize, seconds: f64) {
+    println!(
+        "{}",
+        serde_json::json!({"impl": "rs", "op": op, "items": items, "seconds": seconds})
+    );
+}
+
+fn fresh_branch(path: &Path) -> Fs {
+    let store = GitStore::open(path, OpenOptions {
+        create: true,
+        branch: Some("main".to_string()),
+        ..Default::default()
+    })
+    .unwrap();
+    store.branches().get("main").unwrap()
+}
+
+fn main() {
+    let args: Vec<String> = std::env::args().collect();
+    if args.len() < 3 {
+        eprintln!("Usage: rs_bench <bench_workload.json> <workdir>");
+        std::process::exit(1);
+    }
+    let w: Workload = serde_json::from_str(&std::fs::read_to_string(&args[1]).unwrap()).unwrap();
+    let workdir = PathBuf::from(&args[2]);
+    let out = workdir.join("rs");
+    let _ = std::fs::remove_dir_all(&out);
+    std::fs::create_dir_all(&out).unwrap();
+
+    // bulk_write
+    let blobs: Vec<Vec<u8>> = (0..w.bulk_files).map(|i| content(i, w.file_size)).collect();
+    let secs = best_of(w.repeat, |r| {
+        let fs = fresh_branch(&out.join(format!("bulk{}.git", r)));
+        let mut batch = fs.batch(BatchOptions::default());
+        for (i, data) in blobs.iter().enumerate() {
+            batch.write(&format!("bulk/d{:02}/f{:05}.bin", i % 50, i), data).unwrap();
+        }
+        batch.commit().unwrap();
+    });
+    emit("bulk_write", blobs.len(), secs);
+
+    let store = GitStore::open(workdir.join("base.git"), OpenOptions {
+        create: false,
+        ..Default::default()
+    })
+    .unwrap();
+    let fs = store.branches().get("main").unwrap();
+
+    // random_read
+    let reads_text = std::fs::read_to_string(workdir.join("read_paths.txt")).unwrap();
+    let reads: Vec<&str> = reads_text.split_whitespace().collect();
+    let secs = best_of(w.repeat, |_| {
+        for p in &reads {
+            fs.read(p).unwrap();
+        }
+    });
+    emit("random_read", reads.len(), secs);
+
+    // glob
+    let matched = fs.glob(&w.glob).unwrap().len();
+    emit("glob", matched, best_of(w.repeat, |_| { fs.glob(&w.glob).unwrap(); }));
+
+    // log_by_path
+    let log_opts = || LogOptions { path: Some(w.log_path.clone()), ..Default::default() };
+    let found = fs.log(log_opts()).unwrap().len();
+    emit("log_by_path", found, best_of(w.repeat, |_| { fs.log(log_opts()).unwrap(); }));
+
+    // copy_in
+    let disk = format!("{}/", workdir.join("disk").display());
+    let secs = best_of(w.repeat, |r| {
+        let fs = fresh_branch(&out.join(format!("copy{}.git", r)));
+        fs.copy_in(&[disk.as_str()], "in", CopyInOptions::default()).unwrap();
+    });
+    emit("copy_in", w.copy_in_files, secs);
+}